@@ -0,0 +1,104 @@
+#pragma once
+
+#include "rve_geometry_pool.hpp"
+#include "rve_job_system.hpp"
+#include "rve_model.hpp"
+#include "rve_residency_manager.hpp"
+#include "rve_vulkan_device.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rve {
+	// Owns every model and hands out 32 bit RveModelHandles to them. Models are keyed by name, or for mesh
+	// files by the hash of the file content, so requesting an asset again shares the existing upload.
+	// Reference counts live in a central table next to a dense array of models indexed by handle. A model
+	// whose count drops to zero is destroyed once the frames in flight that may draw it have retired;
+	// until then a new request for it revives it.
+	class RveAssetRegistry {
+	public:
+		struct Stats {
+			uint32_t models = 0;
+			uint32_t pendingFrees = 0;
+			uint64_t requests = 0;
+			uint64_t deduplicated = 0;
+			uint64_t freed = 0;
+		};
+
+		RveAssetRegistry(RveVulkanDevice& device, RveGeometryPool& pool, RveJobSystem& jobSystem, RveResidencyManager& residency);
+		// Destroys every model, including ones still referenced
+		~RveAssetRegistry();
+		RveAssetRegistry(const RveAssetRegistry &) = delete;
+		RveAssetRegistry &operator=(const RveAssetRegistry &) = delete;
+
+		// Acquires the model registered under the key, create is only called when there is none
+		RveModelHandle Create(const std::string& key, const std::function<std::unique_ptr<RveModel>()>& create);
+		// Acquires one handle per mesh of every file, in file order. Files already loaded, repeated or with
+		// the same content as another are loaded once. Mesh caches stream through the residency manager,
+		// other files are imported together on the job system. Throws if a file cannot be loaded.
+		std::vector<RveModelHandle> Load(const std::vector<std::string>& filePaths);
+		void Acquire(RveModelHandle handle);
+		void Release(RveModelHandle handle);
+
+		bool IsValid(RveModelHandle handle) const {
+			uint32_t index = handle.GetIndex();
+			return index < models.size() && generations[index] == handle.GetGeneration() && models[index] != nullptr;
+		}
+		RveModel& Get(RveModelHandle handle) const {
+			assert(IsValid(handle) && "(rve_asset_registry.hpp) Stale or null model handle");
+			return *models[handle.GetIndex()];
+		}
+		// nullptr for null or stale handles
+		RveModel *TryGet(RveModelHandle handle) const { return IsValid(handle) ? models[handle.GetIndex()].get() : nullptr; }
+
+		// Destroys released models whose frames have retired, call once per frame
+		void Update();
+		// Handles of the models the last Update destroyed, for caches keyed by handle to drop them
+		const std::vector<RveModelHandle>& GetDestroyedModels() const { return destroyedModels; }
+		Stats GetStats() const;
+
+		static constexpr uint32_t maxModels = RveModelHandle::indexMask;
+
+	private:
+		struct PendingFree {
+			RveModelHandle handle;
+			uint64_t frame;
+		};
+
+		RveModelHandle AddModel(const std::string& key, std::unique_ptr<RveModel> model, bool streamed);
+		// Acquires the slot under the key, a null handle when there is none
+		RveModelHandle AcquireKey(const std::string& key);
+		void DestroyModel(uint32_t index);
+		static std::string MeshKey(uint64_t contentHash, uint32_t mesh);
+
+		RveVulkanDevice& rveVulkanDevice;
+		RveGeometryPool& rveGeometryPool;
+		RveJobSystem& jobSystem;
+		RveResidencyManager& residency;
+
+		// Slot tables indexed by handle index
+		std::vector<std::unique_ptr<RveModel>> models;
+		std::vector<uint32_t> refCounts;
+		std::vector<uint8_t> generations;
+		// Frame of the last release to zero, earlier pending frees of a revived model are ignored
+		std::vector<uint64_t> releaseFrames;
+		std::vector<bool> streamed;
+		std::vector<std::string> keys;
+		std::vector<uint32_t> freeSlots;
+		std::vector<PendingFree> pendingFrees;
+		std::vector<RveModelHandle> destroyedModels;
+
+		std::unordered_map<std::string, uint32_t> slotByKey;
+		// Content hash per canonical path and mesh count per content hash, known once a file was loaded
+		std::unordered_map<std::string, uint64_t> hashByPath;
+		std::unordered_map<uint64_t, uint32_t> meshCountByHash;
+		uint64_t requests = 0;
+		uint64_t deduplicated = 0;
+		uint64_t freed = 0;
+	};
+} // namespace rve
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rve {
+	// Benchmarks run with --bench <name> [arguments]. Each prints its numbers and returns the process exit
+	// code, failing when the code it measured produced a wrong result or missed its target.
+	class RveBenchmarks {
+	public:
+		// The files to import for load, the size of the run for every other benchmark, none or 0 keeps the default
+		static int Run(const std::string& name, const std::vector<std::string>& arguments);
+
+		// Each benchmark keeps the fastest of this many runs
+		static constexpr uint32_t runs = 5;
+
+	private:
+		// TransformComponent::mat4() per object against RveTransformStore::Update, with every transform
+		// changed and with one in a hundred changed
+		static int Transforms(uint32_t count);
+		// Destroys and recreates one in a hundred of count live objects per round three ways: the removed
+		// RveGameObject vector, found by id and erased from the middle, RveWorld destroying in bulk and
+		// creating directly, and handles reserved on the job system and spawned at the next structural change
+		static int EntityChurn(uint32_t count);
+		// Builds a deep (16 chains) and a wide (root, sqrt(count) children, the rest grandchildren) hierarchy of
+		// count nodes and times RveTransformHierarchy::Update with every node, one in a hundred and none changed,
+		// against recomputing every world matrix in creation order
+		static int Hierarchy(uint32_t count);
+		// Scatters count boxes at a constant density and times RveBvh::QueryFrustum against testing every box,
+		// at a hundredth, a tenth and all of count, with the SAH rebuild and a refit of one box in ten moved
+		static int Bvh(uint32_t count);
+		// Times count empty jobs scheduled in batches, an empty ParallelFor and a compute bound ParallelFor over
+		// count items with 1, 2, 4 and more workers, up to the default worker count. Threads beyond the
+		// machine's cores only add switching, so scaling is read against hardware_concurrency.
+		static int Jobs(uint32_t count);
+		// Imports and uploads the files with RveMeshLoader on the calling thread alone, then with 1, 2, 4 and
+		// more workers up to the default worker count, and prints the parse and upload time of each
+		static int Load(const std::vector<std::string>& filePaths);
+	};
+} // namespace rve
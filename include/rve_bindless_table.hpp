@@ -0,0 +1,71 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+#include "rve_swap_chain.hpp"
+
+#include <array>
+#include <vector>
+
+namespace rve {
+	// One large update after bind descriptor set holding every storage buffer and texture,
+	// shaders reach resources through 32 bit slot indices so a frame needs a single set bind.
+	// Requires RveVulkanDevice::IsBindlessSupported().
+	class RveBindlessTable {
+	public:
+		// Matches the binding numbers of the bindless set in the shaders
+		enum class Binding : uint32_t {
+			StorageBuffer = 0,
+			Texture = 1
+		};
+
+		struct Stats {
+			uint32_t storageBuffers = 0;
+			uint32_t textures = 0;
+		};
+
+		static constexpr uint32_t invalidIndex = ~0u;
+
+		RveBindlessTable(RveVulkanDevice& device, uint32_t maxStorageBuffers = 1024, uint32_t maxTextures = 4096);
+		~RveBindlessTable();
+		RveBindlessTable(const RveBindlessTable &) = delete;
+		RveBindlessTable &operator=(const RveBindlessTable &) = delete;
+
+		// Must be called after the frame's fence has been waited on, recycles slots released MAX_FRAMES_IN_FLIGHT frames ago
+		void BeginFrame(int frameIndex);
+		uint32_t AddStorageBuffer(const VkDescriptorBufferInfo& bufferInfo);
+		uint32_t AddTexture(const VkDescriptorImageInfo& imageInfo);
+		// Only valid while no pending command buffer reads the slot
+		void UpdateStorageBuffer(uint32_t index, const VkDescriptorBufferInfo& bufferInfo);
+		void UpdateTexture(uint32_t index, const VkDescriptorImageInfo& imageInfo);
+		// The slot stays readable by frames already recorded, the resource must outlive them
+		void Release(Binding binding, uint32_t index);
+
+		void Bind(
+			VkCommandBuffer commandBuffer,
+			VkPipelineLayout pipelineLayout,
+			uint32_t setIndex,
+			VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS) const;
+
+		VkDescriptorSetLayout GetSetLayout() const { return setLayout; }
+		Stats GetStats() const { return {slots[0].used, slots[1].used}; }
+
+	private:
+		struct SlotAllocator {
+			uint32_t capacity = 0;
+			uint32_t next = 0;
+			uint32_t used = 0;
+			std::vector<uint32_t> freeList;
+			std::array<std::vector<uint32_t>, RveSwapChain::MAX_FRAMES_IN_FLIGHT> retired;
+		};
+
+		uint32_t AllocateSlot(Binding binding);
+		void Write(Binding binding, uint32_t index, const VkDescriptorBufferInfo *bufferInfo, const VkDescriptorImageInfo *imageInfo);
+
+		RveVulkanDevice& rveVulkanDevice;
+		VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+		std::array<SlotAllocator, 2> slots;
+		int currentFrame = 0;
+	};
+} // namespace rve
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <cstdint>
+
+namespace rve {
+	// CPU decoder for the BC formats a device without textureCompressionBC cannot sample. Blocks decode
+	// to 4x4 RGBA8 pixels, row major; BC4 and BC5 fill the channels they store and leave the rest at
+	// 0 with an opaque alpha, which is what sampling the compressed format returns.
+	class RveBlockDecoder {
+	public:
+		// BC1 to BC5 unorm and BC7, in their sRGB variants where they have one
+		static bool IsSupported(VkFormat format);
+		// 8 or 16 bytes, 0 for formats that are not block compressed
+		static uint32_t GetBlockSize(VkFormat format);
+		static bool IsSrgb(VkFormat format);
+		static void DecodeBlock(VkFormat format, const uint8_t *block, uint8_t pixels[64]);
+
+	private:
+		static void DecodeColor(const uint8_t *block, bool fourColors, uint8_t pixels[64]);
+		// BC3 alpha and BC4/BC5 channel block, written to every fourth byte starting at channel
+		static void DecodeChannel(const uint8_t *block, uint8_t pixels[64], uint32_t channel);
+		static void DecodeBc7(const uint8_t *block, uint8_t pixels[64]);
+	};
+} // namespace rve
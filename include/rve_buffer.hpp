@@ -0,0 +1,54 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+
+namespace rve {
+	class RveBuffer {
+	public:
+		RveBuffer(
+			RveVulkanDevice& device,
+			VkDeviceSize instanceSize,
+			uint32_t instanceCount,
+			VkBufferUsageFlags usageFlags,
+			VkMemoryPropertyFlags memoryPropertyFlags,
+			VkDeviceSize minOffsetAlignment = 1);
+		~RveBuffer();
+		RveBuffer(const RveBuffer &) = delete;
+		RveBuffer &operator=(const RveBuffer &) = delete;
+
+		VkResult Map(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+		void Unmap();
+
+		void WriteToBuffer(const void *data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+		VkResult Flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+		VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) const;
+
+		void WriteToIndex(const void *data, uint32_t index);
+		VkResult FlushIndex(uint32_t index);
+		VkDescriptorBufferInfo DescriptorInfoForIndex(uint32_t index) const;
+
+		VkBuffer GetBuffer() const { return buffer; }
+		void *GetMappedMemory() const { return mapped; }
+		uint32_t GetInstanceCount() const { return instanceCount; }
+		VkDeviceSize GetInstanceSize() const { return instanceSize; }
+		VkDeviceSize GetAlignmentSize() const { return alignmentSize; }
+		VkBufferUsageFlags GetUsageFlags() const { return usageFlags; }
+		VkMemoryPropertyFlags GetMemoryPropertyFlags() const { return memoryPropertyFlags; }
+		VkDeviceSize GetBufferSize() const { return bufferSize; }
+
+		static VkDeviceSize GetAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
+
+	private:
+		RveVulkanDevice& rveVulkanDevice;
+		void *mapped = nullptr;
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+
+		VkDeviceSize bufferSize;
+		uint32_t instanceCount;
+		VkDeviceSize instanceSize;
+		VkDeviceSize alignmentSize;
+		VkBufferUsageFlags usageFlags;
+		VkMemoryPropertyFlags memoryPropertyFlags;
+	};
+} // namespace rve
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "rve_job_system.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace rve {
+	// Default constructed boxes are empty, expanding one by another box gives that box
+	struct RveAabb {
+		glm::vec3 min{std::numeric_limits<float>::max()};
+		glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+		void Expand(const RveAabb& other) {
+			min = glm::min(min, other.min);
+			max = glm::max(max, other.max);
+		}
+		glm::vec3 Center() const { return (min + max) * 0.5f; }
+		float SurfaceArea() const {
+			glm::vec3 extent = glm::max(max - min, glm::vec3{0.0f});
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+		}
+		bool Overlaps(const RveAabb& other) const {
+			return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::lessThanEqual(other.min, max));
+		}
+		bool operator==(const RveAabb &) const = default;
+	};
+
+	// Bounding volume hierarchy over dynamic boxes. Moved boxes refit their leaf and the ancestors whose
+	// bounds actually change. New boxes are kept in a short list tested linearly until the next rebuild,
+	// which runs a binned SAH build as a job from a snapshot and is swapped in when finished.
+	// Queries append the user data of every matching live box to a caller owned list.
+	class RveBvh {
+	public:
+		using Proxy = uint32_t;
+
+		struct Stats {
+			uint32_t proxies = 0;
+			uint32_t pendingProxies = 0;
+			uint32_t nodes = 0;
+			uint32_t rebuilds = 0;
+			uint32_t refitNodes = 0;
+			// Nodes tested by queries since the last Maintain
+			uint32_t nodesVisited = 0;
+		};
+
+		explicit RveBvh(RveJobSystem& jobSystem) : jobSystem{jobSystem} {}
+		~RveBvh();
+		RveBvh(const RveBvh &) = delete;
+		RveBvh &operator=(const RveBvh &) = delete;
+
+		Proxy Insert(const RveAabb& bounds, uint32_t userData);
+		void Remove(Proxy proxy);
+		// Unchanged bounds are ignored, changed ones are refit by the next Maintain
+		void Update(Proxy proxy, const RveAabb& bounds);
+		// Call once per frame before querying: swaps in a finished rebuild, refits moved boxes and starts
+		// a rebuild when one is due
+		void Maintain();
+
+		// Planes face inward as returned by RveCamera::GetFrustumPlanes
+		void QueryFrustum(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& results) const;
+		void QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<uint32_t>& results) const;
+		void QueryOverlap(const RveAabb& bounds, std::vector<uint32_t>& results) const;
+
+		const Stats& GetStats() const { return stats; }
+
+		static constexpr Proxy noProxy = ~0u;
+		static constexpr uint32_t maxLeafSize = 4;
+		static constexpr uint32_t binCount = 12;
+		// Maintain calls between rebuilds while boxes keep moving, refits slowly loosen the tree
+		static constexpr uint32_t rebuildInterval = 120;
+		// Rebuild early once this many inserted boxes are waiting outside the tree
+		static constexpr uint32_t maxPendingProxies = 64;
+
+	private:
+		// Every node covers a contiguous range of the primitive list. Children are allocated in pairs
+		// after their parent, so walking the nodes backwards visits children before parents.
+		struct Node {
+			RveAabb bounds;
+			// Index of the left child, the right child follows it, 0 for leaves
+			uint32_t left = 0;
+			uint32_t first = 0;
+			uint32_t count = 0;
+		};
+
+		struct Tree {
+			std::vector<Node> nodes;
+			std::vector<uint32_t> parents;
+			std::vector<Proxy> primitives;
+		};
+
+		static Tree Build(const std::vector<RveAabb>& bounds, std::vector<Proxy> primitives);
+		void StartRebuild();
+		void FinishRebuild();
+		RveAabb LeafBounds(const Node& node) const;
+		void RefitLeaf(uint32_t nodeIndex);
+		void RefitAll();
+		void AppendRange(const Node& node, std::vector<uint32_t>& results) const;
+		void AppendIfAlive(Proxy proxy, std::vector<uint32_t>& results) const;
+		// Shared traversal for the queries, test(bounds) returns whether to descend
+		template<typename Test>
+		void Traverse(const Test& test, std::vector<uint32_t>& results) const;
+
+		std::vector<RveAabb> proxyBounds;
+		std::vector<uint32_t> proxyUserData;
+		std::vector<uint8_t> proxyAlive;
+		// Leaf holding the proxy in the current tree, or noProxy while pending
+		std::vector<uint32_t> proxyLeaves;
+		std::vector<Proxy> pendingProxies;
+		std::vector<Proxy> freeProxies;
+		// Removed proxies may still sit in the current tree or in the snapshot being built, so their
+		// slots are only reused once a tree built without them is in place
+		std::vector<Proxy> retiredProxies;
+		std::vector<Proxy> retiredBeforeBuild;
+
+		RveJobSystem& jobSystem;
+		Tree tree;
+		std::vector<uint8_t> leafDirty;
+		std::vector<uint32_t> dirtyLeaves;
+		// Written by the rebuild job, owned by it until the counter is done
+		Tree rebuiltTree;
+		RveJobCounter rebuildCounter;
+		bool rebuilding = false;
+		uint32_t framesSinceBuild = 0;
+		bool changedSinceBuild = false;
+		mutable Stats stats{};
+	};
+} // namespace rve
@@ -0,0 +1,30 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <array>
+
+namespace rve {
+	class RveCamera {
+	public:
+		void SetOrthographicProjection(float left, float right, float top, float bottom, float near, float far);
+		void SetPerspectiveProjection(float fovy, float aspect, float near, float far);
+
+		void SetViewDirection(glm::vec3 position, glm::vec3 direction, glm::vec3 up = glm::vec3{0.0f, -1.0f, 0.0f});
+		void SetViewTarget(glm::vec3 position, glm::vec3 target, glm::vec3 up = glm::vec3{0.0f, -1.0f, 0.0f});
+
+		const glm::mat4& GetProjection() const { return projectionMatrix; }
+		const glm::mat4& GetView() const { return viewMatrix; }
+		const glm::vec3& GetPosition() const { return position; }
+		bool IsPerspective() const { return perspective; }
+		// Normalized planes facing inward, a sphere is outside when dot(plane.xyz, center) + plane.w < -radius
+		std::array<glm::vec4, 6> GetFrustumPlanes() const;
+
+	private:
+		glm::mat4 projectionMatrix{1.0f};
+		glm::mat4 viewMatrix{1.0f};
+		glm::vec3 position{0.0f};
+		bool perspective = false;
+	};
+} // namespace rve
@@ -43,27 +43,20 @@ namespace rve {
 		}
 	};
 
-	class RveGameObject {
-		public:
-		using id_t = unsigned int;
-
-		RveGameObject(const RveGameObject &) = delete;
-		RveGameObject &operator=(const RveGameObject &) = delete;
-		RveGameObject(RveGameObject &&) = default;
-		RveGameObject &operator=(RveGameObject &&) = default;
+	// Drawn by RveRenderSystem, lodLevel is the LOD selected last frame and is updated while rendering
+	struct ModelComponent {
+		RveModelHandle model{};
+		uint32_t materialIndex = 0;
+		uint32_t lodLevel = 0;
+	};
 
-		static RveGameObject CreateGameObject() {
-			static id_t currentId = 0;
-			return RveGameObject{currentId++};
-		};
-		const id_t GetId() { return id; }
+	// Takes the place of TransformComponent for entities attached to an RveTransformHierarchy node,
+	// their world matrix is the node's
+	struct HierarchyComponent {
+		uint32_t node = ~0u;
+	};
 
-		std::shared_ptr<RveModel> model{};
+	struct ColorComponent {
 		glm::vec3 color{};
-		TransformComponent transform{};
-
-		private:
-		RveGameObject(id_t objectId) : id{objectId} {};
-		id_t id;
 	};
 } // namespace rve
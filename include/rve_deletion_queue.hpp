@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <type_traits>
+
+namespace rve {
+	// Vulkan objects released while earlier frames may still be executing. Each one is tagged with the
+	// frame that was recording when it was released and destroyed in bulk by the BeginFrame that follows
+	// the wait on that frame's fence, so releasing never blocks the CPU. Safe to release from any thread.
+	class RveDeletionQueue {
+	public:
+		struct Stats {
+			uint32_t pending = 0;
+			uint64_t destroyed = 0;
+		};
+
+		// frameLatency is the number of frames in flight, a frame retires that many frames after it began
+		RveDeletionQueue(VkDevice device, uint32_t frameLatency);
+		// Destroys everything still queued, the device must be idle
+		~RveDeletionQueue();
+		RveDeletionQueue(const RveDeletionQueue &) = delete;
+		RveDeletionQueue &operator=(const RveDeletionQueue &) = delete;
+
+		void DestroyBuffer(VkBuffer buffer) { Enqueue(VK_OBJECT_TYPE_BUFFER, buffer); }
+		void DestroyImage(VkImage image) { Enqueue(VK_OBJECT_TYPE_IMAGE, image); }
+		void DestroyImageView(VkImageView imageView) { Enqueue(VK_OBJECT_TYPE_IMAGE_VIEW, imageView); }
+		void DestroySampler(VkSampler sampler) { Enqueue(VK_OBJECT_TYPE_SAMPLER, sampler); }
+		void DestroyPipeline(VkPipeline pipeline) { Enqueue(VK_OBJECT_TYPE_PIPELINE, pipeline); }
+		void DestroyShaderModule(VkShaderModule shaderModule) { Enqueue(VK_OBJECT_TYPE_SHADER_MODULE, shaderModule); }
+		void FreeMemory(VkDeviceMemory memory) { Enqueue(VK_OBJECT_TYPE_DEVICE_MEMORY, memory); }
+
+		// Call once the fence of the frame about to be recorded has been waited on
+		void BeginFrame();
+		// Destroys everything queued, only after the device has been idled
+		void Flush();
+
+		// Frame being recorded, other owners of deferred work tag it with this
+		uint64_t GetFrame() const { return currentFrame.load(std::memory_order_acquire); }
+		// True once no command buffer recorded during the frame can still be executing
+		bool IsRetired(uint64_t frame) const { return frame + frameLatency <= GetFrame(); }
+		Stats GetStats();
+
+	private:
+		struct Deletion {
+			VkObjectType type;
+			uint64_t handle;
+			uint64_t frame;
+		};
+
+		// Non dispatchable handles are pointers on 64 bit platforms and uint64_t elsewhere
+		template<typename Handle>
+		void Enqueue(VkObjectType type, Handle handle) {
+			if(handle == VK_NULL_HANDLE) {
+				return;
+			}
+			if constexpr(std::is_pointer_v<Handle>) {
+				Enqueue(type, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle)));
+			} else {
+				Enqueue(type, static_cast<uint64_t>(handle));
+			}
+		}
+		void Enqueue(VkObjectType type, uint64_t handle);
+		void Destroy(const Deletion& deletion);
+
+		VkDevice device;
+		const uint32_t frameLatency;
+		std::mutex mutex;
+		std::deque<Deletion> deletions;
+		std::atomic<uint64_t> currentFrame{0};
+		uint64_t destroyed = 0;
+	};
+} // namespace rve
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace rve {
+	class RveDescriptorSetLayout {
+	public:
+		class Builder {
+		public:
+			Builder(RveVulkanDevice& device) : rveVulkanDevice{device} {}
+
+			Builder& AddBinding(
+				uint32_t binding,
+				VkDescriptorType descriptorType,
+				VkShaderStageFlags stageFlags,
+				uint32_t count = 1);
+			std::unique_ptr<RveDescriptorSetLayout> Build() const;
+
+		private:
+			RveVulkanDevice& rveVulkanDevice;
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings{};
+		};
+
+		RveDescriptorSetLayout(RveVulkanDevice& device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+		~RveDescriptorSetLayout();
+		RveDescriptorSetLayout(const RveDescriptorSetLayout &) = delete;
+		RveDescriptorSetLayout &operator=(const RveDescriptorSetLayout &) = delete;
+
+		VkDescriptorSetLayout GetDescriptorSetLayout() const { return descriptorSetLayout; }
+
+	private:
+		RveVulkanDevice& rveVulkanDevice;
+		VkDescriptorSetLayout descriptorSetLayout;
+		std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+
+		friend class RveDescriptorWriter;
+	};
+
+	class RveDescriptorPool {
+	public:
+		class Builder {
+		public:
+			Builder(RveVulkanDevice& device) : rveVulkanDevice{device} {}
+
+			Builder& AddPoolSize(VkDescriptorType descriptorType, uint32_t count);
+			Builder& SetPoolFlags(VkDescriptorPoolCreateFlags flags);
+			Builder& SetMaxSets(uint32_t count);
+			std::unique_ptr<RveDescriptorPool> Build() const;
+
+		private:
+			RveVulkanDevice& rveVulkanDevice;
+			std::vector<VkDescriptorPoolSize> poolSizes{};
+			uint32_t maxSets = 1000;
+			VkDescriptorPoolCreateFlags poolFlags = 0;
+		};
+
+		RveDescriptorPool(
+			RveVulkanDevice& device,
+			uint32_t maxSets,
+			VkDescriptorPoolCreateFlags poolFlags,
+			const std::vector<VkDescriptorPoolSize>& poolSizes);
+		~RveDescriptorPool();
+		RveDescriptorPool(const RveDescriptorPool &) = delete;
+		RveDescriptorPool &operator=(const RveDescriptorPool &) = delete;
+
+		bool AllocateDescriptorSet(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor) const;
+		void FreeDescriptors(std::vector<VkDescriptorSet>& descriptors) const;
+		void ResetPool();
+
+	private:
+		RveVulkanDevice& rveVulkanDevice;
+		VkDescriptorPool descriptorPool;
+
+		friend class RveDescriptorWriter;
+	};
+
+	// Reuses descriptor sets whose layout and contents match an earlier request, so steady
+	// state frames bind existing sets without any vkUpdateDescriptorSets calls
+	class RveDescriptorSetCache {
+	public:
+		struct Stats {
+			uint32_t hits = 0;
+			uint32_t misses = 0;
+			uint32_t cachedSets = 0;
+		};
+
+		RveDescriptorSetCache(RveDescriptorPool& pool) : rveDescriptorPool{pool} {}
+		RveDescriptorSetCache(const RveDescriptorSetCache &) = delete;
+		RveDescriptorSetCache &operator=(const RveDescriptorSetCache &) = delete;
+
+		// Must be called after destroying anything a cached set refers to, handles can be recycled by the driver
+		void Clear();
+		Stats GetStats() const { return {hits, misses, static_cast<uint32_t>(sets.size())}; }
+
+	private:
+		struct Key {
+			VkDescriptorSetLayout layout;
+			std::vector<uint64_t> contents;
+
+			bool operator==(const Key& other) const { return layout == other.layout && contents == other.contents; }
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const;
+		};
+
+		RveDescriptorPool& rveDescriptorPool;
+		std::unordered_map<Key, VkDescriptorSet, KeyHash> sets;
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+
+		friend class RveDescriptorWriter;
+	};
+
+	class RveDescriptorWriter {
+	public:
+		RveDescriptorWriter(RveDescriptorSetLayout& setLayout, RveDescriptorPool& pool);
+
+		RveDescriptorWriter& WriteBuffer(uint32_t binding, const VkDescriptorBufferInfo *bufferInfo);
+		RveDescriptorWriter& WriteImage(uint32_t binding, const VkDescriptorImageInfo *imageInfo);
+
+		bool Build(VkDescriptorSet& set);
+		// Returns the cached set for these contents, allocating and writing one only on a miss
+		bool Build(VkDescriptorSet& set, RveDescriptorSetCache& cache);
+		void Overwrite(VkDescriptorSet& set);
+
+	private:
+		RveDescriptorSetLayout& rveDescriptorSetLayout;
+		RveDescriptorPool& rveDescriptorPool;
+		std::vector<VkWriteDescriptorSet> writes;
+	};
+} // namespace rve
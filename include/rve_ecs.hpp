@@ -0,0 +1,335 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace rve {
+	using RveComponentId = uint32_t;
+
+	// Slot index plus the generation the slot had when the handle was made. Destroying an entity bumps
+	// the generation before the slot is reused, so stale handles are rejected instead of aliasing.
+	struct RveEntity {
+		uint32_t index = ~0u;
+		uint32_t generation = 0;
+
+		bool operator==(const RveEntity &) const = default;
+	};
+
+	template<typename... Ts>
+	class RveQuery;
+
+	// Entities with the same set of components share an archetype. Each archetype stores its entities
+	// in fixed size chunks holding one contiguous, cache line aligned array per component, so a query
+	// walks memory linearly. Adding or removing components moves the entity to another archetype, these
+	// structural changes are not allowed while a query runs and must be recorded in RveEntityCommands.
+	// Entity slots form a slot map: creation, destruction and lookup are O(1) and freed slots are reused.
+	class RveWorld {
+	public:
+		RveWorld();
+		~RveWorld();
+		RveWorld(const RveWorld &) = delete;
+		RveWorld &operator=(const RveWorld &) = delete;
+
+		template<typename... Ts>
+		RveEntity CreateEntity(Ts&&... components) {
+			constexpr Mask noComponents = 0;
+			const Mask mask = (noComponents | ... | ComponentBit<Ts>());
+			assert(
+				std::popcount(mask) == sizeof...(Ts) &&
+				"(rve_ecs.hpp) An entity can hold one component of each type"
+			);
+			RveEntity entity = CreateEntityRaw(mask);
+			(new (GetComponentRaw(entity, ComponentId<Ts>())) std::remove_cvref_t<Ts>(std::forward<Ts>(components)), ...);
+			return entity;
+		}
+		void DestroyEntity(RveEntity entity);
+		// Handles that are already dead are skipped
+		void DestroyEntities(std::span<const RveEntity> entities);
+		bool IsAlive(RveEntity entity) const {
+			return entity.index < slots.size() &&
+				slots[entity.index].generation == entity.generation &&
+				slots[entity.index].archetype != nullptr;
+		}
+
+		// Lock free, may be called from any thread while no structural change is running. The handle
+		// becomes an entity without components at the next structural change, see SpawnReserved.
+		RveEntity ReserveEntity();
+		// Gives a reserved entity its components, does nothing if it was destroyed in the meantime
+		template<typename... Ts>
+		void SpawnReserved(RveEntity entity, Ts&&... components) {
+			constexpr Mask noComponents = 0;
+			const Mask mask = (noComponents | ... | ComponentBit<Ts>());
+			assert(
+				std::popcount(mask) == sizeof...(Ts) &&
+				"(rve_ecs.hpp) An entity can hold one component of each type"
+			);
+			if(!SpawnReservedRaw(entity, mask)) {
+				return;
+			}
+			(new (GetComponentRaw(entity, ComponentId<Ts>())) std::remove_cvref_t<Ts>(std::forward<Ts>(components)), ...);
+		}
+
+		// Replaces the component when the entity already has one
+		template<typename T>
+		T& AddComponent(RveEntity entity, T&& component) {
+			using Component = std::remove_cvref_t<T>;
+			if(Component *existing = GetComponent<Component>(entity)) {
+				*existing = std::forward<T>(component);
+				return *existing;
+			}
+			return *new (AddComponentRaw(entity, ComponentId<Component>())) Component(std::forward<T>(component));
+		}
+		template<typename T>
+		void RemoveComponent(RveEntity entity) {
+			RemoveComponentRaw(entity, ComponentId<T>());
+		}
+		template<typename T>
+		T *GetComponent(RveEntity entity) {
+			return static_cast<T*>(GetComponentRaw(entity, ComponentId<T>()));
+		}
+		template<typename T>
+		bool HasComponent(RveEntity entity) const {
+			return IsAlive(entity) && (slots[entity.index].archetype->mask & ComponentBit<T>()) != 0;
+		}
+
+		// Convenience for one off queries, keep an RveQuery around to reuse its archetype matches
+		template<typename... Ts, typename F>
+		void ForEach(F&& function) {
+			RveQuery<Ts...>{}.ForEach(*this, std::forward<F>(function));
+		}
+
+		uint32_t GetEntityCount() const { return entityCount; }
+		uint32_t GetArchetypeCount() const { return static_cast<uint32_t>(archetypes.size()); }
+		uint32_t GetChunkCount() const;
+
+		template<typename T>
+		static RveComponentId ComponentId() {
+			// Stripped first so const and reference forms share one id
+			return RegisteredComponentId<std::remove_cvref_t<T>>();
+		}
+
+		static constexpr uint32_t maxComponents = 64;
+		static constexpr size_t chunkSize = 16 * 1024;
+		static constexpr size_t cacheLineSize = 64;
+
+	private:
+		template<typename...> friend class RveQuery;
+		using Mask = uint64_t;
+
+		// Type erased operations for one component type, registered on first use
+		struct ComponentInfo {
+			size_t size;
+			void (*moveConstruct)(void *destination, void *source);
+			void (*destroy)(void *component);
+		};
+
+		struct Chunk {
+			std::byte *data = nullptr;
+			uint32_t count = 0;
+		};
+
+		struct Archetype {
+			Mask mask = 0;
+			std::vector<RveComponentId> components;
+			// Byte offset of each component array within a chunk, the entity array is at offset 0
+			std::vector<uint32_t> offsets;
+			uint32_t capacity = 0;
+			std::vector<Chunk> chunks;
+
+			int32_t Column(RveComponentId id) const;
+		};
+
+		struct Slot {
+			Archetype *archetype = nullptr;
+			uint32_t chunk = 0;
+			uint32_t row = 0;
+			uint32_t generation = 0;
+		};
+
+		// Queries hold one while iterating so structural changes can be caught
+		struct IterationScope {
+			explicit IterationScope(RveWorld& world) : world{world} { world.iterationDepth++; }
+			~IterationScope() { world.iterationDepth--; }
+			RveWorld& world;
+		};
+
+		template<typename T>
+		static Mask ComponentBit() {
+			return Mask{1} << ComponentId<T>();
+		}
+		template<typename Component>
+		static RveComponentId RegisteredComponentId() {
+			static_assert(alignof(Component) <= cacheLineSize, "(rve_ecs.hpp) Component alignment exceeds a cache line");
+			static const RveComponentId id = RegisterComponent({
+				sizeof(Component),
+				[](void *destination, void *source) { new (destination) Component(std::move(*static_cast<Component*>(source))); },
+				[](void *component) { static_cast<Component*>(component)->~Component(); }
+			});
+			return id;
+		}
+		static RveComponentId RegisterComponent(const ComponentInfo& info);
+		static const ComponentInfo& GetComponentInfo(RveComponentId id);
+
+		static RveEntity *Entities(const Chunk& chunk) {
+			return reinterpret_cast<RveEntity*>(chunk.data);
+		}
+		template<typename T>
+		static T *ComponentArray(const Archetype& archetype, const Chunk& chunk) {
+			int32_t column = archetype.Column(ComponentId<T>());
+			return std::launder(reinterpret_cast<T*>(chunk.data + archetype.offsets[column]));
+		}
+
+		// Returns a new entity whose components are left unconstructed
+		RveEntity CreateEntityRaw(Mask mask);
+		// Moves the entity to the archetype with the extra component and returns its unconstructed storage
+		void *AddComponentRaw(RveEntity entity, RveComponentId id);
+		bool SpawnReservedRaw(RveEntity entity, Mask mask);
+		void RemoveComponentRaw(RveEntity entity, RveComponentId id);
+		void *GetComponentRaw(RveEntity entity, RveComponentId id);
+
+		Archetype& GetOrCreateArchetype(Mask mask);
+		void AllocateRow(Archetype& archetype, RveEntity entity);
+		// Destroys the components in the row and fills the hole with the last entity of the archetype
+		void RemoveRow(Archetype& archetype, uint32_t chunkIndex, uint32_t row);
+		void MoveEntity(RveEntity entity, Archetype& destination);
+		void DestroyAliveEntity(RveEntity entity);
+		// Checks no query is running and turns handles reserved since the last change into entities
+		void BeginStructuralChange();
+
+		static ComponentInfo componentInfos[maxComponents];
+		static uint32_t componentCount;
+
+		std::vector<std::unique_ptr<Archetype>> archetypes;
+		std::unordered_map<Mask, Archetype*> archetypeLookup;
+		std::vector<Slot> slots;
+		std::vector<uint32_t> freeSlots;
+		// Free slots not yet taken by ReserveEntity, negative once reservations run past the free list
+		// and start handing out new slots
+		std::atomic<int64_t> freeCursor{0};
+		uint32_t entityCount = 0;
+		uint32_t iterationDepth = 0;
+		// Lets queries notice they are used with a different world
+		uint64_t worldId;
+	};
+
+	// Typed query over every archetype holding all of Ts. Matching archetypes are cached and new ones
+	// picked up incrementally, so keeping the query between frames makes matching nearly free.
+	// Ts may be const qualified for read only access.
+	template<typename... Ts>
+	class RveQuery {
+	public:
+		// function(uint32_t count, const RveEntity *entities, Ts *...arrays) once per chunk
+		template<typename F>
+		void ForEachChunk(RveWorld& world, F&& function) {
+			Refresh(world);
+			RveWorld::IterationScope scope{world};
+			for(RveWorld::Archetype *archetype : matches) {
+				for(const RveWorld::Chunk& chunk : archetype->chunks) {
+					function(
+						chunk.count,
+						static_cast<const RveEntity*>(RveWorld::Entities(chunk)),
+						RveWorld::ComponentArray<Ts>(*archetype, chunk)...);
+				}
+			}
+		}
+
+		// function(RveEntity entity, Ts&... components) once per entity
+		template<typename F>
+		void ForEach(RveWorld& world, F&& function) {
+			ForEachChunk(world, [&function](uint32_t count, const RveEntity *entities, Ts *...arrays) {
+				for(uint32_t row = 0; row < count; row++) {
+					function(entities[row], arrays[row]...);
+				}
+			});
+		}
+
+		uint32_t Count(RveWorld& world) {
+			Refresh(world);
+			uint32_t count = 0;
+			for(const RveWorld::Archetype *archetype : matches) {
+				for(const RveWorld::Chunk& chunk : archetype->chunks) {
+					count += chunk.count;
+				}
+			}
+			return count;
+		}
+
+	private:
+		void Refresh(const RveWorld& world) {
+			if(world.worldId != worldId) {
+				worldId = world.worldId;
+				matches.clear();
+				archetypesSeen = 0;
+			}
+			const RveWorld::Mask mask = (RveWorld::Mask{0} | ... | RveWorld::ComponentBit<Ts>());
+			// Archetypes are never removed, so only ones created since the last refresh need testing
+			for(; archetypesSeen < world.archetypes.size(); archetypesSeen++) {
+				RveWorld::Archetype *archetype = world.archetypes[archetypesSeen].get();
+				if((archetype->mask & mask) == mask) {
+					matches.push_back(archetype);
+				}
+			}
+		}
+
+		std::vector<RveWorld::Archetype*> matches;
+		size_t archetypesSeen = 0;
+		uint64_t worldId = 0;
+	};
+
+	// Records structural changes to apply later at a point where no query is running.
+	// Commands are applied in recording order. Not thread safe, use one per thread; the handles
+	// returned by CreateEntity are reserved up front so they can be referenced before playback.
+	class RveEntityCommands {
+	public:
+		explicit RveEntityCommands(RveWorld& world) : world{world} {}
+		RveEntityCommands(const RveEntityCommands &) = delete;
+		RveEntityCommands &operator=(const RveEntityCommands &) = delete;
+
+		template<typename... Ts>
+		RveEntity CreateEntity(Ts&&... components) {
+			RveEntity entity = world.ReserveEntity();
+			// Held through a shared_ptr so move only components fit in a std::function
+			auto stored = std::make_shared<std::tuple<std::remove_cvref_t<Ts>...>>(std::forward<Ts>(components)...);
+			commands.push_back([entity, stored](RveWorld& world) {
+				std::apply([&](auto&... values) { world.SpawnReserved(entity, std::move(values)...); }, *stored);
+			});
+			return entity;
+		}
+		void DestroyEntity(RveEntity entity) {
+			commands.push_back([entity](RveWorld& world) { world.DestroyEntity(entity); });
+		}
+		void DestroyEntities(std::span<const RveEntity> entities) {
+			commands.push_back([stored = std::vector<RveEntity>(entities.begin(), entities.end())](RveWorld& world) {
+				world.DestroyEntities(stored);
+			});
+		}
+		template<typename T>
+		void AddComponent(RveEntity entity, T&& component) {
+			auto stored = std::make_shared<std::remove_cvref_t<T>>(std::forward<T>(component));
+			commands.push_back([entity, stored](RveWorld& world) { world.AddComponent(entity, std::move(*stored)); });
+		}
+		template<typename T>
+		void RemoveComponent(RveEntity entity) {
+			commands.push_back([entity](RveWorld& world) { world.RemoveComponent<T>(entity); });
+		}
+
+		void Playback();
+		bool IsEmpty() const { return commands.empty(); }
+
+	private:
+		RveWorld& world;
+		std::vector<std::function<void(RveWorld&)>> commands;
+	};
+} // namespace rve
@@ -1,35 +1,117 @@
 #pragma once
 
 #include "rve_pipeline.hpp"
+#include "rve_pipeline_registry.hpp"
 #include "rve_window.hpp"
 #include "rve_vulkan_device.hpp"
-#include "rve_game_object.hpp"
+#include "rve_components.hpp"
+#include "rve_ecs.hpp"
+#include "rve_job_system.hpp"
+#include "rve_transform_hierarchy.hpp"
+#include "rve_simulation.hpp"
+#include "rve_geometry_pool.hpp"
+#include "rve_mesh_cache.hpp"
+#include "rve_mesh_loader.hpp"
+#include "rve_residency_manager.hpp"
+#include "rve_asset_registry.hpp"
+#include "rve_texture.hpp"
+#include "rve_sampler_cache.hpp"
+#include "rve_virtual_texture.hpp"
 #include "rve_renderer.hpp"
 #include "rve_render_system.hpp"
+#include "rve_camera.hpp"
+#include "rve_shader_watcher.hpp"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace rve {
 	class RveEngine {
 	public:
-		RveEngine();
+		// printStats reports assets as they load and every subsystem's stats each statsInterval, one line each
+		explicit RveEngine(bool printStats = false);
 		~RveEngine();
 		RveEngine(const RveEngine &) = delete;
 		RveEngine &operator=(const RveEngine &) = delete;
 
 		void Run();
+		// Draws the scene while requesting variants one per frame, first compiled in the background and then
+		// blocking, and prints frame time percentiles of both next to a run without compiles. Fails when the
+		// background compiles raise the p99 frame time by more than pipelineBenchmarkSpikeRatio.
+		int RunPipelineBenchmark(uint32_t variants);
 
 		static constexpr int windowWidth = 600;
 		static constexpr int windowHeight = 600;
+		static constexpr RveVertexFormat vertexFormat = RveVertexFormat::Compact;
+		static constexpr uint32_t geometryPoolVertices = 1 << 18;
+		static constexpr uint32_t geometryPoolIndices = 1 << 20;
+		// Pool memory the full meshes of cached models may take, they draw a coarse mesh while not resident
+		static constexpr VkDeviceSize streamingBudget = VkDeviceSize{64} << 20;
+		static constexpr int scalingSceneGridSize = 8;
+		static constexpr float statsInterval = 1.0f;
+		// Frames of each pipeline benchmark phase at least, and the p99 frame time growth it tolerates
+		static constexpr uint32_t pipelineBenchmarkFrames = 300;
+		static constexpr float pipelineBenchmarkSpikeRatio = 1.5f;
+		// Every .obj and .glb found here is loaded at startup, from its cooked .rvemesh when that is up to date
+		static constexpr const char *modelDirectory = "models/";
+		// Every .ktx2 found here is loaded at startup and drawn on the loaded models
+		static constexpr const char *textureDirectory = "textures/";
+		static constexpr uint32_t checkerboardSize = 256;
+		// Every cooked .rvevt found here is streamed onto a ground plane, cook large images with --cook
+		static constexpr const char *virtualTextureDirectory = "textures/virtual/";
+		#ifdef NDEBUG
+			static constexpr bool enableShaderHotReload = false;
+		#else
+			static constexpr bool enableShaderHotReload = true;
+		#endif
+		#ifdef RVE_SHADER_SOURCE_DIR
+			static constexpr const char *shaderSourceDirectory = RVE_SHADER_SOURCE_DIR;
+		#else
+			static constexpr const char *shaderSourceDirectory = "../shaders/";
+		#endif
 	
 	private:
 		void LoadGameObjects();
-		std::unique_ptr<RveModel> Create3DTestModel(RveVulkanDevice& device, glm::vec3 offset);
+		void LoadScalingScene(int gridSize);
+		void LoadOrbitingCubes(RveModelHandle model);
+		void LoadModelFiles();
+		void LoadTextureFiles();
+		void LoadVirtualTextureFiles();
+		// Textures go into the render system's bindless table, so their materials are made once it exists
+		void RegisterMaterials(RveRenderSystem& renderSystem);
+		std::unique_ptr<RveTexture> CreateCheckerboardTexture(uint32_t size);
+		std::unique_ptr<RveModel> Create3DTestModel(RveGeometryPool& pool, glm::vec3 offset);
+		std::unique_ptr<RveModel> CreatePlaneModel(RveGeometryPool& pool, uint32_t quads);
+		std::unique_ptr<RveModel> CreateSphereModel(RveGeometryPool& pool, uint32_t rings, uint32_t segments, glm::vec3 color);
+		// Records and submits one frame, false when the swap chain was being recreated
+		bool DrawFrame(RveRenderSystem& renderSystem, RveCamera& camera, float frameTime);
+		void PrintStats(const RveRenderSystem& renderSystem, float seconds, uint32_t frames, uint64_t ticks);
 
+		bool printStats;
+
+		// Constructed first so the main thread owns a deque and everything below may schedule jobs
+		RveJobSystem rveJobSystem;
 		RveWindow rveWindow{windowWidth, windowHeight, "Vulkan Test"};
 		RveVulkanDevice rveVulkanDevice{rveWindow};
 		RveRenderer rveRenderer{rveWindow, rveVulkanDevice};
-		std::vector<RveGameObject> rveGameObjects;
+		RvePipelineRegistry rvePipelineRegistry{rveVulkanDevice};
+		RveGeometryPool rveGeometryPool{rveVulkanDevice, vertexFormat, geometryPoolVertices, geometryPoolIndices};
+		RveResidencyManager rveResidency{rveJobSystem, streamingBudget};
+		// Owns every model, entities refer to them by handle
+		RveAssetRegistry rveAssets{rveVulkanDevice, rveGeometryPool, rveJobSystem, rveResidency};
+		RveSamplerCache rveSamplers{rveVulkanDevice};
+		std::vector<std::unique_ptr<RveTexture>> textures;
+		// Index into textures that every entity drawing the model is given
+		std::vector<std::pair<RveModelHandle, uint32_t>> modelTextures;
+		std::vector<std::shared_ptr<RveVirtualTexture>> virtualTextures;
+		// Ground plane drawing each virtual texture, same order
+		std::vector<RveEntity> virtualTextureEntities;
+		RveWorld rveWorld;
+		// Structural changes recorded during the frame, applied before the render system queries the world
+		RveEntityCommands entityCommands{rveWorld};
+		RveTransformHierarchy rveHierarchy{rveJobSystem};
+		RveSimulation rveSimulation;
+		std::unique_ptr<RveShaderWatcher> shaderWatcher;
 	};
 } // namespace rve
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "rve_camera.hpp"
+
+#include <vulkan/vulkan.h>
+
+namespace rve {
+	// Early draws what was visible last frame, late draws what the occlusion test found newly visible
+	enum class RveDrawPhase {
+		Early = 0,
+		Late = 1
+	};
+
+	struct RveFrameInfo {
+		int frameIndex;
+		float frameTime;
+		VkCommandBuffer commandBuffer;
+		RveCamera &camera;
+		VkExtent2D extent;
+	};
+} // namespace rve
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "rve_buffer.hpp"
+#include "rve_swap_chain.hpp"
+
+#include <array>
+#include <memory>
+
+namespace rve {
+	// One persistently mapped buffer per frame in flight with a linear bump allocator.
+	// Allocations live until the slot is reused MAX_FRAMES_IN_FLIGHT frames later, descriptors
+	// point at a fixed range of the slot's buffer and the allocation offset is bound dynamically.
+	class RveFrameRing {
+	public:
+		struct Allocation {
+			void *data = nullptr;
+			uint32_t offset = 0;
+		};
+
+		RveFrameRing(RveVulkanDevice& device, VkDeviceSize bytesPerFrame);
+		RveFrameRing(const RveFrameRing &) = delete;
+		RveFrameRing &operator=(const RveFrameRing &) = delete;
+
+		// Must be called after the frame's fence has been waited on
+		void BeginFrame(int frameIndex);
+		Allocation Allocate(VkDeviceSize size);
+		template<typename T>
+		Allocation Push(const T& value) {
+			Allocation allocation = Allocate(sizeof(T));
+			*static_cast<T*>(allocation.data) = value;
+			return allocation;
+		}
+
+		// Descriptor for a UNIFORM_BUFFER_DYNAMIC or STORAGE_BUFFER_DYNAMIC binding of the current slot
+		VkDescriptorBufferInfo DescriptorInfo(VkDeviceSize range) const;
+		VkDeviceSize GetUsedBytes() const { return head; }
+		VkDeviceSize GetPeakBytes() const { return peak; }
+		VkDeviceSize GetCapacity() const { return capacity; }
+
+	private:
+		std::array<std::unique_ptr<RveBuffer>, RveSwapChain::MAX_FRAMES_IN_FLIGHT> buffers;
+		int currentFrame = 0;
+		VkDeviceSize capacity;
+		VkDeviceSize alignment;
+		VkDeviceSize head = 0;
+		VkDeviceSize peak = 0;
+	};
+} // namespace rve
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+#include "rve_buffer.hpp"
+#include "rve_model.hpp"
+#include "rve_range_allocator.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace rve {
+	// Shared vertex and index buffers that meshes are sub-allocated from. Uploads are staged in a persistent
+	// host visible ring and their copies recorded into the frame's command buffer by Update, so allocating
+	// never waits on the GPU; replaced buffers go through the deletion queue.
+	class RveGeometryPool {
+	public:
+		using handle_t = uint32_t;
+
+		struct Range {
+			uint32_t firstVertex = 0;
+			uint32_t vertexCount = 0;
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+		};
+
+		struct Stats {
+			uint32_t liveMeshes = 0;
+			// Freed while frames in flight may still draw them, their ranges are still in use
+			uint32_t retiringMeshes = 0;
+			uint32_t usedVertices = 0;
+			uint32_t usedIndices = 0;
+			uint32_t vertexCapacity = 0;
+			uint32_t indexCapacity = 0;
+			uint32_t freeVertexBlocks = 0;
+			uint32_t freeIndexBlocks = 0;
+			// Totals since creation, overflow bytes did not fit the staging ring and took a buffer of their own
+			uint64_t uploadBytes = 0;
+			uint64_t overflowBytes = 0;
+			uint64_t defragmentations = 0;
+		};
+
+		RveGeometryPool(
+			RveVulkanDevice& device,
+			RveVertexFormat format,
+			uint32_t vertexCapacity,
+			uint32_t indexCapacity);
+		~RveGeometryPool();
+		RveGeometryPool(const RveGeometryPool &) = delete;
+		RveGeometryPool &operator=(const RveGeometryPool &) = delete;
+
+		// Index data is local to the mesh, draws add firstVertex through vertexOffset. The data is copied
+		// into staging right away and reaches the GPU with the next Update, which must come before the mesh is drawn.
+		handle_t Allocate(const void *vertexData, uint32_t vertexCount, const uint32_t *indexData, uint32_t indexCount);
+		// The handle is invalid right away, its ranges are reused once the frames in flight retire
+		void Free(handle_t handle);
+		// Records the copies staged since the last call and repacks the buffers when freed ranges leave
+		// them fragmented. Call once per frame after the frame's fence was waited on, outside of a render
+		// pass and before anything draws from the pool.
+		void Update(VkCommandBuffer commandBuffer);
+
+		void Bind(VkCommandBuffer commandBuffer);
+		void Draw(VkCommandBuffer commandBuffer, handle_t handle, uint32_t instanceCount = 1);
+		// Draws a sub range of the mesh indices, used for LODs packed behind the base index list
+		void DrawIndexRange(
+			VkCommandBuffer commandBuffer,
+			handle_t handle,
+			uint32_t indexOffset,
+			uint32_t indexCount,
+			uint32_t instanceCount = 1);
+
+		const Range& GetRange(handle_t handle) const { return ranges[handle]; }
+		RveVertexFormat GetVertexFormat() const { return vertexFormat; }
+		VkDeviceSize GetVertexStride() const { return vertexStride; }
+		VkBuffer GetVertexBuffer() const { return vertexBuffer; }
+		VkBuffer GetIndexBuffer() const { return indexBuffer; }
+		Stats GetStats() const;
+
+		static constexpr VkDeviceSize stagingRingSize = VkDeviceSize{16} << 20;
+		// Fragmentation only triggers a repack once this share of the capacity is free
+		static constexpr float defragmentFreeRatio = 0.25f;
+
+	private:
+		struct PendingFree {
+			handle_t handle;
+			uint64_t frame;
+		};
+
+		// Copy recorded by the next Update, in order. Copies after a repack read what earlier ones wrote.
+		struct PendingCopy {
+			VkBuffer srcBuffer;
+			VkBuffer dstBuffer;
+			VkBufferCopy region;
+			bool barrierBefore;
+		};
+
+		// Replaced by a repack, released to the deletion queue once the copies reading it are recorded
+		struct ReplacedBuffer {
+			VkBuffer buffer;
+			VkDeviceMemory memory;
+		};
+
+		// Bytes of the staging ring in use, frame is noFrame until the copies reading them are recorded
+		struct StagingSpan {
+			VkDeviceSize offset;
+			VkDeviceSize size;
+			uint64_t frame;
+		};
+		static constexpr uint64_t noFrame = ~0ull;
+
+		void CreateBuffers(uint32_t vertexCapacity, uint32_t indexCapacity, VkBuffer &newVertexBuffer, VkDeviceMemory &newVertexMemory, VkBuffer &newIndexBuffer, VkDeviceMemory &newIndexMemory);
+		void Repack(uint32_t newVertexCapacity, uint32_t newIndexCapacity);
+		bool IsFragmented() const;
+		void ReleaseRetired();
+		void Upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size);
+		// Offset of size free bytes in the staging ring, false when the ring is full
+		bool AllocateStaging(VkDeviceSize size, VkDeviceSize &offset);
+		static uint32_t GrowCapacity(uint32_t capacity, uint64_t required);
+
+		RveVulkanDevice& rveVulkanDevice;
+		RveVertexFormat vertexFormat;
+		VkDeviceSize vertexStride;
+
+		VkBuffer vertexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory vertexBufferMemory = VK_NULL_HANDLE;
+		VkBuffer indexBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory indexBufferMemory = VK_NULL_HANDLE;
+		uint32_t vertexCapacity;
+		uint32_t indexCapacity;
+
+		RveRangeAllocator vertexAllocator;
+		RveRangeAllocator indexAllocator;
+		std::vector<Range> ranges;
+		std::vector<bool> rangeAlive;
+		std::vector<handle_t> freeHandles;
+		std::vector<PendingFree> pendingFrees;
+
+		std::unique_ptr<RveBuffer> stagingRing;
+		std::deque<StagingSpan> stagingSpans;
+		// Uploads that did not fit the ring, released once their copies are recorded
+		std::vector<std::unique_ptr<RveBuffer>> overflowStaging;
+		std::vector<PendingCopy> pendingCopies;
+		std::vector<ReplacedBuffer> replacedBuffers;
+		uint64_t uploadBytes = 0;
+		uint64_t overflowBytes = 0;
+		uint64_t lastRepackFrame = 0;
+		uint64_t defragmentations = 0;
+	};
+} // namespace rve
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rve {
+	struct RveJob;
+
+	// Number of jobs still to finish, plus the jobs waiting for it to reach zero. Must outlive every job
+	// scheduled against it; Wait on it before it goes out of scope.
+	class RveJobCounter {
+	public:
+		RveJobCounter() = default;
+		RveJobCounter(const RveJobCounter &) = delete;
+		RveJobCounter &operator=(const RveJobCounter &) = delete;
+
+		bool IsDone();
+
+	private:
+		friend class RveJobSystem;
+		std::atomic<uint32_t> pending{0};
+		std::mutex mutex;
+		std::vector<RveJob*> continuations;
+	};
+
+	// Work stealing scheduler. Every worker owns a Chase-Lev deque, pushing and popping its own jobs at the
+	// bottom while idle workers steal from the top, so the owner works depth first on recent, cache warm
+	// jobs and thieves take the oldest, usually largest, pieces. The thread that creates the system owns
+	// a deque as well and runs jobs while it waits, other threads hand jobs over through a shared queue.
+	class RveJobSystem {
+	public:
+		using Job = std::function<void()>;
+
+		struct Stats {
+			uint64_t jobsRun = 0;
+			uint64_t steals = 0;
+			uint64_t sleeps = 0;
+		};
+
+		// Without workers every job runs on the owning thread while it waits, a single threaded baseline
+		explicit RveJobSystem(uint32_t workerCount = DefaultWorkerCount());
+		~RveJobSystem();
+		RveJobSystem(const RveJobSystem &) = delete;
+		RveJobSystem &operator=(const RveJobSystem &) = delete;
+
+		// Increments the counter now and decrements it once the job has run
+		void Schedule(Job job, RveJobCounter *counter = nullptr);
+		// Holds the job back until the dependency reaches zero, the counter counts it from now on
+		void ScheduleAfter(RveJobCounter& dependency, Job job, RveJobCounter *counter = nullptr);
+		// Runs other jobs until the counter reaches zero
+		void Wait(RveJobCounter& counter);
+		// Calls body(begin, end) over chunks of [0, count) no smaller than minChunkSize and returns once all
+		// of them ran. Chunks are split off lazily by halving, so stolen pieces stay large.
+		void ParallelFor(uint32_t count, uint32_t minChunkSize, const std::function<void(uint32_t, uint32_t)>& body);
+
+		// Workers plus the owning thread
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+		Stats GetStats() const;
+
+		static uint32_t DefaultWorkerCount();
+		// Target chunks per thread for ParallelFor, enough for stealing to even out uneven chunks
+		static constexpr uint32_t chunksPerThread = 4;
+		// Failed searches before a worker goes to sleep
+		static constexpr uint32_t idleSpins = 64;
+
+	private:
+		// Fixed capacity Chase-Lev deque (Le et al. 2013 memory orderings). Push and Pop are owner only,
+		// Steal may be called from any thread.
+		class Deque {
+		public:
+			bool Push(RveJob *job);
+			RveJob *Pop();
+			RveJob *Steal();
+
+			static constexpr int64_t capacity = 4096;
+
+		private:
+			alignas(64) std::atomic<int64_t> top{0};
+			alignas(64) std::atomic<int64_t> bottom{0};
+			std::array<std::atomic<RveJob*>, capacity> jobs{};
+		};
+
+		struct alignas(64) Worker {
+			Deque deque;
+			std::thread thread;
+			uint32_t randomState = 0;
+			std::atomic<uint64_t> jobsRun{0};
+			std::atomic<uint64_t> steals{0};
+			std::atomic<uint64_t> sleeps{0};
+		};
+
+		void Submit(RveJob *job);
+		RveJob *FindJob(uint32_t workerIndex);
+		void Execute(uint32_t workerIndex, RveJob *job);
+		void Finish(RveJobCounter& counter);
+		void WakeWorkers();
+		void WorkerLoop(uint32_t workerIndex);
+		void SplitRange(uint32_t begin, uint32_t end, uint32_t chunkSize, const std::function<void(uint32_t, uint32_t)>& body, RveJobCounter& counter);
+		uint32_t CurrentWorker() const;
+
+		// Index 0 is the owning thread, which has a deque but no thread of its own
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		std::mutex injectedMutex;
+		std::deque<RveJob*> injectedJobs;
+		std::atomic<uint32_t> injectedCount{0};
+		std::atomic<uint64_t> foreignJobsRun{0};
+
+		std::atomic<uint32_t> wakeEpoch{0};
+		std::atomic<uint32_t> sleepingWorkers{0};
+		std::atomic<bool> stopping{false};
+	};
+} // namespace rve
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rve {
+	// Read only view of a whole file. Memory mapped where available so parsers read straight from the
+	// page cache without a copy, falls back to reading the file into memory elsewhere.
+	class RveMappedFile {
+	public:
+		explicit RveMappedFile(const std::string& filePath);
+		~RveMappedFile();
+		RveMappedFile(const RveMappedFile &) = delete;
+		RveMappedFile &operator=(const RveMappedFile &) = delete;
+
+		const char *GetData() const { return data; }
+		size_t GetSize() const { return size; }
+
+	private:
+		const char *data = nullptr;
+		size_t size = 0;
+		bool mapped = false;
+		std::vector<char> fallbackStorage;
+	};
+} // namespace rve
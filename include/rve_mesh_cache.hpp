@@ -0,0 +1,74 @@
+#pragma once
+
+#include "rve_mapped_file.hpp"
+#include "rve_model.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rve {
+	// Cooked meshes in a versioned binary file laid out the way RveModel consumes them: a header, a mesh
+	// table, then per mesh the vertex, index, LOD and meshlet arrays, each aligned to blobAlignment.
+	// The file is mapped and its arrays handed to RveModel as spans, so loading copies the data only once,
+	// into staging memory. The header stores a hash of everything after it and a stamp of the source file.
+	class RveMeshCache {
+	public:
+		// Opens a cooked file and checks its header and table, throws if it cannot be used as is
+		explicit RveMeshCache(const std::string& filePath);
+		RveMeshCache(const RveMeshCache &) = delete;
+		RveMeshCache &operator=(const RveMeshCache &) = delete;
+
+		uint32_t GetMeshCount() const { return header.meshCount; }
+		RveModel::MeshData GetMeshData(uint32_t mesh) const;
+		uint64_t GetSourceStamp() const { return header.sourceStamp; }
+		uint64_t GetFileSize() const { return header.fileSize; }
+		// Rehashes the payload and checks every index, reads the whole file so only tools call it
+		bool VerifyContent() const;
+
+		static void Write(const std::string& filePath, const std::vector<RveModel::Builder>& builders, uint64_t sourceStamp);
+		// Reads only the header, false for missing, stale or older files
+		static bool IsUpToDate(const std::string& filePath, const std::string& sourcePath);
+		// Size and modification time of the source, changes whenever the source is edited
+		static uint64_t SourceStamp(const std::string& sourcePath);
+		static uint64_t Hash(const char *data, size_t size);
+
+		static constexpr uint32_t magic = 0x4D455652;
+		static constexpr uint32_t version = 2;
+		static constexpr uint32_t blobAlignment = 64;
+		static constexpr const char *extension = ".rvemesh";
+
+	private:
+		struct Header {
+			uint32_t magic = 0;
+			uint32_t version = 0;
+			uint32_t meshCount = 0;
+			// Strides guard against layout changes that forget to bump the version
+			uint32_t vertexStride = 0;
+			uint32_t lodStride = 0;
+			uint32_t meshletStride = 0;
+			uint64_t fileSize = 0;
+			uint64_t sourceStamp = 0;
+			uint64_t contentHash = 0;
+			uint32_t reserved[4]{};
+		};
+		static_assert(sizeof(Header) == 64, "RveMeshCache header must stay 64 bytes");
+
+		struct MeshRecord {
+			uint64_t vertexOffset = 0;
+			uint64_t indexOffset = 0;
+			uint64_t lodOffset = 0;
+			uint64_t meshletOffset = 0;
+			uint32_t vertexCount = 0;
+			uint32_t indexCount = 0;
+			uint32_t lodCount = 0;
+			uint32_t meshletCount = 0;
+			float boundingCenter[3]{};
+			float boundingRadius = 0.0f;
+		};
+
+		RveMappedFile file;
+		Header header{};
+		std::vector<MeshRecord> records;
+	};
+} // namespace rve
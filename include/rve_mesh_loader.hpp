@@ -0,0 +1,56 @@
+#pragma once
+
+#include "rve_job_system.hpp"
+#include "rve_mapped_file.hpp"
+#include "rve_model.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rve {
+	// Imports Wavefront OBJ and binary glTF 2.0 (.glb) meshes into model builders. Files are memory mapped
+	// and parsed in parallel, one job per file, with large OBJ files further split into line aligned chunks
+	// and glTF files into one job per primitive. Every mesh is welded, gets normals when the file has none,
+	// and has its meshlets and LODs built on the worker that parsed it.
+	class RveMeshLoader {
+	public:
+		struct Stats {
+			uint32_t files = 0;
+			uint32_t meshes = 0;
+			uint64_t bytesRead = 0;
+			uint64_t vertices = 0;
+			uint64_t triangles = 0;
+			float parseSeconds = 0.0f;
+			float uploadSeconds = 0.0f;
+		};
+
+		explicit RveMeshLoader(RveJobSystem& jobSystem) : jobSystem{jobSystem} {}
+		RveMeshLoader(const RveMeshLoader &) = delete;
+		RveMeshLoader &operator=(const RveMeshLoader &) = delete;
+
+		// Builders of every mesh in every file, in file order, meshCounts receives the number per file.
+		// Throws if any file cannot be parsed.
+		std::vector<RveModel::Builder> Load(const std::vector<std::string>& filePaths, std::vector<uint32_t> *meshCounts = nullptr);
+		// Loads and uploads into the pool, uploads run on the calling thread
+		std::vector<std::unique_ptr<RveModel>> LoadModels(RveGeometryPool& pool, const std::vector<std::string>& filePaths);
+
+		// Stats of the last Load or LoadModels
+		const Stats& GetStats() const { return stats; }
+
+		static bool IsSupported(const std::string& filePath);
+
+		// Bytes of OBJ text per parse job
+		static constexpr size_t objChunkSize = 4 << 20;
+		// Color given to vertices when the file has none
+		static constexpr float defaultColor = 0.8f;
+
+	private:
+		std::vector<RveModel::Builder> LoadObj(const RveMappedFile& file, const std::string& filePath);
+		std::vector<RveModel::Builder> LoadGlb(const RveMappedFile& file, const std::string& filePath);
+
+		RveJobSystem& jobSystem;
+		Stats stats{};
+	};
+} // namespace rve
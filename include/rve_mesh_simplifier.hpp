@@ -0,0 +1,37 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace rve {
+	// Quadric error metric edge collapse (Garland & Heckbert 1997).
+	// Vertices are collapsed onto one of the edge endpoints so every LOD can share the source vertex data.
+	class RveMeshSimplifier {
+	public:
+		struct Result {
+			std::vector<uint32_t> indices{};
+			float error = 0.0f;
+		};
+
+		static Result Simplify(
+			const std::vector<glm::vec3> &positions,
+			const std::vector<uint32_t> &indices,
+			size_t targetIndexCount,
+			float maxError);
+
+	private:
+		struct Quadric {
+			double a2 = 0, ab = 0, ac = 0, ad = 0;
+			double b2 = 0, bc = 0, bd = 0;
+			double c2 = 0, cd = 0;
+			double d2 = 0;
+
+			static Quadric FromPlane(glm::dvec3 normal, double distance, double weight);
+			Quadric &operator+=(const Quadric &other);
+			double Evaluate(glm::dvec3 point) const;
+		};
+	};
+} // namespace rve
@@ -0,0 +1,40 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace rve {
+	// Matches the Meshlet struct in shaders/meshlet_cull.comp
+	struct RveMeshlet {
+		glm::vec3 center{};
+		float radius = 0.0f;
+		glm::vec3 coneAxis{};
+		float coneCutoff = 1.0f;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		uint32_t vertexCount = 0;
+		uint32_t padding = 0;
+	};
+
+	class RveMeshletBuilder {
+	public:
+		static constexpr uint32_t maxVertices = 64;
+		static constexpr uint32_t maxTriangles = 124;
+
+		// Reorders indices[firstIndex, firstIndex + indexCount) so every meshlet is one contiguous run
+		static std::vector<RveMeshlet> Build(
+			const std::vector<glm::vec3> &positions,
+			std::vector<uint32_t> &indices,
+			uint32_t firstIndex,
+			uint32_t indexCount);
+
+	private:
+		static void ComputeBounds(
+			const std::vector<glm::vec3> &positions,
+			const uint32_t *meshletIndices,
+			RveMeshlet &meshlet);
+	};
+} // namespace rve
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+#include "rve_buffer.hpp"
+#include "rve_pipeline.hpp"
+#include "rve_range_allocator.hpp"
+#include "rve_model.hpp"
+#include "rve_frame_info.hpp"
+#include "rve_swap_chain.hpp"
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace rve {
+	// Culls meshlets against the frustum and their normal cone in a compute pass and writes one
+	// VkDrawIndexedIndirectCommand per meshlet and draw phase, culled meshlets get an instanceCount of 0.
+	// Whole object visibility comes from the phase flags of RveOcclusionCuller.
+	class RveMeshletCuller {
+	public:
+		// Matches the Instance struct in shaders/meshlet_cull.comp
+		struct Instance {
+			glm::mat4 modelMatrix{1.0f};
+			uint32_t firstMeshlet = 0;
+			uint32_t meshletCount = 0;
+			uint32_t firstCommand = 0;
+			float maxScale = 1.0f;
+			int32_t vertexOffset = 0;
+			uint32_t firstIndex = 0;
+			uint32_t objectIndex = 0;
+			uint32_t padding = 0;
+		};
+
+		struct Stats {
+			uint32_t meshletsTotal = 0;
+			uint32_t meshletsVisible = 0;
+			uint32_t frustumCulled = 0;
+			uint32_t coneCulled = 0;
+		};
+
+		RveMeshletCuller(RveVulkanDevice& device);
+		~RveMeshletCuller();
+		RveMeshletCuller(const RveMeshletCuller &) = delete;
+		RveMeshletCuller &operator=(const RveMeshletCuller &) = delete;
+
+		// Must be called after the frame's fence has been waited on, collects stats from the previous use of the slot
+		void BeginFrame(int frameIndex);
+		// objectIndex selects the instance's flags in the occlusion culler's phase buffer. The model's meshlets
+		// are uploaded once and kept under its handle until RemoveModel.
+		uint32_t AddInstance(RveModelHandle handle, const RveModel& model, const glm::mat4& modelMatrix, float maxScale, uint32_t objectIndex);
+		// Drops the model's meshlets, their range is reused once the frames that may have culled them retire
+		void RemoveModel(RveModelHandle handle);
+		// Records the culling dispatch for one phase, must be outside of a render pass
+		void Dispatch(const RveFrameInfo& frameInfo, RveDrawPhase phase, VkBuffer objectPhaseBuffer);
+		void DrawInstance(VkCommandBuffer commandBuffer, uint32_t instanceIndex, RveDrawPhase phase);
+
+		// Stats lag MAX_FRAMES_IN_FLIGHT frames behind
+		const Stats& GetStats() const { return stats; }
+
+	private:
+		struct GpuStats {
+			uint32_t meshletsVisible;
+			uint32_t frustumCulled;
+			uint32_t coneCulled;
+		};
+
+		struct MeshletRange {
+			uint32_t first;
+			uint32_t count;
+		};
+
+		struct PendingFree {
+			MeshletRange range;
+			uint64_t frame;
+		};
+
+		// Meshlets of a newly registered model, dataOffset indexes stagedMeshlets
+		struct StagedUpload {
+			MeshletRange range;
+			size_t dataOffset;
+		};
+
+		struct FrameResources {
+			VkBuffer instanceBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory instanceMemory = VK_NULL_HANDLE;
+			void *instanceMapped = nullptr;
+			uint32_t instanceCapacity = 0;
+			VkBuffer commandBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory commandMemory = VK_NULL_HANDLE;
+			uint32_t commandCapacity = 0;
+			VkBuffer statsBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory statsMemory = VK_NULL_HANDLE;
+			void *statsMapped = nullptr;
+			uint32_t meshletsSubmitted = 0;
+			VkBuffer objectPhaseBuffer = VK_NULL_HANDLE;
+			VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+			// Rewritten when the slot comes around again, a frame in flight may still use the set
+			bool descriptorSetStale = true;
+		};
+
+		void CreateDescriptorResources();
+		void CreatePipelineLayout();
+		void CreateFrameResources(FrameResources& frame);
+		void DestroyFrameResources(FrameResources& frame);
+		void EnsureFrameCapacity(FrameResources& frame, uint32_t instanceCount, uint32_t commandCount);
+		// Grows the shared buffer on the GPU to the allocator's capacity and copies the staged meshlets
+		void UploadMeshlets(VkCommandBuffer commandBuffer);
+		void ReleaseRetired();
+		void WriteDescriptorSet(FrameResources& frame);
+
+		RveVulkanDevice& rveVulkanDevice;
+		std::unique_ptr<RveComputePipeline> cullPipeline;
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+
+		VkBuffer meshletBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory meshletMemory = VK_NULL_HANDLE;
+		// meshletBuffer holds bufferCapacity meshlets and grows to meshletCapacity on the next upload
+		uint32_t bufferCapacity = 0;
+		uint32_t meshletCapacity = 0;
+		RveRangeAllocator meshletAllocator;
+		// Keyed by RveModelHandle::value
+		std::unordered_map<uint32_t, MeshletRange> modelMeshlets;
+		std::vector<PendingFree> pendingFrees;
+		std::vector<RveMeshlet> stagedMeshlets;
+		std::vector<StagedUpload> stagedUploads;
+
+		std::array<FrameResources, RveSwapChain::MAX_FRAMES_IN_FLIGHT> frames;
+		int currentFrame = 0;
+		std::vector<Instance> instances;
+		uint32_t commandCount = 0;
+		uint32_t maxMeshletsPerInstance = 0;
+		Stats stats{};
+	};
+} // namespace rve
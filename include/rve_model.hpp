@@ -1,37 +1,187 @@
 #pragma once
 
 #include "rve_vulkan_device.hpp"
+#include "rve_meshlet_builder.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
 #include <vector>
 
 namespace rve {
+	class RveGeometryPool;
+
+	enum class RveVertexFormat {
+		Float,
+		Compact
+	};
+
+	// Model owned by an RveAssetRegistry: slot index in the low 24 bits, the slot's generation in the high 8
+	struct RveModelHandle {
+		uint32_t value = ~0u;
+
+		uint32_t GetIndex() const { return value & indexMask; }
+		uint32_t GetGeneration() const { return value >> indexBits; }
+		bool IsNull() const { return value == ~0u; }
+		bool operator==(const RveModelHandle &) const = default;
+
+		static constexpr uint32_t indexBits = 24;
+		static constexpr uint32_t indexMask = (1u << indexBits) - 1;
+	};
+
 	class RveModel {
 	public:
 		struct Vertex {
 			glm::vec3 position{};
 			glm::vec3 color{};
+			glm::vec3 normal{};
+			glm::vec2 uv{};
+
+			static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions(
+				RveVertexFormat format = RveVertexFormat::Float);
+			static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions(
+				RveVertexFormat format = RveVertexFormat::Float);
+		};
+
+		// Position is unorm16 relative to the mesh bounds, color is RGBA8, normal is octahedral snorm16 and
+		// texture coordinates are half floats so tiling coordinates outside [0, 1] survive
+		struct CompactVertex {
+			uint16_t position[4];
+			uint8_t color[4];
+			int16_t normal[2];
+			uint16_t uv[2];
+		};
+
+		struct QuantizationReport {
+			float maxPositionError = 0.0f;
+			float meanPositionError = 0.0f;
+			float maxColorError = 0.0f;
+			float maxNormalErrorDegrees = 0.0f;
+			float maxUvError = 0.0f;
+			VkDeviceSize floatBytes = 0;
+			VkDeviceSize compactBytes = 0;
+		};
 
-			static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
-			static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+		// Index range relative to the mesh, error is the simplification error in model units
+		struct Lod {
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			float error = 0.0f;
 		};
 
-		RveModel(RveVulkanDevice& device, std::vector<Vertex> &vertices);
+		// Non owning view of mesh data, the model keeps copies of the small tables only. Precomputed bounds
+		// are used as is when given, otherwise they are computed from the vertices.
+		struct MeshData {
+			std::span<const Vertex> vertices{};
+			std::span<const uint32_t> indices{};
+			std::span<const Lod> lods{};
+			std::span<const RveMeshlet> meshlets{};
+			bool hasBounds = false;
+			glm::vec3 boundingCenter{0.0f};
+			float boundingRadius = 0.0f;
+		};
+
+		struct Builder {
+			std::vector<Vertex> vertices{};
+			// All LOD index lists back to back, LOD 0 first
+			std::vector<uint32_t> indices{};
+			std::vector<Lod> lods{};
+			// Clusters of LOD 0, their index runs replace the LOD 0 triangle order
+			std::vector<RveMeshlet> meshlets{};
+			// Seen from both sides, the pipeline does not cull back faces so its meshlets skip the cone test
+			bool twoSided = false;
+
+			void GenerateLods(uint32_t maxLodCount = 5, float reduction = 0.5f);
+			void GenerateMeshlets();
+			MeshData GetMeshData() const { return {vertices, indices, lods, meshlets}; }
+		};
+
+		// Upload ready copy of mesh data, vertices are quantized here when the pool stores compact vertices
+		struct StagedMesh {
+			MeshData data{};
+			std::vector<CompactVertex> compactVertices{};
+			QuantizationReport report{};
+		};
+
+		// Streamed models also keep their coarsest LOD, or a box over the bounds when there are no LODs,
+		// as a separate mesh that is always resident. They start out with only that mesh in the pool and
+		// draw it whenever the full mesh is not resident.
+		RveModel(RveGeometryPool& pool, const MeshData& data, bool streamed = false);
+		RveModel(RveGeometryPool& pool, const Builder& builder) : RveModel(pool, builder.GetMeshData()) {}
 		~RveModel();
 		RveModel(const RveModel &) = delete;
 		RveModel &operator=(const RveModel &) = delete;
 
-		void Bind(VkCommandBuffer commandBuffer);
-		void Draw(VkCommandBuffer commandBuffer);
-		
+		void Draw(VkCommandBuffer commandBuffer, uint32_t lodLevel = 0);
+
+		// CPU side of an upload, safe to call from any thread. The data must be the mesh the model was made from.
+		StagedMesh StageMesh(const MeshData& data) const;
+		void MakeResident(const StagedMesh& staged);
+		// Streamed models only, the pool keeps the range until frames in flight that drew it retire
+		void Evict();
+		bool IsResident() const { return meshHandle != noHandle; }
+		bool IsStreamed() const { return coarseHandle != noHandle; }
+		// Pool memory taken by the full mesh while resident
+		VkDeviceSize GetMeshBytes() const;
+		uint32_t GetCoarseTriangleCount() const { return coarseIndexCount / 3; }
+
+		// The renderer notes every draw with the mesh's projected radius in pixels, the residency manager
+		// takes the request once per frame
+		void NoteDrawn(float screenRadius) {
+			drawRequested = true;
+			drawPriority = glm::max(drawPriority, screenRadius);
+		}
+		bool TakeDrawRequest(float& priority) {
+			bool requested = drawRequested;
+			priority = drawPriority;
+			drawRequested = false;
+			drawPriority = 0.0f;
+			return requested;
+		}
+
+		RveGeometryPool& GetGeometryPool() const { return rveGeometryPool; }
+		RveVertexFormat GetVertexFormat() const { return vertexFormat; }
+		const glm::mat4& GetDequantizeTransform() const { return dequantizeTransform; }
+		const QuantizationReport& GetQuantizationReport() const { return quantizationReport; }
+		uint32_t GetLodCount() const { return static_cast<uint32_t>(lods.size()); }
+		const Lod& GetLod(uint32_t lodLevel) const { return lods[lodLevel]; }
+		uint32_t GetTriangleCount(uint32_t lodLevel = 0) const;
+		const glm::vec3& GetBoundingCenter() const { return boundingCenter; }
+		float GetBoundingRadius() const { return boundingRadius; }
+		bool HasMeshlets() const { return !meshlets.empty(); }
+		const std::vector<RveMeshlet>& GetMeshlets() const { return meshlets; }
+		uint32_t GetMeshHandle() const { return meshHandle; }
+
+		static constexpr uint32_t noHandle = ~0u;
+
 	private:
-		void CreateVertexBuffers(std::vector<Vertex> &vertices);
+		// Positions are stored relative to boundsMin and extent, the same frame for the full and coarse mesh
+		static std::vector<CompactVertex> QuantizeVertices(
+			std::span<const Vertex> vertices,
+			glm::vec3 boundsMin,
+			glm::vec3 extent,
+			QuantizationReport *report);
+		void CreateCoarseMesh(const MeshData& data);
+		uint32_t AllocateMesh(const StagedMesh& staged);
 
-		RveVulkanDevice& rveDevice;
-		VkBuffer vertexBuffer;
-		VkDeviceMemory vertexBufferMemory;
+		RveGeometryPool& rveGeometryPool;
+		uint32_t meshHandle = noHandle;
+		uint32_t coarseHandle = noHandle;
 		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t coarseIndexCount = 0;
+		RveVertexFormat vertexFormat;
+		glm::vec3 boundsMin{0.0f};
+		glm::vec3 boundsExtent{1.0f};
+		glm::mat4 dequantizeTransform{1.0f};
+		QuantizationReport quantizationReport{};
+		std::vector<Lod> lods{};
+		std::vector<RveMeshlet> meshlets{};
+		glm::vec3 boundingCenter{0.0f};
+		float boundingRadius = 0.0f;
+		bool drawRequested = false;
+		float drawPriority = 0.0f;
 	};
 } // namespace rve
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+#include "rve_pipeline.hpp"
+#include "rve_frame_info.hpp"
+#include "rve_swap_chain.hpp"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace rve {
+	// Two phase occlusion culling against a Hi-Z pyramid built from the early pass depth.
+	// Objects visible last frame are drawn first, the rest are tested against the pyramid
+	// and the newly visible ones are drawn in the late pass.
+	class RveOcclusionCuller {
+	public:
+		// Matches the Object struct in shaders/occlusion_cull.comp
+		struct Object {
+			glm::vec3 viewCenter{0.0f};
+			float radius = 0.0f;
+			uint32_t indexCount = 0;
+			uint32_t firstIndex = 0;
+			int32_t vertexOffset = 0;
+			uint32_t visibilityIndex = 0;
+		};
+
+		struct Stats {
+			uint32_t objectsTotal = 0;
+			uint32_t drawnEarly = 0;
+			uint32_t drawnLate = 0;
+			uint32_t frustumCulled = 0;
+			uint32_t occlusionCulled = 0;
+		};
+
+		RveOcclusionCuller(RveVulkanDevice& device);
+		~RveOcclusionCuller();
+		RveOcclusionCuller(const RveOcclusionCuller &) = delete;
+		RveOcclusionCuller &operator=(const RveOcclusionCuller &) = delete;
+
+		// Must be called after the frame's fence has been waited on, collects stats from the previous use of the slot
+		void BeginFrame(int frameIndex);
+		// visibilityIndex must stay the same for an object across frames, it keys the persistent visibility
+		uint32_t AddObject(
+			uint32_t visibilityIndex,
+			const glm::vec3& viewCenter,
+			float radius,
+			uint32_t indexCount,
+			uint32_t firstIndex,
+			int32_t vertexOffset);
+		// Without occlusion every object inside the frustum is drawn early and the late phase is skipped
+		void DispatchEarly(const RveFrameInfo& frameInfo, bool occlusionEnabled);
+		// Records between the two render passes, depthView must be in DEPTH_STENCIL_READ_ONLY_OPTIMAL
+		void DispatchLate(const RveFrameInfo& frameInfo, VkImageView depthView);
+		void DrawObject(VkCommandBuffer commandBuffer, uint32_t objectIndex, RveDrawPhase phase);
+
+		// One uint per object, bit 0 drawn early and bit 1 drawn late
+		VkBuffer GetObjectPhaseBuffer() const { return frames[currentFrame].phaseBuffer; }
+		bool IsLateActive() const { return lateActive; }
+		// Stats lag MAX_FRAMES_IN_FLIGHT frames behind
+		const Stats& GetStats() const { return stats; }
+
+		static constexpr uint32_t maxPyramidLevels = 16;
+
+	private:
+		struct GpuStats {
+			uint32_t drawnEarly;
+			uint32_t drawnLate;
+			uint32_t frustumCulled;
+			uint32_t occlusionCulled;
+		};
+
+		struct FrameResources {
+			VkBuffer objectBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory objectMemory = VK_NULL_HANDLE;
+			void *objectMapped = nullptr;
+			VkBuffer commandBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory commandMemory = VK_NULL_HANDLE;
+			VkBuffer phaseBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory phaseMemory = VK_NULL_HANDLE;
+			uint32_t objectCapacity = 0;
+			VkBuffer statsBuffer = VK_NULL_HANDLE;
+			VkDeviceMemory statsMemory = VK_NULL_HANDLE;
+			void *statsMapped = nullptr;
+			uint32_t objectsSubmitted = 0;
+
+			VkImage pyramidImage = VK_NULL_HANDLE;
+			VkDeviceMemory pyramidMemory = VK_NULL_HANDLE;
+			VkImageView pyramidView = VK_NULL_HANDLE;
+			std::array<VkImageView, maxPyramidLevels> pyramidLevelViews{};
+			VkExtent2D depthExtent{0, 0};
+			uint32_t pyramidLevels = 0;
+			bool pyramidNeedsTransition = false;
+
+			VkDescriptorSet cullDescriptorSet = VK_NULL_HANDLE;
+			std::array<VkDescriptorSet, maxPyramidLevels> pyramidDescriptorSets{};
+			// Set when the shared visibility buffer was replaced while the slot's set may have been in use
+			bool cullDescriptorSetStale = false;
+		};
+
+		void CreateDescriptorResources();
+		void CreatePipelineLayouts();
+		void CreateFrameResources(FrameResources& frame);
+		void DestroyFrameResources(FrameResources& frame);
+		void DestroyPyramid(FrameResources& frame);
+		void EnsureObjectCapacity(FrameResources& frame, uint32_t objectCount);
+		// Grows the buffer on the GPU, the copy is recorded into the frame's command buffer
+		void EnsureVisibilityCapacity(VkCommandBuffer commandBuffer, uint32_t visibilityCount);
+		void EnsurePyramid(FrameResources& frame, VkExtent2D depthExtent);
+		void WriteCullDescriptorSet(FrameResources& frame);
+		void BuildDepthPyramid(VkCommandBuffer commandBuffer, FrameResources& frame, VkImageView depthView);
+		void DispatchCull(const RveFrameInfo& frameInfo, RveDrawPhase phase, bool occlusionEnabled);
+
+		RveVulkanDevice& rveVulkanDevice;
+		std::unique_ptr<RveComputePipeline> cullPipeline;
+		std::unique_ptr<RveComputePipeline> pyramidPipeline;
+		VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+		VkPipelineLayout pyramidPipelineLayout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout cullSetLayout = VK_NULL_HANDLE;
+		VkDescriptorSetLayout pyramidSetLayout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		VkSampler pyramidSampler = VK_NULL_HANDLE;
+
+		// Visible last frame, persistent across frames and indexed by Object::visibilityIndex
+		VkBuffer visibilityBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory visibilityMemory = VK_NULL_HANDLE;
+		uint32_t visibilityCapacity = 0;
+
+		std::array<FrameResources, RveSwapChain::MAX_FRAMES_IN_FLIGHT> frames;
+		int currentFrame = 0;
+		std::vector<Object> objects;
+		uint32_t maxVisibilityIndex = 0;
+		bool lateActive = false;
+		Stats stats{};
+	};
+} // namespace rve
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+#include "rve_bindless_table.hpp"
+#include "rve_buffer.hpp"
+#include "rve_frame_info.hpp"
+#include "rve_job_system.hpp"
+#include "rve_sampler_cache.hpp"
+#include "rve_swap_chain.hpp"
+#include "rve_virtual_texture.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rve {
+	// Software virtual texturing over the bindless table. Resident pages of every registered virtual texture
+	// share one atlas of physical pages, and each virtual texture has a page table texture with a texel per
+	// page and mip pointing at the atlas page to read, or at the nearest coarser resident page while its own
+	// is missing. The bindless fragment shader does the indirection and writes the page it wanted into a low
+	// resolution feedback buffer; once the frame retires its requests are loaded from the cooked tiles on the
+	// job system, coarse mips first, into the least recently requested physical pages. Only plain sampled
+	// images are used, no sparse binding, so it runs on any device with bindless support.
+	class RvePageCache {
+	public:
+		struct Stats {
+			uint32_t virtualTextures = 0;
+			uint32_t physicalPages = 0;
+			uint32_t residentPages = 0;
+			uint32_t loadingPages = 0;
+			// Distinct pages in the last feedback read back
+			uint32_t requestedPages = 0;
+			uint64_t uploads = 0;
+			uint64_t evictions = 0;
+		};
+
+		RvePageCache(
+			RveVulkanDevice& device,
+			RveBindlessTable& bindlessTable,
+			RveJobSystem& jobSystem,
+			RveSamplerCache& samplers,
+			uint32_t atlasPages = defaultAtlasPages,
+			VkFormat atlasFormat = VK_FORMAT_R8G8B8A8_SRGB);
+		~RvePageCache();
+		RvePageCache(const RvePageCache &) = delete;
+		RvePageCache &operator=(const RvePageCache &) = delete;
+
+		// Index for RveMaterial::virtualTextureIndex. Loads the coarsest mip, which stays resident so every
+		// page has something to fall back to. Must not be called while frames are in flight.
+		uint32_t Register(std::shared_ptr<RveVirtualTexture> texture);
+		// Call after the frame's fence was waited on and before the render pass begins, reads the requests the
+		// frame slot recorded last time and records this frame's page uploads
+		void Update(RveFrameInfo& frameInfo);
+		// Call after the last render pass, makes the frame's feedback visible to the host
+		void EndFrame(RveFrameInfo& frameInfo);
+
+		// Bindless storage buffer slots the fragment shader reads, valid after Update
+		uint32_t GetInfoSlot() const { return infoSlot; }
+		uint32_t GetFeedbackSlot() const { return currentFeedback != nullptr ? currentFeedback->slot : RveBindlessTable::invalidIndex; }
+		Stats GetStats() const;
+
+		// 16 x 16 pages of 136 texels, a 2176 pixel square atlas
+		static constexpr uint32_t defaultAtlasPages = 16;
+		// Width and height in pixels of the screen area each feedback entry covers
+		static constexpr uint32_t feedbackScale = 8;
+		static constexpr uint32_t maxLoadsInFlight = 16;
+		static constexpr uint32_t maxUploadsPerFrame = 8;
+		// Feedback requests spend 6 bits on the virtual texture and all bits set marks an empty entry
+		static constexpr uint32_t maxVirtualTextures = 63;
+
+	private:
+		static constexpr uint32_t noPage = ~0u;
+		static constexpr uint32_t loadingPage = ~0u - 1;
+
+		struct PhysicalPage {
+			uint32_t texture = noPage;
+			uint32_t page = 0;
+			uint64_t lastRequested = 0;
+			// The coarsest page of a virtual texture, never evicted
+			bool pinned = false;
+		};
+
+		struct VirtualTextureEntry {
+			std::shared_ptr<RveVirtualTexture> file;
+			VkImage pageTable = VK_NULL_HANDLE;
+			VkDeviceMemory pageTableMemory = VK_NULL_HANDLE;
+			VkImageView pageTableView = VK_NULL_HANDLE;
+			uint32_t slot = RveBindlessTable::invalidIndex;
+			// Physical page of each virtual page, noPage or loadingPage when not resident
+			std::vector<uint32_t> residency;
+			// RGBA8 page table texels for every mip, in the order of the file's pages
+			std::vector<uint32_t> tableTexels;
+			bool tableDirty = false;
+		};
+
+		struct Load {
+			RveJobCounter counter;
+			uint32_t texture = 0;
+			uint32_t page = 0;
+			std::vector<uint8_t> texels;
+		};
+
+		// Per frame feedback and staging memory, reused once the frame's fence has been waited on
+		struct FrameResources {
+			std::unique_ptr<RveBuffer> feedback;
+			uint32_t slot = RveBindlessTable::invalidIndex;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			bool recorded = false;
+			std::unique_ptr<RveBuffer> staging;
+		};
+
+		struct TileUpload {
+			uint32_t physicalPage;
+			const uint8_t *texels;
+		};
+
+		void CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImage& image, VkDeviceMemory& memory, VkImageView& view);
+		void EnsureFeedbackCapacity(FrameResources& frame, VkExtent2D extent);
+		void ReadFeedback(FrameResources& frame);
+		// Touches the resident pages from the coarsest mip down to the requested one, queues the first missing one
+		void RequestPage(uint32_t texture, uint32_t mip, uint32_t x, uint32_t y);
+		// Free page first, then the least recently requested one not wanted by the latest feedback
+		uint32_t AllocatePhysicalPage();
+		void Evict(uint32_t physicalPage);
+		void RebuildPageTable(VirtualTextureEntry& entry);
+		// Copies the tiles and dirty page tables through the staging buffer, throws before writing past GetStagingSize() bytes
+		void RecordUploads(VkCommandBuffer commandBuffer, RveBuffer& staging, const std::vector<TileUpload>& tiles);
+		VkDeviceSize GetStagingSize() const;
+
+		RveVulkanDevice& rveVulkanDevice;
+		RveBindlessTable& bindlessTable;
+		RveJobSystem& jobSystem;
+		const uint32_t atlasPages;
+		const VkFormat atlasFormat;
+		VkSampler atlasSampler = VK_NULL_HANDLE;
+		VkSampler pageTableSampler = VK_NULL_HANDLE;
+		VkImage atlas = VK_NULL_HANDLE;
+		VkDeviceMemory atlasMemory = VK_NULL_HANDLE;
+		VkImageView atlasView = VK_NULL_HANDLE;
+		uint32_t atlasSlot = RveBindlessTable::invalidIndex;
+		std::unique_ptr<RveBuffer> infoBuffer;
+		uint32_t infoSlot = RveBindlessTable::invalidIndex;
+		std::vector<VirtualTextureEntry> virtualTextures;
+		std::vector<PhysicalPage> physicalPages;
+		std::vector<std::unique_ptr<Load>> loads;
+		// Mip, virtual texture and page of the missing pages the feedback being processed asked for
+		std::vector<std::array<uint32_t, 3>> pendingRequests;
+		std::array<FrameResources, RveSwapChain::MAX_FRAMES_IN_FLIGHT> frames;
+		FrameResources *currentFeedback = nullptr;
+		std::vector<uint32_t> feedbackKeys;
+		uint64_t frame = 1;
+		uint32_t requestedPages = 0;
+		uint64_t uploads = 0;
+		uint64_t evictions = 0;
+	};
+} // namespace rve
@@ -1,11 +1,22 @@
 #pragma once
 
 #include "rve_vulkan_device.hpp"
+#include "rve_model.hpp"
 
+#include <span>
 #include <string>
 #include <vector>
 
 namespace rve {
+	// 32 bit specialization constants shared by every stage of a pipeline, stages ignore ids they do not declare
+	struct RveSpecializationConstants {
+		std::vector<VkSpecializationMapEntry> entries;
+		std::vector<uint32_t> data;
+
+		void Set(uint32_t constantId, uint32_t value);
+		VkSpecializationInfo Info() const;
+	};
+
 	struct RvePipelineConfigInfo {
 		uint32_t subpass = 0;
 		VkPipelineViewportStateCreateInfo viewportInfo;
@@ -19,16 +30,18 @@ namespace rve {
 		VkRenderPass renderPass = nullptr;
 		std::vector<VkDynamicState> dynamicStateEnables;
 		VkPipelineDynamicStateCreateInfo dynamicStateInfo;
+		RveVertexFormat vertexFormat = RveVertexFormat::Float;
+		RveSpecializationConstants specialization;
 	};
 
 	class RvePipeline {
 	private:
-		static std::vector<char> ReadFile(const std::string& filePath);
 		void CreateGraphicsPipeline(
 			const std::string& vertFilePath,
 			const std::string& fragFilePath,
-			const RvePipelineConfigInfo& configInfo);
-		void CreateShaderModule(const std::vector<char>& shaderCode, VkShaderModule* shaderModule);
+			const RvePipelineConfigInfo& configInfo,
+			VkPipelineCache pipelineCache);
+		void CreateShaderModule(std::span<const uint32_t> shaderCode, VkShaderModule* shaderModule);
 
 		RveVulkanDevice& rveVulkanDevice;
 		VkPipeline graphicsPipeline;
@@ -40,12 +53,36 @@ namespace rve {
 			RveVulkanDevice& device,
 			const std::string& vertFilePath,
 			const std::string& fragFilePath,
-			const RvePipelineConfigInfo& configInfo);
+			const RvePipelineConfigInfo& configInfo,
+			VkPipelineCache pipelineCache = VK_NULL_HANDLE);
 		~RvePipeline();
 		RvePipeline(const RvePipeline &) = delete;
 		RvePipeline &operator=(const RvePipeline &) = delete;
 
 		static void DefaultPipelineConfigInfo(RvePipelineConfigInfo &configInfo);
+		static std::vector<char> ReadFile(const std::string& filePath);
+		// Prefers the embedded bundle, falls back to reading the file into fileStorage
+		static std::span<const uint32_t> LoadShaderCode(const std::string& filePath, std::vector<char>& fileStorage);
+		void Bind(VkCommandBuffer commandBuffer);
+		// Exchanges the Vulkan objects with other, so a rebuilt variant replaces this one while pointers to it stay valid
+		void Swap(RvePipeline& other);
+	};
+
+	class RveComputePipeline {
+	private:
+		RveVulkanDevice& rveVulkanDevice;
+		VkPipeline computePipeline;
+		VkShaderModule compShaderModule;
+
+	public:
+		RveComputePipeline(
+			RveVulkanDevice& device,
+			const std::string& compFilePath,
+			VkPipelineLayout pipelineLayout);
+		~RveComputePipeline();
+		RveComputePipeline(const RveComputePipeline &) = delete;
+		RveComputePipeline &operator=(const RveComputePipeline &) = delete;
+
 		void Bind(VkCommandBuffer commandBuffer);
 	};
 } // namespace rve
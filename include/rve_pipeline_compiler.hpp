@@ -0,0 +1,50 @@
+#pragma once
+
+#include "rve_pipeline.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rve {
+	// Builds graphics pipelines on a pool of worker threads. Every pipeline goes through one
+	// shared VkPipelineCache, which the driver synchronizes internally.
+	class RvePipelineCompiler {
+	public:
+		// workerCount 0 picks one less than the hardware threads, capped at maxWorkers
+		RvePipelineCompiler(RveVulkanDevice& device, uint32_t workerCount = 0);
+		~RvePipelineCompiler();
+		RvePipelineCompiler(const RvePipelineCompiler &) = delete;
+		RvePipelineCompiler &operator=(const RvePipelineCompiler &) = delete;
+
+		// The config is copied, compile errors are rethrown from the future's get()
+		std::future<std::unique_ptr<RvePipeline>> CompileGraphicsPipeline(
+			const std::string& vertFilePath,
+			const std::string& fragFilePath,
+			const RvePipelineConfigInfo& configInfo);
+
+		VkPipelineCache GetPipelineCache() const { return pipelineCache; }
+		uint32_t GetPendingCount() const { return pendingCount.load(); }
+
+		static constexpr uint32_t maxWorkers = 4;
+
+	private:
+		void WorkerLoop();
+
+		RveVulkanDevice& rveVulkanDevice;
+		VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> jobs;
+		std::mutex jobMutex;
+		std::condition_variable jobCondition;
+		bool stopping = false;
+		std::atomic<uint32_t> pendingCount{0};
+	};
+} // namespace rve
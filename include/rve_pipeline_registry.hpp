@@ -0,0 +1,94 @@
+#pragma once
+
+#include "rve_pipeline.hpp"
+#include "rve_pipeline_compiler.hpp"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rve {
+	// Deduplicates graphics pipeline variants keyed by shader paths, fixed function state and
+	// specialization constants. Variants are only compiled the first time they are requested,
+	// either in place or on the compiler's worker threads.
+	class RvePipelineRegistry {
+	public:
+		struct Stats {
+			uint32_t variants = 0;
+			uint32_t pending = 0;
+			uint32_t hits = 0;
+			uint32_t misses = 0;
+			uint32_t compileFailures = 0;
+			uint32_t reloads = 0;
+			uint32_t reloadFailures = 0;
+		};
+
+		RvePipelineRegistry(RveVulkanDevice& device) : rveVulkanDevice{device}, compiler{device} {}
+		~RvePipelineRegistry();
+		RvePipelineRegistry(const RvePipelineRegistry &) = delete;
+		RvePipelineRegistry &operator=(const RvePipelineRegistry &) = delete;
+
+		// Blocks until the variant exists, the returned pipeline lives until Clear or the registry is destroyed
+		RvePipeline& GetGraphicsPipeline(
+			const std::string& vertFilePath,
+			const std::string& fragFilePath,
+			const RvePipelineConfigInfo& configInfo);
+		// Never blocks, queues the variant on first request and returns nullptr until it is compiled. A variant
+		// whose compile failed is logged once and keeps returning nullptr.
+		RvePipeline *RequestGraphicsPipeline(
+			const std::string& vertFilePath,
+			const std::string& fragFilePath,
+			const RvePipelineConfigInfo& configInfo);
+		// Rebuilds every variant that uses the SPIR-V file in the background, including failed ones
+		void ReloadShader(const std::string& spvFilePath);
+		// Call once per frame. Swaps in finished rebuilds, the replaced objects go to the device's deletion
+		// queue. Failed rebuilds keep the old pipeline.
+		void BeginFrame();
+		// Drops every variant, their objects are destroyed once the frames in flight retire
+		void Clear();
+		Stats GetStats() const;
+
+	private:
+		struct Key {
+			std::string vertFilePath;
+			std::string fragFilePath;
+			std::vector<uint64_t> state;
+
+			bool operator==(const Key& other) const {
+				return state == other.state && vertFilePath == other.vertFilePath && fragFilePath == other.fragFilePath;
+			}
+		};
+
+		struct KeyHash {
+			size_t operator()(const Key& key) const;
+		};
+
+		struct Entry {
+			std::unique_ptr<RvePipeline> pipeline;
+			std::future<std::unique_ptr<RvePipeline>> pending;
+			// The background compile threw, the variant is not compiled again
+			bool failed = false;
+			// Kept for rebuilding the variant when one of its shaders is reloaded
+			RvePipelineConfigInfo configInfo;
+			std::future<std::unique_ptr<RvePipeline>> reload;
+			// The shader was saved again while a compile was in flight
+			bool reloadAgain = false;
+		};
+
+		static Key MakeKey(const std::string& vertFilePath, const std::string& fragFilePath, const RvePipelineConfigInfo& configInfo);
+		static void AppendConfigState(const RvePipelineConfigInfo& configInfo, std::vector<uint64_t>& state);
+		// Moves a finished compile into the entry, nullptr while pending or after it failed
+		RvePipeline *Resolve(const Key& key, Entry& entry, bool wait);
+
+		RveVulkanDevice& rveVulkanDevice;
+		RvePipelineCompiler compiler;
+		std::unordered_map<Key, Entry, KeyHash> pipelines;
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+		uint32_t compileFailures = 0;
+		uint32_t reloads = 0;
+		uint32_t reloadFailures = 0;
+	};
+} // namespace rve
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rve {
+	// First fit over offset-sorted free blocks, neighbours are merged on release. Only tracks offsets,
+	// the owner keeps the storage and grows it by releasing the new tail.
+	class RveRangeAllocator {
+	public:
+		void Reset(uint32_t capacity, uint32_t used);
+		bool Allocate(uint32_t count, uint32_t &offset);
+		void Release(uint32_t offset, uint32_t count);
+		uint32_t LargestBlock() const;
+		uint32_t FreeCount() const;
+		size_t BlockCount() const { return freeBlocks.size(); }
+
+	private:
+		struct FreeBlock {
+			uint32_t offset;
+			uint32_t count;
+		};
+
+		std::vector<FreeBlock> freeBlocks;
+	};
+} // namespace rve
@@ -1,31 +1,230 @@
 #pragma once
 
 #include "rve_pipeline.hpp" 
+#include "rve_pipeline_registry.hpp"
 #include "rve_vulkan_device.hpp"
-#include "rve_game_object.hpp"
+#include "rve_components.hpp"
+#include "rve_ecs.hpp"
+#include "rve_frame_info.hpp"
+#include "rve_meshlet_culler.hpp"
+#include "rve_occlusion_culler.hpp"
+#include "rve_descriptors.hpp"
+#include "rve_frame_ring.hpp"
+#include "rve_bindless_table.hpp"
+#include "rve_buffer.hpp"
+#include "rve_transform_store.hpp"
+#include "rve_transform_hierarchy.hpp"
+#include "rve_bvh.hpp"
+#include "rve_job_system.hpp"
+#include "rve_asset_registry.hpp"
+#include "rve_texture.hpp"
+#include "rve_sampler_cache.hpp"
+#include "rve_page_cache.hpp"
 
+#include <array>
 #include <memory>
 #include <vector>
 
 namespace rve {
+	// Matches GlobalUbo in the vertex shaders, bound at set 0 binding 0 with a dynamic offset
+	struct RveGlobalUbo {
+		glm::mat4 projectionView{1.0f};
+		glm::vec4 ambientLightColor{1.0f, 1.0f, 1.0f, 0.2f};
+		glm::vec4 lightDirection{glm::normalize(glm::vec3{1.0f, 3.0f, 1.0f}), 0.0f};
+	};
+
+	// Only read by the bindless shaders, textureIndex is a slot from RveRenderSystem::RegisterTexture and
+	// virtualTextureIndex one from RegisterVirtualTexture, the texels of each set multiply the base color
+	struct RveMaterial {
+		glm::vec4 baseColor{1.0f};
+		uint32_t textureIndex = RveBindlessTable::invalidIndex;
+		uint32_t virtualTextureIndex = RveBindlessTable::invalidIndex;
+	};
+
+	// Per draw entry of the bindless frame buffer, defined next to its layout checks in the source
+	struct RveBindlessObjectData;
+
+	// Specialization constant values, matching the constant_id declarations in the vertex shaders
+	enum class RveLightingModel : uint32_t {
+		Lambert = 0,
+		Unlit = 1
+	};
+
+	enum class RveDebugView : uint32_t {
+		None = 0,
+		Normals = 1
+	};
+
 	class RveRenderSystem {
 	public:
-		RveRenderSystem(RveVulkanDevice& device, VkRenderPass renderPass);
+		struct Stats {
+			uint32_t objectsDrawn = 0;
+			uint64_t trianglesRendered = 0;
+			uint64_t trianglesFullDetail = 0;
+			RveMeshletCuller::Stats meshlets{};
+			RveOcclusionCuller::Stats occlusion{};
+			uint32_t descriptorSetWrites = 0;
+			VkDeviceSize frameRingBytes = 0;
+			RveBindlessTable::Stats bindless{};
+			RvePageCache::Stats virtualTexturing{};
+			uint32_t spatialCulled = 0;
+			RveBvh::Stats spatial{};
+		};
+
+		RveRenderSystem(
+			RveVulkanDevice& device,
+			RvePipelineRegistry& registry,
+			RveJobSystem& jobSystem,
+			const RveAssetRegistry& assets,
+			RveSamplerCache& samplers,
+			VkRenderPass renderPass,
+			RveVertexFormat format = RveVertexFormat::Float);
 		~RveRenderSystem();
 		RveRenderSystem(const RveRenderSystem &) = delete;
 		RveRenderSystem &operator=(const RveRenderSystem &) = delete;
 
-		void RenderGameObjects(
-			VkCommandBuffer commandBuffer, 
-			std::vector<RveGameObject>& gameObjects
-		);
+		// Selects LODs and records early phase culling, must be called before the render pass begins.
+		// Draws entities with a ModelComponent and either a TransformComponent or a HierarchyComponent,
+		// the hierarchy and the asset registry must have been updated for this frame.
+		void PrepareFrame(RveFrameInfo& frameInfo, RveWorld& world, const RveTransformHierarchy& hierarchy);
+		// Records late phase culling between the two render passes
+		void CullOccluded(RveFrameInfo& frameInfo, VkImageView depthView);
+		void RenderGameObjects(RveFrameInfo& frameInfo, RveDrawPhase phase);
+		// Records what has to follow the last render pass of the frame
+		void FinishFrame(RveFrameInfo& frameInfo);
+
+		// Materials are indexed by ModelComponent::materialIndex, index 0 is a default white material.
+		// Must not be called while frames are in flight.
+		uint32_t RegisterMaterial(const RveMaterial& material);
+		// Bindless slot reading the texture through the sampler, both must outlive the render system.
+		// Without bindless support textures are not drawn and invalidIndex is returned.
+		uint32_t RegisterTexture(const RveTexture& texture, VkSampler sampler);
+		// Streamed through the page cache from then on. Must not be called while frames are in flight,
+		// without bindless support virtual textures are not drawn and invalidIndex is returned.
+		uint32_t RegisterVirtualTexture(std::shared_ptr<RveVirtualTexture> texture);
+
+		const Stats& GetStats() const { return stats; }
+		bool IsBindless() const { return bindlessEnabled; }
+		void SetLodEnabled(bool enabled) { lodEnabled = enabled; }
+		void SetMeshletCullingEnabled(bool enabled) { meshletCullingEnabled = enabled; }
+		void SetOcclusionCullingEnabled(bool enabled) { occlusionCullingEnabled = enabled; }
+		void SetSpatialCullingEnabled(bool enabled) { spatialCullingEnabled = enabled; }
+		// World bounds of everything drawn last frame, user data is the entity index, for picking and other queries
+		const RveBvh& GetSpatialIndex() const { return spatialIndex; }
+		// Switches to another pipeline variant, compiled in the background on first use
+		void SetLightingModel(RveLightingModel model);
+		void SetDebugView(RveDebugView view);
+		// The current variant with an extra specialization constant that no shader declares, so every tag is a
+		// distinct variant compiling the same code. wait compiles on the calling thread like a registry miss did.
+		RvePipeline *RequestTaggedVariant(uint32_t tag, bool wait);
+
+		// Coarsest LOD whose projected error stays under this many pixels is selected
+		static constexpr float lodErrorThreshold = 1.0f;
+		// Switching to a coarser LOD also requires its error to drop below threshold * hysteresis
+		static constexpr float lodHysteresis = 0.75f;
+		static constexpr VkDeviceSize frameRingSize = 64 * 1024;
+		static constexpr uint32_t maxMaterials = 256;
+		static constexpr uint32_t variantTagConstantId = 64;
 	
 	private:
+		struct DrawItem {
+			const RveModel *model;
+			glm::mat4 modelMatrix;
+			glm::mat4 normalMatrix;
+			uint32_t lodLevel;
+			// Index into the occlusion culler objects, or noCullIndex for non indexed models drawn directly
+			uint32_t occlusionObject;
+			// Index into the meshlet culler instances, or noCullIndex for a plain LOD draw
+			uint32_t meshletInstance;
+		};
+		static constexpr uint32_t noCullIndex = ~0u;
+
+		// Renderable found by the queries this frame, pointers stay valid until the next structural change
+		struct DrawCandidate {
+			RveEntity entity;
+			RveModel *model;
+			ModelComponent *modelComponent;
+			const glm::mat4 *modelMatrix;
+		};
+
+		// Indexed by entity index, the generation detects a destroyed entity whose slot was reused
+		struct SpatialProxy {
+			RveBvh::Proxy proxy = RveBvh::noProxy;
+			uint32_t generation = 0;
+			uint32_t lastFrame = 0;
+		};
+
+		// Per frame storage buffer holding the global data followed by one entry per draw item
+		struct BindlessFrame {
+			std::unique_ptr<RveBuffer> buffer;
+			uint32_t slot = RveBindlessTable::invalidIndex;
+			uint32_t objectCapacity = 0;
+		};
+
+		void CreateDescriptorResources();
+		void CreateBindlessResources();
+		void EnsureBindlessCapacity(BindlessFrame& frame, uint32_t objectCount);
 		void CreatePipelineLayout();
-		void CreatePipeline(VkRenderPass renderPass);
+		void BuildPipelineConfig(RvePipelineConfigInfo& pipelineConfig, RveLightingModel lighting, RveDebugView view) const;
+		const char *GetVertexShaderPath() const;
+		const char *GetFragmentShaderPath() const;
+		RvePipeline& GetPipeline();
+		uint32_t SelectLod(
+			const RveModel& model,
+			ModelComponent& modelComponent,
+			const glm::mat4& modelMatrix,
+			float maxScale,
+			const RveFrameInfo& frameInfo);
+		void AddCandidate(RveEntity entity, ModelComponent& modelComponent, const glm::mat4& modelMatrix);
+		void AddDrawItem(
+			const RveFrameInfo& frameInfo,
+			RveEntity entity,
+			RveModel& model,
+			ModelComponent& modelComponent,
+			const glm::mat4& modelMatrix,
+			RveBindlessObjectData *objectData);
 
 		RveVulkanDevice& rveVulkanDevice;
-		std::unique_ptr<RvePipeline> rvePipeline;
+		RvePipelineRegistry& pipelineRegistry;
+		const RveAssetRegistry& assetRegistry;
+		VkRenderPass renderPass;
+		// Current variant owned by the registry, reset when a specialization setting changes
+		RvePipeline *rvePipeline = nullptr;
+		RvePipeline *fallbackPipeline = nullptr;
+		RveLightingModel lightingModel = RveLightingModel::Lambert;
+		RveDebugView debugView = RveDebugView::None;
 		VkPipelineLayout pipelineLayout;
+		std::unique_ptr<RveDescriptorSetLayout> globalSetLayout;
+		std::unique_ptr<RveDescriptorPool> descriptorPool;
+		std::unique_ptr<RveDescriptorSetCache> descriptorSetCache;
+		std::unique_ptr<RveFrameRing> frameRing;
+		VkDescriptorSet globalSet = VK_NULL_HANDLE;
+		uint32_t globalOffset = 0;
+		bool bindlessEnabled = false;
+		std::unique_ptr<RveBindlessTable> bindlessTable;
+		std::unique_ptr<RvePageCache> pageCache;
+		std::array<BindlessFrame, RveSwapChain::MAX_FRAMES_IN_FLIGHT> bindlessFrames;
+		BindlessFrame *currentBindlessFrame = nullptr;
+		std::unique_ptr<RveBuffer> materialBuffer;
+		uint32_t materialSlot = RveBindlessTable::invalidIndex;
+		uint32_t materialCount = 0;
+		RveVertexFormat vertexFormat;
+		std::unique_ptr<RveMeshletCuller> meshletCuller;
+		std::unique_ptr<RveOcclusionCuller> occlusionCuller;
+		std::vector<DrawItem> drawItems;
+		RveQuery<TransformComponent, ModelComponent> renderQuery;
+		RveQuery<const HierarchyComponent, ModelComponent> attachedQuery;
+		std::vector<DrawCandidate> drawCandidates;
+		std::vector<uint32_t> candidateByEntity;
+		RveBvh spatialIndex;
+		std::vector<SpatialProxy> spatialProxies;
+		std::vector<uint32_t> visibleEntities;
+		uint32_t spatialFrame = 0;
+		RveTransformStore transformStore;
+		Stats stats{};
+		bool lodEnabled = true;
+		bool meshletCullingEnabled = true;
+		bool occlusionCullingEnabled = true;
+		bool spatialCullingEnabled = true;
 	};
 } // namespace rve
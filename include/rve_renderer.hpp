@@ -19,9 +19,18 @@ namespace rve {
 		VkCommandBuffer BeginFrame();
 		void EndFrame();
 		void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+		// Continues the frame after a compute break, every frame must end with this pass to present
+		void ResumeSwapChainRenderPass(VkCommandBuffer commandBuffer);
 		void EndSwapChainRenderPass(VkCommandBuffer commandBuffer);
 		bool IsFrameInProgress() const { return isFrameStarted; }
 		VkRenderPass GetSwapChainRenderPass() const { return rveSwapChain->GetRenderPass(); }
+		float GetAspectRatio() const { return rveSwapChain->ExtentAspectRatio(); }
+		VkExtent2D GetSwapChainExtent() const { return rveSwapChain->GetSwapChainExtent(); }
+		VkImageView GetCurrentDepthImageView() const {
+			assert(isFrameStarted && 
+			"(rve_renderer.hpp) Cannot get depth image out of frame progress");
+			return rveSwapChain->GetDepthImageView(currentImageIndex);
+		}
 		VkCommandBuffer GetCurrentCommandBuffer() const { 
 			assert(isFrameStarted && 
 			"(rve_renderer.hpp) Cannot get command buffer out of frame progress");
@@ -37,6 +46,7 @@ namespace rve {
 		void CreateCommandBuffers();
 		void FreeCommandBuffers();
 		void RecreateSwapChain();
+		void BeginRenderPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass);
 
 		RveWindow& rveWindow;
 		RveVulkanDevice& rveVulkanDevice;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "rve_geometry_pool.hpp"
+#include "rve_job_system.hpp"
+#include "rve_mesh_cache.hpp"
+#include "rve_model.hpp"
+#include "rve_swap_chain.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rve {
+	// Keeps the full meshes of streamed models within a geometry pool budget. Models draw their coarse mesh
+	// until their full mesh is resident. Every frame the meshes drawn since the last update are requested,
+	// the largest on screen first, and read and quantized from their mesh cache on the job system. Finished
+	// loads are staged into the pool up to a byte budget per frame, evicting the least recently drawn meshes
+	// when over the memory budget, and copied by the frame's command buffer when the pool updates.
+	class RveResidencyManager {
+	public:
+		struct Stats {
+			uint32_t meshes = 0;
+			uint32_t residentMeshes = 0;
+			uint32_t loadingMeshes = 0;
+			uint64_t loadsStarted = 0;
+			uint64_t uploads = 0;
+			uint64_t uploadBytes = 0;
+			uint64_t evictions = 0;
+			VkDeviceSize residentBytes = 0;
+			VkDeviceSize budgetBytes = 0;
+		};
+
+		RveResidencyManager(RveJobSystem& jobSystem, VkDeviceSize budget);
+		~RveResidencyManager();
+		RveResidencyManager(const RveResidencyManager &) = delete;
+		RveResidencyManager &operator=(const RveResidencyManager &) = delete;
+
+		// The model must have been created streamed from mesh of the cache and be unregistered before it is destroyed
+		void Register(RveModel& model, std::shared_ptr<RveMeshCache> cache, uint32_t mesh);
+		// Waits for the model's load if one is running
+		void Unregister(RveModel& model);
+		// Takes effect at the next Update, evicting as far as frames in flight allow
+		void SetBudget(VkDeviceSize budget) { budgetBytes = budget; }
+		// Call once per frame after the frame's fence was waited on and before the geometry pool's Update
+		void Update();
+
+		Stats GetStats() const;
+
+		static constexpr uint32_t maxLoadsInFlight = 4;
+		// Keeps streamed uploads inside the pool's staging ring, which holds the frames in flight and the one
+		// being recorded. A single larger mesh still goes through, staged in a buffer of its own.
+		static constexpr VkDeviceSize maxUploadBytesPerFrame = RveGeometryPool::stagingRingSize / (RveSwapChain::MAX_FRAMES_IN_FLIGHT + 1);
+		// Updates a mesh must go undrawn before eviction, so meshes briefly out of view are kept
+		static constexpr uint64_t evictionGraceFrames = RveSwapChain::MAX_FRAMES_IN_FLIGHT + 1;
+
+	private:
+		struct Load {
+			RveJobCounter counter;
+			RveModel::StagedMesh staged{};
+		};
+
+		struct Entry {
+			RveModel *model = nullptr;
+			std::shared_ptr<RveMeshCache> cache{};
+			uint32_t mesh = 0;
+			VkDeviceSize bytes = 0;
+			uint64_t lastDrawnFrame = 0;
+			float priority = 0.0f;
+			std::unique_ptr<Load> load{};
+		};
+
+		bool IsEvictable(const Entry& entry) const;
+		// Evicts least recently drawn meshes until the bytes fit, false if frames in flight prevent it
+		bool MakeRoom(VkDeviceSize bytes);
+
+		RveJobSystem& jobSystem;
+		std::vector<Entry> entries;
+		VkDeviceSize budgetBytes;
+		VkDeviceSize residentBytes = 0;
+		uint64_t frame = evictionGraceFrames;
+		uint64_t loadsStarted = 0;
+		uint64_t uploads = 0;
+		uint64_t uploadBytes = 0;
+		uint64_t evictions = 0;
+	};
+} // namespace rve
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+
+#include <unordered_map>
+
+namespace rve {
+	// Sampler state a texture is read with. Samplers never clamp the LOD, so one sampler serves
+	// textures of any mip count.
+	struct RveSamplerInfo {
+		VkFilter filter = VK_FILTER_LINEAR;
+		VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		// Clamped to the device limit, 1 disables anisotropic filtering
+		float maxAnisotropy = 16.0f;
+
+		bool operator==(const RveSamplerInfo &) const = default;
+	};
+
+	// Creates each distinct sampler once and hands the same VkSampler to every texture asking for it,
+	// samplers live until the cache is destroyed
+	class RveSamplerCache {
+	public:
+		struct Stats {
+			uint32_t samplers = 0;
+			uint32_t requests = 0;
+		};
+
+		RveSamplerCache(RveVulkanDevice& device) : rveVulkanDevice{device} {}
+		~RveSamplerCache();
+		RveSamplerCache(const RveSamplerCache &) = delete;
+		RveSamplerCache &operator=(const RveSamplerCache &) = delete;
+
+		VkSampler GetSampler(const RveSamplerInfo& info = RveSamplerInfo{});
+		Stats GetStats() const { return {static_cast<uint32_t>(samplers.size()), requests}; }
+
+	private:
+		struct InfoHash {
+			size_t operator()(const RveSamplerInfo& info) const;
+		};
+
+		RveVulkanDevice& rveVulkanDevice;
+		std::unordered_map<RveSamplerInfo, VkSampler, InfoHash> samplers;
+		uint32_t requests = 0;
+	};
+} // namespace rve
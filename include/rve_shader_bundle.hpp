@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace rve {
+	// SPIR-V modules linked into the binary by shaders/pack_shaders.cmake, optimized by spirv-opt
+	// when it is available. Lookups return spans into the embedded words, nothing is read or copied.
+	class RveShaderBundle {
+	public:
+		struct Entry {
+			const char *path;
+			uint32_t offset;
+			uint32_t wordCount;
+		};
+
+		// Empty when the path is not bundled or has been handed over to the file with PreferFile
+		static std::span<const uint32_t> Find(const std::string& filePath);
+		// Hot reloaded shaders are read from disk from then on
+		static void PreferFile(const std::string& filePath);
+
+	private:
+		// Defined in the generated bundle source
+		static const uint32_t *words;
+		static const Entry *entries;
+		static const uint32_t entryCount;
+	};
+} // namespace rve
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace rve {
+	// Watches the GLSL sources with inotify and recompiles changed shaders on its own thread.
+	// The SPIR-V is written next to the runtime shaders so pipelines can be rebuilt from it.
+	// Uses shaderc in process when built with RVE_WITH_SHADERC, otherwise runs glslc.
+	class RveShaderWatcher {
+	public:
+		RveShaderWatcher(const std::string& sourceDirectory, const std::string& outputDirectory);
+		~RveShaderWatcher();
+		RveShaderWatcher(const RveShaderWatcher &) = delete;
+		RveShaderWatcher &operator=(const RveShaderWatcher &) = delete;
+
+		// SPIR-V paths, relative like the paths given to the pipelines, compiled since the last call
+		std::vector<std::string> TakeCompiledShaders();
+		bool IsWatching() const { return watchDescriptor >= 0; }
+
+		static constexpr int pollTimeoutMs = 100;
+
+	private:
+		void WatchLoop();
+		void CompileShader(const std::string& fileName);
+		// Writes to a temporary file and renames it, so readers never see a partial module
+		static bool WriteSpirv(const std::string& filePath, const std::vector<uint32_t>& spirv);
+
+		std::string sourceDirectory;
+		std::string outputDirectory;
+		int inotifyDescriptor = -1;
+		int watchDescriptor = -1;
+		std::atomic<bool> stopping{false};
+		std::thread watchThread;
+		std::mutex compiledMutex;
+		std::vector<std::string> compiledShaders;
+	};
+} // namespace rve
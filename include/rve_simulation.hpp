@@ -0,0 +1,95 @@
+#pragma once
+
+#include "rve_components.hpp"
+#include "rve_ecs.hpp"
+#include "rve_transform_hierarchy.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rve {
+	// Steps animated bodies at a fixed rate on its own thread and publishes every tick through a triple
+	// buffer, so neither side ever waits for the other. Each snapshot holds the previous and current tick,
+	// and the render thread blends between them, trailing the simulation by at most one tick.
+	class RveSimulation {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		RveSimulation();
+		~RveSimulation();
+		RveSimulation(const RveSimulation &) = delete;
+		RveSimulation &operator=(const RveSimulation &) = delete;
+
+		// The simulation owns the body's transform from the next tick on, writing it to the entity's
+		// TransformComponent, or to the hierarchy node's local transform when one is given
+		void AddBody(RveEntity entity, const TransformComponent& transform, glm::vec3 angularVelocity);
+		void AddBody(RveTransformHierarchy::Node node, const TransformComponent& transform, glm::vec3 angularVelocity);
+		void RemoveBody(RveEntity entity);
+
+		// Render thread only, writes the interpolated transforms of the latest snapshot
+		void Interpolate(RveWorld& world, RveTransformHierarchy& hierarchy);
+
+		uint64_t GetTickCount() const { return tickCount.load(std::memory_order_relaxed); }
+
+		static constexpr float fixedTimestep = 1.0f / 60.0f;
+		// After a stall, ticks further behind than this are dropped instead of run back to back
+		static constexpr uint32_t maxCatchUpTicks = 5;
+
+	private:
+		struct Target {
+			RveEntity entity{};
+			RveTransformHierarchy::Node node = RveTransformHierarchy::noNode;
+		};
+
+		struct Body {
+			Target target;
+			TransformComponent transform;
+			glm::vec3 angularVelocity;
+		};
+
+		struct Snapshot {
+			std::vector<Target> targets;
+			std::vector<TransformComponent> previous;
+			std::vector<TransformComponent> current;
+			Clock::time_point publishTime{};
+			uint64_t tick = 0;
+		};
+
+		void SimulationLoop();
+		void ApplyPendingChanges();
+		void Step();
+		void Publish();
+		const Snapshot& AcquireSnapshot();
+
+		// Simulation thread state
+		std::vector<Target> targets;
+		std::vector<TransformComponent> previous;
+		std::vector<TransformComponent> current;
+		std::vector<glm::vec3> angularVelocities;
+
+		std::mutex pendingMutex;
+		std::vector<Body> pendingBodies;
+		std::vector<RveEntity> pendingRemovals;
+
+		std::array<Snapshot, 3> snapshots;
+		// Index of the buffer between the threads, with freshBit set while it holds an unread snapshot
+		std::atomic<uint32_t> middle{1};
+		uint32_t back = 0;
+		uint32_t front = 2;
+		static constexpr uint32_t indexMask = 3;
+		static constexpr uint32_t freshBit = 4;
+
+		std::atomic<uint64_t> tickCount{0};
+		std::atomic<bool> stopping{false};
+		std::thread simulationThread;
+	};
+} // namespace rve
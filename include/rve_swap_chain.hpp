@@ -26,6 +26,7 @@ namespace rve {
 		VkExtent2D swapChainExtent;
 		std::vector<VkFramebuffer> swapChainFramebuffers;
 		VkRenderPass renderPass;
+		VkRenderPass loadRenderPass;
 		std::vector<VkImage> depthImages;
 		std::vector<VkDeviceMemory> depthImageMemorys;
 		std::vector<VkImageView> depthImageViews;
@@ -49,7 +50,10 @@ namespace rve {
 		RveSwapChain &operator=(const RveSwapChain &) = delete;
 
 		VkFramebuffer GetFrameBuffer(int index) { return swapChainFramebuffers[index]; }
+		// Clears and leaves depth readable by compute, loadRenderPass then continues the frame and presents
 		VkRenderPass GetRenderPass() { return renderPass; }
+		VkRenderPass GetLoadRenderPass() { return loadRenderPass; }
+		VkImageView GetDepthImageView(int index) { return depthImageViews[index]; }
 		VkImageView GetImageView(int index) { return swapChainImageViews[index]; }
 		size_t ImageCount() { return swapChainImages.size(); }
 		VkFormat GetSwapChainImageFormat() { return swapChainImageFormat; }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "rve_vulkan_device.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rve {
+	// Sampled 2D texture in device local memory. Block compressed images are uploaded as is when the
+	// device can sample their format and decompressed to RGBA8 on the CPU when it cannot. Images that
+	// come with a single level get their mip chain generated on the GPU with linear blits.
+	class RveTexture {
+	public:
+		// Byte range of one mip level in ImageData::bytes
+		struct Level {
+			size_t offset = 0;
+			size_t size = 0;
+		};
+
+		// CPU side image, level 0 is the full size one
+		struct ImageData {
+			VkFormat format = VK_FORMAT_UNDEFINED;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			std::vector<Level> levels{};
+			std::vector<uint8_t> bytes{};
+		};
+
+		struct UploadReport {
+			// Format of the image given, differs from the texture's when it was decompressed
+			VkFormat sourceFormat = VK_FORMAT_UNDEFINED;
+			VkDeviceSize memoryBytes = 0;
+			VkDeviceSize uploadBytes = 0;
+			// From receiving the image until the copy and mip generation completed on the GPU
+			float uploadMilliseconds = 0.0f;
+			bool decompressed = false;
+			bool generatedMips = false;
+		};
+
+		RveTexture(RveVulkanDevice& device, const ImageData& image, bool generateMips = true);
+		~RveTexture();
+		RveTexture(const RveTexture &) = delete;
+		RveTexture &operator=(const RveTexture &) = delete;
+
+		VkDescriptorImageInfo DescriptorInfo(VkSampler sampler) const;
+
+		VkImage GetImage() const { return image; }
+		VkImageView GetImageView() const { return imageView; }
+		VkFormat GetFormat() const { return format; }
+		uint32_t GetWidth() const { return width; }
+		uint32_t GetHeight() const { return height; }
+		uint32_t GetMipLevels() const { return mipLevels; }
+		const UploadReport& GetUploadReport() const { return uploadReport; }
+
+		// Reads a 2D KTX2 file. Supercompressed files (Basis Universal, zstd, zlib) are not supported.
+		// Throws if the file cannot be read or uses a format textures cannot be made from.
+		static ImageData LoadKtx2(const std::string& filePath);
+		// Tightly packed RGBA8 pixels as a single level
+		static ImageData FromPixels(uint32_t width, uint32_t height, const uint8_t *pixels, bool srgb = true);
+		// RGBA8 copy of every level of a block compressed image, keeping its sRGB encoding
+		static ImageData Decompress(const ImageData& image);
+		static bool IsBlockCompressed(VkFormat format);
+		// Bytes one level of the format takes, 0 for formats textures cannot be made from
+		static size_t GetLevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+		static constexpr const char *extension = ".ktx2";
+		// Level offsets in ImageData::bytes are kept aligned for buffer to image copies
+		static constexpr size_t levelAlignment = 16;
+
+	private:
+		bool HasFormatFeatures(VkFormat candidate, VkFormatFeatureFlags features) const;
+		void RecordMipGeneration(VkCommandBuffer commandBuffer);
+
+		RveVulkanDevice& rveVulkanDevice;
+		VkImage image = VK_NULL_HANDLE;
+		VkDeviceMemory imageMemory = VK_NULL_HANDLE;
+		VkImageView imageView = VK_NULL_HANDLE;
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 1;
+		UploadReport uploadReport{};
+	};
+} // namespace rve
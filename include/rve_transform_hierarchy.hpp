@@ -0,0 +1,79 @@
+#pragma once
+
+#include "rve_components.hpp"
+#include "rve_job_system.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace rve {
+	// Parent child transforms stored breadth first in flat arrays, so every parent precedes its children
+	// and each depth level is one contiguous range. Update only recomputes world matrices below nodes whose
+	// local transform changed, and splits large levels across threads since nodes in a level are independent.
+	class RveTransformHierarchy {
+	public:
+		using Node = uint32_t;
+
+		struct Stats {
+			uint32_t nodes = 0;
+			uint32_t levels = 0;
+			uint32_t nodesUpdated = 0;
+			uint32_t parallelLevels = 0;
+		};
+
+		explicit RveTransformHierarchy(RveJobSystem& jobSystem) : jobSystem{jobSystem} {}
+		RveTransformHierarchy(const RveTransformHierarchy &) = delete;
+		RveTransformHierarchy &operator=(const RveTransformHierarchy &) = delete;
+
+		Node AddNode(const TransformComponent& local, Node parent = noNode);
+		// Removes the node together with its whole subtree
+		void RemoveNode(Node node);
+		void SetParent(Node node, Node parent);
+		void SetLocal(Node node, const TransformComponent& local);
+		const TransformComponent& GetLocal(Node node) const { return locals[positions[node]]; }
+		// Valid after the Update following the last change
+		const glm::mat4& GetWorldMatrix(Node node) const { return worldMatrices[positions[node]]; }
+		bool IsValid(Node node) const { return node < positions.size() && positions[node] != noNode; }
+
+		void Update();
+		const Stats& GetStats() const { return stats; }
+
+		static constexpr Node noNode = ~0u;
+		// Levels smaller than this are updated on the calling thread, larger ones are split over the job system
+		static constexpr uint32_t parallelLevelSize = 4096;
+
+	private:
+		// Rebuilds the breadth first order after nodes were added, removed or reparented
+		void RebuildOrder();
+		uint32_t UpdateRange(uint32_t first, uint32_t last);
+		void Unlink(Node node);
+		void Link(Node node, Node parent);
+
+		RveJobSystem& jobSystem;
+
+		// Indexed by breadth first position
+		std::vector<uint32_t> parentPositions;
+		std::vector<TransformComponent> locals;
+		std::vector<glm::mat4> worldMatrices;
+		std::vector<uint8_t> dirty;
+		std::vector<uint8_t> updated;
+		// First position of every level, plus one past the last node
+		std::vector<uint32_t> levelStarts;
+
+		// Indexed by node, positions[node] is noNode for free nodes
+		std::vector<uint32_t> positions;
+		std::vector<Node> parents;
+		std::vector<Node> firstChildren;
+		std::vector<Node> nextSiblings;
+		std::vector<Node> freeNodes;
+		Node firstRoot = noNode;
+
+		bool orderDirty = false;
+		bool anyDirty = false;
+		Stats stats{};
+	};
+} // namespace rve
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "rve_components.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace rve {
+	// Structure of arrays copy of TransformComponent with a batched world matrix kernel.
+	// Only transforms changed since the last Update are rebuilt, eight at a time with AVX2,
+	// four with NEON, or one at a time otherwise. Results match TransformComponent::mat4().
+	class RveTransformStore {
+	public:
+		RveTransformStore() = default;
+		RveTransformStore(const RveTransformStore &) = delete;
+		RveTransformStore &operator=(const RveTransformStore &) = delete;
+
+		// New transforms are identity and dirty
+		void Resize(uint32_t count);
+		// Marks the transform dirty only when a value differs from the stored one
+		void Set(uint32_t index, const TransformComponent& transform);
+		TransformComponent Get(uint32_t index) const;
+		void Update();
+
+		const glm::mat4& GetWorldMatrix(uint32_t index) const { return worldMatrices[index]; }
+		uint32_t GetCount() const { return count; }
+		// Transforms rebuilt by the last Update, including clean ones sharing a batch with a dirty one
+		uint32_t GetLastUpdateCount() const { return lastUpdateCount; }
+
+		// Storage is padded to this many entries so every batch can be loaded whole
+		static constexpr uint32_t batchPadding = 8;
+
+	private:
+		enum Component {
+			TranslationX, TranslationY, TranslationZ,
+			RotationX, RotationY, RotationZ,
+			ScaleX, ScaleY, ScaleZ,
+			ComponentCount
+		};
+
+		std::vector<float> components[ComponentCount];
+		std::vector<uint8_t> dirty;
+		std::vector<glm::mat4> worldMatrices;
+		uint32_t count = 0;
+		uint32_t lastUpdateCount = 0;
+	};
+} // namespace rve
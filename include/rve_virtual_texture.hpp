@@ -0,0 +1,76 @@
+#pragma once
+
+#include "rve_mapped_file.hpp"
+#include "rve_texture.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rve {
+	// Cooked virtual texture: every mip level cut into pages of pageSize texels, each stored as a tile with
+	// pageBorder texels of its neighbours around it so the page atlas can be filtered bilinearly. Tiles are
+	// RGBA8 and laid out by mip, then row, then column after a fixed header, so any tile is found without
+	// an index. The file is mapped and tiles are read straight from it by RvePageCache.
+	class RveVirtualTexture {
+	public:
+		// Opens a cooked file and checks its header, throws if it cannot be used as is
+		explicit RveVirtualTexture(const std::string& filePath);
+		RveVirtualTexture(const RveVirtualTexture &) = delete;
+		RveVirtualTexture &operator=(const RveVirtualTexture &) = delete;
+
+		VkFormat GetFormat() const { return static_cast<VkFormat>(header.format); }
+		uint32_t GetWidth() const { return header.width; }
+		uint32_t GetHeight() const { return header.height; }
+		// The coarsest mip is a single page
+		uint32_t GetMipCount() const { return header.mipCount; }
+		uint32_t GetPageCount() const { return mipFirstPage.back(); }
+		uint32_t GetPagesWide(uint32_t mip) const { return GetPageCount(header.width, mip); }
+		uint32_t GetPagesHigh(uint32_t mip) const { return GetPageCount(header.height, mip); }
+		// Pages numbered across all mips, the order tiles are stored in
+		uint32_t GetPageIndex(uint32_t mip, uint32_t x, uint32_t y) const { return mipFirstPage[mip] + y * GetPagesWide(mip) + x; }
+		// tileSize * tileSize RGBA8 texels, reading it may fault the tile in from disk
+		const uint8_t *GetTile(uint32_t page) const;
+		uint64_t GetFileSize() const { return header.fileSize; }
+
+		// Cuts an image into tiles, generating its mip chain on the CPU from level 0. The image must be RGBA8 or
+		// block compressed with a decoder, its sides powers of two and at least one of them pageSize or more.
+		// Every level is held in memory while cooking, so this is a tool step rather than a load step.
+		static void Write(const std::string& filePath, const RveTexture::ImageData& image);
+
+		static constexpr uint32_t magic = 0x54565652;
+		static constexpr uint32_t version = 1;
+		static constexpr uint32_t pageSize = 128;
+		static constexpr uint32_t pageBorder = 4;
+		static constexpr uint32_t tileSize = pageSize + 2 * pageBorder;
+		static constexpr size_t tileBytes = static_cast<size_t>(tileSize) * tileSize * 4;
+		// Limits of the page request encoding in the feedback buffer
+		static constexpr uint32_t maxMipCount = 16;
+		static constexpr uint32_t maxPagesPerSide = 2048;
+		static constexpr const char *extension = ".rvevt";
+
+	private:
+		struct Header {
+			uint32_t magic = 0;
+			uint32_t version = 0;
+			uint32_t format = 0;
+			uint32_t width = 0;
+			uint32_t height = 0;
+			uint32_t mipCount = 0;
+			// Guard against files cooked with other page dimensions
+			uint32_t pageSize = 0;
+			uint32_t pageBorder = 0;
+			uint64_t fileSize = 0;
+			uint32_t reserved[6]{};
+		};
+		static_assert(sizeof(Header) == 64, "RveVirtualTexture header must stay 64 bytes");
+
+		static uint32_t GetPageCount(uint32_t size, uint32_t mip) { return std::max((size >> mip) / pageSize, 1u); }
+
+		RveMappedFile file;
+		Header header{};
+		// Running page count at the start of each mip, with the total at the end
+		std::vector<uint32_t> mipFirstPage;
+	};
+} // namespace rve
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "rve_window.hpp"
+#include "rve_deletion_queue.hpp"
 
 namespace rve {
 	struct SwapChainSupportDetails {
@@ -38,6 +40,7 @@ namespace rve {
 		void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
 		void HasGflwRequiredInstanceExtensions();
 		bool CheckDeviceExtensionSupport(VkPhysicalDevice physicalDevice);
+		bool IsDeviceExtensionAvailable(VkPhysicalDevice physicalDevice, const char *extensionName);
 		SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice physicalDevice);
 
 		VkInstance instance;
@@ -50,6 +53,9 @@ namespace rve {
 		VkSurfaceKHR surface_;
 		VkQueue graphicsQueue_;
 		VkQueue presentQueue_;
+		VkPhysicalDeviceFeatures enabledFeatures{};
+		bool bindlessSupported = false;
+		std::unique_ptr<RveDeletionQueue> deletionQueue;
 
 		const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
 		const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -70,9 +76,16 @@ namespace rve {
 
 		VkCommandPool GetCommandPool() { return commandPool; }
 		VkDevice Device() { return device_; }
+		VkPhysicalDevice PhysicalDevice() { return physicalDevice; }
 		VkSurfaceKHR Surface() { return surface_; }
 		VkQueue GraphicsQueue() { return graphicsQueue_; }
 		VkQueue PresentQueue() { return presentQueue_; }
+		const VkPhysicalDeviceFeatures &EnabledFeatures() const { return enabledFeatures; }
+		// True when descriptor indexing with update after bind and partially bound arrays is enabled, along with
+		// fragment shader stores for virtual texture feedback
+		bool IsBindlessSupported() const { return bindlessSupported; }
+		// Objects a frame in flight may still use are released through here instead of destroyed directly
+		RveDeletionQueue& GetDeletionQueue() { return *deletionQueue; }
 
 		SwapChainSupportDetails GetSwapChainSupport() { return QuerySwapChainSupport(physicalDevice); }
 		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -88,7 +101,12 @@ namespace rve {
 			VkDeviceMemory &bufferMemory);
 		VkCommandBuffer BeginSingleTimeCommands();
 		void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
-		void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+		void CopyBuffer(
+			VkBuffer srcBuffer,
+			VkBuffer dstBuffer,
+			VkDeviceSize size,
+			VkDeviceSize srcOffset = 0,
+			VkDeviceSize dstOffset = 0);
 		void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
 		void CreateImageWithInfo(
@@ -0,0 +1,112 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+const uint NO_TEXTURE = 0xFFFFFFFF;
+
+// Depth is tested before the shader runs, so hidden surfaces do not request virtual texture pages
+layout (early_fragment_tests) in;
+
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec2 fragUv;
+layout (location = 2) flat in uint fragTexture;
+layout (location = 3) flat in uint fragVirtualTexture;
+layout (location = 0) out vec4 outputColor;
+
+// Texture array of the bindless set, the material selects the slot
+layout (set = 0, binding = 1) uniform sampler2D textures[];
+
+struct VirtualTexture {
+	uint pageTable;
+	uint width;
+	uint height;
+	uint mipCount;
+};
+
+// Atlas of the page cache followed by every registered virtual texture, see RvePageCacheInfo
+layout (set = 0, binding = 0) readonly buffer VirtualTextureBuffer {
+	uint atlas;
+	uint atlasPages;
+	uint pageSize;
+	uint pageBorder;
+	VirtualTexture virtualTextures[];
+} virtualTextureBuffers[];
+
+// One page request per cell of scale x scale pixels, read back by RvePageCache once the frame retires
+layout (set = 0, binding = 0) buffer FeedbackBuffer {
+	uint width;
+	uint height;
+	uint scale;
+	uint jitter;
+	uint requests[];
+} feedbackBuffers[];
+
+layout(push_constant) uniform Push {
+	uint frameBuffer;
+	uint materialBuffer;
+	uint objectIndex;
+	uint virtualTextureBuffer;
+	uint feedbackBuffer;
+} push;
+
+// Only the pixel of each cell the jitter selects writes, RvePageCache::ReadFeedback decodes the request
+void WriteFeedback(uint virtualTexture, uint mip, uvec2 page) {
+	uint scale = feedbackBuffers[push.feedbackBuffer].scale;
+	uint jitter = feedbackBuffers[push.feedbackBuffer].jitter;
+	uvec2 pixel = uvec2(gl_FragCoord.xy);
+	if (pixel.x % scale != jitter % scale || pixel.y % scale != jitter / scale) {
+		return;
+	}
+	uvec2 cell = pixel / scale;
+	uint width = feedbackBuffers[push.feedbackBuffer].width;
+	if (cell.x >= width || cell.y >= feedbackBuffers[push.feedbackBuffer].height) {
+		return;
+	}
+	feedbackBuffers[push.feedbackBuffer].requests[cell.y * width + cell.x] = virtualTexture << 26 | mip << 22 | page.y << 11 | page.x;
+}
+
+uvec2 PageOf(vec2 texel, uvec2 levelSize, uint pageSize) {
+	return min(uvec2(texel) / pageSize, max(levelSize / pageSize, uvec2(1)) - 1);
+}
+
+// Software indirection: the page table texel of the wanted page names the atlas page and the mip it holds,
+// which is a coarser one while the wanted page is not resident
+vec4 SampleVirtualTexture(uint index, vec2 uv) {
+	VirtualTexture virtualTexture = virtualTextureBuffers[push.virtualTextureBuffer].virtualTextures[index];
+	uint pageSize = virtualTextureBuffers[push.virtualTextureBuffer].pageSize;
+	uint pageBorder = virtualTextureBuffers[push.virtualTextureBuffer].pageBorder;
+	uvec2 size = uvec2(virtualTexture.width, virtualTexture.height);
+	uv = clamp(uv, 0.0, 1.0);
+
+	// Same level selection as the hardware without anisotropy, taken before any divergence
+	vec2 texel = uv * vec2(size);
+	vec2 dx = dFdx(texel);
+	vec2 dy = dFdy(texel);
+	float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8));
+	uint mip = uint(clamp(floor(lod), 0.0, float(virtualTexture.mipCount - 1)));
+
+	uvec2 levelSize = max(size >> mip, uvec2(1));
+	uvec2 page = PageOf(uv * vec2(levelSize), levelSize, pageSize);
+	WriteFeedback(index, mip, page);
+
+	uvec4 entry = uvec4(texelFetch(textures[nonuniformEXT(virtualTexture.pageTable)], ivec2(page), int(mip)) * 255.0 + 0.5);
+	uvec2 residentSize = max(size >> entry.b, uvec2(1));
+	vec2 residentTexel = uv * vec2(residentSize);
+	vec2 inPage = residentTexel - vec2(PageOf(residentTexel, residentSize, pageSize) * pageSize);
+
+	float tileSize = float(pageSize + 2 * pageBorder);
+	float atlasSize = float(virtualTextureBuffers[push.virtualTextureBuffer].atlasPages) * tileSize;
+	vec2 atlasTexel = vec2(entry.rg) * tileSize + float(pageBorder) + inPage;
+	uint atlas = virtualTextureBuffers[push.virtualTextureBuffer].atlas;
+	return textureLod(textures[nonuniformEXT(atlas)], atlasTexel / atlasSize, 0.0);
+}
+
+void main() {
+	vec4 color = vec4(fragColor, 1.0);
+	if (fragTexture != NO_TEXTURE) {
+		color *= texture(textures[nonuniformEXT(fragTexture)], fragUv);
+	}
+	if (fragVirtualTexture != NO_TEXTURE) {
+		color *= SampleVirtualTexture(fragVirtualTexture, fragUv);
+	}
+	outputColor = color;
+}
@@ -0,0 +1,87 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Specialization constants, see RveVertexFormat, RveLightingModel and RveDebugView
+layout (constant_id = 0) const uint vertexFormat = 0;
+layout (constant_id = 1) const uint lightingModel = 0;
+layout (constant_id = 2) const uint debugView = 0;
+
+const uint VERTEX_FORMAT_COMPACT = 1;
+const uint LIGHTING_UNLIT = 1;
+const uint DEBUG_VIEW_NORMALS = 1;
+const uint NO_TEXTURE = 0xFFFFFFFF;
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 color;
+// Compact vertices store an octahedral encoded normal, z reads as 0
+layout (location = 2) in vec3 normal;
+layout (location = 3) in vec2 uv;
+
+layout (location = 0) out vec3 fragColor;	
+layout (location = 1) out vec2 fragUv;
+layout (location = 2) flat out uint fragTexture;
+layout (location = 3) flat out uint fragVirtualTexture;
+
+struct ObjectData {
+	mat4 modelMatrix;
+	mat4 normalMatrix;
+	uint materialIndex;
+};
+
+struct Material {
+	vec4 baseColor;
+	uint textureIndex;
+	uint virtualTextureIndex;
+};
+
+// Both blocks alias the bindless storage buffer array, push selects the slot of each
+layout (set = 0, binding = 0) readonly buffer FrameBuffer {
+	mat4 projectionView;
+	vec4 ambientLightColor;
+	vec4 lightDirection;
+	ObjectData objects[];
+} frameBuffers[];
+
+layout (set = 0, binding = 0) readonly buffer MaterialBuffer {
+	Material materials[];
+} materialBuffers[];
+
+layout(push_constant) uniform Push {
+	uint frameBuffer;
+	uint materialBuffer;
+	uint objectIndex;
+	uint virtualTextureBuffer;
+	uint feedbackBuffer;
+} push;
+
+// Inverse of EncodeOctahedral in rve_model.cpp
+vec3 DecodeOctahedral(vec2 encoded) {
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+void main() {
+	ObjectData object = frameBuffers[push.frameBuffer].objects[push.objectIndex];
+	Material material = materialBuffers[push.materialBuffer].materials[object.materialIndex];
+	// Compact positions are unorm16 in mesh bounds space, object.modelMatrix carries the dequantize scale and offset
+	gl_Position = frameBuffers[push.frameBuffer].projectionView * object.modelMatrix * vec4(position, 1.0);
+
+	vec3 objectNormal = vertexFormat == VERTEX_FORMAT_COMPACT ? DecodeOctahedral(normal.xy) : normal;
+	vec3 normalWorldSpace = normalize(mat3(object.normalMatrix) * objectNormal);
+	vec3 baseColor = color * material.baseColor.rgb;
+	fragUv = uv;
+	fragTexture = debugView == DEBUG_VIEW_NORMALS ? NO_TEXTURE : material.textureIndex;
+	fragVirtualTexture = debugView == DEBUG_VIEW_NORMALS ? NO_TEXTURE : material.virtualTextureIndex;
+	if (debugView == DEBUG_VIEW_NORMALS) {
+		fragColor = normalWorldSpace * 0.5 + 0.5;
+	} else if (lightingModel == LIGHTING_UNLIT) {
+		fragColor = baseColor;
+	} else {
+		vec4 ambientLightColor = frameBuffers[push.frameBuffer].ambientLightColor;
+		float lightIntensity = max(dot(normalWorldSpace, -frameBuffers[push.frameBuffer].lightDirection.xyz), 0.0);
+		fragColor = (ambientLightColor.xyz * ambientLightColor.w + lightIntensity) * baseColor;
+	}
+}
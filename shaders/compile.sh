@@ -1,7 +1,13 @@
 #!/bin/sh
+# Stops at the first shader that fails to compile or validate, so the build fails with it
+set -e
 
-# loop through vert and frag file
-for i in *.{vert,frag}; do
+# loop through vert, frag and comp files, the braces of bash are not expanded by every sh
+for i in *.vert *.frag *.comp; do
   echo "Processing: " "$i" "${i}.spv";
-  glslc "$i" -o "${i}.spv";
-done
\ No newline at end of file
+  glslc --target-env=vulkan1.1 "$i" -o "${i}.spv";
+  # Catches invalid SPIR-V, such as a descriptor array indexed without a capability the device enables
+  if command -v spirv-val > /dev/null; then
+    spirv-val --target-env vulkan1.1 "${i}.spv";
+  fi
+done
@@ -0,0 +1,66 @@
+# Packs every compiled .spv in SHADER_DIR into one generated C++ source holding an indexed word array.
+# Usage: cmake -DSHADER_DIR=<dir> -DOUTPUT=<file.cpp> -DWORK_DIR=<dir> [-DSPIRV_OPT=<spirv-opt>] [-DSTRIP_DEBUG=ON] -P pack_shaders.cmake
+
+file(GLOB spirv_files "${SHADER_DIR}/*.spv")
+list(SORT spirv_files)
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+set(words "")
+set(entries "")
+set(offset 0)
+set(count 0)
+foreach(spirv_file ${spirv_files})
+	get_filename_component(name "${spirv_file}" NAME)
+	set(packed_file "${spirv_file}")
+
+	if(SPIRV_OPT)
+		set(optimized_file "${WORK_DIR}/${name}")
+		set(opt_args -O)
+		if(STRIP_DEBUG)
+			list(APPEND opt_args --strip-debug)
+		endif()
+		execute_process(
+			COMMAND "${SPIRV_OPT}" ${opt_args} "${spirv_file}" -o "${optimized_file}"
+			RESULT_VARIABLE opt_result)
+		if(opt_result EQUAL 0)
+			set(packed_file "${optimized_file}")
+		else()
+			message(WARNING "spirv-opt failed for ${name}, packing the unoptimized module")
+		endif()
+	endif()
+
+	file(READ "${packed_file}" hex HEX)
+	string(LENGTH "${hex}" hex_length)
+	math(EXPR word_count "${hex_length} / 8")
+	# SPIR-V is little endian, so each group of four bytes is reversed into one word literal
+	string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1u," module_words "${hex}")
+	string(APPEND words "\t\t// ${name}\n\t\t${module_words}\n")
+	string(APPEND entries "\t\t{\"shaders/${name}\", ${offset}, ${word_count}},\n")
+	math(EXPR offset "${offset} + ${word_count}")
+	math(EXPR count "${count} + 1")
+endforeach()
+
+if(count EQUAL 0)
+	set(words "\t\t0u\n")
+endif()
+
+file(WRITE "${OUTPUT}.tmp"
+"// Generated by shaders/pack_shaders.cmake, do not edit
+#include \"rve_shader_bundle.hpp\"
+
+namespace rve {
+	static const uint32_t bundleWords[] = {
+${words}	};
+
+	static const RveShaderBundle::Entry bundleEntries[] = {
+${entries}		{nullptr, 0, 0}
+	};
+
+	const uint32_t *RveShaderBundle::words = bundleWords;
+	const RveShaderBundle::Entry *RveShaderBundle::entries = bundleEntries;
+	const uint32_t RveShaderBundle::entryCount = ${count};
+} // namespace rve
+")
+# Only touch the output when it changed, so an unchanged bundle does not trigger a recompile
+configure_file("${OUTPUT}.tmp" "${OUTPUT}" COPYONLY)
+file(REMOVE "${OUTPUT}.tmp")
@@ -1,16 +1,53 @@
 #version 460
 
+// Specialization constants, see RveVertexFormat, RveLightingModel and RveDebugView
+layout (constant_id = 0) const uint vertexFormat = 0;
+layout (constant_id = 1) const uint lightingModel = 0;
+layout (constant_id = 2) const uint debugView = 0;
+
+const uint VERTEX_FORMAT_COMPACT = 1;
+const uint LIGHTING_UNLIT = 1;
+const uint DEBUG_VIEW_NORMALS = 1;
+
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 color;
+// Compact vertices store an octahedral encoded normal, z reads as 0
+layout (location = 2) in vec3 normal;
 
 layout (location = 0) out vec3 fragColor;	
 
+layout (set = 0, binding = 0) uniform GlobalUbo {
+	mat4 projectionView;
+	vec4 ambientLightColor;
+	vec4 lightDirection;
+} ubo;
+
 layout(push_constant) uniform Push {
-	mat4 transform;
-	vec3 color;
+	mat4 modelMatrix;
+	mat4 normalMatrix;
 } push;
 
+// Inverse of EncodeOctahedral in rve_model.cpp
+vec3 DecodeOctahedral(vec2 encoded) {
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
 void main() {
-	gl_Position = push.transform * vec4(position, 1.0);
-	fragColor = color;
+	// Compact positions are unorm16 in mesh bounds space, push.modelMatrix carries the dequantize scale and offset
+	gl_Position = ubo.projectionView * push.modelMatrix * vec4(position, 1.0);
+
+	vec3 objectNormal = vertexFormat == VERTEX_FORMAT_COMPACT ? DecodeOctahedral(normal.xy) : normal;
+	vec3 normalWorldSpace = normalize(mat3(push.normalMatrix) * objectNormal);
+	if (debugView == DEBUG_VIEW_NORMALS) {
+		fragColor = normalWorldSpace * 0.5 + 0.5;
+	} else if (lightingModel == LIGHTING_UNLIT) {
+		fragColor = color;
+	} else {
+		float lightIntensity = max(dot(normalWorldSpace, -ubo.lightDirection.xyz), 0.0);
+		fragColor = (ubo.ambientLightColor.xyz * ubo.ambientLightColor.w + lightIntensity) * color;
+	}
 }
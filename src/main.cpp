@@ -1,11 +1,114 @@
+#include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #include "../include/rve_engine.hpp"
+#include "../include/rve_benchmarks.hpp"
+#include "../include/rve_mesh_cache.hpp"
+#include "../include/rve_mesh_loader.hpp"
+#include "../include/rve_virtual_texture.hpp"
 
-int main() {
-	rve::RveEngine engine{};
+namespace {
+	float SecondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// --cook <source> [output]: imports a mesh file and writes it as a mesh cache
+	int CookMesh(const std::string& sourcePath, std::string outputPath) {
+		if(outputPath.empty()) {
+			outputPath = std::filesystem::path{sourcePath}.replace_extension(rve::RveMeshCache::extension).string();
+		}
+		rve::RveJobSystem jobSystem{};
+		rve::RveMeshLoader meshLoader{jobSystem};
+		auto builders = meshLoader.Load({sourcePath});
+		rve::RveMeshCache::Write(outputPath, builders, rve::RveMeshCache::SourceStamp(sourcePath));
+		auto& stats = meshLoader.GetStats();
+		std::cout << "Cooked " << stats.meshes << " meshes, " << stats.triangles << " triangles into " << outputPath << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	// --cook <source.ktx2> [output]: cuts a large image into the pages of a virtual texture
+	int CookVirtualTexture(const std::string& sourcePath, std::string outputPath) {
+		if(outputPath.empty()) {
+			outputPath = std::filesystem::path{sourcePath}.replace_extension(rve::RveVirtualTexture::extension).string();
+		}
+		auto start = std::chrono::steady_clock::now();
+		rve::RveVirtualTexture::Write(outputPath, rve::RveTexture::LoadKtx2(sourcePath));
+		rve::RveVirtualTexture texture{outputPath};
+		std::cout << "Cooked " << texture.GetWidth() << "x" << texture.GetHeight() << " into " << texture.GetPageCount()
+			<< " pages over " << texture.GetMipCount() << " mips, " << outputPath << " in " << SecondsSince(start) << " s" << std::endl;
+		return EXIT_SUCCESS;
+	}
+
+	// --validate <cache> [source]: checks a mesh cache and, given its source, compares it against a fresh import
+	int ValidateMeshCache(const std::string& cachePath, const std::string& sourcePath) {
+		auto start = std::chrono::steady_clock::now();
+		rve::RveMeshCache cache{cachePath};
+		float openSeconds = SecondsSince(start);
+		start = std::chrono::steady_clock::now();
+		bool contentValid = cache.VerifyContent();
+		float verifySeconds = SecondsSince(start);
+		std::cout << cachePath << ": " << cache.GetMeshCount() << " meshes, " << cache.GetFileSize() << " bytes, content "
+			<< (contentValid ? "valid" : "CORRUPT") << " (open " << openSeconds * 1000.0f << " ms, verify " << verifySeconds * 1000.0f << " ms)" << std::endl;
+		if(!contentValid || sourcePath.empty()) {
+			return contentValid ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		if(cache.GetSourceStamp() != rve::RveMeshCache::SourceStamp(sourcePath)) {
+			std::cout << "Source changed since cooking: " << sourcePath << std::endl;
+		}
+		rve::RveJobSystem jobSystem{};
+		rve::RveMeshLoader meshLoader{jobSystem};
+		auto builders = meshLoader.Load({sourcePath});
+		bool matches = builders.size() == cache.GetMeshCount();
+		for(uint32_t mesh = 0; matches && mesh < cache.GetMeshCount(); mesh++) {
+			rve::RveModel::MeshData cached = cache.GetMeshData(mesh);
+			const rve::RveModel::Builder& imported = builders[mesh];
+			matches = cached.vertices.size() == imported.vertices.size() &&
+				cached.indices.size() == imported.indices.size() &&
+				cached.lods.size() == imported.lods.size() &&
+				cached.meshlets.size() == imported.meshlets.size() &&
+				std::memcmp(cached.vertices.data(), imported.vertices.data(), cached.vertices.size_bytes()) == 0 &&
+				std::memcmp(cached.indices.data(), imported.indices.data(), cached.indices.size_bytes()) == 0 &&
+				std::memcmp(cached.lods.data(), imported.lods.data(), cached.lods.size_bytes()) == 0 &&
+				std::memcmp(cached.meshlets.data(), imported.meshlets.data(), cached.meshlets.size_bytes()) == 0;
+		}
+		std::cout << "Import of " << sourcePath << " " << (matches ? "matches" : "DIFFERS FROM") << " the cache, import took "
+			<< meshLoader.GetStats().parseSeconds * 1000.0f << " ms against " << (openSeconds + verifySeconds) * 1000.0f << " ms to open and read the cache" << std::endl;
+		return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+} // namespace
+
+int main(int argc, char **argv) {
+	if(argc >= 3 && (std::strcmp(argv[1], "--cook") == 0 || std::strcmp(argv[1], "--validate") == 0)) {
+		try {
+			std::string secondPath = argc >= 4 ? argv[3] : "";
+			if(std::strcmp(argv[1], "--cook") == 0) {
+				bool isTexture = std::filesystem::path{argv[2]}.extension() == rve::RveTexture::extension;
+				return isTexture ? CookVirtualTexture(argv[2], secondPath) : CookMesh(argv[2], secondPath);
+			}
+			return ValidateMeshCache(argv[2], secondPath);
+		} catch (const std::exception &exception) {
+			std::cerr << exception.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(argc >= 3 && std::strcmp(argv[1], "--bench") == 0) {
+		try {
+			return rve::RveBenchmarks::Run(argv[2], std::vector<std::string>(argv + 3, argv + argc));
+		} catch (const std::exception &exception) {
+			std::cerr << exception.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	// --stats: prints load reports and per subsystem stats while running
+	rve::RveEngine engine{argc >= 2 && std::strcmp(argv[1], "--stats") == 0};
 
 	try {
 		engine.Run();
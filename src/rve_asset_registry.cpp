@@ -0,0 +1,210 @@
+#include "../include/rve_asset_registry.hpp"
+#include "../include/rve_mapped_file.hpp"
+#include "../include/rve_mesh_cache.hpp"
+#include "../include/rve_mesh_loader.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+namespace rve {
+	RveAssetRegistry::RveAssetRegistry(RveVulkanDevice& device, RveGeometryPool& pool, RveJobSystem& jobSystem, RveResidencyManager& residency) :
+		rveVulkanDevice{device}, rveGeometryPool{pool}, jobSystem{jobSystem}, residency{residency} {}
+
+	RveAssetRegistry::~RveAssetRegistry() {
+		for(uint32_t index = 0; index < models.size(); index++) {
+			if(models[index] != nullptr) {
+				DestroyModel(index);
+			}
+		}
+	}
+
+	RveModelHandle RveAssetRegistry::Create(const std::string& key, const std::function<std::unique_ptr<RveModel>()>& create) {
+		requests++;
+		RveModelHandle handle = AcquireKey(key);
+		if(!handle.IsNull()) {
+			deduplicated++;
+			return handle;
+		}
+		handle = AddModel(key, create(), false);
+		Acquire(handle);
+		return handle;
+	}
+
+	std::vector<RveModelHandle> RveAssetRegistry::Load(const std::vector<std::string>& filePaths) {
+		requests += filePaths.size();
+		// Content hashes decide what is loaded, so the same file under two paths or two copies share models
+		std::vector<uint64_t> hashes(filePaths.size());
+		std::vector<std::string> cachePaths;
+		std::vector<uint64_t> cacheHashes;
+		std::vector<std::string> importPaths;
+		std::vector<uint64_t> importHashes;
+		for(size_t file = 0; file < filePaths.size(); file++) {
+			std::error_code error;
+			std::string path = std::filesystem::weakly_canonical(filePaths[file], error).string();
+			if(error) {
+				path = filePaths[file];
+			}
+			auto known = hashByPath.find(path);
+			if(known == hashByPath.end()) {
+				RveMappedFile mappedFile{path};
+				known = hashByPath.emplace(path, RveMeshCache::Hash(mappedFile.GetData(), mappedFile.GetSize())).first;
+			}
+			uint64_t hash = known->second;
+			hashes[file] = hash;
+
+			bool queued = std::find(cacheHashes.begin(), cacheHashes.end(), hash) != cacheHashes.end() ||
+				std::find(importHashes.begin(), importHashes.end(), hash) != importHashes.end();
+			auto meshCount = meshCountByHash.find(hash);
+			bool loaded = meshCount != meshCountByHash.end();
+			for(uint32_t mesh = 0; loaded && mesh < meshCount->second; mesh++) {
+				loaded = slotByKey.contains(MeshKey(hash, mesh));
+			}
+			if(queued || loaded) {
+				deduplicated++;
+			} else if(std::filesystem::path{path}.extension() == RveMeshCache::extension) {
+				cachePaths.push_back(path);
+				cacheHashes.push_back(hash);
+			} else {
+				importPaths.push_back(path);
+				importHashes.push_back(hash);
+			}
+		}
+
+		// Meshes of a partly released file that are still alive are kept, only the missing ones are added
+		for(size_t file = 0; file < cachePaths.size(); file++) {
+			auto cache = std::make_shared<RveMeshCache>(cachePaths[file]);
+			for(uint32_t mesh = 0; mesh < cache->GetMeshCount(); mesh++) {
+				std::string key = MeshKey(cacheHashes[file], mesh);
+				if(slotByKey.contains(key)) {
+					continue;
+				}
+				auto model = std::make_unique<RveModel>(rveGeometryPool, cache->GetMeshData(mesh), true);
+				RveModel& streamedModel = *model;
+				AddModel(key, std::move(model), true);
+				residency.Register(streamedModel, cache, mesh);
+			}
+			meshCountByHash[cacheHashes[file]] = cache->GetMeshCount();
+		}
+		if(!importPaths.empty()) {
+			RveMeshLoader meshLoader{jobSystem};
+			std::vector<uint32_t> meshCounts;
+			std::vector<RveModel::Builder> builders = meshLoader.Load(importPaths, &meshCounts);
+			size_t builder = 0;
+			for(size_t file = 0; file < importPaths.size(); file++) {
+				for(uint32_t mesh = 0; mesh < meshCounts[file]; mesh++, builder++) {
+					std::string key = MeshKey(importHashes[file], mesh);
+					if(!slotByKey.contains(key)) {
+						AddModel(key, std::make_unique<RveModel>(rveGeometryPool, builders[builder]), false);
+					}
+				}
+				meshCountByHash[importHashes[file]] = meshCounts[file];
+			}
+		}
+
+		std::vector<RveModelHandle> handles;
+		for(uint64_t hash : hashes) {
+			for(uint32_t mesh = 0; mesh < meshCountByHash[hash]; mesh++) {
+				handles.push_back(AcquireKey(MeshKey(hash, mesh)));
+			}
+		}
+		return handles;
+	}
+
+	void RveAssetRegistry::Acquire(RveModelHandle handle) {
+		assert(IsValid(handle) && "(rve_asset_registry.cpp) Acquiring a stale or null model handle");
+		refCounts[handle.GetIndex()]++;
+	}
+
+	void RveAssetRegistry::Release(RveModelHandle handle) {
+		assert(IsValid(handle) && refCounts[handle.GetIndex()] > 0 && "(rve_asset_registry.cpp) Releasing an unreferenced model handle");
+		uint32_t index = handle.GetIndex();
+		if(--refCounts[index] == 0) {
+			uint64_t frame = rveVulkanDevice.GetDeletionQueue().GetFrame();
+			releaseFrames[index] = frame;
+			pendingFrees.push_back({handle, frame});
+		}
+	}
+
+	void RveAssetRegistry::Update() {
+		const RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		destroyedModels.clear();
+		size_t processed = 0;
+		for(; processed < pendingFrees.size() && deletionQueue.IsRetired(pendingFrees[processed].frame); processed++) {
+			const PendingFree& pending = pendingFrees[processed];
+			uint32_t index = pending.handle.GetIndex();
+			// Models acquired again since, or released again later, are skipped
+			if(IsValid(pending.handle) && refCounts[index] == 0 && releaseFrames[index] == pending.frame) {
+				destroyedModels.push_back(pending.handle);
+				DestroyModel(index);
+				freed++;
+			}
+		}
+		pendingFrees.erase(pendingFrees.begin(), pendingFrees.begin() + processed);
+	}
+
+	RveAssetRegistry::Stats RveAssetRegistry::GetStats() const {
+		Stats stats{};
+		stats.models = static_cast<uint32_t>(models.size() - freeSlots.size());
+		stats.pendingFrees = static_cast<uint32_t>(pendingFrees.size());
+		stats.requests = requests;
+		stats.deduplicated = deduplicated;
+		stats.freed = freed;
+		return stats;
+	}
+
+	RveModelHandle RveAssetRegistry::AddModel(const std::string& key, std::unique_ptr<RveModel> model, bool isStreamed) {
+		uint32_t index;
+		if(!freeSlots.empty()) {
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		} else {
+			if(models.size() >= maxModels) {
+				throw std::runtime_error("(rve_asset_registry.cpp) Too many models");
+			}
+			index = static_cast<uint32_t>(models.size());
+			models.emplace_back();
+			refCounts.push_back(0);
+			generations.push_back(0);
+			releaseFrames.push_back(0);
+			streamed.push_back(false);
+			keys.emplace_back();
+		}
+		models[index] = std::move(model);
+		refCounts[index] = 0;
+		streamed[index] = isStreamed;
+		keys[index] = key;
+		slotByKey[key] = index;
+		return {index | (static_cast<uint32_t>(generations[index]) << RveModelHandle::indexBits)};
+	}
+
+	RveModelHandle RveAssetRegistry::AcquireKey(const std::string& key) {
+		auto found = slotByKey.find(key);
+		if(found == slotByKey.end()) {
+			return {};
+		}
+		uint32_t index = found->second;
+		refCounts[index]++;
+		return {index | (static_cast<uint32_t>(generations[index]) << RveModelHandle::indexBits)};
+	}
+
+	void RveAssetRegistry::DestroyModel(uint32_t index) {
+		if(streamed[index]) {
+			residency.Unregister(*models[index]);
+		}
+		// The model's pool ranges are only reused once the frames that drew it retire
+		models[index].reset();
+		slotByKey.erase(keys[index]);
+		keys[index].clear();
+		refCounts[index] = 0;
+		generations[index]++;
+		freeSlots.push_back(index);
+	}
+
+	std::string RveAssetRegistry::MeshKey(uint64_t contentHash, uint32_t mesh) {
+		char key[40];
+		std::snprintf(key, sizeof(key), "mesh:%016llx#%u", static_cast<unsigned long long>(contentHash), mesh);
+		return key;
+	}
+} // namespace rve
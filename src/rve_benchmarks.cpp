@@ -0,0 +1,513 @@
+#include "../include/rve_benchmarks.hpp"
+#include "../include/rve_bvh.hpp"
+#include "../include/rve_ecs.hpp"
+#include "../include/rve_engine.hpp"
+#include "../include/rve_mesh_loader.hpp"
+#include "../include/rve_transform_hierarchy.hpp"
+#include "../include/rve_transform_store.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace rve {
+	namespace {
+		float SecondsSince(std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// Fastest of the runs, so one-off stalls such as page faults on first touch do not count
+		template<typename Run>
+		float BestMilliseconds(uint32_t runs, Run&& run) {
+			float best = std::numeric_limits<float>::max();
+			for(uint32_t i = 0; i < runs; i++) {
+				auto start = std::chrono::steady_clock::now();
+				run();
+				best = std::min(best, SecondsSince(start) * 1000.0f);
+			}
+			return best;
+		}
+	} // namespace
+
+	int RveBenchmarks::Transforms(uint32_t count) {
+		std::vector<uint32_t> counts{10000, 100000, 1000000};
+		if(count != 0) {
+			counts = {count};
+		}
+		std::mt19937 random{1};
+		std::uniform_real_distribution<float> position{-100.0f, 100.0f};
+		std::uniform_real_distribution<float> angle{-3.14159265f, 3.14159265f};
+		std::uniform_real_distribution<float> scale{0.5f, 2.0f};
+		for(uint32_t objects : counts) {
+			std::vector<TransformComponent> transforms(objects);
+			for(auto& transform : transforms) {
+				transform.translation = {position(random), position(random), position(random)};
+				transform.rotation = {angle(random), angle(random), angle(random)};
+				transform.scale = {scale(random), scale(random), scale(random)};
+			}
+			std::vector<glm::mat4> matrices(objects);
+			float aosMilliseconds = BestMilliseconds(runs, [&]() {
+				for(uint32_t i = 0; i < objects; i++) {
+					matrices[i] = transforms[i].mat4();
+				}
+			});
+
+			RveTransformStore store;
+			store.Resize(objects);
+			// Nudging a rotation marks the transform dirty outside of the timed Update
+			uint32_t nudges = 0;
+			auto timeUpdate = [&](uint32_t stride) {
+				nudges++;
+				for(uint32_t i = 0; i < objects; i += stride) {
+					TransformComponent transform = transforms[i];
+					transform.rotation.y += nudges * 1e-4f;
+					store.Set(i, transform);
+				}
+				auto start = std::chrono::steady_clock::now();
+				store.Update();
+				return SecondsSince(start) * 1000.0f;
+			};
+			float allMilliseconds = std::numeric_limits<float>::max();
+			float sparseMilliseconds = std::numeric_limits<float>::max();
+			for(uint32_t run = 0; run < runs; run++) {
+				allMilliseconds = std::min(allMilliseconds, timeUpdate(1));
+				sparseMilliseconds = std::min(sparseMilliseconds, timeUpdate(100));
+			}
+			uint32_t sparseUpdated = store.GetLastUpdateCount();
+
+			float maxError = 0.0f;
+			for(uint32_t i = 0; i < objects; i += 97) {
+				TransformComponent transform = store.Get(i);
+				glm::mat4 expected = transform.mat4();
+				for(int column = 0; column < 4; column++) {
+					for(int row = 0; row < 4; row++) {
+						maxError = std::max(maxError, std::abs(store.GetWorldMatrix(i)[column][row] - expected[column][row]));
+					}
+				}
+			}
+			const float toNanoseconds = 1e6f / objects;
+			std::cout << objects << " transforms: mat4() " << aosMilliseconds * toNanoseconds << " ns each, store "
+				<< allMilliseconds * toNanoseconds << " ns each (" << aosMilliseconds / allMilliseconds << "x), 1% changed "
+				<< sparseMilliseconds * 1000.0f << " us for " << sparseUpdated << " rebuilt, max error " << maxError << std::endl;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	int RveBenchmarks::EntityChurn(uint32_t count) {
+		const uint32_t liveCount = count != 0 ? count : 100000;
+		const uint32_t churnCount = std::max(liveCount / 100, 1u);
+		constexpr uint32_t rounds = 20;
+		std::mt19937 random{1};
+		auto model = std::make_shared<int>(0);
+
+		struct VectorObject {
+			uint32_t id;
+			TransformComponent transform;
+			ColorComponent color;
+			std::shared_ptr<int> model;
+		};
+		std::vector<VectorObject> objects;
+		uint32_t nextId = 0;
+		for(uint32_t i = 0; i < liveCount; i++) {
+			objects.push_back({nextId++, {}, {}, model});
+		}
+		auto vectorStart = std::chrono::steady_clock::now();
+		for(uint32_t round = 0; round < rounds; round++) {
+			for(uint32_t i = 0; i < churnCount; i++) {
+				uint32_t id = objects[random() % objects.size()].id;
+				objects.erase(std::find_if(objects.begin(), objects.end(), [id](const VectorObject& object) { return object.id == id; }));
+			}
+			for(uint32_t i = 0; i < churnCount; i++) {
+				objects.push_back({nextId++, {}, {}, model});
+			}
+		}
+		float vectorSeconds = SecondsSince(vectorStart);
+
+		// Both world paths keep the live handles in a list and swap remove the destroyed ones from it
+		auto takeRandom = [&](std::vector<RveEntity>& live, std::vector<RveEntity>& batch) {
+			batch.clear();
+			for(uint32_t i = 0; i < churnCount; i++) {
+				size_t position = random() % live.size();
+				batch.push_back(live[position]);
+				live[position] = live.back();
+				live.pop_back();
+			}
+		};
+		auto maxIndex = [](const std::vector<RveEntity>& live) {
+			uint32_t index = 0;
+			for(RveEntity entity : live) {
+				index = std::max(index, entity.index);
+			}
+			return index;
+		};
+		std::vector<RveEntity> batch;
+
+		RveWorld directWorld;
+		std::vector<RveEntity> directLive;
+		for(uint32_t i = 0; i < liveCount; i++) {
+			directLive.push_back(directWorld.CreateEntity(TransformComponent{}, ColorComponent{}));
+		}
+		auto directStart = std::chrono::steady_clock::now();
+		for(uint32_t round = 0; round < rounds; round++) {
+			takeRandom(directLive, batch);
+			directWorld.DestroyEntities(batch);
+			for(uint32_t i = 0; i < churnCount; i++) {
+				directLive.push_back(directWorld.CreateEntity(TransformComponent{}, ColorComponent{}));
+			}
+		}
+		float directSeconds = SecondsSince(directStart);
+
+		RveJobSystem jobSystem{};
+		RveWorld reservedWorld;
+		std::vector<RveEntity> reservedLive;
+		for(uint32_t i = 0; i < liveCount; i++) {
+			reservedLive.push_back(reservedWorld.CreateEntity(TransformComponent{}, ColorComponent{}));
+		}
+		std::vector<RveEntity> reserved(churnCount);
+		bool reusedStale = false;
+		auto reservedStart = std::chrono::steady_clock::now();
+		for(uint32_t round = 0; round < rounds; round++) {
+			takeRandom(reservedLive, batch);
+			reservedWorld.DestroyEntities(batch);
+			jobSystem.ParallelFor(churnCount, 64, [&](uint32_t begin, uint32_t end) {
+				for(uint32_t i = begin; i < end; i++) {
+					reserved[i] = reservedWorld.ReserveEntity();
+				}
+			});
+			// The first spawn is a structural change, it turns every reservation into an entity
+			for(RveEntity entity : reserved) {
+				reservedWorld.SpawnReserved(entity, TransformComponent{}, ColorComponent{});
+				reservedLive.push_back(entity);
+			}
+			for(RveEntity entity : batch) {
+				reusedStale = reusedStale || reservedWorld.IsAlive(entity);
+			}
+		}
+		float reservedSeconds = SecondsSince(reservedStart);
+
+		bool allAlive = reservedWorld.GetEntityCount() == liveCount && directWorld.GetEntityCount() == liveCount;
+		for(RveEntity entity : reservedLive) {
+			allAlive = allAlive && reservedWorld.HasComponent<ColorComponent>(entity);
+		}
+		const float toNanoseconds = 1e9f / (rounds * churnCount);
+		std::cout << liveCount << " live, " << churnCount << " destroyed and created per round, " << rounds << " rounds" << std::endl;
+		std::cout << "vector erase: " << vectorSeconds * toNanoseconds << " ns per destroy and create" << std::endl;
+		std::cout << "world direct: " << directSeconds * toNanoseconds << " ns per destroy and create ("
+			<< vectorSeconds / directSeconds << "x), highest slot " << maxIndex(directLive) << std::endl;
+		std::cout << "world reserved on " << jobSystem.GetThreadCount() << " threads: " << reservedSeconds * toNanoseconds
+			<< " ns per destroy and create (" << vectorSeconds / reservedSeconds << "x), highest slot " << maxIndex(reservedLive) << std::endl;
+		std::cout << "Slots " << (maxIndex(reservedLive) < liveCount && maxIndex(directLive) < liveCount ? "reused" : "GREW")
+			<< ", stale handles " << (reusedStale ? "ALIVE" : "rejected") << ", spawned entities " << (allAlive ? "complete" : "MISSING") << std::endl;
+		return allAlive && !reusedStale && maxIndex(reservedLive) < liveCount ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	int RveBenchmarks::Hierarchy(uint32_t count) {
+		const uint32_t nodeCount = std::max(count != 0 ? count : 100000, 32u);
+		RveJobSystem jobSystem{};
+		std::mt19937 random{1};
+		auto makeLocal = [&]() {
+			TransformComponent local{};
+			local.translation = {0.0f, 1.0f, 0.0f};
+			// Unit scale, a shrinking one compounded over thousands of levels ends in denormals
+			local.rotation = {0.0f, (random() % 628) * 0.01f, 0.0f};
+			return local;
+		};
+
+		for(bool deep : {true, false}) {
+			RveTransformHierarchy hierarchy{jobSystem};
+			std::vector<RveTransformHierarchy::Node> nodes;
+			std::vector<uint32_t> parentOf;
+			std::vector<TransformComponent> locals;
+			auto add = [&](uint32_t parent) {
+				locals.push_back(makeLocal());
+				parentOf.push_back(parent);
+				nodes.push_back(hierarchy.AddNode(locals.back(), parent == ~0u ? RveTransformHierarchy::noNode : nodes[parent]));
+			};
+			auto buildStart = std::chrono::steady_clock::now();
+			const uint32_t chains = 16;
+			const uint32_t width = static_cast<uint32_t>(std::sqrt(static_cast<float>(nodeCount)));
+			for(uint32_t i = 0; i < nodeCount; i++) {
+				if(deep) {
+					add(i < chains ? ~0u : i - chains);
+				} else {
+					add(i == 0 ? ~0u : i <= width ? 0 : 1 + (i - width - 1) % width);
+				}
+			}
+			hierarchy.Update();
+			float buildMilliseconds = SecondsSince(buildStart) * 1000.0f;
+
+			auto timeHierarchyUpdate = [&](const std::vector<uint32_t>& changed) {
+				float best = std::numeric_limits<float>::max();
+				for(uint32_t run = 0; run < runs; run++) {
+					for(uint32_t i : changed) {
+						locals[i].rotation.y += 1e-3f;
+						hierarchy.SetLocal(nodes[i], locals[i]);
+					}
+					auto start = std::chrono::steady_clock::now();
+					hierarchy.Update();
+					best = std::min(best, SecondsSince(start) * 1000.0f);
+				}
+				return best;
+			};
+			std::vector<uint32_t> all(nodeCount);
+			std::iota(all.begin(), all.end(), 0u);
+			float allMilliseconds = timeHierarchyUpdate(all);
+			const RveTransformHierarchy::Stats allStats = hierarchy.GetStats();
+			// Random nodes, mostly leaves or deep in a chain, the way animated parts change
+			std::vector<uint32_t> sparse;
+			for(uint32_t i = 0; i < nodeCount / 100; i++) {
+				sparse.push_back(random() % nodeCount);
+			}
+			float sparseMilliseconds = timeHierarchyUpdate(sparse);
+			uint32_t sparseUpdated = hierarchy.GetStats().nodesUpdated;
+			float cleanMilliseconds = timeHierarchyUpdate({});
+
+			// Parents are created before their children, so one pass in creation order is enough
+			std::vector<glm::mat4> worldMatrices(nodeCount);
+			float naiveMilliseconds = BestMilliseconds(runs, [&]() {
+				for(uint32_t i = 0; i < nodeCount; i++) {
+					glm::mat4 local = locals[i].mat4();
+					worldMatrices[i] = parentOf[i] == ~0u ? local : worldMatrices[parentOf[i]] * local;
+				}
+			});
+			float maxError = 0.0f;
+			for(uint32_t i = 0; i < nodeCount; i += 97) {
+				for(int column = 0; column < 4; column++) {
+					for(int row = 0; row < 4; row++) {
+						maxError = std::max(maxError, std::abs(hierarchy.GetWorldMatrix(nodes[i])[column][row] - worldMatrices[i][column][row]));
+					}
+				}
+			}
+
+			std::cout << (deep ? "deep" : "wide") << " hierarchy: " << allStats.nodes << " nodes in " << allStats.levels << " levels ("
+				<< allStats.parallelLevels << " split over " << jobSystem.GetThreadCount() << " threads), built in " << buildMilliseconds << " ms" << std::endl;
+			std::cout << "\tall changed " << allMilliseconds << " ms for " << allStats.nodesUpdated << " updated, 1% changed "
+				<< sparseMilliseconds << " ms for " << sparseUpdated << " updated, none changed " << cleanMilliseconds
+				<< " ms, recomputing all " << naiveMilliseconds << " ms, max error " << maxError << std::endl;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	int RveBenchmarks::Bvh(uint32_t count) {
+		const uint32_t maxCount = std::max(count != 0 ? count : 100000, 100u);
+		RveJobSystem jobSystem{};
+		std::mt19937 random{1};
+		std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+		// Inward planes of a 60 degree frustum at the origin looking down +z, as RveCamera::GetFrustumPlanes returns them
+		const float halfAngle = glm::radians(30.0f);
+		const float sine = std::sin(halfAngle);
+		const float cosine = std::cos(halfAngle);
+		bool matched = true;
+
+		for(uint32_t boxCount : {maxCount / 100, maxCount / 10, maxCount}) {
+			const float side = 10.0f * std::cbrt(static_cast<float>(boxCount));
+			const std::array<glm::vec4, 6> planes{
+				glm::vec4{cosine, 0.0f, sine, 0.0f},
+				glm::vec4{-cosine, 0.0f, sine, 0.0f},
+				glm::vec4{0.0f, cosine, sine, 0.0f},
+				glm::vec4{0.0f, -cosine, sine, 0.0f},
+				glm::vec4{0.0f, 0.0f, 1.0f, -0.1f},
+				glm::vec4{0.0f, 0.0f, -1.0f, side * 0.5f}
+			};
+			std::vector<RveAabb> boxes(boxCount);
+			for(RveAabb& box : boxes) {
+				glm::vec3 center = (glm::vec3{unit(random), unit(random), unit(random)} - 0.5f) * side;
+				glm::vec3 extent = glm::vec3{0.25f + unit(random)};
+				box.min = center - extent;
+				box.max = center + extent;
+			}
+
+			RveBvh bvh{jobSystem};
+			std::vector<RveBvh::Proxy> proxies;
+			for(uint32_t i = 0; i < boxCount; i++) {
+				proxies.push_back(bvh.Insert(boxes[i], i));
+			}
+			// More pending boxes than maxPendingProxies, so the first Maintain starts the rebuild job
+			auto rebuildStart = std::chrono::steady_clock::now();
+			bvh.Maintain();
+			while(bvh.GetStats().rebuilds == 0) {
+				std::this_thread::yield();
+				bvh.Maintain();
+			}
+			float rebuildMilliseconds = SecondsSince(rebuildStart) * 1000.0f;
+
+			std::vector<uint32_t> bvhResults;
+			float bvhMilliseconds = BestMilliseconds(runs, [&]() {
+				bvhResults.clear();
+				bvh.QueryFrustum(planes, bvhResults);
+			});
+			bvh.Maintain();
+			bvh.QueryFrustum(planes, bvhResults);
+			uint32_t nodesVisited = bvh.GetStats().nodesVisited;
+
+			std::vector<uint32_t> linearResults;
+			float linearMilliseconds = BestMilliseconds(runs, [&]() {
+				linearResults.clear();
+				for(uint32_t i = 0; i < boxCount; i++) {
+					bool outside = false;
+					for(const glm::vec4& plane : planes) {
+						const glm::vec3 normal{plane};
+						const glm::vec3 furthest = glm::mix(boxes[i].min, boxes[i].max, glm::greaterThan(normal, glm::vec3{0.0f}));
+						outside = outside || glm::dot(normal, furthest) + plane.w < 0.0f;
+					}
+					if(!outside) {
+						linearResults.push_back(i);
+					}
+				}
+			});
+			std::sort(bvhResults.begin(), bvhResults.end());
+			bvhResults.erase(std::unique(bvhResults.begin(), bvhResults.end()), bvhResults.end());
+			matched = matched && bvhResults == linearResults;
+
+			// Moving one box in ten refits its leaf and the ancestors whose bounds grow
+			for(uint32_t i = 0; i < boxCount; i += 10) {
+				boxes[i].min.x += 0.5f;
+				boxes[i].max.x += 0.5f;
+				bvh.Update(proxies[i], boxes[i]);
+			}
+			auto refitStart = std::chrono::steady_clock::now();
+			bvh.Maintain();
+			float refitMilliseconds = SecondsSince(refitStart) * 1000.0f;
+			uint32_t refitNodes = bvh.GetStats().refitNodes;
+
+			std::cout << boxCount << " boxes, " << bvh.GetStats().nodes << " nodes, SAH rebuild " << rebuildMilliseconds
+				<< " ms, refit of " << boxCount / 10 << " moved " << refitMilliseconds << " ms for " << refitNodes << " nodes" << std::endl;
+			std::cout << "	frustum query " << bvhMilliseconds << " ms visiting " << nodesVisited << " nodes, linear "
+				<< linearMilliseconds << " ms (" << linearMilliseconds / bvhMilliseconds << "x), " << linearResults.size()
+				<< " visible, results " << (bvhResults == linearResults ? "match" : "DIFFER") << std::endl;
+		}
+		return matched ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	int RveBenchmarks::Jobs(uint32_t count) {
+		const uint32_t jobCount = std::max(count != 0 ? count : 100000, 1000u);
+		// Stays under RveJobSystem's deque capacity, so every job goes through the deque
+		constexpr uint32_t batchSize = 1000;
+		constexpr uint32_t work = 256;
+		std::vector<float> results(jobCount);
+		auto compute = [&](uint32_t begin, uint32_t end) {
+			for(uint32_t i = begin; i < end; i++) {
+				float value = static_cast<float>(i);
+				for(uint32_t step = 0; step < work; step++) {
+					value = std::sqrt(value + 1.0f);
+				}
+				results[i] = value;
+			}
+		};
+		float serialMilliseconds = BestMilliseconds(runs, [&]() { compute(0, jobCount); });
+		std::cout << jobCount << " jobs on " << std::thread::hardware_concurrency() << " hardware threads, compute bound loop "
+			<< serialMilliseconds << " ms without the job system" << std::endl;
+
+		bool complete = true;
+		const uint32_t maxWorkers = std::max(RveJobSystem::DefaultWorkerCount(), 4u);
+		for(uint32_t workerCount = 1; workerCount <= maxWorkers; workerCount *= 2) {
+			RveJobSystem jobSystem{workerCount};
+			std::atomic<uint32_t> jobsRun{0};
+			float scheduleMilliseconds = BestMilliseconds(runs, [&]() {
+				for(uint32_t batch = 0; batch < jobCount; batch += batchSize) {
+					RveJobCounter counter;
+					for(uint32_t i = batch; i < std::min(batch + batchSize, jobCount); i++) {
+						jobSystem.Schedule([&jobsRun]() { jobsRun.fetch_add(1, std::memory_order_relaxed); }, &counter);
+					}
+					jobSystem.Wait(counter);
+				}
+			});
+			complete = complete && jobsRun == jobCount * runs;
+			float emptyForMilliseconds = BestMilliseconds(runs, [&]() {
+				jobSystem.ParallelFor(jobCount, 1, [](uint32_t, uint32_t) {});
+			});
+			std::fill(results.begin(), results.end(), 0.0f);
+			float computeMilliseconds = BestMilliseconds(runs, [&]() {
+				jobSystem.ParallelFor(jobCount, 64, compute);
+			});
+			complete = complete && std::find(results.begin(), results.end(), 0.0f) == results.end();
+			const RveJobSystem::Stats stats = jobSystem.GetStats();
+
+			std::cout << jobSystem.GetThreadCount() << " threads: schedule and wait " << scheduleMilliseconds * 1e6f / jobCount
+				<< " ns per job, empty ParallelFor " << emptyForMilliseconds << " ms, compute ParallelFor " << computeMilliseconds
+				<< " ms (" << serialMilliseconds / computeMilliseconds << "x), " << stats.jobsRun << " jobs run, "
+				<< stats.steals << " steals, " << stats.sleeps << " sleeps" << std::endl;
+		}
+		std::cout << "Every job " << (complete ? "ran" : "DID NOT RUN") << std::endl;
+		return complete ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	int RveBenchmarks::Load(const std::vector<std::string>& filePaths) {
+		if(filePaths.empty()) {
+			throw std::runtime_error("(rve_benchmarks.cpp) The load benchmark needs the mesh files to import");
+		}
+		// Uploads go through a geometry pool, which needs a device and so a window
+		RveWindow window{RveEngine::windowWidth, RveEngine::windowHeight, "Load benchmark"};
+		RveVulkanDevice device{window};
+		struct Timing {
+			float parseSeconds = std::numeric_limits<float>::max();
+			float uploadSeconds = std::numeric_limits<float>::max();
+		};
+		RveMeshLoader::Stats stats{};
+		// A fresh pool per run, so no run pays for growing the pool another one filled
+		auto time = [&](uint32_t workerCount) {
+			RveJobSystem jobSystem{workerCount};
+			RveMeshLoader meshLoader{jobSystem};
+			Timing timing{};
+			for(uint32_t run = 0; run < runs; run++) {
+				RveGeometryPool pool{device, RveEngine::vertexFormat, RveEngine::geometryPoolVertices, RveEngine::geometryPoolIndices};
+				meshLoader.LoadModels(pool, filePaths);
+				stats = meshLoader.GetStats();
+				timing.parseSeconds = std::min(timing.parseSeconds, stats.parseSeconds);
+				timing.uploadSeconds = std::min(timing.uploadSeconds, stats.uploadSeconds);
+			}
+			return timing;
+		};
+
+		const Timing baseline = time(0);
+		std::cout << stats.files << " files, " << stats.bytesRead << " bytes, " << stats.meshes << " meshes, " << stats.triangles
+			<< " triangles" << std::endl;
+		std::cout << "no workers, calling thread only: parse " << baseline.parseSeconds * 1000.0f << " ms, upload "
+			<< baseline.uploadSeconds * 1000.0f << " ms" << std::endl;
+		const uint32_t maxWorkers = std::max(RveJobSystem::DefaultWorkerCount(), 4u);
+		for(uint32_t workerCount = 1; workerCount <= maxWorkers; workerCount *= 2) {
+			const Timing timing = time(workerCount);
+			std::cout << workerCount << " workers: parse " << timing.parseSeconds * 1000.0f << " ms ("
+				<< baseline.parseSeconds / timing.parseSeconds << "x), upload " << timing.uploadSeconds * 1000.0f << " ms" << std::endl;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	int RveBenchmarks::Run(const std::string& name, const std::vector<std::string>& arguments) {
+		if(name == "load") {
+			return Load(arguments);
+		}
+		const uint32_t count = arguments.empty() ? 0 : static_cast<uint32_t>(std::strtoul(arguments[0].c_str(), nullptr, 10));
+		if(name == "transforms") {
+			return Transforms(count);
+		}
+		if(name == "entities") {
+			return EntityChurn(count);
+		}
+		if(name == "hierarchy") {
+			return Hierarchy(count);
+		}
+		if(name == "bvh") {
+			return Bvh(count);
+		}
+		if(name == "jobs") {
+			return Jobs(count);
+		}
+		if(name == "pipelines") {
+			// Opens the window and draws the default scene while the variants compile
+			RveEngine engine{};
+			return engine.RunPipelineBenchmark(count != 0 ? count : 256);
+		}
+		throw std::runtime_error("(rve_benchmarks.cpp) Unknown benchmark " + name);
+	}
+} // namespace rve
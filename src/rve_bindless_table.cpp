@@ -0,0 +1,165 @@
+#include "../include/rve_bindless_table.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace rve {
+	RveBindlessTable::RveBindlessTable(RveVulkanDevice& device, uint32_t maxStorageBuffers, uint32_t maxTextures) :
+		rveVulkanDevice{device} {
+			assert(rveVulkanDevice.IsBindlessSupported() && "(rve_bindless_table.cpp) Descriptor indexing is not enabled");
+
+			VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+			indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+			VkPhysicalDeviceProperties2 properties2{};
+			properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+			properties2.pNext = &indexingProperties;
+			vkGetPhysicalDeviceProperties2(rveVulkanDevice.PhysicalDevice(), &properties2);
+
+			slots[static_cast<uint32_t>(Binding::StorageBuffer)].capacity = std::min({
+				maxStorageBuffers,
+				indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+				indexingProperties.maxDescriptorSetUpdateAfterBindStorageBuffers});
+			slots[static_cast<uint32_t>(Binding::Texture)].capacity = std::min({
+				maxTextures,
+				indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+				indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+				indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+
+			std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+			bindings[0].binding = static_cast<uint32_t>(Binding::StorageBuffer);
+			bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[0].descriptorCount = slots[0].capacity;
+			bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+			bindings[1].binding = static_cast<uint32_t>(Binding::Texture);
+			bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			bindings[1].descriptorCount = slots[1].capacity;
+			bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+
+			// Slots are only written while unused by pending frames, so neither binding has to be fully valid
+			std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags{};
+			bindingFlags.fill(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT);
+			VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+			bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+			bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+			bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+			VkDescriptorSetLayoutCreateInfo layoutInfo{};
+			layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutInfo.pNext = &bindingFlagsInfo;
+			layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+			layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+			layoutInfo.pBindings = bindings.data();
+			if(vkCreateDescriptorSetLayout(rveVulkanDevice.Device(), &layoutInfo, nullptr, &setLayout) != VK_SUCCESS) {
+				throw std::runtime_error("(rve_bindless_table.cpp) Failed to create bindless descriptor set layout");
+			}
+
+			std::array<VkDescriptorPoolSize, 2> poolSizes{{
+				{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, slots[0].capacity},
+				{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, slots[1].capacity}
+			}};
+			VkDescriptorPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+			poolInfo.maxSets = 1;
+			poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+			poolInfo.pPoolSizes = poolSizes.data();
+			if(vkCreateDescriptorPool(rveVulkanDevice.Device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+				throw std::runtime_error("(rve_bindless_table.cpp) Failed to create bindless descriptor pool");
+			}
+
+			VkDescriptorSetAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = descriptorPool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &setLayout;
+			if(vkAllocateDescriptorSets(rveVulkanDevice.Device(), &allocInfo, &descriptorSet) != VK_SUCCESS) {
+				throw std::runtime_error("(rve_bindless_table.cpp) Failed to allocate bindless descriptor set");
+			}
+	}
+
+	RveBindlessTable::~RveBindlessTable() {
+		vkDestroyDescriptorPool(rveVulkanDevice.Device(), descriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(rveVulkanDevice.Device(), setLayout, nullptr);
+	}
+
+	void RveBindlessTable::BeginFrame(int frameIndex) {
+		currentFrame = frameIndex;
+		for(auto& allocator : slots) {
+			auto& retired = allocator.retired[currentFrame];
+			allocator.freeList.insert(allocator.freeList.end(), retired.begin(), retired.end());
+			retired.clear();
+		}
+	}
+
+	uint32_t RveBindlessTable::AllocateSlot(Binding binding) {
+		SlotAllocator& allocator = slots[static_cast<uint32_t>(binding)];
+		uint32_t index;
+		if(!allocator.freeList.empty()) {
+			index = allocator.freeList.back();
+			allocator.freeList.pop_back();
+		} else {
+			if(allocator.next == allocator.capacity) {
+				throw std::runtime_error("(rve_bindless_table.cpp) Bindless table out of slots");
+			}
+			index = allocator.next++;
+		}
+		allocator.used++;
+		return index;
+	}
+
+	uint32_t RveBindlessTable::AddStorageBuffer(const VkDescriptorBufferInfo& bufferInfo) {
+		uint32_t index = AllocateSlot(Binding::StorageBuffer);
+		Write(Binding::StorageBuffer, index, &bufferInfo, nullptr);
+		return index;
+	}
+
+	uint32_t RveBindlessTable::AddTexture(const VkDescriptorImageInfo& imageInfo) {
+		uint32_t index = AllocateSlot(Binding::Texture);
+		Write(Binding::Texture, index, nullptr, &imageInfo);
+		return index;
+	}
+
+	void RveBindlessTable::UpdateStorageBuffer(uint32_t index, const VkDescriptorBufferInfo& bufferInfo) {
+		Write(Binding::StorageBuffer, index, &bufferInfo, nullptr);
+	}
+
+	void RveBindlessTable::UpdateTexture(uint32_t index, const VkDescriptorImageInfo& imageInfo) {
+		Write(Binding::Texture, index, nullptr, &imageInfo);
+	}
+
+	void RveBindlessTable::Release(Binding binding, uint32_t index) {
+		SlotAllocator& allocator = slots[static_cast<uint32_t>(binding)];
+		assert(index < allocator.next && "(rve_bindless_table.cpp) Releasing a slot that was never allocated");
+		allocator.retired[currentFrame].push_back(index);
+		allocator.used--;
+	}
+
+	void RveBindlessTable::Write(
+		Binding binding,
+		uint32_t index,
+		const VkDescriptorBufferInfo *bufferInfo,
+		const VkDescriptorImageInfo *imageInfo) {
+			assert(index < slots[static_cast<uint32_t>(binding)].next && "(rve_bindless_table.cpp) Slot index out of range");
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = descriptorSet;
+			write.dstBinding = static_cast<uint32_t>(binding);
+			write.dstArrayElement = index;
+			write.descriptorCount = 1;
+			write.descriptorType = binding == Binding::StorageBuffer ?
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER :
+				VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			write.pBufferInfo = bufferInfo;
+			write.pImageInfo = imageInfo;
+			vkUpdateDescriptorSets(rveVulkanDevice.Device(), 1, &write, 0, nullptr);
+	}
+
+	void RveBindlessTable::Bind(
+		VkCommandBuffer commandBuffer,
+		VkPipelineLayout pipelineLayout,
+		uint32_t setIndex,
+		VkPipelineBindPoint bindPoint) const {
+			vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, setIndex, 1, &descriptorSet, 0, nullptr);
+	}
+} // namespace rve
@@ -0,0 +1,400 @@
+#include "../include/rve_block_decoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace rve {
+	namespace {
+		// Reads a BC7 block least significant bit first
+		class BitReader {
+		public:
+			explicit BitReader(const uint8_t *block) {
+				std::memcpy(&low, block, sizeof(low));
+				std::memcpy(&high, block + 8, sizeof(high));
+			}
+
+			uint32_t Read(uint32_t count) {
+				if(count == 0) {
+					return 0;
+				}
+				uint32_t value;
+				if(position >= 64) {
+					value = static_cast<uint32_t>(high >> (position - 64));
+				} else if(position + count <= 64) {
+					value = static_cast<uint32_t>(low >> position);
+				} else {
+					value = static_cast<uint32_t>((low >> position) | (high << (64 - position)));
+				}
+				position += count;
+				return value & ((1u << count) - 1);
+			}
+
+		private:
+			uint64_t low = 0;
+			uint64_t high = 0;
+			uint32_t position = 0;
+		};
+
+		struct Bc7Mode {
+			uint32_t subsets;
+			uint32_t partitionBits;
+			uint32_t rotationBits;
+			uint32_t indexSelectionBits;
+			uint32_t colorBits;
+			uint32_t alphaBits;
+			uint32_t endpointPBits;
+			uint32_t sharedPBits;
+			uint32_t indexBits;
+			uint32_t secondaryIndexBits;
+		};
+
+		constexpr Bc7Mode bc7Modes[8] = {
+			{3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+			{2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+			{3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+			{2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+			{1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+			{1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+			{1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+			{2, 6, 0, 0, 5, 5, 1, 0, 2, 0}
+		};
+
+		// Bit i is the subset of pixel i
+		constexpr uint16_t bc7Partitions2[64] = {
+			0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+			0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+			0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+			0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+			0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+			0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+			0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+			0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+		};
+
+		constexpr uint8_t bc7Partitions3[64][16] = {
+			{0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+			{0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+			{0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+			{0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1}, {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+			{0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2}, {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+			{0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+			{0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2}, {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+			{0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+			{0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2}, {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+			{0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+			{0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+			{0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2}, {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+			{0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0}, {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+			{0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0}, {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+			{0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2}, {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+			{0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1}, {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+			{0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+			{0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2}, {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+			{0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0}, {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+			{0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0}, {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+			{0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1}, {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+			{0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1}, {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+			{0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1}, {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+			{0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1}, {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+			{0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2}, {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+			{0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2}, {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+			{0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2}, {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+			{0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+			{0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+			{0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+			{0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1}, {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+			{0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0}
+		};
+
+		// Pixel whose index drops its top bit, for the second subset of two and the second and third of three
+		constexpr uint8_t bc7Anchors2[64] = {
+			15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+			15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+			15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+			6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15
+		};
+		constexpr uint8_t bc7Anchors3Second[64] = {
+			3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+			3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+			8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+			3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3
+		};
+		constexpr uint8_t bc7Anchors3Third[64] = {
+			15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+			15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+			15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+			15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8
+		};
+
+		constexpr uint8_t bc7Weights2[4] = {0, 21, 43, 64};
+		constexpr uint8_t bc7Weights3[8] = {0, 9, 18, 27, 37, 46, 55, 64};
+		constexpr uint8_t bc7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+		uint8_t Bc7Interpolate(uint32_t a, uint32_t b, uint32_t index, uint32_t indexBits) {
+			const uint8_t *weights = indexBits == 2 ? bc7Weights2 : indexBits == 3 ? bc7Weights3 : bc7Weights4;
+			return static_cast<uint8_t>(((64 - weights[index]) * a + weights[index] * b + 32) >> 6);
+		}
+
+		void Expand565(uint16_t color, uint8_t rgb[3]) {
+			uint32_t r = (color >> 11) & 31;
+			uint32_t g = (color >> 5) & 63;
+			uint32_t b = color & 31;
+			rgb[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+			rgb[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+			rgb[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+		}
+	} // namespace
+
+	bool RveBlockDecoder::IsSupported(VkFormat format) {
+		return GetBlockSize(format) != 0;
+	}
+
+	uint32_t RveBlockDecoder::GetBlockSize(VkFormat format) {
+		switch(format) {
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				return 8;
+			case VK_FORMAT_BC2_UNORM_BLOCK:
+			case VK_FORMAT_BC2_SRGB_BLOCK:
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+			case VK_FORMAT_BC3_SRGB_BLOCK:
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				return 16;
+			default:
+				return 0;
+		}
+	}
+
+	bool RveBlockDecoder::IsSrgb(VkFormat format) {
+		return format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK ||
+			format == VK_FORMAT_BC2_SRGB_BLOCK || format == VK_FORMAT_BC3_SRGB_BLOCK || format == VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+
+	void RveBlockDecoder::DecodeBlock(VkFormat format, const uint8_t *block, uint8_t pixels[64]) {
+		switch(format) {
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+				// Still three colors and black on the endpoint order, only the alpha is dropped
+				DecodeColor(block, false, pixels);
+				for(uint32_t pixel = 0; pixel < 16; pixel++) {
+					pixels[pixel * 4 + 3] = 255;
+				}
+				break;
+			case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+			case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+				DecodeColor(block, false, pixels);
+				break;
+			case VK_FORMAT_BC2_UNORM_BLOCK:
+			case VK_FORMAT_BC2_SRGB_BLOCK:
+				DecodeColor(block + 8, true, pixels);
+				for(uint32_t pixel = 0; pixel < 16; pixel++) {
+					uint32_t alpha = (block[pixel / 2] >> (pixel % 2 * 4)) & 15;
+					pixels[pixel * 4 + 3] = static_cast<uint8_t>(alpha * 17);
+				}
+				break;
+			case VK_FORMAT_BC3_UNORM_BLOCK:
+			case VK_FORMAT_BC3_SRGB_BLOCK:
+				DecodeColor(block + 8, true, pixels);
+				DecodeChannel(block, pixels, 3);
+				break;
+			case VK_FORMAT_BC4_UNORM_BLOCK:
+				std::memset(pixels, 0, 64);
+				DecodeChannel(block, pixels, 0);
+				for(uint32_t pixel = 0; pixel < 16; pixel++) {
+					pixels[pixel * 4 + 3] = 255;
+				}
+				break;
+			case VK_FORMAT_BC5_UNORM_BLOCK:
+				std::memset(pixels, 0, 64);
+				DecodeChannel(block, pixels, 0);
+				DecodeChannel(block + 8, pixels, 1);
+				for(uint32_t pixel = 0; pixel < 16; pixel++) {
+					pixels[pixel * 4 + 3] = 255;
+				}
+				break;
+			case VK_FORMAT_BC7_UNORM_BLOCK:
+			case VK_FORMAT_BC7_SRGB_BLOCK:
+				DecodeBc7(block, pixels);
+				break;
+			default:
+				std::memset(pixels, 0, 64);
+				break;
+		}
+	}
+
+	void RveBlockDecoder::DecodeColor(const uint8_t *block, bool fourColors, uint8_t pixels[64]) {
+		uint16_t color0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+		uint16_t color1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+		uint8_t palette[4][4]{};
+		Expand565(color0, palette[0]);
+		Expand565(color1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+		// BC2 and BC3 always interpolate four colors, BC1 switches to three and transparent black on the endpoint order
+		for(uint32_t channel = 0; channel < 3; channel++) {
+			uint32_t a = palette[0][channel];
+			uint32_t b = palette[1][channel];
+			if(fourColors || color0 > color1) {
+				palette[2][channel] = static_cast<uint8_t>((2 * a + b) / 3);
+				palette[3][channel] = static_cast<uint8_t>((a + 2 * b) / 3);
+			} else {
+				palette[2][channel] = static_cast<uint8_t>((a + b) / 2);
+				palette[3][channel] = 0;
+			}
+		}
+		if(!fourColors && color0 <= color1) {
+			palette[3][3] = 0;
+		}
+
+		uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | static_cast<uint32_t>(block[7]) << 24;
+		for(uint32_t pixel = 0; pixel < 16; pixel++) {
+			std::memcpy(pixels + pixel * 4, palette[(indices >> (pixel * 2)) & 3], 4);
+		}
+	}
+
+	void RveBlockDecoder::DecodeChannel(const uint8_t *block, uint8_t pixels[64], uint32_t channel) {
+		uint32_t a = block[0];
+		uint32_t b = block[1];
+		uint8_t palette[8];
+		palette[0] = static_cast<uint8_t>(a);
+		palette[1] = static_cast<uint8_t>(b);
+		if(a > b) {
+			for(uint32_t step = 1; step < 7; step++) {
+				palette[step + 1] = static_cast<uint8_t>(((7 - step) * a + step * b) / 7);
+			}
+		} else {
+			for(uint32_t step = 1; step < 5; step++) {
+				palette[step + 1] = static_cast<uint8_t>(((5 - step) * a + step * b) / 5);
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for(uint32_t byte = 0; byte < 6; byte++) {
+			indices |= static_cast<uint64_t>(block[2 + byte]) << (byte * 8);
+		}
+		for(uint32_t pixel = 0; pixel < 16; pixel++) {
+			pixels[pixel * 4 + channel] = palette[(indices >> (pixel * 3)) & 7];
+		}
+	}
+
+	void RveBlockDecoder::DecodeBc7(const uint8_t *block, uint8_t pixels[64]) {
+		uint32_t mode = 0;
+		while(mode < 8 && (block[0] & (1u << mode)) == 0) {
+			mode++;
+		}
+		if(mode == 8) {
+			// Reserved mode, decoders return transparent black
+			std::memset(pixels, 0, 64);
+			return;
+		}
+		const Bc7Mode& info = bc7Modes[mode];
+		BitReader bits{block};
+		bits.Read(mode + 1);
+		uint32_t partition = bits.Read(info.partitionBits);
+		uint32_t rotation = bits.Read(info.rotationBits);
+		uint32_t indexSelection = bits.Read(info.indexSelectionBits);
+
+		// endpoints[subset * 2 + end][channel]
+		uint32_t endpoints[6][4]{};
+		const uint32_t endpointCount = info.subsets * 2;
+		for(uint32_t channel = 0; channel < 3; channel++) {
+			for(uint32_t endpoint = 0; endpoint < endpointCount; endpoint++) {
+				endpoints[endpoint][channel] = bits.Read(info.colorBits);
+			}
+		}
+		for(uint32_t endpoint = 0; endpoint < endpointCount; endpoint++) {
+			endpoints[endpoint][3] = info.alphaBits > 0 ? bits.Read(info.alphaBits) : 255;
+		}
+
+		uint32_t colorBits = info.colorBits;
+		uint32_t alphaBits = info.alphaBits;
+		if(info.endpointPBits != 0 || info.sharedPBits != 0) {
+			uint32_t pBits[6];
+			for(uint32_t endpoint = 0; endpoint < endpointCount; endpoint++) {
+				pBits[endpoint] = info.endpointPBits != 0 || endpoint % 2 == 0 ? bits.Read(1) : pBits[endpoint - 1];
+			}
+			for(uint32_t endpoint = 0; endpoint < endpointCount; endpoint++) {
+				for(uint32_t channel = 0; channel < 4; channel++) {
+					if(channel < 3 || alphaBits > 0) {
+						endpoints[endpoint][channel] = endpoints[endpoint][channel] << 1 | pBits[endpoint];
+					}
+				}
+			}
+			colorBits++;
+			alphaBits += alphaBits > 0 ? 1 : 0;
+		}
+		for(uint32_t endpoint = 0; endpoint < endpointCount; endpoint++) {
+			for(uint32_t channel = 0; channel < 4; channel++) {
+				uint32_t channelBits = channel < 3 ? colorBits : alphaBits;
+				if(channelBits == 0) {
+					continue;
+				}
+				uint32_t value = endpoints[endpoint][channel] << (8 - channelBits);
+				endpoints[endpoint][channel] = value | value >> channelBits;
+			}
+		}
+
+		auto subsetOf = [&](uint32_t pixel) -> uint32_t {
+			if(info.subsets == 2) {
+				return (bc7Partitions2[partition] >> pixel) & 1;
+			}
+			return info.subsets == 3 ? bc7Partitions3[partition][pixel] : 0;
+		};
+		auto isAnchor = [&](uint32_t pixel) {
+			if(pixel == 0) {
+				return true;
+			}
+			if(info.subsets == 2) {
+				return pixel == bc7Anchors2[partition];
+			}
+			return info.subsets == 3 && (pixel == bc7Anchors3Second[partition] || pixel == bc7Anchors3Third[partition]);
+		};
+
+		uint32_t indices[16];
+		for(uint32_t pixel = 0; pixel < 16; pixel++) {
+			indices[pixel] = bits.Read(info.indexBits - (isAnchor(pixel) ? 1 : 0));
+		}
+		uint32_t secondaryIndices[16]{};
+		if(info.secondaryIndexBits != 0) {
+			for(uint32_t pixel = 0; pixel < 16; pixel++) {
+				secondaryIndices[pixel] = bits.Read(info.secondaryIndexBits - (pixel == 0 ? 1 : 0));
+			}
+		}
+
+		for(uint32_t pixel = 0; pixel < 16; pixel++) {
+			uint32_t subset = subsetOf(pixel);
+			const uint32_t *a = endpoints[subset * 2];
+			const uint32_t *b = endpoints[subset * 2 + 1];
+			uint8_t *output = pixels + pixel * 4;
+			if(info.secondaryIndexBits == 0) {
+				for(uint32_t channel = 0; channel < 4; channel++) {
+					output[channel] = Bc7Interpolate(a[channel], b[channel], indices[pixel], info.indexBits);
+				}
+			} else {
+				// Modes 4 and 5 index color and alpha separately, mode 4 can swap which set goes where
+				uint32_t colorIndex = indices[pixel];
+				uint32_t colorIndexBits = info.indexBits;
+				uint32_t alphaIndex = secondaryIndices[pixel];
+				uint32_t alphaIndexBits = info.secondaryIndexBits;
+				if(indexSelection != 0) {
+					std::swap(colorIndex, alphaIndex);
+					std::swap(colorIndexBits, alphaIndexBits);
+				}
+				for(uint32_t channel = 0; channel < 3; channel++) {
+					output[channel] = Bc7Interpolate(a[channel], b[channel], colorIndex, colorIndexBits);
+				}
+				output[3] = Bc7Interpolate(a[3], b[3], alphaIndex, alphaIndexBits);
+			}
+			if(rotation != 0) {
+				std::swap(output[3], output[rotation - 1]);
+			}
+		}
+	}
+} // namespace rve
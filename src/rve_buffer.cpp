@@ -0,0 +1,86 @@
+#include "../include/rve_buffer.hpp"
+
+#include <cassert>
+#include <cstring>
+
+namespace rve {
+	// Rounds instanceSize up to the device's minimum offset alignment, which must be a power of two
+	VkDeviceSize RveBuffer::GetAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment) {
+		if(minOffsetAlignment > 0) {
+			return (instanceSize + minOffsetAlignment - 1) & ~(minOffsetAlignment - 1);
+		}
+		return instanceSize;
+	}
+
+	RveBuffer::RveBuffer(
+		RveVulkanDevice& device,
+		VkDeviceSize instanceSize,
+		uint32_t instanceCount,
+		VkBufferUsageFlags usageFlags,
+		VkMemoryPropertyFlags memoryPropertyFlags,
+		VkDeviceSize minOffsetAlignment) : 
+			rveVulkanDevice{device},
+			instanceCount{instanceCount},
+			instanceSize{instanceSize},
+			usageFlags{usageFlags},
+			memoryPropertyFlags{memoryPropertyFlags} {
+				alignmentSize = GetAlignment(instanceSize, minOffsetAlignment);
+				bufferSize = alignmentSize * instanceCount;
+				rveVulkanDevice.CreateBuffer(bufferSize, usageFlags, memoryPropertyFlags, buffer, memory);
+	}
+
+	RveBuffer::~RveBuffer() {
+		Unmap();
+		rveVulkanDevice.GetDeletionQueue().DestroyBuffer(buffer);
+		rveVulkanDevice.GetDeletionQueue().FreeMemory(memory);
+	}
+
+	VkResult RveBuffer::Map(VkDeviceSize size, VkDeviceSize offset) {
+		assert(buffer && memory && "(rve_buffer.cpp) Called map on buffer before create");
+		return vkMapMemory(rveVulkanDevice.Device(), memory, offset, size, 0, &mapped);
+	}
+
+	void RveBuffer::Unmap() {
+		if(mapped) {
+			vkUnmapMemory(rveVulkanDevice.Device(), memory);
+			mapped = nullptr;
+		}
+	}
+
+	void RveBuffer::WriteToBuffer(const void *data, VkDeviceSize size, VkDeviceSize offset) {
+		assert(mapped && "(rve_buffer.cpp) Cannot copy to unmapped buffer");
+		if(size == VK_WHOLE_SIZE) {
+			memcpy(mapped, data, bufferSize);
+		} else {
+			char *memoryOffset = static_cast<char*>(mapped);
+			memoryOffset += offset;
+			memcpy(memoryOffset, data, size);
+		}
+	}
+
+	// Only required for memory that is not HOST_COHERENT
+	VkResult RveBuffer::Flush(VkDeviceSize size, VkDeviceSize offset) {
+		VkMappedMemoryRange mappedRange{};
+		mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		mappedRange.memory = memory;
+		mappedRange.offset = offset;
+		mappedRange.size = size;
+		return vkFlushMappedMemoryRanges(rveVulkanDevice.Device(), 1, &mappedRange);
+	}
+
+	VkDescriptorBufferInfo RveBuffer::DescriptorInfo(VkDeviceSize size, VkDeviceSize offset) const {
+		return VkDescriptorBufferInfo{buffer, offset, size};
+	}
+
+	void RveBuffer::WriteToIndex(const void *data, uint32_t index) {
+		WriteToBuffer(data, instanceSize, index * alignmentSize);
+	}
+
+	VkResult RveBuffer::FlushIndex(uint32_t index) {
+		return Flush(alignmentSize, index * alignmentSize);
+	}
+
+	VkDescriptorBufferInfo RveBuffer::DescriptorInfoForIndex(uint32_t index) const {
+		return DescriptorInfo(alignmentSize, index * alignmentSize);
+	}
+} // namespace rve
@@ -0,0 +1,376 @@
+#include "../include/rve_bvh.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rve {
+	enum class RveContainment {
+		Outside,
+		Intersecting,
+		Inside
+	};
+
+	RveBvh::~RveBvh() {
+		if(rebuilding) {
+			jobSystem.Wait(rebuildCounter);
+		}
+	}
+
+	RveBvh::Proxy RveBvh::Insert(const RveAabb& bounds, uint32_t userData) {
+		Proxy proxy;
+		if(!freeProxies.empty()) {
+			proxy = freeProxies.back();
+			freeProxies.pop_back();
+		} else {
+			proxy = static_cast<Proxy>(proxyBounds.size());
+			proxyBounds.emplace_back();
+			proxyUserData.push_back(0);
+			proxyAlive.push_back(0);
+			proxyLeaves.push_back(noProxy);
+		}
+		proxyBounds[proxy] = bounds;
+		proxyUserData[proxy] = userData;
+		proxyAlive[proxy] = 1;
+		proxyLeaves[proxy] = noProxy;
+		pendingProxies.push_back(proxy);
+		changedSinceBuild = true;
+		return proxy;
+	}
+
+	void RveBvh::Remove(Proxy proxy) {
+		assert(proxy < proxyAlive.size() && proxyAlive[proxy] && "(rve_bvh.cpp) Proxy is not alive");
+		proxyAlive[proxy] = 0;
+		if(proxyLeaves[proxy] == noProxy) {
+			auto pending = std::find(pendingProxies.begin(), pendingProxies.end(), proxy);
+			if(pending != pendingProxies.end()) {
+				*pending = pendingProxies.back();
+				pendingProxies.pop_back();
+			}
+		} else if(!leafDirty[proxyLeaves[proxy]]) {
+			leafDirty[proxyLeaves[proxy]] = 1;
+			dirtyLeaves.push_back(proxyLeaves[proxy]);
+		}
+		retiredProxies.push_back(proxy);
+		changedSinceBuild = true;
+	}
+
+	void RveBvh::Update(Proxy proxy, const RveAabb& bounds) {
+		assert(proxy < proxyAlive.size() && proxyAlive[proxy] && "(rve_bvh.cpp) Proxy is not alive");
+		if(proxyBounds[proxy] == bounds) {
+			return;
+		}
+		proxyBounds[proxy] = bounds;
+		uint32_t leaf = proxyLeaves[proxy];
+		if(leaf != noProxy && !leafDirty[leaf]) {
+			leafDirty[leaf] = 1;
+			dirtyLeaves.push_back(leaf);
+		}
+		changedSinceBuild = true;
+	}
+
+	void RveBvh::Maintain() {
+		stats.refitNodes = 0;
+		stats.nodesVisited = 0;
+		if(rebuilding && rebuildCounter.IsDone()) {
+			FinishRebuild();
+		}
+		for(uint32_t leaf : dirtyLeaves) {
+			leafDirty[leaf] = 0;
+			RefitLeaf(leaf);
+		}
+		dirtyLeaves.clear();
+
+		framesSinceBuild++;
+		if(!rebuilding && (
+			pendingProxies.size() > maxPendingProxies ||
+			(changedSinceBuild && framesSinceBuild >= rebuildInterval))) {
+				StartRebuild();
+		}
+		stats.proxies = static_cast<uint32_t>(proxyBounds.size() - freeProxies.size() - retiredProxies.size() - retiredBeforeBuild.size());
+		stats.pendingProxies = static_cast<uint32_t>(pendingProxies.size());
+		stats.nodes = static_cast<uint32_t>(tree.nodes.size());
+	}
+
+	void RveBvh::StartRebuild() {
+		std::vector<Proxy> primitives;
+		primitives.reserve(proxyBounds.size());
+		for(Proxy proxy = 0; proxy < proxyAlive.size(); proxy++) {
+			if(proxyAlive[proxy]) {
+				primitives.push_back(proxy);
+			}
+		}
+		retiredBeforeBuild.insert(retiredBeforeBuild.end(), retiredProxies.begin(), retiredProxies.end());
+		retiredProxies.clear();
+		jobSystem.Schedule([this, bounds = proxyBounds, primitives = std::move(primitives)]() mutable {
+			rebuiltTree = Build(bounds, std::move(primitives));
+		}, &rebuildCounter);
+		rebuilding = true;
+		changedSinceBuild = false;
+		framesSinceBuild = 0;
+	}
+
+	void RveBvh::FinishRebuild() {
+		tree = std::move(rebuiltTree);
+		rebuilding = false;
+		std::fill(proxyLeaves.begin(), proxyLeaves.end(), noProxy);
+		for(uint32_t nodeIndex = 0; nodeIndex < tree.nodes.size(); nodeIndex++) {
+			const Node& node = tree.nodes[nodeIndex];
+			if(node.left != 0) {
+				continue;
+			}
+			for(uint32_t primitive = node.first; primitive < node.first + node.count; primitive++) {
+				proxyLeaves[tree.primitives[primitive]] = nodeIndex;
+			}
+		}
+		// Boxes inserted while the build ran are not in the new tree yet
+		pendingProxies.clear();
+		for(Proxy proxy = 0; proxy < proxyAlive.size(); proxy++) {
+			if(proxyAlive[proxy] && proxyLeaves[proxy] == noProxy) {
+				pendingProxies.push_back(proxy);
+			}
+		}
+		freeProxies.insert(freeProxies.end(), retiredBeforeBuild.begin(), retiredBeforeBuild.end());
+		retiredBeforeBuild.clear();
+		leafDirty.assign(tree.nodes.size(), 0);
+		dirtyLeaves.clear();
+		// The snapshot is a few frames old, bring every node up to the current bounds
+		RefitAll();
+		stats.rebuilds++;
+	}
+
+	RveBvh::Tree RveBvh::Build(const std::vector<RveAabb>& bounds, std::vector<Proxy> primitives) {
+		Tree result;
+		result.primitives = std::move(primitives);
+		if(result.primitives.empty()) {
+			return result;
+		}
+		auto& nodes = result.nodes;
+		auto& sorted = result.primitives;
+		nodes.reserve(sorted.size() * 2);
+		result.parents.reserve(sorted.size() * 2);
+		nodes.push_back({RveAabb{}, 0, 0, static_cast<uint32_t>(sorted.size())});
+		result.parents.push_back(noProxy);
+
+		std::vector<uint32_t> stack{0};
+		while(!stack.empty()) {
+			const uint32_t nodeIndex = stack.back();
+			stack.pop_back();
+			const uint32_t first = nodes[nodeIndex].first;
+			const uint32_t count = nodes[nodeIndex].count;
+
+			RveAabb nodeBounds{};
+			RveAabb centroidBounds{};
+			for(uint32_t primitive = first; primitive < first + count; primitive++) {
+				const RveAabb& box = bounds[sorted[primitive]];
+				nodeBounds.Expand(box);
+				glm::vec3 center = box.Center();
+				centroidBounds.Expand({center, center});
+			}
+			nodes[nodeIndex].bounds = nodeBounds;
+			if(count <= maxLeafSize) {
+				continue;
+			}
+
+			// Binned SAH: bucket centroids along each axis and sweep the bucket boundaries from both sides
+			const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+			int bestAxis = -1;
+			uint32_t bestSplit = 0;
+			float bestCost = std::numeric_limits<float>::max();
+			auto binOf = [&](Proxy proxy, int axis) {
+				float offset = (bounds[proxy].Center()[axis] - centroidBounds.min[axis]) * (binCount / extent[axis]);
+				return std::min(binCount - 1, static_cast<uint32_t>(offset));
+			};
+			for(int axis = 0; axis < 3; axis++) {
+				if(extent[axis] <= 0.0f) {
+					continue;
+				}
+				std::array<RveAabb, binCount> binBounds{};
+				std::array<uint32_t, binCount> binCounts{};
+				for(uint32_t primitive = first; primitive < first + count; primitive++) {
+					uint32_t bin = binOf(sorted[primitive], axis);
+					binCounts[bin]++;
+					binBounds[bin].Expand(bounds[sorted[primitive]]);
+				}
+				std::array<float, binCount - 1> leftAreas{};
+				std::array<uint32_t, binCount - 1> leftCounts{};
+				RveAabb accumulated{};
+				uint32_t accumulatedCount = 0;
+				for(uint32_t bin = 0; bin < binCount - 1; bin++) {
+					accumulated.Expand(binBounds[bin]);
+					accumulatedCount += binCounts[bin];
+					leftAreas[bin] = accumulated.SurfaceArea();
+					leftCounts[bin] = accumulatedCount;
+				}
+				accumulated = {};
+				accumulatedCount = 0;
+				for(uint32_t split = binCount - 1; split > 0; split--) {
+					accumulated.Expand(binBounds[split]);
+					accumulatedCount += binCounts[split];
+					if(leftCounts[split - 1] == 0 || accumulatedCount == 0) {
+						continue;
+					}
+					float cost = leftCounts[split - 1] * leftAreas[split - 1] + accumulatedCount * accumulated.SurfaceArea();
+					if(cost < bestCost) {
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
+				}
+			}
+
+			uint32_t middle = first + count / 2;
+			if(bestAxis >= 0) {
+				auto split = std::partition(sorted.begin() + first, sorted.begin() + first + count, [&](Proxy proxy) {
+					return binOf(proxy, bestAxis) < bestSplit;
+				});
+				middle = static_cast<uint32_t>(split - sorted.begin());
+			}
+			// Otherwise every centroid coincides and the range is simply halved
+
+			const uint32_t left = static_cast<uint32_t>(nodes.size());
+			nodes.push_back({RveAabb{}, 0, first, middle - first});
+			nodes.push_back({RveAabb{}, 0, middle, first + count - middle});
+			result.parents.push_back(nodeIndex);
+			result.parents.push_back(nodeIndex);
+			nodes[nodeIndex].left = left;
+			stack.push_back(left);
+			stack.push_back(left + 1);
+		}
+		return result;
+	}
+
+	RveAabb RveBvh::LeafBounds(const Node& node) const {
+		RveAabb leafBounds{};
+		for(uint32_t primitive = node.first; primitive < node.first + node.count; primitive++) {
+			Proxy proxy = tree.primitives[primitive];
+			if(proxyAlive[proxy]) {
+				leafBounds.Expand(proxyBounds[proxy]);
+			}
+		}
+		return leafBounds;
+	}
+
+	void RveBvh::RefitLeaf(uint32_t nodeIndex) {
+		tree.nodes[nodeIndex].bounds = LeafBounds(tree.nodes[nodeIndex]);
+		stats.refitNodes++;
+		// Stops at the first ancestor whose bounds come out the same
+		for(uint32_t parent = tree.parents[nodeIndex]; parent != noProxy; parent = tree.parents[parent]) {
+			Node& node = tree.nodes[parent];
+			RveAabb merged = tree.nodes[node.left].bounds;
+			merged.Expand(tree.nodes[node.left + 1].bounds);
+			if(merged == node.bounds) {
+				break;
+			}
+			node.bounds = merged;
+			stats.refitNodes++;
+		}
+	}
+
+	void RveBvh::RefitAll() {
+		for(size_t nodeIndex = tree.nodes.size(); nodeIndex-- > 0;) {
+			Node& node = tree.nodes[nodeIndex];
+			if(node.left == 0) {
+				node.bounds = LeafBounds(node);
+			} else {
+				node.bounds = tree.nodes[node.left].bounds;
+				node.bounds.Expand(tree.nodes[node.left + 1].bounds);
+			}
+		}
+		stats.refitNodes += static_cast<uint32_t>(tree.nodes.size());
+	}
+
+	void RveBvh::AppendIfAlive(Proxy proxy, std::vector<uint32_t>& results) const {
+		if(proxyAlive[proxy]) {
+			results.push_back(proxyUserData[proxy]);
+		}
+	}
+
+	void RveBvh::AppendRange(const Node& node, std::vector<uint32_t>& results) const {
+		for(uint32_t primitive = node.first; primitive < node.first + node.count; primitive++) {
+			AppendIfAlive(tree.primitives[primitive], results);
+		}
+	}
+
+	template<typename Test>
+	void RveBvh::Traverse(const Test& test, std::vector<uint32_t>& results) const {
+		for(Proxy proxy : pendingProxies) {
+			if(test(proxyBounds[proxy]) != RveContainment::Outside) {
+				AppendIfAlive(proxy, results);
+			}
+		}
+		if(tree.nodes.empty()) {
+			return;
+		}
+		std::vector<uint32_t> stack;
+		stack.reserve(64);
+		stack.push_back(0);
+		while(!stack.empty()) {
+			const Node& node = tree.nodes[stack.back()];
+			stack.pop_back();
+			stats.nodesVisited++;
+			RveContainment containment = test(node.bounds);
+			if(containment == RveContainment::Outside) {
+				continue;
+			}
+			// A subtree's primitives are contiguous, so a fully contained node is appended without descending
+			if(containment == RveContainment::Inside) {
+				AppendRange(node, results);
+				continue;
+			}
+			if(node.left != 0) {
+				stack.push_back(node.left);
+				stack.push_back(node.left + 1);
+				continue;
+			}
+			for(uint32_t primitive = node.first; primitive < node.first + node.count; primitive++) {
+				Proxy proxy = tree.primitives[primitive];
+				if(test(proxyBounds[proxy]) != RveContainment::Outside) {
+					AppendIfAlive(proxy, results);
+				}
+			}
+		}
+	}
+
+	void RveBvh::QueryFrustum(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& results) const {
+		Traverse([&planes](const RveAabb& box) {
+			RveContainment containment = RveContainment::Inside;
+			for(const glm::vec4& plane : planes) {
+				const glm::vec3 normal{plane};
+				const glm::bvec3 positiveAxes = glm::greaterThan(normal, glm::vec3{0.0f});
+				// Corners furthest along and against the plane normal
+				const glm::vec3 furthest = glm::mix(box.min, box.max, positiveAxes);
+				if(glm::dot(normal, furthest) + plane.w < 0.0f) {
+					return RveContainment::Outside;
+				}
+				const glm::vec3 nearest = glm::mix(box.max, box.min, positiveAxes);
+				if(glm::dot(normal, nearest) + plane.w < 0.0f) {
+					containment = RveContainment::Intersecting;
+				}
+			}
+			return containment;
+		}, results);
+	}
+
+	void RveBvh::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<uint32_t>& results) const {
+		const glm::vec3 inverseDirection = 1.0f / direction;
+		Traverse([&](const RveAabb& box) {
+			const glm::vec3 t0 = (box.min - origin) * inverseDirection;
+			const glm::vec3 t1 = (box.max - origin) * inverseDirection;
+			const glm::vec3 slabNear = glm::min(t0, t1);
+			const glm::vec3 slabFar = glm::max(t0, t1);
+			float enter = glm::max(glm::max(slabNear.x, slabNear.y), glm::max(slabNear.z, 0.0f));
+			float exit = glm::min(glm::min(slabFar.x, slabFar.y), glm::min(slabFar.z, maxDistance));
+			return enter <= exit ? RveContainment::Intersecting : RveContainment::Outside;
+		}, results);
+	}
+
+	void RveBvh::QueryOverlap(const RveAabb& bounds, std::vector<uint32_t>& results) const {
+		Traverse([&bounds](const RveAabb& box) {
+			if(!bounds.Overlaps(box)) {
+				return RveContainment::Outside;
+			}
+			bool contained = glm::all(glm::lessThanEqual(bounds.min, box.min)) && glm::all(glm::lessThanEqual(box.max, bounds.max));
+			return contained ? RveContainment::Inside : RveContainment::Intersecting;
+		}, results);
+	}
+} // namespace rve
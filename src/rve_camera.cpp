@@ -0,0 +1,71 @@
+#include "../include/rve_camera.hpp"
+
+#include <cassert>
+#include <limits>
+
+namespace rve {
+	void RveCamera::SetOrthographicProjection(float left, float right, float top, float bottom, float near, float far) {
+		projectionMatrix = glm::mat4{1.0f};
+		projectionMatrix[0][0] = 2.0f / (right - left);
+		projectionMatrix[1][1] = 2.0f / (bottom - top);
+		projectionMatrix[2][2] = 1.0f / (far - near);
+		projectionMatrix[3][0] = -(right + left) / (right - left);
+		projectionMatrix[3][1] = -(bottom + top) / (bottom - top);
+		projectionMatrix[3][2] = -near / (far - near);
+		perspective = false;
+	}
+
+	void RveCamera::SetPerspectiveProjection(float fovy, float aspect, float near, float far) {
+		assert(glm::abs(aspect - std::numeric_limits<float>::epsilon()) > 0.0f && "(rve_camera.cpp) Invalid aspect ratio");
+		const float tanHalfFovy = glm::tan(fovy / 2.0f);
+		projectionMatrix = glm::mat4{0.0f};
+		projectionMatrix[0][0] = 1.0f / (aspect * tanHalfFovy);
+		projectionMatrix[1][1] = 1.0f / (tanHalfFovy);
+		projectionMatrix[2][2] = far / (far - near);
+		projectionMatrix[2][3] = 1.0f;
+		projectionMatrix[3][2] = -(far * near) / (far - near);
+		perspective = true;
+	}
+
+	void RveCamera::SetViewDirection(glm::vec3 cameraPosition, glm::vec3 direction, glm::vec3 up) {
+		const glm::vec3 w{glm::normalize(direction)};
+		const glm::vec3 u{glm::normalize(glm::cross(w, up))};
+		const glm::vec3 v{glm::cross(w, u)};
+
+		viewMatrix = glm::mat4{1.0f};
+		viewMatrix[0][0] = u.x;
+		viewMatrix[1][0] = u.y;
+		viewMatrix[2][0] = u.z;
+		viewMatrix[0][1] = v.x;
+		viewMatrix[1][1] = v.y;
+		viewMatrix[2][1] = v.z;
+		viewMatrix[0][2] = w.x;
+		viewMatrix[1][2] = w.y;
+		viewMatrix[2][2] = w.z;
+		viewMatrix[3][0] = -glm::dot(u, cameraPosition);
+		viewMatrix[3][1] = -glm::dot(v, cameraPosition);
+		viewMatrix[3][2] = -glm::dot(w, cameraPosition);
+		position = cameraPosition;
+	}
+
+	std::array<glm::vec4, 6> RveCamera::GetFrustumPlanes() const {
+		// Gribb/Hartmann plane extraction for a [0, 1] depth range
+		const glm::mat4 m = glm::transpose(projectionMatrix * viewMatrix);
+		std::array<glm::vec4, 6> planes{
+			m[3] + m[0],
+			m[3] - m[0],
+			m[3] + m[1],
+			m[3] - m[1],
+			m[2],
+			m[3] - m[2]
+		};
+		for(auto& plane : planes) {
+			plane /= glm::length(glm::vec3{plane});
+		}
+		return planes;
+	}
+
+	void RveCamera::SetViewTarget(glm::vec3 cameraPosition, glm::vec3 target, glm::vec3 up) {
+		SetViewDirection(cameraPosition, target - cameraPosition, up);
+	}
+} // namespace rve
@@ -0,0 +1,85 @@
+#include "../include/rve_deletion_queue.hpp"
+
+#include <cassert>
+
+namespace rve {
+	namespace {
+		template<typename Handle>
+		Handle FromHandle(uint64_t handle) {
+			if constexpr(std::is_pointer_v<Handle>) {
+				return reinterpret_cast<Handle>(static_cast<uintptr_t>(handle));
+			} else {
+				return static_cast<Handle>(handle);
+			}
+		}
+	} // namespace
+
+	RveDeletionQueue::RveDeletionQueue(VkDevice device, uint32_t frameLatency) :
+		device{device}, frameLatency{frameLatency} {}
+
+	RveDeletionQueue::~RveDeletionQueue() {
+		Flush();
+	}
+
+	void RveDeletionQueue::Enqueue(VkObjectType type, uint64_t handle) {
+		std::lock_guard<std::mutex> lock{mutex};
+		deletions.push_back({type, handle, currentFrame.load(std::memory_order_relaxed)});
+	}
+
+	void RveDeletionQueue::BeginFrame() {
+		uint64_t frame = currentFrame.load(std::memory_order_relaxed) + 1;
+		currentFrame.store(frame, std::memory_order_release);
+		// Tags only grow, so everything retired sits at the front
+		std::lock_guard<std::mutex> lock{mutex};
+		while(!deletions.empty() && deletions.front().frame + frameLatency <= frame) {
+			Destroy(deletions.front());
+			deletions.pop_front();
+		}
+	}
+
+	void RveDeletionQueue::Flush() {
+		std::lock_guard<std::mutex> lock{mutex};
+		for(const Deletion& deletion : deletions) {
+			Destroy(deletion);
+		}
+		deletions.clear();
+	}
+
+	RveDeletionQueue::Stats RveDeletionQueue::GetStats() {
+		std::lock_guard<std::mutex> lock{mutex};
+		Stats stats{};
+		stats.pending = static_cast<uint32_t>(deletions.size());
+		stats.destroyed = destroyed;
+		return stats;
+	}
+
+	void RveDeletionQueue::Destroy(const Deletion& deletion) {
+		switch(deletion.type) {
+			case VK_OBJECT_TYPE_BUFFER:
+				vkDestroyBuffer(device, FromHandle<VkBuffer>(deletion.handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_IMAGE:
+				vkDestroyImage(device, FromHandle<VkImage>(deletion.handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_IMAGE_VIEW:
+				vkDestroyImageView(device, FromHandle<VkImageView>(deletion.handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_SAMPLER:
+				vkDestroySampler(device, FromHandle<VkSampler>(deletion.handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_PIPELINE:
+				vkDestroyPipeline(device, FromHandle<VkPipeline>(deletion.handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_SHADER_MODULE:
+				vkDestroyShaderModule(device, FromHandle<VkShaderModule>(deletion.handle), nullptr);
+				break;
+			case VK_OBJECT_TYPE_DEVICE_MEMORY:
+				vkFreeMemory(device, FromHandle<VkDeviceMemory>(deletion.handle), nullptr);
+				break;
+			default:
+				assert(false && "(rve_deletion_queue.cpp) Unsupported object type");
+				break;
+		}
+		destroyed++;
+	}
+} // namespace rve
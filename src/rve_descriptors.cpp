@@ -0,0 +1,214 @@
+#include "../include/rve_descriptors.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace rve {
+	RveDescriptorSetLayout::Builder& RveDescriptorSetLayout::Builder::AddBinding(
+		uint32_t binding,
+		VkDescriptorType descriptorType,
+		VkShaderStageFlags stageFlags,
+		uint32_t count) {
+			assert(bindings.count(binding) == 0 && "(rve_descriptors.cpp) Binding already in use");
+			VkDescriptorSetLayoutBinding layoutBinding{};
+			layoutBinding.binding = binding;
+			layoutBinding.descriptorType = descriptorType;
+			layoutBinding.descriptorCount = count;
+			layoutBinding.stageFlags = stageFlags;
+			bindings[binding] = layoutBinding;
+			return *this;
+	}
+
+	std::unique_ptr<RveDescriptorSetLayout> RveDescriptorSetLayout::Builder::Build() const {
+		return std::make_unique<RveDescriptorSetLayout>(rveVulkanDevice, bindings);
+	}
+
+	RveDescriptorSetLayout::RveDescriptorSetLayout(
+		RveVulkanDevice& device,
+		std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings) :
+			rveVulkanDevice{device}, bindings{bindings} {
+				std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+				for(auto& binding : bindings) {
+					setLayoutBindings.push_back(binding.second);
+				}
+
+				VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
+				descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+				descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
+				descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
+
+				if(vkCreateDescriptorSetLayout(
+					rveVulkanDevice.Device(),
+					&descriptorSetLayoutInfo,
+					nullptr,
+					&descriptorSetLayout) != VK_SUCCESS) {
+						throw std::runtime_error("(rve_descriptors.cpp) Failed to create descriptor set layout");
+				}
+	}
+
+	RveDescriptorSetLayout::~RveDescriptorSetLayout() {
+		vkDestroyDescriptorSetLayout(rveVulkanDevice.Device(), descriptorSetLayout, nullptr);
+	}
+
+	RveDescriptorPool::Builder& RveDescriptorPool::Builder::AddPoolSize(VkDescriptorType descriptorType, uint32_t count) {
+		poolSizes.push_back({descriptorType, count});
+		return *this;
+	}
+
+	RveDescriptorPool::Builder& RveDescriptorPool::Builder::SetPoolFlags(VkDescriptorPoolCreateFlags flags) {
+		poolFlags = flags;
+		return *this;
+	}
+
+	RveDescriptorPool::Builder& RveDescriptorPool::Builder::SetMaxSets(uint32_t count) {
+		maxSets = count;
+		return *this;
+	}
+
+	std::unique_ptr<RveDescriptorPool> RveDescriptorPool::Builder::Build() const {
+		return std::make_unique<RveDescriptorPool>(rveVulkanDevice, maxSets, poolFlags, poolSizes);
+	}
+
+	RveDescriptorPool::RveDescriptorPool(
+		RveVulkanDevice& device,
+		uint32_t maxSets,
+		VkDescriptorPoolCreateFlags poolFlags,
+		const std::vector<VkDescriptorPoolSize>& poolSizes) : rveVulkanDevice{device} {
+			VkDescriptorPoolCreateInfo descriptorPoolInfo{};
+			descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+			descriptorPoolInfo.pPoolSizes = poolSizes.data();
+			descriptorPoolInfo.maxSets = maxSets;
+			descriptorPoolInfo.flags = poolFlags;
+
+			if(vkCreateDescriptorPool(rveVulkanDevice.Device(), &descriptorPoolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+				throw std::runtime_error("(rve_descriptors.cpp) Failed to create descriptor pool");
+			}
+	}
+
+	RveDescriptorPool::~RveDescriptorPool() {
+		vkDestroyDescriptorPool(rveVulkanDevice.Device(), descriptorPool, nullptr);
+	}
+
+	bool RveDescriptorPool::AllocateDescriptorSet(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor) const {
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.pSetLayouts = &descriptorSetLayout;
+		allocInfo.descriptorSetCount = 1;
+		return vkAllocateDescriptorSets(rveVulkanDevice.Device(), &allocInfo, &descriptor) == VK_SUCCESS;
+	}
+
+	void RveDescriptorPool::FreeDescriptors(std::vector<VkDescriptorSet>& descriptors) const {
+		vkFreeDescriptorSets(
+			rveVulkanDevice.Device(),
+			descriptorPool,
+			static_cast<uint32_t>(descriptors.size()),
+			descriptors.data());
+	}
+
+	void RveDescriptorPool::ResetPool() {
+		vkResetDescriptorPool(rveVulkanDevice.Device(), descriptorPool, 0);
+	}
+
+	size_t RveDescriptorSetCache::KeyHash::operator()(const Key& key) const {
+		// FNV-1a over the layout handle and the flattened write contents
+		uint64_t hash = 14695981039346656037ull;
+		auto combine = [&](uint64_t value) {
+			hash ^= value;
+			hash *= 1099511628211ull;
+		};
+		combine((uint64_t)key.layout);
+		for(uint64_t value : key.contents) {
+			combine(value);
+		}
+		return static_cast<size_t>(hash);
+	}
+
+	void RveDescriptorSetCache::Clear() {
+		rveDescriptorPool.ResetPool();
+		sets.clear();
+	}
+
+	RveDescriptorWriter::RveDescriptorWriter(RveDescriptorSetLayout& setLayout, RveDescriptorPool& pool) :
+		rveDescriptorSetLayout{setLayout}, rveDescriptorPool{pool} {}
+
+	RveDescriptorWriter& RveDescriptorWriter::WriteBuffer(uint32_t binding, const VkDescriptorBufferInfo *bufferInfo) {
+		assert(rveDescriptorSetLayout.bindings.count(binding) == 1 && "(rve_descriptors.cpp) Layout does not contain specified binding");
+		auto& bindingDescription = rveDescriptorSetLayout.bindings[binding];
+		assert(bindingDescription.descriptorCount == 1 && "(rve_descriptors.cpp) Binding single descriptor info, but binding expects multiple");
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.descriptorType = bindingDescription.descriptorType;
+		write.dstBinding = binding;
+		write.pBufferInfo = bufferInfo;
+		write.descriptorCount = 1;
+
+		writes.push_back(write);
+		return *this;
+	}
+
+	RveDescriptorWriter& RveDescriptorWriter::WriteImage(uint32_t binding, const VkDescriptorImageInfo *imageInfo) {
+		assert(rveDescriptorSetLayout.bindings.count(binding) == 1 && "(rve_descriptors.cpp) Layout does not contain specified binding");
+		auto& bindingDescription = rveDescriptorSetLayout.bindings[binding];
+		assert(bindingDescription.descriptorCount == 1 && "(rve_descriptors.cpp) Binding single descriptor info, but binding expects multiple");
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.descriptorType = bindingDescription.descriptorType;
+		write.dstBinding = binding;
+		write.pImageInfo = imageInfo;
+		write.descriptorCount = 1;
+
+		writes.push_back(write);
+		return *this;
+	}
+
+	bool RveDescriptorWriter::Build(VkDescriptorSet& set) {
+		bool success = rveDescriptorPool.AllocateDescriptorSet(rveDescriptorSetLayout.GetDescriptorSetLayout(), set);
+		if(!success) {
+			return false;
+		}
+		Overwrite(set);
+		return true;
+	}
+
+	bool RveDescriptorWriter::Build(VkDescriptorSet& set, RveDescriptorSetCache& cache) {
+		assert(&cache.rveDescriptorPool == &rveDescriptorPool && "(rve_descriptors.cpp) Cache belongs to a different pool");
+		RveDescriptorSetCache::Key key{rveDescriptorSetLayout.GetDescriptorSetLayout(), {}};
+		key.contents.reserve(writes.size() * 5);
+		for(auto& write : writes) {
+			key.contents.push_back((static_cast<uint64_t>(write.dstBinding) << 32) | static_cast<uint64_t>(write.descriptorType));
+			if(write.pBufferInfo != nullptr) {
+				key.contents.push_back((uint64_t)write.pBufferInfo->buffer);
+				key.contents.push_back(write.pBufferInfo->offset);
+				key.contents.push_back(write.pBufferInfo->range);
+			} else {
+				key.contents.push_back((uint64_t)write.pImageInfo->sampler);
+				key.contents.push_back((uint64_t)write.pImageInfo->imageView);
+				key.contents.push_back(static_cast<uint64_t>(write.pImageInfo->imageLayout));
+			}
+		}
+
+		auto cached = cache.sets.find(key);
+		if(cached != cache.sets.end()) {
+			cache.hits++;
+			set = cached->second;
+			return true;
+		}
+		cache.misses++;
+		if(!Build(set)) {
+			return false;
+		}
+		cache.sets.emplace(std::move(key), set);
+		return true;
+	}
+
+	void RveDescriptorWriter::Overwrite(VkDescriptorSet& set) {
+		for(auto& write : writes) {
+			write.dstSet = set;
+		}
+		vkUpdateDescriptorSets(rveDescriptorPool.rveVulkanDevice.Device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+	}
+} // namespace rve
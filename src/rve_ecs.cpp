@@ -0,0 +1,302 @@
+#include "../include/rve_ecs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+
+namespace rve {
+	static std::atomic<uint64_t> nextWorldId{1};
+
+	static size_t AlignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	static std::byte *AllocateChunk() {
+		return static_cast<std::byte*>(::operator new(RveWorld::chunkSize, std::align_val_t{RveWorld::cacheLineSize}));
+	}
+
+	static void FreeChunk(std::byte *data) {
+		::operator delete(data, std::align_val_t{RveWorld::cacheLineSize});
+	}
+
+	// Component ids are shared by every world, the table only grows so entries stay valid without the lock
+	static std::mutex componentMutex;
+	RveWorld::ComponentInfo RveWorld::componentInfos[RveWorld::maxComponents];
+	uint32_t RveWorld::componentCount = 0;
+
+	RveComponentId RveWorld::RegisterComponent(const ComponentInfo& info) {
+		std::lock_guard<std::mutex> lock{componentMutex};
+		if(componentCount == maxComponents) {
+			throw std::runtime_error("(rve_ecs.cpp) Too many component types");
+		}
+		componentInfos[componentCount] = info;
+		return componentCount++;
+	}
+
+	const RveWorld::ComponentInfo& RveWorld::GetComponentInfo(RveComponentId id) {
+		return componentInfos[id];
+	}
+
+	int32_t RveWorld::Archetype::Column(RveComponentId id) const {
+		auto found = std::lower_bound(components.begin(), components.end(), id);
+		if(found == components.end() || *found != id) {
+			return -1;
+		}
+		return static_cast<int32_t>(found - components.begin());
+	}
+
+	RveWorld::RveWorld() : worldId{nextWorldId++} {
+		GetOrCreateArchetype(0);
+	}
+
+	RveWorld::~RveWorld() {
+		for(auto& archetype : archetypes) {
+			for(Chunk& chunk : archetype->chunks) {
+				for(size_t column = 0; column < archetype->components.size(); column++) {
+					const ComponentInfo& info = GetComponentInfo(archetype->components[column]);
+					std::byte *array = chunk.data + archetype->offsets[column];
+					for(uint32_t row = 0; row < chunk.count; row++) {
+						info.destroy(array + row * info.size);
+					}
+				}
+				FreeChunk(chunk.data);
+			}
+		}
+	}
+
+	uint32_t RveWorld::GetChunkCount() const {
+		uint32_t count = 0;
+		for(const auto& archetype : archetypes) {
+			count += static_cast<uint32_t>(archetype->chunks.size());
+		}
+		return count;
+	}
+
+	RveEntity RveWorld::CreateEntityRaw(Mask mask) {
+		BeginStructuralChange();
+		RveEntity entity{};
+		if(!freeSlots.empty()) {
+			entity.index = freeSlots.back();
+			freeSlots.pop_back();
+			freeCursor.store(static_cast<int64_t>(freeSlots.size()), std::memory_order_relaxed);
+		} else {
+			entity.index = static_cast<uint32_t>(slots.size());
+			slots.emplace_back();
+		}
+		entity.generation = slots[entity.index].generation;
+		AllocateRow(GetOrCreateArchetype(mask), entity);
+		entityCount++;
+		return entity;
+	}
+
+	void RveWorld::DestroyEntity(RveEntity entity) {
+		BeginStructuralChange();
+		if(IsAlive(entity)) {
+			DestroyAliveEntity(entity);
+		}
+	}
+
+	void RveWorld::DestroyEntities(std::span<const RveEntity> entities) {
+		BeginStructuralChange();
+		freeSlots.reserve(freeSlots.size() + entities.size());
+		for(RveEntity entity : entities) {
+			if(IsAlive(entity)) {
+				DestroyAliveEntity(entity);
+			}
+		}
+	}
+
+	void RveWorld::DestroyAliveEntity(RveEntity entity) {
+		Slot& slot = slots[entity.index];
+		RemoveRow(*slot.archetype, slot.chunk, slot.row);
+		slot.archetype = nullptr;
+		slot.generation++;
+		freeSlots.push_back(entity.index);
+		freeCursor.store(static_cast<int64_t>(freeSlots.size()), std::memory_order_relaxed);
+		entityCount--;
+	}
+
+	RveEntity RveWorld::ReserveEntity() {
+		// Takes free slots from the back of the list, then counts past the end of the slot array
+		int64_t cursor = freeCursor.fetch_sub(1, std::memory_order_relaxed);
+		if(cursor > 0) {
+			uint32_t index = freeSlots[cursor - 1];
+			return {index, slots[index].generation};
+		}
+		return {static_cast<uint32_t>(slots.size() - cursor), 0};
+	}
+
+	bool RveWorld::SpawnReservedRaw(RveEntity entity, Mask mask) {
+		BeginStructuralChange();
+		if(!IsAlive(entity)) {
+			return false;
+		}
+		assert(slots[entity.index].archetype->mask == 0 && "(rve_ecs.cpp) Reserved entity was already given components");
+		MoveEntity(entity, GetOrCreateArchetype(mask));
+		return true;
+	}
+
+	void *RveWorld::AddComponentRaw(RveEntity entity, RveComponentId id) {
+		BeginStructuralChange();
+		assert(IsAlive(entity) && "(rve_ecs.cpp) Entity is not alive");
+		MoveEntity(entity, GetOrCreateArchetype(slots[entity.index].archetype->mask | (Mask{1} << id)));
+		return GetComponentRaw(entity, id);
+	}
+
+	void RveWorld::RemoveComponentRaw(RveEntity entity, RveComponentId id) {
+		BeginStructuralChange();
+		if(!IsAlive(entity) || (slots[entity.index].archetype->mask & (Mask{1} << id)) == 0) {
+			return;
+		}
+		MoveEntity(entity, GetOrCreateArchetype(slots[entity.index].archetype->mask & ~(Mask{1} << id)));
+	}
+
+	void *RveWorld::GetComponentRaw(RveEntity entity, RveComponentId id) {
+		if(!IsAlive(entity)) {
+			return nullptr;
+		}
+		const Slot& slot = slots[entity.index];
+		int32_t column = slot.archetype->Column(id);
+		if(column < 0) {
+			return nullptr;
+		}
+		const Chunk& chunk = slot.archetype->chunks[slot.chunk];
+		return chunk.data + slot.archetype->offsets[column] + slot.row * GetComponentInfo(id).size;
+	}
+
+	RveWorld::Archetype& RveWorld::GetOrCreateArchetype(Mask mask) {
+		auto found = archetypeLookup.find(mask);
+		if(found != archetypeLookup.end()) {
+			return *found->second;
+		}
+
+		auto archetype = std::make_unique<Archetype>();
+		archetype->mask = mask;
+		size_t rowSize = sizeof(RveEntity);
+		for(RveComponentId id = 0; id < maxComponents; id++) {
+			if(mask & (Mask{1} << id)) {
+				archetype->components.push_back(id);
+				rowSize += GetComponentInfo(id).size;
+			}
+		}
+		archetype->offsets.resize(archetype->components.size());
+
+		// Start from the unpadded estimate and shrink until every array fits after rounding to cache lines
+		for(uint32_t capacity = static_cast<uint32_t>(chunkSize / rowSize); capacity > 0; capacity--) {
+			size_t offset = AlignUp(capacity * sizeof(RveEntity), cacheLineSize);
+			for(size_t column = 0; column < archetype->components.size(); column++) {
+				archetype->offsets[column] = static_cast<uint32_t>(offset);
+				offset = AlignUp(offset + capacity * GetComponentInfo(archetype->components[column]).size, cacheLineSize);
+			}
+			if(offset <= chunkSize) {
+				archetype->capacity = capacity;
+				break;
+			}
+		}
+		if(archetype->capacity == 0) {
+			throw std::runtime_error("(rve_ecs.cpp) Components do not fit in a chunk");
+		}
+
+		Archetype& result = *archetype;
+		archetypeLookup.emplace(mask, archetype.get());
+		archetypes.push_back(std::move(archetype));
+		return result;
+	}
+
+	void RveWorld::AllocateRow(Archetype& archetype, RveEntity entity) {
+		if(archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+			archetype.chunks.push_back({AllocateChunk(), 0});
+		}
+		Chunk& chunk = archetype.chunks.back();
+		Entities(chunk)[chunk.count] = entity;
+		Slot& slot = slots[entity.index];
+		slot.archetype = &archetype;
+		slot.chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+		slot.row = chunk.count;
+		chunk.count++;
+	}
+
+	void RveWorld::RemoveRow(Archetype& archetype, uint32_t chunkIndex, uint32_t row) {
+		Chunk& chunk = archetype.chunks[chunkIndex];
+		Chunk& lastChunk = archetype.chunks.back();
+		const uint32_t lastRow = lastChunk.count - 1;
+		const bool isLast = &chunk == &lastChunk && row == lastRow;
+		for(size_t column = 0; column < archetype.components.size(); column++) {
+			const ComponentInfo& info = GetComponentInfo(archetype.components[column]);
+			void *target = chunk.data + archetype.offsets[column] + row * info.size;
+			info.destroy(target);
+			if(!isLast) {
+				void *source = lastChunk.data + archetype.offsets[column] + lastRow * info.size;
+				info.moveConstruct(target, source);
+				info.destroy(source);
+			}
+		}
+		if(!isLast) {
+			RveEntity moved = Entities(lastChunk)[lastRow];
+			Entities(chunk)[row] = moved;
+			slots[moved.index].chunk = chunkIndex;
+			slots[moved.index].row = row;
+		}
+		lastChunk.count--;
+		if(lastChunk.count == 0) {
+			FreeChunk(lastChunk.data);
+			archetype.chunks.pop_back();
+		}
+	}
+
+	void RveWorld::MoveEntity(RveEntity entity, Archetype& destination) {
+		const Slot source = slots[entity.index];
+		AllocateRow(destination, entity);
+		const Slot& target = slots[entity.index];
+		Chunk& sourceChunk = source.archetype->chunks[source.chunk];
+		Chunk& targetChunk = destination.chunks[target.chunk];
+		for(size_t column = 0; column < source.archetype->components.size(); column++) {
+			RveComponentId id = source.archetype->components[column];
+			int32_t targetColumn = destination.Column(id);
+			if(targetColumn < 0) {
+				continue;
+			}
+			size_t size = GetComponentInfo(id).size;
+			GetComponentInfo(id).moveConstruct(
+				targetChunk.data + destination.offsets[targetColumn] + target.row * size,
+				sourceChunk.data + source.archetype->offsets[column] + source.row * size);
+		}
+		// Moved from components are destroyed with the rest of the old row
+		RemoveRow(*source.archetype, source.chunk, source.row);
+	}
+
+	void RveWorld::BeginStructuralChange() {
+		assert(iterationDepth == 0 && "(rve_ecs.cpp) Structural change during a query, record it in RveEntityCommands instead");
+		int64_t cursor = freeCursor.load(std::memory_order_relaxed);
+		if(cursor == static_cast<int64_t>(freeSlots.size())) {
+			return;
+		}
+		Archetype& empty = *archetypes[0];
+		const size_t reusedFrom = static_cast<size_t>(std::max<int64_t>(cursor, 0));
+		for(size_t freeIndex = reusedFrom; freeIndex < freeSlots.size(); freeIndex++) {
+			uint32_t index = freeSlots[freeIndex];
+			AllocateRow(empty, {index, slots[index].generation});
+			entityCount++;
+		}
+		freeSlots.resize(reusedFrom);
+		if(cursor < 0) {
+			const size_t firstNew = slots.size();
+			slots.resize(firstNew + static_cast<size_t>(-cursor));
+			for(size_t index = firstNew; index < slots.size(); index++) {
+				AllocateRow(empty, {static_cast<uint32_t>(index), 0});
+				entityCount++;
+			}
+		}
+		freeCursor.store(static_cast<int64_t>(freeSlots.size()), std::memory_order_relaxed);
+	}
+
+	void RveEntityCommands::Playback() {
+		// Swapped out first so commands recorded while playing back are kept for the next playback
+		std::vector<std::function<void(RveWorld&)>> pending;
+		pending.swap(commands);
+		for(auto& command : pending) {
+			command(world);
+		}
+	}
+} // namespace rve
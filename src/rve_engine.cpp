@@ -1,4 +1,5 @@
 #include "../include/rve_engine.hpp"
+#include "../include/rve_block_decoder.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -6,11 +7,20 @@
 #include <glm/gtc/constants.hpp>
 #include <stdexcept>
 #include <cassert>
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
 
 namespace rve {
-	RveEngine::RveEngine() {
+	RveEngine::RveEngine(bool printStats) : printStats{printStats} {
 		LoadGameObjects();
+		if(enableShaderHotReload) {
+			shaderWatcher = std::make_unique<RveShaderWatcher>(shaderSourceDirectory, "shaders/");
+		}
 	}
 
 	RveEngine::~RveEngine() {
@@ -18,20 +28,306 @@ namespace rve {
 	}
 
 	void RveEngine::LoadGameObjects() {
-		std::shared_ptr<RveModel> rveModel = Create3DTestModel(
-			rveVulkanDevice, 
-			{0.0f, 0.0f, 0.0f}
-		);
-		auto cube = RveGameObject::CreateGameObject();
-		cube.model = rveModel;
-		cube.transform.translation = {0.0f, 0.0f, 0.5f};
-		cube.transform.scale = {0.5f, 0.5f, 0.5f};
-		rveGameObjects.push_back(std::move(cube));
+		RveModelHandle cubeModel = rveAssets.Create("test cube", [this]() {
+			return Create3DTestModel(rveGeometryPool, {0.0f, 0.0f, 0.0f});
+		});
+		TransformComponent cubeTransform{};
+		cubeTransform.translation = {0.0f, 0.0f, 2.5f};
+		cubeTransform.scale = {0.5f, 0.5f, 0.5f};
+		RveEntity cube = rveWorld.CreateEntity(cubeTransform, ModelComponent{cubeModel}, ColorComponent{});
+		rveSimulation.AddBody(cube, cubeTransform, {0.6f, 0.6f, 0.0f});
+		LoadOrbitingCubes(cubeModel);
+		textures.push_back(CreateCheckerboardTexture(checkerboardSize));
+		modelTextures.push_back({cubeModel, 0});
+
+		if(printStats && vertexFormat == RveVertexFormat::Compact) {
+			auto& report = rveAssets.Get(cubeModel).GetQuantizationReport();
+			std::cout << "Vertex quantization: " << report.floatBytes << " -> " << report.compactBytes << " bytes" << std::endl;
+			std::cout << "\tposition error max " << report.maxPositionError << " mean " << report.meanPositionError << std::endl;
+			std::cout << "\tcolor error max " << report.maxColorError << std::endl;
+			std::cout << "\tnormal error max " << report.maxNormalErrorDegrees << " degrees" << std::endl;
+			std::cout << "\ttexture coordinate error max " << report.maxUvError << std::endl;
+		}
+
+		LoadScalingScene(scalingSceneGridSize);
+		LoadTextureFiles();
+		LoadVirtualTextureFiles();
+		LoadModelFiles();
+	}
+
+	void RveEngine::LoadTextureFiles() {
+		std::error_code error;
+		std::vector<std::string> filePaths;
+		for(const auto& entry : std::filesystem::directory_iterator{textureDirectory, error}) {
+			if(entry.is_regular_file() && entry.path().extension() == RveTexture::extension) {
+				filePaths.push_back(entry.path().string());
+			}
+		}
+		std::sort(filePaths.begin(), filePaths.end());
+
+		for(const std::string& filePath : filePaths) {
+			RveTexture::ImageData image = RveTexture::LoadKtx2(filePath);
+			textures.push_back(std::make_unique<RveTexture>(rveVulkanDevice, image));
+			if(!printStats) {
+				continue;
+			}
+			const RveTexture& texture = *textures.back();
+			const auto& report = texture.GetUploadReport();
+			std::cout << "Texture " << std::filesystem::path{filePath}.filename().string() << ": "
+				<< texture.GetWidth() << "x" << texture.GetHeight() << ", " << texture.GetMipLevels() << " levels, "
+				<< report.memoryBytes / 1024.0f << " KB uploaded in " << report.uploadMilliseconds << " ms"
+				<< (report.decompressed ? " after decompressing, the device cannot sample its format" : "");
+			// Uploads the same levels as RGBA8 once to compare footprint and upload time, then drops them
+			if(RveBlockDecoder::IsSupported(image.format) && !report.decompressed) {
+				RveTexture uncompressed{rveVulkanDevice, RveTexture::Decompress(image), false};
+				const auto& uncompressedReport = uncompressed.GetUploadReport();
+				std::cout << ", as RGBA8 " << uncompressedReport.memoryBytes / 1024.0f << " KB in "
+					<< uncompressedReport.uploadMilliseconds << " ms";
+			}
+			std::cout << std::endl;
+		}
+	}
+
+	void RveEngine::LoadVirtualTextureFiles() {
+		std::error_code error;
+		std::vector<std::string> filePaths;
+		for(const auto& entry : std::filesystem::directory_iterator{virtualTextureDirectory, error}) {
+			if(entry.is_regular_file() && entry.path().extension() == RveVirtualTexture::extension) {
+				filePaths.push_back(entry.path().string());
+			}
+		}
+		if(filePaths.empty()) {
+			return;
+		}
+		std::sort(filePaths.begin(), filePaths.end());
+
+		RveModelHandle planeModel = rveAssets.Create("virtual texture plane", [this]() {
+			return CreatePlaneModel(rveGeometryPool, 16);
+		});
+		for(size_t index = 0; index < filePaths.size(); index++) {
+			auto texture = std::make_shared<RveVirtualTexture>(filePaths[index]);
+			if(printStats) {
+				std::cout << "Virtual texture " << std::filesystem::path{filePaths[index]}.filename().string() << ": "
+					<< texture->GetWidth() << "x" << texture->GetHeight() << ", " << texture->GetMipCount() << " mips, "
+					<< texture->GetPageCount() << " pages, " << texture->GetFileSize() / (1024.0f * 1024.0f) << " MB on disk" << std::endl;
+			}
+			// Side by side below the scene and running away from the camera, so one plane needs every mip at once
+			TransformComponent transform{};
+			transform.scale = glm::vec3{20.0f};
+			transform.translation = {(index - (filePaths.size() - 1) * 0.5f) * 20.0f, 2.0f, 12.0f};
+			virtualTextureEntities.push_back(rveWorld.CreateEntity(transform, ModelComponent{planeModel}, ColorComponent{}));
+			virtualTextures.push_back(std::move(texture));
+		}
+	}
+
+	void RveEngine::RegisterMaterials(RveRenderSystem& renderSystem) {
+		std::vector<uint32_t> materials;
+		for(const auto& texture : textures) {
+			RveMaterial material{};
+			material.textureIndex = renderSystem.RegisterTexture(*texture, rveSamplers.GetSampler());
+			materials.push_back(renderSystem.RegisterMaterial(material));
+		}
+		rveWorld.ForEach<ModelComponent>([&](RveEntity, ModelComponent& modelComponent) {
+			for(const auto& [model, texture] : modelTextures) {
+				if(model == modelComponent.model) {
+					modelComponent.materialIndex = materials[texture];
+				}
+			}
+		});
+		for(size_t index = 0; index < virtualTextures.size(); index++) {
+			RveMaterial material{};
+			material.virtualTextureIndex = renderSystem.RegisterVirtualTexture(virtualTextures[index]);
+			rveWorld.GetComponent<ModelComponent>(virtualTextureEntities[index])->materialIndex = renderSystem.RegisterMaterial(material);
+		}
+	}
+
+	std::unique_ptr<RveTexture> RveEngine::CreateCheckerboardTexture(uint32_t size) {
+		// Single level so the texture generates its mip chain on the GPU
+		std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+		for(uint32_t y = 0; y < size; y++) {
+			for(uint32_t x = 0; x < size; x++) {
+				uint8_t value = ((x / 32) + (y / 32)) % 2 == 0 ? 255 : 96;
+				uint8_t *pixel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+				pixel[0] = pixel[1] = pixel[2] = value;
+				pixel[3] = 255;
+			}
+		}
+		auto texture = std::make_unique<RveTexture>(rveVulkanDevice, RveTexture::FromPixels(size, size, pixels.data()));
+		const auto& report = texture->GetUploadReport();
+		if(printStats) {
+			std::cout << "Checkerboard texture: " << texture->GetMipLevels() << " levels"
+				<< (report.generatedMips ? " generated on the GPU" : "") << ", "
+				<< report.memoryBytes / 1024.0f << " KB uploaded in " << report.uploadMilliseconds << " ms" << std::endl;
+		}
+		return texture;
+	}
+
+	void RveEngine::LoadModelFiles() {
+		std::error_code error;
+		std::vector<std::string> sourcePaths;
+		std::vector<std::string> cachePaths;
+		for(const auto& entry : std::filesystem::directory_iterator{modelDirectory, error}) {
+			if(!entry.is_regular_file()) {
+				continue;
+			}
+			if(RveMeshLoader::IsSupported(entry.path().string())) {
+				sourcePaths.push_back(entry.path().string());
+			} else if(entry.path().extension() == RveMeshCache::extension) {
+				cachePaths.push_back(entry.path().string());
+			}
+		}
+
+		// Sources are imported only when their cache is missing or stale, caches without a source are used as is
+		std::vector<std::string> importPaths;
+		for(const std::string& sourcePath : sourcePaths) {
+			std::string cachePath = std::filesystem::path{sourcePath}.replace_extension(RveMeshCache::extension).string();
+			auto cached = std::find(cachePaths.begin(), cachePaths.end(), cachePath);
+			if(cached == cachePaths.end()) {
+				importPaths.push_back(sourcePath);
+			} else if(!RveMeshCache::IsUpToDate(cachePath, sourcePath)) {
+				cachePaths.erase(cached);
+				importPaths.push_back(sourcePath);
+			}
+		}
+		std::sort(importPaths.begin(), importPaths.end());
+		std::sort(cachePaths.begin(), cachePaths.end());
+
+		// Caches upload only their coarse meshes here, the full meshes stream in once drawn
+		std::vector<std::string> filePaths = cachePaths;
+		filePaths.insert(filePaths.end(), importPaths.begin(), importPaths.end());
+		if(filePaths.empty()) {
+			return;
+		}
+		auto startTime = std::chrono::steady_clock::now();
+		std::vector<RveModelHandle> models = rveAssets.Load(filePaths);
+		if(printStats) {
+			std::cout << "Loaded " << models.size() << " meshes from " << cachePaths.size() << " mesh caches and "
+				<< importPaths.size() << " imported files in "
+				<< std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms"
+				<< (importPaths.empty() ? "" : ", cook with --cook to skip the import") << std::endl;
+		}
+
+		// Lined up behind the test scene, each scaled to a unit radius and drawn with the texture files in turn
+		const size_t textureFiles = textures.size() - 1;
+		for(size_t index = 0; index < models.size(); index++) {
+			if(textureFiles > 0) {
+				modelTextures.push_back({models[index], static_cast<uint32_t>(1 + index % textureFiles)});
+			}
+			const RveModel& model = rveAssets.Get(models[index]);
+			TransformComponent transform{};
+			float scale = model.GetBoundingRadius() > 0.0f ? 1.0f / model.GetBoundingRadius() : 1.0f;
+			transform.scale = glm::vec3{scale};
+			transform.translation = -model.GetBoundingCenter() * scale + glm::vec3{(index - models.size() * 0.5f) * 2.5f, -1.5f, 8.0f};
+			rveWorld.CreateEntity(transform, ModelComponent{models[index]}, ColorComponent{});
+		}
+	}
+
+	void RveEngine::LoadScalingScene(int gridSize) {
+		RveModelHandle sphereModel = rveAssets.Create("scaling sphere", [this]() {
+			return CreateSphereModel(rveGeometryPool, 64, 128, {.2f, .6f, .9f});
+		});
+		const RveModel& sphereMesh = rveAssets.Get(sphereModel);
+		if(printStats) {
+			std::cout << "Scaling scene: " << gridSize * gridSize << " spheres, LOD triangles";
+			for(uint32_t level = 0; level < sphereMesh.GetLodCount(); level++) {
+				std::cout << " " << sphereMesh.GetTriangleCount(level);
+			}
+			std::cout << std::endl;
+		}
+
+		for(int x = 0; x < gridSize; x++) {
+			for(int z = 0; z < gridSize; z++) {
+				TransformComponent transform{};
+				transform.translation = {
+					(x - gridSize * 0.5f) * 1.5f,
+					1.0f,
+					4.0f + z * 3.0f};
+				transform.scale = {0.5f, 0.5f, 0.5f};
+				RveEntity sphere = entityCommands.CreateEntity(transform, ModelComponent{sphereModel}, ColorComponent{{.2f, .6f, .9f}});
+				rveSimulation.AddBody(sphere, transform, {0.6f, 0.6f, 0.0f});
+			}
+		}
+	}
+
+	void RveEngine::LoadOrbitingCubes(RveModelHandle model) {
+		TransformComponent orbit{};
+		orbit.translation = {0.0f, 0.0f, 2.5f};
+		RveTransformHierarchy::Node orbitNode = rveHierarchy.AddNode(orbit);
+		rveSimulation.AddBody(orbitNode, orbit, {0.0f, 1.0f, 0.0f});
+		for(float side : {-1.0f, 1.0f}) {
+			TransformComponent arm{};
+			arm.translation = {side * 0.8f, 0.0f, 0.0f};
+			arm.scale = {0.15f, 0.15f, 0.15f};
+			RveTransformHierarchy::Node armNode = rveHierarchy.AddNode(arm, orbitNode);
+			rveWorld.CreateEntity(HierarchyComponent{armNode}, ModelComponent{model}, ColorComponent{});
+
+			TransformComponent moon{};
+			moon.translation = {0.0f, 2.0f, 0.0f};
+			moon.scale = {0.5f, 0.5f, 0.5f};
+			rveWorld.CreateEntity(HierarchyComponent{rveHierarchy.AddNode(moon, armNode)}, ModelComponent{model}, ColorComponent{});
+		}
+	}
+
+	//TODO: Delete after 3d tests
+	std::unique_ptr<RveModel> RveEngine::CreatePlaneModel(RveGeometryPool& pool, uint32_t quads) {
+		// Unit square in the xz plane facing up, split into a grid so meshlet and occlusion culling have pieces to cull
+		RveModel::Builder modelBuilder{};
+		for(uint32_t row = 0; row <= quads; row++) {
+			for(uint32_t column = 0; column <= quads; column++) {
+				glm::vec2 uv{static_cast<float>(column) / quads, static_cast<float>(row) / quads};
+				modelBuilder.vertices.push_back({{uv.x - 0.5f, 0.0f, uv.y - 0.5f}, {1.0f, 1.0f, 1.0f}, {0.0f, -1.0f, 0.0f}, uv});
+			}
+		}
+		for(uint32_t row = 0; row < quads; row++) {
+			for(uint32_t column = 0; column < quads; column++) {
+				uint32_t a = row * (quads + 1) + column;
+				uint32_t b = a + 1;
+				uint32_t c = a + quads + 1;
+				uint32_t d = c + 1;
+				modelBuilder.indices.insert(modelBuilder.indices.end(), {a, b, c, b, d, c});
+			}
+		}
+		modelBuilder.GenerateMeshlets();
+		modelBuilder.GenerateLods();
+		return std::make_unique<RveModel>(pool, modelBuilder);
+	}
+
+	std::unique_ptr<RveModel> RveEngine::CreateSphereModel(RveGeometryPool& pool, uint32_t rings, uint32_t segments, glm::vec3 color) {
+		RveModel::Builder modelBuilder{};
+		modelBuilder.vertices.push_back({{0.0f, -1.0f, 0.0f}, color, {0.0f, -1.0f, 0.0f}, {0.5f, 1.0f}});
+		for(uint32_t ring = 1; ring < rings; ring++) {
+			float phi = glm::pi<float>() * ring / rings;
+			for(uint32_t segment = 0; segment < segments; segment++) {
+				float theta = glm::two_pi<float>() * segment / segments;
+				glm::vec3 position{glm::sin(phi) * glm::cos(theta), -glm::cos(phi), glm::sin(phi) * glm::sin(theta)};
+				modelBuilder.vertices.push_back({position, color, position, {static_cast<float>(segment) / segments, 1.0f - static_cast<float>(ring) / rings}});
+			}
+		}
+		modelBuilder.vertices.push_back({{0.0f, 1.0f, 0.0f}, color, {0.0f, 1.0f, 0.0f}, {0.5f, 0.0f}});
+
+		auto& indices = modelBuilder.indices;
+		const uint32_t bottom = static_cast<uint32_t>(modelBuilder.vertices.size()) - 1;
+		auto ringVertex = [&](uint32_t ring, uint32_t segment) { return 1 + (ring - 1) * segments + segment % segments; };
+		for(uint32_t segment = 0; segment < segments; segment++) {
+			indices.insert(indices.end(), {0, ringVertex(1, segment), ringVertex(1, segment + 1)});
+			for(uint32_t ring = 1; ring + 1 < rings; ring++) {
+				uint32_t a = ringVertex(ring, segment);
+				uint32_t b = ringVertex(ring, segment + 1);
+				uint32_t c = ringVertex(ring + 1, segment);
+				uint32_t d = ringVertex(ring + 1, segment + 1);
+				indices.insert(indices.end(), {a, b, c, b, d, c});
+			}
+			indices.insert(indices.end(), {ringVertex(rings - 1, segment), bottom, ringVertex(rings - 1, segment + 1)});
+		}
+		modelBuilder.GenerateMeshlets();
+		modelBuilder.GenerateLods();
+		return std::make_unique<RveModel>(pool, modelBuilder);
 	}
 
 	//TODO: Delete after 3d tests
-	std::unique_ptr<RveModel> RveEngine::Create3DTestModel(RveVulkanDevice& device, glm::vec3 offset) {
-		std::vector<RveModel::Vertex> vertices{
+	std::unique_ptr<RveModel> RveEngine::Create3DTestModel(RveGeometryPool& pool, glm::vec3 offset) {
+		RveModel::Builder modelBuilder{};
+		modelBuilder.vertices = {
 			// left face (white)
 			{{-.5f, -.5f, -.5f}, {.9f, .9f, .9f}},
 			{{-.5f, .5f, .5f}, {.9f, .9f, .9f}},
@@ -81,25 +377,210 @@ namespace rve {
 			{{.5f, .5f, -0.5f}, {.1f, .8f, .1f}},
 
 		};
+		auto& vertices = modelBuilder.vertices;
 		for (auto& v : vertices) {
 			v.position += offset;
 		}
-		return std::make_unique<RveModel>(device, vertices);
+		for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+			glm::vec3 normal = glm::normalize(glm::cross(
+				vertices[i + 1].position - vertices[i].position,
+				vertices[i + 2].position - vertices[i].position));
+			vertices[i].normal = vertices[i + 1].normal = vertices[i + 2].normal = normal;
+			// Each face maps the whole texture, projected along its normal
+			int axis = glm::abs(normal.x) > 0.5f ? 0 : glm::abs(normal.y) > 0.5f ? 1 : 2;
+			for(size_t corner = i; corner < i + 3; corner++) {
+				glm::vec3 local = vertices[corner].position - offset + 0.5f;
+				vertices[corner].uv = {local[(axis + 1) % 3], local[(axis + 2) % 3]};
+			}
+		}
+		return std::make_unique<RveModel>(pool, modelBuilder);
 	} //TODO: Delete after 3d tests
 
+	bool RveEngine::DrawFrame(RveRenderSystem& renderSystem, RveCamera& camera, float frameTime) {
+		float aspect = rveRenderer.GetAspectRatio();
+		camera.SetPerspectiveProjection(glm::radians(50.0f), aspect, 0.1f, 100.0f);
+
+		auto commandBuffer = rveRenderer.BeginFrame();
+		if(!commandBuffer) {
+			return false;
+		}
+		int frameIndex = rveRenderer.GetFrameIndex();
+		if(shaderWatcher != nullptr) {
+			for(const auto& shaderPath : shaderWatcher->TakeCompiledShaders()) {
+				rvePipelineRegistry.ReloadShader(shaderPath);
+			}
+		}
+		rvePipelineRegistry.BeginFrame();
+		entityCommands.Playback();
+		rveAssets.Update();
+		rveResidency.Update();
+		rveGeometryPool.Update(commandBuffer);
+		rveSimulation.Interpolate(rveWorld, rveHierarchy);
+		rveHierarchy.Update();
+		RveFrameInfo frameInfo{
+			frameIndex,
+			frameTime,
+			commandBuffer,
+			camera,
+			rveRenderer.GetSwapChainExtent()
+		};
+		renderSystem.PrepareFrame(frameInfo, rveWorld, rveHierarchy);
+		rveRenderer.BeginSwapChainRenderPass(commandBuffer);
+		renderSystem.RenderGameObjects(frameInfo, RveDrawPhase::Early);
+		rveRenderer.EndSwapChainRenderPass(commandBuffer);
+		renderSystem.CullOccluded(frameInfo, rveRenderer.GetCurrentDepthImageView());
+		rveRenderer.ResumeSwapChainRenderPass(commandBuffer);
+		renderSystem.RenderGameObjects(frameInfo, RveDrawPhase::Late);
+		rveRenderer.EndSwapChainRenderPass(commandBuffer);
+		renderSystem.FinishFrame(frameInfo);
+		rveRenderer.EndFrame();
+		return true;
+	}
+
 	void RveEngine::Run() {
-		RveRenderSystem renderSystem{rveVulkanDevice, rveRenderer.GetSwapChainRenderPass()};
+		RveRenderSystem renderSystem{rveVulkanDevice, rvePipelineRegistry, rveJobSystem, rveAssets, rveSamplers, rveRenderer.GetSwapChainRenderPass(), vertexFormat};
+		RegisterMaterials(renderSystem);
+		RveCamera camera{};
+		camera.SetViewDirection(glm::vec3{0.0f}, glm::vec3{0.0f, 0.0f, 1.0f});
+
+		auto currentTime = std::chrono::high_resolution_clock::now();
+		float statsTimer = 0.0f;
+		uint32_t statsFrames = 0;
+		uint64_t statsTicks = rveSimulation.GetTickCount();
 
 		while(!rveWindow.ShouldClose()) {
 			glfwPollEvents();
-			
-			if(auto commandBuffer = rveRenderer.BeginFrame()) {
-				rveRenderer.BeginSwapChainRenderPass(commandBuffer);
-				renderSystem.RenderGameObjects(commandBuffer, rveGameObjects);
-				rveRenderer.EndSwapChainRenderPass(commandBuffer);
-				rveRenderer.EndFrame();
+
+			auto newTime = std::chrono::high_resolution_clock::now();
+			float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
+			currentTime = newTime;
+
+			if(DrawFrame(renderSystem, camera, frameTime)) {
+				statsFrames++;
+			}
+
+			statsTimer += frameTime;
+			if(statsTimer >= statsInterval) {
+				uint64_t ticks = rveSimulation.GetTickCount();
+				if(printStats) {
+					PrintStats(renderSystem, statsTimer, statsFrames, ticks - statsTicks);
+				}
+				statsTimer = 0.0f;
+				statsFrames = 0;
+				statsTicks = ticks;
 			}
 		}
 		vkDeviceWaitIdle(rveVulkanDevice.Device());
 	}
+
+	int RveEngine::RunPipelineBenchmark(uint32_t variants) {
+		RveRenderSystem renderSystem{rveVulkanDevice, rvePipelineRegistry, rveJobSystem, rveAssets, rveSamplers, rveRenderer.GetSwapChainRenderPass(), vertexFormat};
+		RegisterMaterials(renderSystem);
+		RveCamera camera{};
+		camera.SetViewDirection(glm::vec3{0.0f}, glm::vec3{0.0f, 0.0f, 1.0f});
+
+		// Milliseconds per frame, requestVariant runs before each frame. A phase lasts until its compiles finished.
+		auto currentTime = std::chrono::high_resolution_clock::now();
+		float frameTime = 0.0f;
+		auto runPhase = [&](uint32_t minFrames, const std::function<void(uint32_t)>& requestVariant) {
+			std::vector<float> frameTimes;
+			while(!rveWindow.ShouldClose() && (frameTimes.size() < minFrames || rvePipelineRegistry.GetStats().pending > 0)) {
+				glfwPollEvents();
+				requestVariant(static_cast<uint32_t>(frameTimes.size()));
+				DrawFrame(renderSystem, camera, frameTime);
+				auto newTime = std::chrono::high_resolution_clock::now();
+				frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
+				currentTime = newTime;
+				frameTimes.push_back(frameTime * 1000.0f);
+			}
+			std::sort(frameTimes.begin(), frameTimes.end());
+			return frameTimes;
+		};
+		auto percentile = [](const std::vector<float>& sorted, float share) {
+			return sorted.empty() ? 0.0f : sorted[std::min(sorted.size() - 1, static_cast<size_t>(share * sorted.size()))];
+		};
+		auto report = [&](const char *phase, const std::vector<float>& sorted) {
+			std::cout << phase << ": " << sorted.size() << " frames, p50 " << percentile(sorted, 0.5f)
+				<< " ms, p95 " << percentile(sorted, 0.95f) << " ms, p99 " << percentile(sorted, 0.99f)
+				<< " ms, max " << (sorted.empty() ? 0.0f : sorted.back()) << " ms" << std::endl;
+		};
+
+		// One new variant per frame, the way materials first appear while playing
+		const uint32_t phaseFrames = std::max(variants, pipelineBenchmarkFrames);
+		runPhase(pipelineBenchmarkFrames, [](uint32_t) {});
+		std::vector<float> baseline = runPhase(phaseFrames, [](uint32_t) {});
+		std::vector<float> async = runPhase(phaseFrames, [&](uint32_t frame) {
+			if(frame < variants) {
+				renderSystem.RequestTaggedVariant(frame, false);
+			}
+		});
+		std::vector<float> blocking = runPhase(phaseFrames, [&](uint32_t frame) {
+			if(frame < variants) {
+				renderSystem.RequestTaggedVariant(variants + frame, true);
+			}
+		});
+		vkDeviceWaitIdle(rveVulkanDevice.Device());
+
+		std::cout << variants << " pipeline variants, " << rvePipelineRegistry.GetStats().variants << " in the registry" << std::endl;
+		report("no compiles", baseline);
+		report("background compiles", async);
+		report("blocking compiles", blocking);
+		bool spiked = percentile(async, 0.99f) > percentile(baseline, 0.99f) * pipelineBenchmarkSpikeRatio;
+		std::cout << "Background compiles " << (spiked ? "SPIKED" : "kept") << " the p99 frame time "
+			<< (spiked ? "above " : "within ") << pipelineBenchmarkSpikeRatio << "x of no compiles" << std::endl;
+		return spiked ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+
+	void RveEngine::PrintStats(const RveRenderSystem& renderSystem, float seconds, uint32_t frames, uint64_t ticks) {
+		const auto& stats = renderSystem.GetStats();
+		const float megabyte = 1024.0f * 1024.0f;
+		std::cout << "frame: fps " << frames / seconds
+			<< ", simulation hz " << ticks / seconds << std::endl;
+		std::cout << "draw: objects " << stats.objectsDrawn
+			<< ", triangles " << stats.trianglesRendered
+			<< " (without LOD " << stats.trianglesFullDetail << ")"
+			<< ", descriptor writes " << stats.descriptorSetWrites
+			<< ", frame ring bytes " << stats.frameRingBytes << std::endl;
+		std::cout << "meshlets: visible " << stats.meshlets.meshletsVisible << "/" << stats.meshlets.meshletsTotal
+			<< ", frustum culled " << stats.meshlets.frustumCulled
+			<< ", cone culled " << stats.meshlets.coneCulled << std::endl;
+		std::cout << "occlusion: early " << stats.occlusion.drawnEarly
+			<< ", late " << stats.occlusion.drawnLate
+			<< ", frustum culled " << stats.occlusion.frustumCulled
+			<< ", occluded " << stats.occlusion.occlusionCulled << std::endl;
+		std::cout << "bvh: culled " << stats.spatialCulled
+			<< ", nodes visited " << stats.spatial.nodesVisited
+			<< ", rebuilds " << stats.spatial.rebuilds << std::endl;
+		auto samplerStats = rveSamplers.GetStats();
+		std::cout << "bindless: buffers " << stats.bindless.storageBuffers
+			<< ", textures " << stats.bindless.textures
+			<< ", samplers " << samplerStats.samplers << "/" << samplerStats.requests << std::endl;
+		std::cout << "virtual texturing: resident pages " << stats.virtualTexturing.residentPages << "/" << stats.virtualTexturing.physicalPages
+			<< ", requested " << stats.virtualTexturing.requestedPages
+			<< ", loading " << stats.virtualTexturing.loadingPages
+			<< ", evicted " << stats.virtualTexturing.evictions << std::endl;
+		auto jobStats = rveJobSystem.GetStats();
+		std::cout << "jobs: run " << jobStats.jobsRun
+			<< ", stolen " << jobStats.steals << std::endl;
+		auto assetStats = rveAssets.GetStats();
+		std::cout << "assets: models " << assetStats.models
+			<< ", shared requests " << assetStats.deduplicated << "/" << assetStats.requests
+			<< ", freed " << assetStats.freed << std::endl;
+		auto residencyStats = rveResidency.GetStats();
+		std::cout << "streaming: resident meshes " << residencyStats.residentMeshes << "/" << residencyStats.meshes
+			<< ", loading " << residencyStats.loadingMeshes
+			<< ", evicted " << residencyStats.evictions
+			<< ", MB " << residencyStats.residentBytes / megabyte << "/" << residencyStats.budgetBytes / megabyte << std::endl;
+		auto poolStats = rveGeometryPool.GetStats();
+		std::cout << "geometry pool: meshes " << poolStats.liveMeshes
+			<< ", vertices " << poolStats.usedVertices << "/" << poolStats.vertexCapacity
+			<< ", indices " << poolStats.usedIndices << "/" << poolStats.indexCapacity
+			<< ", uploaded MB " << poolStats.uploadBytes / megabyte
+			<< ", defragmentations " << poolStats.defragmentations << std::endl;
+		std::cout << "deletion queue: pending " << rveVulkanDevice.GetDeletionQueue().GetStats().pending << std::endl;
+		std::cout << "hierarchy: nodes updated " << rveHierarchy.GetStats().nodesUpdated << "/" << rveHierarchy.GetStats().nodes << std::endl;
+		std::cout << "pipelines: variants " << rvePipelineRegistry.GetStats().variants
+			<< ", compiling " << rvePipelineRegistry.GetStats().pending
+			<< ", failed " << rvePipelineRegistry.GetStats().compileFailures << std::endl;
+	}
 } // namespace rve
@@ -0,0 +1,48 @@
+#include "../include/rve_frame_ring.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace rve {
+	RveFrameRing::RveFrameRing(RveVulkanDevice& device, VkDeviceSize bytesPerFrame) {
+		const VkPhysicalDeviceLimits& limits = device.properties.limits;
+		alignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+		capacity = RveBuffer::GetAlignment(bytesPerFrame, alignment);
+		for(auto& buffer : buffers) {
+			buffer = std::make_unique<RveBuffer>(
+				device,
+				capacity,
+				1,
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			if(buffer->Map() != VK_SUCCESS) {
+				throw std::runtime_error("(rve_frame_ring.cpp) Failed to map frame ring buffer");
+			}
+		}
+	}
+
+	void RveFrameRing::BeginFrame(int frameIndex) {
+		currentFrame = frameIndex;
+		head = 0;
+	}
+
+	RveFrameRing::Allocation RveFrameRing::Allocate(VkDeviceSize size) {
+		VkDeviceSize offset = head;
+		VkDeviceSize end = offset + RveBuffer::GetAlignment(size, alignment);
+		if(end > capacity) {
+			throw std::runtime_error("(rve_frame_ring.cpp) Frame ring out of space");
+		}
+		head = end;
+		peak = std::max(peak, head);
+		Allocation allocation{};
+		allocation.data = static_cast<char*>(buffers[currentFrame]->GetMappedMemory()) + offset;
+		allocation.offset = static_cast<uint32_t>(offset);
+		return allocation;
+	}
+
+	VkDescriptorBufferInfo RveFrameRing::DescriptorInfo(VkDeviceSize range) const {
+		assert(range <= capacity && "(rve_frame_ring.cpp) Descriptor range exceeds frame ring capacity");
+		return buffers[currentFrame]->DescriptorInfo(range, 0);
+	}
+} // namespace rve
@@ -0,0 +1,375 @@
+#include "../include/rve_geometry_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace rve {
+	RveGeometryPool::RveGeometryPool(
+		RveVulkanDevice& device,
+		RveVertexFormat format,
+		uint32_t initialVertexCapacity,
+		uint32_t initialIndexCapacity) :
+		rveVulkanDevice{device},
+		vertexFormat{format},
+		vertexCapacity{std::max(initialVertexCapacity, 1u)},
+		indexCapacity{std::max(initialIndexCapacity, 1u)} {
+			vertexStride = RveModel::Vertex::GetBindingDescriptions(vertexFormat)[0].stride;
+			CreateBuffers(vertexCapacity, indexCapacity, vertexBuffer, vertexBufferMemory, indexBuffer, indexBufferMemory);
+			vertexAllocator.Reset(vertexCapacity, 0);
+			indexAllocator.Reset(indexCapacity, 0);
+			stagingRing = std::make_unique<RveBuffer>(
+				rveVulkanDevice,
+				stagingRingSize,
+				1,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			if(stagingRing->Map() != VK_SUCCESS) {
+				throw std::runtime_error("(rve_geometry_pool.cpp) Failed to map staging ring");
+			}
+	}
+
+	RveGeometryPool::~RveGeometryPool() {
+		RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		for(const ReplacedBuffer& replaced : replacedBuffers) {
+			deletionQueue.DestroyBuffer(replaced.buffer);
+			deletionQueue.FreeMemory(replaced.memory);
+		}
+		deletionQueue.DestroyBuffer(vertexBuffer);
+		deletionQueue.FreeMemory(vertexBufferMemory);
+		deletionQueue.DestroyBuffer(indexBuffer);
+		deletionQueue.FreeMemory(indexBufferMemory);
+	}
+
+	void RveGeometryPool::CreateBuffers(
+		uint32_t newVertexCapacity,
+		uint32_t newIndexCapacity,
+		VkBuffer &newVertexBuffer,
+		VkDeviceMemory &newVertexMemory,
+		VkBuffer &newIndexBuffer,
+		VkDeviceMemory &newIndexMemory) {
+			rveVulkanDevice.CreateBuffer(
+				vertexStride * newVertexCapacity,
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				newVertexBuffer,
+				newVertexMemory);
+			rveVulkanDevice.CreateBuffer(
+				sizeof(uint32_t) * newIndexCapacity,
+				VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				newIndexBuffer,
+				newIndexMemory);
+	}
+
+	RveGeometryPool::handle_t RveGeometryPool::Allocate(
+		const void *vertexData,
+		uint32_t vertexCount,
+		const uint32_t *indexData,
+		uint32_t indexCount) {
+			assert(vertexCount > 0 && "(rve_geometry_pool.cpp) Cannot allocate an empty mesh");
+			ReleaseRetired();
+			Range range{};
+			range.vertexCount = vertexCount;
+			range.indexCount = indexCount;
+
+			bool fits = vertexAllocator.Allocate(vertexCount, range.firstVertex);
+			if(fits && indexCount > 0 && !indexAllocator.Allocate(indexCount, range.firstIndex)) {
+				vertexAllocator.Release(range.firstVertex, vertexCount);
+				fits = false;
+			}
+			if(!fits) {
+				Stats stats = GetStats();
+				Repack(
+					GrowCapacity(vertexCapacity, uint64_t{stats.usedVertices} + vertexCount),
+					GrowCapacity(indexCapacity, uint64_t{stats.usedIndices} + indexCount));
+				if(!vertexAllocator.Allocate(vertexCount, range.firstVertex) ||
+					(indexCount > 0 && !indexAllocator.Allocate(indexCount, range.firstIndex))) {
+						throw std::runtime_error("(rve_geometry_pool.cpp) Failed to allocate mesh range");
+				}
+			}
+
+			Upload(vertexBuffer, vertexStride * range.firstVertex, vertexData, vertexStride * vertexCount);
+			if(indexCount > 0) {
+				Upload(indexBuffer, sizeof(uint32_t) * range.firstIndex, indexData, sizeof(uint32_t) * indexCount);
+			}
+
+			handle_t handle;
+			if(!freeHandles.empty()) {
+				handle = freeHandles.back();
+				freeHandles.pop_back();
+				ranges[handle] = range;
+				rangeAlive[handle] = true;
+			} else {
+				handle = static_cast<handle_t>(ranges.size());
+				ranges.push_back(range);
+				rangeAlive.push_back(true);
+			}
+			return handle;
+	}
+
+	void RveGeometryPool::Free(handle_t handle) {
+		assert(handle < ranges.size() && rangeAlive[handle] && "(rve_geometry_pool.cpp) Freeing an invalid mesh handle");
+		// Frames in flight may still draw the range, it stays allocated until they retire
+		pendingFrees.push_back({handle, rveVulkanDevice.GetDeletionQueue().GetFrame()});
+	}
+
+	void RveGeometryPool::ReleaseRetired() {
+		const RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		size_t released = 0;
+		for(; released < pendingFrees.size() && deletionQueue.IsRetired(pendingFrees[released].frame); released++) {
+			handle_t handle = pendingFrees[released].handle;
+			const Range& range = ranges[handle];
+			vertexAllocator.Release(range.firstVertex, range.vertexCount);
+			indexAllocator.Release(range.firstIndex, range.indexCount);
+			ranges[handle] = {};
+			rangeAlive[handle] = false;
+			freeHandles.push_back(handle);
+		}
+		pendingFrees.erase(pendingFrees.begin(), pendingFrees.begin() + released);
+	}
+
+	uint32_t RveGeometryPool::GrowCapacity(uint32_t capacity, uint64_t required) {
+		constexpr uint64_t maxCapacity = std::numeric_limits<uint32_t>::max();
+		if(required > maxCapacity) {
+			throw std::runtime_error("(rve_geometry_pool.cpp) Geometry pool cannot hold more than 2^32 - 1 elements");
+		}
+		uint64_t grown = std::max(capacity, 1u);
+		while(grown < required) {
+			grown *= 2;
+		}
+		return static_cast<uint32_t>(std::min(grown, maxCapacity));
+	}
+
+	// Worth a repack once a good share of the capacity is free but split so that the largest block is small
+	bool RveGeometryPool::IsFragmented() const {
+		auto fragmented = [](const RveRangeAllocator& allocator, uint32_t capacity) {
+			uint64_t freeCount = allocator.FreeCount();
+			return freeCount >= capacity * defragmentFreeRatio && uint64_t{allocator.LargestBlock()} * 2 < freeCount;
+		};
+		return fragmented(vertexAllocator, vertexCapacity) || fragmented(indexAllocator, indexCapacity);
+	}
+
+	void RveGeometryPool::Update(VkCommandBuffer commandBuffer) {
+		ReleaseRetired();
+		RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		// One repack at a time, each keeps a second set of buffers alive until its frame retires
+		if(replacedBuffers.empty() && deletionQueue.IsRetired(lastRepackFrame) && IsFragmented()) {
+			Repack(vertexCapacity, indexCapacity);
+			defragmentations++;
+		}
+		if(pendingCopies.empty() && replacedBuffers.empty()) {
+			return;
+		}
+
+		VkMemoryBarrier transferBarrier{};
+		transferBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		transferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		transferBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+		for(const PendingCopy& copy : pendingCopies) {
+			if(copy.barrierBefore) {
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0, 1, &transferBarrier, 0, nullptr, 0, nullptr);
+			}
+			vkCmdCopyBuffer(commandBuffer, copy.srcBuffer, copy.dstBuffer, 1, &copy.region);
+		}
+
+		if(!pendingCopies.empty()) {
+			VkMemoryBarrier drawBarrier{};
+			drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			drawBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			drawBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+				0, 1, &drawBarrier, 0, nullptr, 0, nullptr);
+		}
+
+		// Staging and replaced buffers are tagged with the frame whose command buffer reads them
+		uint64_t frame = deletionQueue.GetFrame();
+		for(auto span = stagingSpans.rbegin(); span != stagingSpans.rend() && span->frame == noFrame; span++) {
+			span->frame = frame;
+		}
+		overflowStaging.clear();
+		if(!replacedBuffers.empty()) {
+			for(const ReplacedBuffer& replaced : replacedBuffers) {
+				deletionQueue.DestroyBuffer(replaced.buffer);
+				deletionQueue.FreeMemory(replaced.memory);
+			}
+			replacedBuffers.clear();
+			lastRepackFrame = frame;
+		}
+		pendingCopies.clear();
+	}
+
+	void RveGeometryPool::Repack(uint32_t newVertexCapacity, uint32_t newIndexCapacity) {
+		VkBuffer newVertexBuffer;
+		VkDeviceMemory newVertexMemory;
+		VkBuffer newIndexBuffer;
+		VkDeviceMemory newIndexMemory;
+		CreateBuffers(newVertexCapacity, newIndexCapacity, newVertexBuffer, newVertexMemory, newIndexBuffer, newIndexMemory);
+
+		// Staged copies into the old buffers have to land before the live ranges are moved out of them
+		bool barrierBefore = !pendingCopies.empty();
+		auto addCopy = [&](VkBuffer srcBuffer, VkBuffer dstBuffer, VkBufferCopy region) {
+			pendingCopies.push_back({srcBuffer, dstBuffer, region, barrierBefore});
+			barrierBefore = false;
+		};
+		uint32_t nextVertex = 0;
+		uint32_t nextIndex = 0;
+		for(size_t i = 0; i < ranges.size(); i++) {
+			if(!rangeAlive[i]) {
+				continue;
+			}
+			Range& range = ranges[i];
+			addCopy(vertexBuffer, newVertexBuffer, {
+				vertexStride * range.firstVertex,
+				vertexStride * nextVertex,
+				vertexStride * range.vertexCount});
+			range.firstVertex = nextVertex;
+			nextVertex += range.vertexCount;
+
+			if(range.indexCount > 0) {
+				addCopy(indexBuffer, newIndexBuffer, {
+					sizeof(uint32_t) * range.firstIndex,
+					sizeof(uint32_t) * nextIndex,
+					sizeof(uint32_t) * range.indexCount});
+				range.firstIndex = nextIndex;
+				nextIndex += range.indexCount;
+			}
+		}
+
+		// Frames in flight and the copies above still read the old buffers
+		replacedBuffers.push_back({vertexBuffer, vertexBufferMemory});
+		replacedBuffers.push_back({indexBuffer, indexBufferMemory});
+		vertexBuffer = newVertexBuffer;
+		vertexBufferMemory = newVertexMemory;
+		indexBuffer = newIndexBuffer;
+		indexBufferMemory = newIndexMemory;
+		vertexCapacity = newVertexCapacity;
+		indexCapacity = newIndexCapacity;
+		vertexAllocator.Reset(vertexCapacity, nextVertex);
+		indexAllocator.Reset(indexCapacity, nextIndex);
+	}
+
+	bool RveGeometryPool::AllocateStaging(VkDeviceSize size, VkDeviceSize &offset) {
+		const RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		while(!stagingSpans.empty() && stagingSpans.front().frame != noFrame && deletionQueue.IsRetired(stagingSpans.front().frame)) {
+			stagingSpans.pop_front();
+		}
+		size = RveBuffer::GetAlignment(size, 16);
+		if(size > stagingRingSize) {
+			return false;
+		}
+		if(stagingSpans.empty()) {
+			offset = 0;
+		} else {
+			const StagingSpan& tail = stagingSpans.front();
+			const StagingSpan& head = stagingSpans.back();
+			VkDeviceSize end = head.offset + head.size;
+			if(head.offset >= tail.offset) {
+				// Not wrapped, free space is behind the head and in front of the tail
+				if(end + size <= stagingRingSize) {
+					offset = end;
+				} else if(size <= tail.offset) {
+					offset = 0;
+				} else {
+					return false;
+				}
+			} else if(end + size <= tail.offset) {
+				offset = end;
+			} else {
+				return false;
+			}
+		}
+		stagingSpans.push_back({offset, size, noFrame});
+		return true;
+	}
+
+	void RveGeometryPool::Upload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size) {
+		VkBuffer srcBuffer;
+		VkDeviceSize srcOffset = 0;
+		if(AllocateStaging(size, srcOffset)) {
+			memcpy(static_cast<char*>(stagingRing->GetMappedMemory()) + srcOffset, data, static_cast<size_t>(size));
+			srcBuffer = stagingRing->GetBuffer();
+		} else {
+			// Meshes larger than the ring, or more data than it holds staged before a frame records it
+			auto staging = std::make_unique<RveBuffer>(
+				rveVulkanDevice,
+				size,
+				1,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			if(staging->Map() != VK_SUCCESS) {
+				throw std::runtime_error("(rve_geometry_pool.cpp) Failed to map staging buffer");
+			}
+			staging->WriteToBuffer(data, size);
+			srcBuffer = staging->GetBuffer();
+			overflowStaging.push_back(std::move(staging));
+			overflowBytes += size;
+		}
+		uploadBytes += size;
+		pendingCopies.push_back({srcBuffer, dstBuffer, {srcOffset, dstOffset, size}, false});
+	}
+
+	void RveGeometryPool::Bind(VkCommandBuffer commandBuffer) {
+		VkBuffer buffers[] = {vertexBuffer};
+		VkDeviceSize offsets[] = {0};
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+	}
+
+	void RveGeometryPool::Draw(VkCommandBuffer commandBuffer, handle_t handle, uint32_t instanceCount) {
+		const Range& range = ranges[handle];
+		if(range.indexCount > 0) {
+			vkCmdDrawIndexed(
+				commandBuffer,
+				range.indexCount,
+				instanceCount,
+				range.firstIndex,
+				static_cast<int32_t>(range.firstVertex),
+				0);
+		} else {
+			vkCmdDraw(commandBuffer, range.vertexCount, instanceCount, range.firstVertex, 0);
+		}
+	}
+
+	void RveGeometryPool::DrawIndexRange(
+		VkCommandBuffer commandBuffer,
+		handle_t handle,
+		uint32_t indexOffset,
+		uint32_t indexCount,
+		uint32_t instanceCount) {
+			const Range& range = ranges[handle];
+			assert(indexOffset + indexCount <= range.indexCount && "(rve_geometry_pool.cpp) Index range outside of mesh");
+			vkCmdDrawIndexed(
+				commandBuffer,
+				indexCount,
+				instanceCount,
+				range.firstIndex + indexOffset,
+				static_cast<int32_t>(range.firstVertex),
+				0);
+	}
+
+	RveGeometryPool::Stats RveGeometryPool::GetStats() const {
+		Stats stats{};
+		stats.vertexCapacity = vertexCapacity;
+		stats.indexCapacity = indexCapacity;
+		stats.usedVertices = vertexCapacity - vertexAllocator.FreeCount();
+		stats.usedIndices = indexCapacity - indexAllocator.FreeCount();
+		stats.freeVertexBlocks = static_cast<uint32_t>(vertexAllocator.BlockCount());
+		stats.freeIndexBlocks = static_cast<uint32_t>(indexAllocator.BlockCount());
+		stats.liveMeshes = static_cast<uint32_t>(ranges.size() - freeHandles.size() - pendingFrees.size());
+		stats.retiringMeshes = static_cast<uint32_t>(pendingFrees.size());
+		stats.uploadBytes = uploadBytes;
+		stats.overflowBytes = overflowBytes;
+		stats.defragmentations = defragmentations;
+		return stats;
+	}
+} // namespace rve
@@ -0,0 +1,311 @@
+#include "../include/rve_job_system.hpp"
+
+#include <algorithm>
+
+namespace rve {
+	struct RveJob {
+		RveJobSystem::Job task;
+		RveJobCounter *counter = nullptr;
+	};
+
+	namespace {
+		thread_local const RveJobSystem *currentSystem = nullptr;
+		thread_local uint32_t currentWorker = 0;
+		constexpr uint32_t noWorker = ~0u;
+	}
+
+	bool RveJobCounter::IsDone() {
+		if(pending.load(std::memory_order_acquire) != 0) {
+			return false;
+		}
+		// The job that reached zero may still be releasing continuations under the lock, taking it once
+		// makes it safe for the caller to destroy the counter
+		std::lock_guard<std::mutex> lock{mutex};
+		return true;
+	}
+
+	bool RveJobSystem::Deque::Push(RveJob *job) {
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		if(b - t >= capacity) {
+			return false;
+		}
+		jobs[b & (capacity - 1)].store(job, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	RveJob *RveJobSystem::Deque::Pop() {
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+		if(t > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		RveJob *job = jobs[b & (capacity - 1)].load(std::memory_order_relaxed);
+		if(t == b) {
+			// Last job, race the thieves for it
+			if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	RveJob *RveJobSystem::Deque::Steal() {
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+		if(t >= b) {
+			return nullptr;
+		}
+		RveJob *job = jobs[t & (capacity - 1)].load(std::memory_order_acquire);
+		if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+	uint32_t RveJobSystem::DefaultWorkerCount() {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		return std::max(1u, hardwareThreads > 1 ? hardwareThreads - 1 : 1u);
+	}
+
+	RveJobSystem::RveJobSystem(uint32_t workerCount) {
+		currentSystem = this;
+		currentWorker = 0;
+		for(uint32_t index = 0; index <= workerCount; index++) {
+			workers.push_back(std::make_unique<Worker>());
+			workers.back()->randomState = index * 0x9E3779B9u + 1;
+		}
+		for(uint32_t index = 1; index <= workerCount; index++) {
+			workers[index]->thread = std::thread(&RveJobSystem::WorkerLoop, this, index);
+		}
+	}
+
+	RveJobSystem::~RveJobSystem() {
+		stopping.store(true, std::memory_order_seq_cst);
+		wakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+		wakeEpoch.notify_all();
+		for(size_t index = 1; index < workers.size(); index++) {
+			workers[index]->thread.join();
+		}
+		// Jobs nobody waited for are dropped unrun
+		for(const auto& worker : workers) {
+			while(RveJob *job = worker->deque.Pop()) {
+				delete job;
+			}
+		}
+		for(RveJob *job : injectedJobs) {
+			delete job;
+		}
+		if(currentSystem == this) {
+			currentSystem = nullptr;
+		}
+	}
+
+	uint32_t RveJobSystem::CurrentWorker() const {
+		return currentSystem == this ? currentWorker : noWorker;
+	}
+
+	void RveJobSystem::Schedule(Job job, RveJobCounter *counter) {
+		if(counter != nullptr) {
+			counter->pending.fetch_add(1, std::memory_order_relaxed);
+		}
+		Submit(new RveJob{std::move(job), counter});
+	}
+
+	void RveJobSystem::ScheduleAfter(RveJobCounter& dependency, Job job, RveJobCounter *counter) {
+		if(counter != nullptr) {
+			counter->pending.fetch_add(1, std::memory_order_relaxed);
+		}
+		RveJob *held = new RveJob{std::move(job), counter};
+		{
+			std::lock_guard<std::mutex> lock{dependency.mutex};
+			if(dependency.pending.load(std::memory_order_acquire) != 0) {
+				dependency.continuations.push_back(held);
+				return;
+			}
+		}
+		Submit(held);
+	}
+
+	void RveJobSystem::Submit(RveJob *job) {
+		uint32_t workerIndex = CurrentWorker();
+		if(workerIndex != noWorker) {
+			if(!workers[workerIndex]->deque.Push(job)) {
+				// Deque is full, the job runs right away instead
+				Execute(workerIndex, job);
+				return;
+			}
+		} else {
+			std::lock_guard<std::mutex> lock{injectedMutex};
+			injectedJobs.push_back(job);
+			injectedCount.fetch_add(1, std::memory_order_relaxed);
+		}
+		WakeWorkers();
+	}
+
+	void RveJobSystem::WakeWorkers() {
+		// Pairs with the sleeping count a worker publishes before its last search, either the worker finds
+		// the new job or this sees it sleeping and moves the epoch it waits on
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(sleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+			wakeEpoch.fetch_add(1, std::memory_order_seq_cst);
+			wakeEpoch.notify_one();
+		}
+	}
+
+	RveJob *RveJobSystem::FindJob(uint32_t workerIndex) {
+		if(workerIndex != noWorker) {
+			if(RveJob *job = workers[workerIndex]->deque.Pop()) {
+				return job;
+			}
+		}
+		if(injectedCount.load(std::memory_order_relaxed) > 0) {
+			std::lock_guard<std::mutex> lock{injectedMutex};
+			if(!injectedJobs.empty()) {
+				RveJob *job = injectedJobs.front();
+				injectedJobs.pop_front();
+				injectedCount.fetch_sub(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+
+		const uint32_t workerCount = static_cast<uint32_t>(workers.size());
+		uint32_t start = 0;
+		if(workerIndex != noWorker) {
+			// xorshift, so thieves spread over the victims instead of all hitting the first one
+			uint32_t& state = workers[workerIndex]->randomState;
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			start = state % workerCount;
+		}
+		for(uint32_t offset = 0; offset < workerCount; offset++) {
+			uint32_t victim = (start + offset) % workerCount;
+			if(victim == workerIndex) {
+				continue;
+			}
+			if(RveJob *job = workers[victim]->deque.Steal()) {
+				if(workerIndex != noWorker) {
+					workers[workerIndex]->steals.fetch_add(1, std::memory_order_relaxed);
+				}
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	void RveJobSystem::Execute(uint32_t workerIndex, RveJob *job) {
+		job->task();
+		if(workerIndex != noWorker) {
+			workers[workerIndex]->jobsRun.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			foreignJobsRun.fetch_add(1, std::memory_order_relaxed);
+		}
+		RveJobCounter *counter = job->counter;
+		delete job;
+		if(counter != nullptr) {
+			Finish(*counter);
+		}
+	}
+
+	void RveJobSystem::Finish(RveJobCounter& counter) {
+		std::vector<RveJob*> released;
+		{
+			std::lock_guard<std::mutex> lock{counter.mutex};
+			if(counter.pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				released.swap(counter.continuations);
+			}
+		}
+		for(RveJob *job : released) {
+			Submit(job);
+		}
+	}
+
+	void RveJobSystem::Wait(RveJobCounter& counter) {
+		const uint32_t workerIndex = CurrentWorker();
+		while(!counter.IsDone()) {
+			if(RveJob *job = FindJob(workerIndex)) {
+				Execute(workerIndex, job);
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void RveJobSystem::WorkerLoop(uint32_t workerIndex) {
+		currentSystem = this;
+		currentWorker = workerIndex;
+		Worker& worker = *workers[workerIndex];
+		uint32_t idle = 0;
+		while(!stopping.load(std::memory_order_acquire)) {
+			if(RveJob *job = FindJob(workerIndex)) {
+				Execute(workerIndex, job);
+				idle = 0;
+				continue;
+			}
+			if(++idle < idleSpins) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+			uint32_t epoch = wakeEpoch.load(std::memory_order_seq_cst);
+			if(RveJob *job = FindJob(workerIndex)) {
+				sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+				Execute(workerIndex, job);
+				idle = 0;
+				continue;
+			}
+			if(!stopping.load(std::memory_order_acquire)) {
+				worker.sleeps.fetch_add(1, std::memory_order_relaxed);
+				wakeEpoch.wait(epoch, std::memory_order_seq_cst);
+			}
+			sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+			idle = 0;
+		}
+	}
+
+	void RveJobSystem::ParallelFor(uint32_t count, uint32_t minChunkSize, const std::function<void(uint32_t, uint32_t)>& body) {
+		if(count == 0) {
+			return;
+		}
+		uint32_t chunkSize = std::max({1u, minChunkSize, count / (GetThreadCount() * chunksPerThread)});
+		if(chunkSize >= count) {
+			body(0, count);
+			return;
+		}
+		RveJobCounter counter;
+		SplitRange(0, count, chunkSize, body, counter);
+		Wait(counter);
+	}
+
+	void RveJobSystem::SplitRange(uint32_t begin, uint32_t end, uint32_t chunkSize, const std::function<void(uint32_t, uint32_t)>& body, RveJobCounter& counter) {
+		// The upper half goes to the deque, the largest piece first, and the lower half keeps splitting
+		while(end - begin > chunkSize) {
+			uint32_t middle = begin + (end - begin) / 2;
+			Schedule([this, middle, end, chunkSize, &body, &counter]() {
+				SplitRange(middle, end, chunkSize, body, counter);
+			}, &counter);
+			end = middle;
+		}
+		body(begin, end);
+	}
+
+	RveJobSystem::Stats RveJobSystem::GetStats() const {
+		Stats stats{};
+		stats.jobsRun = foreignJobsRun.load(std::memory_order_relaxed);
+		for(const auto& worker : workers) {
+			stats.jobsRun += worker->jobsRun.load(std::memory_order_relaxed);
+			stats.steals += worker->steals.load(std::memory_order_relaxed);
+			stats.sleeps += worker->sleeps.load(std::memory_order_relaxed);
+		}
+		return stats;
+	}
+} // namespace rve
@@ -0,0 +1,58 @@
+#include "../include/rve_mapped_file.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#ifdef __unix__
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace rve {
+	RveMappedFile::RveMappedFile(const std::string& filePath) {
+		#ifdef __unix__
+			int descriptor = open(filePath.c_str(), O_RDONLY);
+			if(descriptor < 0) {
+				throw std::runtime_error("(rve_mapped_file.cpp) Failed to open file: " + filePath);
+			}
+			struct stat fileStat{};
+			if(fstat(descriptor, &fileStat) != 0) {
+				close(descriptor);
+				throw std::runtime_error("(rve_mapped_file.cpp) Failed to stat file: " + filePath);
+			}
+			size = static_cast<size_t>(fileStat.st_size);
+			if(size > 0) {
+				void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+				if(mapping == MAP_FAILED) {
+					close(descriptor);
+					throw std::runtime_error("(rve_mapped_file.cpp) Failed to map file: " + filePath);
+				}
+				// Parsers walk the file front to back, possibly in several places at once
+				madvise(mapping, size, MADV_WILLNEED);
+				data = static_cast<const char*>(mapping);
+				mapped = true;
+			}
+			close(descriptor);
+		#else
+			std::ifstream fileStream{filePath, std::ios::ate | std::ios::binary};
+			if(!fileStream.is_open()) {
+				throw std::runtime_error("(rve_mapped_file.cpp) Failed to open file: " + filePath);
+			}
+			size = static_cast<size_t>(fileStream.tellg());
+			fallbackStorage.resize(size);
+			fileStream.seekg(0);
+			fileStream.read(fallbackStorage.data(), size);
+			data = fallbackStorage.data();
+		#endif
+	}
+
+	RveMappedFile::~RveMappedFile() {
+		#ifdef __unix__
+			if(mapped) {
+				munmap(const_cast<char*>(data), size);
+			}
+		#endif
+	}
+} // namespace rve
@@ -0,0 +1,207 @@
+#include "../include/rve_mesh_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace rve {
+	namespace {
+		uint64_t AlignOffset(uint64_t offset) {
+			return (offset + RveMeshCache::blobAlignment - 1) / RveMeshCache::blobAlignment * RveMeshCache::blobAlignment;
+		}
+
+		// Offsets and sizes come from the file, so the end is computed without overflowing
+		bool FitsInFile(uint64_t offset, uint64_t count, uint64_t stride, uint64_t fileSize) {
+			return offset % RveMeshCache::blobAlignment == 0 && offset <= fileSize && count <= (fileSize - offset) / stride;
+		}
+	} // namespace
+
+	RveMeshCache::RveMeshCache(const std::string& filePath) : file{filePath} {
+		if(file.GetSize() < sizeof(Header)) {
+			throw std::runtime_error("(rve_mesh_cache.cpp) Not a mesh cache: " + filePath);
+		}
+		std::memcpy(&header, file.GetData(), sizeof(Header));
+		if(header.magic != magic) {
+			throw std::runtime_error("(rve_mesh_cache.cpp) Not a mesh cache: " + filePath);
+		}
+		if(header.version != version ||
+			header.vertexStride != sizeof(RveModel::Vertex) ||
+			header.lodStride != sizeof(RveModel::Lod) ||
+			header.meshletStride != sizeof(RveMeshlet)) {
+				throw std::runtime_error("(rve_mesh_cache.cpp) Mesh cache was cooked by another version: " + filePath);
+		}
+		if(header.fileSize != file.GetSize() || !FitsInFile(AlignOffset(sizeof(Header)), header.meshCount, sizeof(MeshRecord), header.fileSize)) {
+			throw std::runtime_error("(rve_mesh_cache.cpp) Truncated mesh cache: " + filePath);
+		}
+
+		records.resize(header.meshCount);
+		std::memcpy(records.data(), file.GetData() + AlignOffset(sizeof(Header)), records.size() * sizeof(MeshRecord));
+		for(const MeshRecord& record : records) {
+			bool valid = record.vertexCount >= 3 &&
+				FitsInFile(record.vertexOffset, record.vertexCount, sizeof(RveModel::Vertex), header.fileSize) &&
+				FitsInFile(record.indexOffset, record.indexCount, sizeof(uint32_t), header.fileSize) &&
+				FitsInFile(record.lodOffset, record.lodCount, sizeof(RveModel::Lod), header.fileSize) &&
+				FitsInFile(record.meshletOffset, record.meshletCount, sizeof(RveMeshlet), header.fileSize);
+			if(!valid) {
+				throw std::runtime_error("(rve_mesh_cache.cpp) Corrupt mesh table in " + filePath);
+			}
+		}
+	}
+
+	RveModel::MeshData RveMeshCache::GetMeshData(uint32_t mesh) const {
+		const MeshRecord& record = records[mesh];
+		const char *data = file.GetData();
+		RveModel::MeshData meshData{};
+		meshData.vertices = {reinterpret_cast<const RveModel::Vertex*>(data + record.vertexOffset), record.vertexCount};
+		meshData.indices = {reinterpret_cast<const uint32_t*>(data + record.indexOffset), record.indexCount};
+		meshData.lods = {reinterpret_cast<const RveModel::Lod*>(data + record.lodOffset), record.lodCount};
+		meshData.meshlets = {reinterpret_cast<const RveMeshlet*>(data + record.meshletOffset), record.meshletCount};
+		meshData.hasBounds = true;
+		meshData.boundingCenter = {record.boundingCenter[0], record.boundingCenter[1], record.boundingCenter[2]};
+		meshData.boundingRadius = record.boundingRadius;
+		return meshData;
+	}
+
+	bool RveMeshCache::VerifyContent() const {
+		if(Hash(file.GetData() + sizeof(Header), file.GetSize() - sizeof(Header)) != header.contentHash) {
+			return false;
+		}
+		for(uint32_t mesh = 0; mesh < header.meshCount; mesh++) {
+			RveModel::MeshData meshData = GetMeshData(mesh);
+			for(uint32_t index : meshData.indices) {
+				if(index >= meshData.vertices.size()) {
+					return false;
+				}
+			}
+			for(const RveModel::Lod& lod : meshData.lods) {
+				if(lod.firstIndex > meshData.indices.size() || lod.indexCount > meshData.indices.size() - lod.firstIndex) {
+					return false;
+				}
+			}
+			for(const RveMeshlet& meshlet : meshData.meshlets) {
+				if(meshlet.firstIndex > meshData.indices.size() || meshlet.indexCount > meshData.indices.size() - meshlet.firstIndex) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	void RveMeshCache::Write(const std::string& filePath, const std::vector<RveModel::Builder>& builders, uint64_t sourceStamp) {
+		Header fileHeader{};
+		fileHeader.magic = magic;
+		fileHeader.version = version;
+		fileHeader.meshCount = static_cast<uint32_t>(builders.size());
+		fileHeader.vertexStride = sizeof(RveModel::Vertex);
+		fileHeader.lodStride = sizeof(RveModel::Lod);
+		fileHeader.meshletStride = sizeof(RveMeshlet);
+		fileHeader.sourceStamp = sourceStamp;
+
+		std::vector<MeshRecord> meshRecords(builders.size());
+		uint64_t offset = AlignOffset(AlignOffset(sizeof(Header)) + meshRecords.size() * sizeof(MeshRecord));
+		for(size_t mesh = 0; mesh < builders.size(); mesh++) {
+			const RveModel::Builder& builder = builders[mesh];
+			MeshRecord& record = meshRecords[mesh];
+			record.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+			record.indexCount = static_cast<uint32_t>(builder.indices.size());
+			record.lodCount = static_cast<uint32_t>(builder.lods.size());
+			record.meshletCount = static_cast<uint32_t>(builder.meshlets.size());
+			record.vertexOffset = offset;
+			offset = AlignOffset(offset + builder.vertices.size() * sizeof(RveModel::Vertex));
+			record.indexOffset = offset;
+			offset = AlignOffset(offset + builder.indices.size() * sizeof(uint32_t));
+			record.lodOffset = offset;
+			offset = AlignOffset(offset + builder.lods.size() * sizeof(RveModel::Lod));
+			record.meshletOffset = offset;
+			offset = AlignOffset(offset + builder.meshlets.size() * sizeof(RveMeshlet));
+
+			// Same bounds RveModel computes, stored so loading does not walk the vertices for them
+			glm::vec3 boundsMin{builder.vertices.empty() ? glm::vec3{0.0f} : builder.vertices[0].position};
+			glm::vec3 boundsMax{boundsMin};
+			for(const auto& vertex : builder.vertices) {
+				boundsMin = glm::min(boundsMin, vertex.position);
+				boundsMax = glm::max(boundsMax, vertex.position);
+			}
+			glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+			for(const auto& vertex : builder.vertices) {
+				record.boundingRadius = glm::max(record.boundingRadius, glm::length(vertex.position - center));
+			}
+			record.boundingCenter[0] = center.x;
+			record.boundingCenter[1] = center.y;
+			record.boundingCenter[2] = center.z;
+		}
+		fileHeader.fileSize = offset;
+
+		std::vector<char> contents(offset, 0);
+		std::memcpy(contents.data() + AlignOffset(sizeof(Header)), meshRecords.data(), meshRecords.size() * sizeof(MeshRecord));
+		for(size_t mesh = 0; mesh < builders.size(); mesh++) {
+			const RveModel::Builder& builder = builders[mesh];
+			const MeshRecord& record = meshRecords[mesh];
+			std::memcpy(contents.data() + record.vertexOffset, builder.vertices.data(), builder.vertices.size() * sizeof(RveModel::Vertex));
+			std::memcpy(contents.data() + record.indexOffset, builder.indices.data(), builder.indices.size() * sizeof(uint32_t));
+			std::memcpy(contents.data() + record.lodOffset, builder.lods.data(), builder.lods.size() * sizeof(RveModel::Lod));
+			std::memcpy(contents.data() + record.meshletOffset, builder.meshlets.data(), builder.meshlets.size() * sizeof(RveMeshlet));
+		}
+		fileHeader.contentHash = Hash(contents.data() + sizeof(Header), contents.size() - sizeof(Header));
+		std::memcpy(contents.data(), &fileHeader, sizeof(Header));
+
+		// Written next to the target and renamed, so a running engine never maps a partial file
+		const std::string temporaryPath = filePath + ".tmp";
+		{
+			std::ofstream output{temporaryPath, std::ios::binary | std::ios::trunc};
+			if(!output.is_open()) {
+				throw std::runtime_error("(rve_mesh_cache.cpp) Failed to write " + temporaryPath);
+			}
+			output.write(contents.data(), contents.size());
+			if(!output) {
+				throw std::runtime_error("(rve_mesh_cache.cpp) Failed to write " + temporaryPath);
+			}
+		}
+		if(std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+			throw std::runtime_error("(rve_mesh_cache.cpp) Failed to replace " + filePath);
+		}
+	}
+
+	bool RveMeshCache::IsUpToDate(const std::string& filePath, const std::string& sourcePath) {
+		std::ifstream input{filePath, std::ios::binary};
+		Header fileHeader{};
+		if(!input.read(reinterpret_cast<char*>(&fileHeader), sizeof(Header))) {
+			return false;
+		}
+		return fileHeader.magic == magic && fileHeader.version == version && fileHeader.sourceStamp == SourceStamp(sourcePath);
+	}
+
+	uint64_t RveMeshCache::SourceStamp(const std::string& sourcePath) {
+		std::error_code error;
+		uint64_t size = std::filesystem::file_size(sourcePath, error);
+		auto writeTime = std::filesystem::last_write_time(sourcePath, error);
+		if(error) {
+			return 0;
+		}
+		uint64_t stamp[2] = {size, static_cast<uint64_t>(writeTime.time_since_epoch().count())};
+		return Hash(reinterpret_cast<const char*>(stamp), sizeof(stamp));
+	}
+
+	uint64_t RveMeshCache::Hash(const char *data, size_t size) {
+		// Multiply and xorshift over 8 byte words, quick enough to check files of hundreds of MB
+		constexpr uint64_t multiplier = 0xff51afd7ed558ccdull;
+		uint64_t hash = 0x9e3779b97f4a7c15ull ^ size;
+		size_t offset = 0;
+		for(; offset + 8 <= size; offset += 8) {
+			uint64_t word;
+			std::memcpy(&word, data + offset, sizeof(word));
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 32;
+		}
+		if(offset < size) {
+			uint64_t word = 0;
+			std::memcpy(&word, data + offset, size - offset);
+			hash = (hash ^ word) * multiplier;
+			hash ^= hash >> 32;
+		}
+		hash *= multiplier;
+		return hash ^ (hash >> 29);
+	}
+} // namespace rve
@@ -0,0 +1,922 @@
+#include "../include/rve_mesh_loader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+namespace rve {
+	namespace {
+		constexpr int32_t noIndex = std::numeric_limits<int32_t>::min();
+		constexpr uint32_t noVertex = ~0u;
+
+		// Fills in area weighted normals for the vertices the file gave none
+		void ComputeMissingNormals(RveModel::Builder& builder, const std::vector<uint8_t>& missingNormals) {
+			if(std::find(missingNormals.begin(), missingNormals.end(), 1) == missingNormals.end()) {
+				return;
+			}
+			for(size_t index = 0; index + 2 < builder.indices.size(); index += 3) {
+				auto& a = builder.vertices[builder.indices[index]];
+				auto& b = builder.vertices[builder.indices[index + 1]];
+				auto& c = builder.vertices[builder.indices[index + 2]];
+				glm::vec3 faceNormal = glm::cross(b.position - a.position, c.position - a.position);
+				for(uint32_t corner = 0; corner < 3; corner++) {
+					uint32_t vertex = builder.indices[index + corner];
+					if(missingNormals[vertex]) {
+						builder.vertices[vertex].normal += faceNormal;
+					}
+				}
+			}
+			for(size_t vertex = 0; vertex < builder.vertices.size(); vertex++) {
+				if(missingNormals[vertex]) {
+					glm::vec3& normal = builder.vertices[vertex].normal;
+					float length = glm::length(normal);
+					normal = length > 0.0f ? normal / length : glm::vec3{0.0f, 1.0f, 0.0f};
+				}
+			}
+		}
+
+		void FinishBuilder(RveModel::Builder& builder) {
+			builder.GenerateMeshlets();
+			builder.GenerateLods();
+		}
+
+		// OBJ
+
+		// Face corner as written in the file. Negative file indices count back from the last element parsed,
+		// so they are kept relative to the chunk's own elements until the chunk offsets are known.
+		struct ObjCorner {
+			int32_t position = noIndex;
+			int32_t normal = noIndex;
+			int32_t texcoord = noIndex;
+			uint8_t relative = 0;
+		};
+
+		constexpr uint8_t relativePosition = 1;
+		constexpr uint8_t relativeNormal = 2;
+		constexpr uint8_t relativeTexcoord = 4;
+
+		// Welded vertex of a position seen with more than one normal or texture coordinate
+		struct ObjVertexKey {
+			uint64_t position;
+			int32_t normal;
+			int32_t texcoord;
+
+			bool operator==(const ObjVertexKey &) const = default;
+		};
+
+		struct ObjVertexKeyHash {
+			size_t operator()(const ObjVertexKey& key) const {
+				uint64_t attributes = static_cast<uint64_t>(static_cast<uint32_t>(key.normal)) << 32 | static_cast<uint32_t>(key.texcoord);
+				return std::hash<uint64_t>{}(key.position * 0x9E3779B97F4A7C15ull ^ attributes);
+			}
+		};
+
+		struct ObjChunk {
+			std::vector<glm::vec3> positions;
+			std::vector<glm::vec3> colors;
+			std::vector<glm::vec3> normals;
+			std::vector<glm::vec2> texcoords;
+			// Three per triangle, polygons are fanned
+			std::vector<ObjCorner> corners;
+			std::string error;
+		};
+
+		const char *SkipSpaces(const char *cursor, const char *end) {
+			while(cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+				cursor++;
+			}
+			return cursor;
+		}
+
+		bool ParseFloat(const char *&cursor, const char *end, float& value) {
+			cursor = SkipSpaces(cursor, end);
+			if(cursor < end && *cursor == '+') {
+				cursor++;
+			}
+			auto result = std::from_chars(cursor, end, value);
+			if(result.ec != std::errc{}) {
+				return false;
+			}
+			cursor = result.ptr;
+			return true;
+		}
+
+		bool ParseInt(const char *&cursor, const char *end, int32_t& value) {
+			if(cursor < end && *cursor == '+') {
+				cursor++;
+			}
+			auto result = std::from_chars(cursor, end, value);
+			if(result.ec != std::errc{}) {
+				return false;
+			}
+			cursor = result.ptr;
+			return true;
+		}
+
+		bool IsKeyword(const char *cursor, const char *end, std::string_view keyword) {
+			size_t length = keyword.size();
+			return static_cast<size_t>(end - cursor) > length &&
+				std::memcmp(cursor, keyword.data(), length) == 0 &&
+				(cursor[length] == ' ' || cursor[length] == '\t');
+		}
+
+		void SetObjIndex(int32_t value, size_t parsedCount, int32_t& index, uint8_t& relative, uint8_t relativeBit) {
+			if(value > 0) {
+				index = value - 1;
+			} else {
+				index = static_cast<int32_t>(parsedCount) + value;
+				relative |= relativeBit;
+			}
+		}
+
+		bool ParseObjFace(const char *cursor, const char *end, ObjChunk& chunk, std::vector<ObjCorner>& polygon) {
+			polygon.clear();
+			while((cursor = SkipSpaces(cursor, end)) < end) {
+				ObjCorner corner{};
+				int32_t value;
+				if(!ParseInt(cursor, end, value) || value == 0) {
+					return false;
+				}
+				SetObjIndex(value, chunk.positions.size(), corner.position, corner.relative, relativePosition);
+				if(cursor < end && *cursor == '/') {
+					cursor++;
+					if(cursor < end && *cursor != '/') {
+						if(!ParseInt(cursor, end, value) || value == 0) {
+							return false;
+						}
+						SetObjIndex(value, chunk.texcoords.size(), corner.texcoord, corner.relative, relativeTexcoord);
+					}
+					if(cursor < end && *cursor == '/') {
+						cursor++;
+						if(!ParseInt(cursor, end, value) || value == 0) {
+							return false;
+						}
+						SetObjIndex(value, chunk.normals.size(), corner.normal, corner.relative, relativeNormal);
+					}
+				}
+				polygon.push_back(corner);
+			}
+			if(polygon.size() < 3) {
+				return false;
+			}
+			for(size_t corner = 1; corner + 1 < polygon.size(); corner++) {
+				chunk.corners.push_back(polygon[0]);
+				chunk.corners.push_back(polygon[corner]);
+				chunk.corners.push_back(polygon[corner + 1]);
+			}
+			return true;
+		}
+
+		void ParseObjChunk(const char *cursor, const char *end, ObjChunk& chunk) {
+			std::vector<ObjCorner> polygon;
+			while(cursor < end) {
+				const char *lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+				if(lineEnd == nullptr) {
+					lineEnd = end;
+				}
+				const char *token = SkipSpaces(cursor, lineEnd);
+				if(IsKeyword(token, lineEnd, "v")) {
+					token += 2;
+					glm::vec3 position;
+					if(!ParseFloat(token, lineEnd, position.x) || !ParseFloat(token, lineEnd, position.y) || !ParseFloat(token, lineEnd, position.z)) {
+						chunk.error = "Malformed vertex position";
+						return;
+					}
+					// Vertex colors are a common extension, written after the position
+					glm::vec3 color;
+					if(!ParseFloat(token, lineEnd, color.r) || !ParseFloat(token, lineEnd, color.g) || !ParseFloat(token, lineEnd, color.b)) {
+						color = glm::vec3{RveMeshLoader::defaultColor};
+					}
+					chunk.positions.push_back(position);
+					chunk.colors.push_back(color);
+				} else if(IsKeyword(token, lineEnd, "vn")) {
+					token += 3;
+					glm::vec3 normal;
+					if(!ParseFloat(token, lineEnd, normal.x) || !ParseFloat(token, lineEnd, normal.y) || !ParseFloat(token, lineEnd, normal.z)) {
+						chunk.error = "Malformed vertex normal";
+						return;
+					}
+					chunk.normals.push_back(normal);
+				} else if(IsKeyword(token, lineEnd, "vt")) {
+					token += 3;
+					// An optional third coordinate is for 3D textures and ignored
+					glm::vec2 texcoord;
+					if(!ParseFloat(token, lineEnd, texcoord.x)) {
+						chunk.error = "Malformed texture coordinate";
+						return;
+					}
+					if(!ParseFloat(token, lineEnd, texcoord.y)) {
+						texcoord.y = 0.0f;
+					}
+					// OBJ puts v = 0 at the bottom of the image, Vulkan samples row 0 at the top
+					chunk.texcoords.push_back({texcoord.x, 1.0f - texcoord.y});
+				} else if(IsKeyword(token, lineEnd, "f")) {
+					if(!ParseObjFace(token + 2, lineEnd, chunk, polygon)) {
+						chunk.error = "Malformed face";
+						return;
+					}
+				}
+				cursor = lineEnd < end ? lineEnd + 1 : end;
+			}
+		}
+
+		// glTF
+
+		struct JsonValue {
+			enum class Type {
+				Null,
+				Bool,
+				Number,
+				String,
+				Array,
+				Object
+			};
+
+			Type type = Type::Null;
+			bool boolean = false;
+			double number = 0.0;
+			std::string string;
+			std::vector<JsonValue> elements;
+			std::vector<std::pair<std::string, JsonValue>> members;
+
+			const JsonValue *Find(std::string_view key) const {
+				for(const auto& member : members) {
+					if(member.first == key) {
+						return &member.second;
+					}
+				}
+				return nullptr;
+			}
+			double GetNumber(std::string_view key, double fallback) const {
+				const JsonValue *value = Find(key);
+				return value != nullptr && value->type == Type::Number ? value->number : fallback;
+			}
+		};
+
+		// Just enough JSON for the glTF header chunk, which is small next to the binary chunk
+		class JsonParser {
+		public:
+			JsonParser(const char *begin, const char *end) : cursor{begin}, end{end} {}
+
+			JsonValue Parse() {
+				JsonValue value = ParseValue(0);
+				SkipWhitespace();
+				if(cursor != end) {
+					Fail("trailing characters");
+				}
+				return value;
+			}
+
+			static constexpr int maxDepth = 64;
+
+		private:
+			[[noreturn]] void Fail(const char *message) {
+				throw std::runtime_error(std::string("(rve_mesh_loader.cpp) Malformed glTF JSON: ") + message);
+			}
+
+			void SkipWhitespace() {
+				while(cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n')) {
+					cursor++;
+				}
+			}
+
+			void Expect(char character) {
+				SkipWhitespace();
+				if(cursor >= end || *cursor != character) {
+					Fail("unexpected character");
+				}
+				cursor++;
+			}
+
+			bool Consume(std::string_view literal) {
+				if(static_cast<size_t>(end - cursor) >= literal.size() && std::memcmp(cursor, literal.data(), literal.size()) == 0) {
+					cursor += literal.size();
+					return true;
+				}
+				return false;
+			}
+
+			JsonValue ParseValue(int depth) {
+				if(depth > maxDepth) {
+					Fail("nested too deeply");
+				}
+				SkipWhitespace();
+				if(cursor >= end) {
+					Fail("unexpected end");
+				}
+				JsonValue value;
+				if(*cursor == '{') {
+					value.type = JsonValue::Type::Object;
+					cursor++;
+					SkipWhitespace();
+					if(cursor < end && *cursor == '}') {
+						cursor++;
+						return value;
+					}
+					do {
+						SkipWhitespace();
+						std::string key = ParseString();
+						Expect(':');
+						value.members.emplace_back(std::move(key), ParseValue(depth + 1));
+						SkipWhitespace();
+					} while(cursor < end && *cursor == ',' && ++cursor);
+					Expect('}');
+				} else if(*cursor == '[') {
+					value.type = JsonValue::Type::Array;
+					cursor++;
+					SkipWhitespace();
+					if(cursor < end && *cursor == ']') {
+						cursor++;
+						return value;
+					}
+					do {
+						value.elements.push_back(ParseValue(depth + 1));
+						SkipWhitespace();
+					} while(cursor < end && *cursor == ',' && ++cursor);
+					Expect(']');
+				} else if(*cursor == '"') {
+					value.type = JsonValue::Type::String;
+					value.string = ParseString();
+				} else if(Consume("true")) {
+					value.type = JsonValue::Type::Bool;
+					value.boolean = true;
+				} else if(Consume("false")) {
+					value.type = JsonValue::Type::Bool;
+				} else if(Consume("null")) {
+					value.type = JsonValue::Type::Null;
+				} else {
+					value.type = JsonValue::Type::Number;
+					auto result = std::from_chars(cursor, end, value.number);
+					if(result.ec != std::errc{}) {
+						Fail("invalid number");
+					}
+					cursor = result.ptr;
+				}
+				return value;
+			}
+
+			void AppendUtf8(std::string& output, uint32_t codePoint) {
+				if(codePoint < 0x80) {
+					output += static_cast<char>(codePoint);
+				} else if(codePoint < 0x800) {
+					output += static_cast<char>(0xC0 | (codePoint >> 6));
+					output += static_cast<char>(0x80 | (codePoint & 0x3F));
+				} else if(codePoint < 0x10000) {
+					output += static_cast<char>(0xE0 | (codePoint >> 12));
+					output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+					output += static_cast<char>(0x80 | (codePoint & 0x3F));
+				} else {
+					output += static_cast<char>(0xF0 | (codePoint >> 18));
+					output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+					output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+					output += static_cast<char>(0x80 | (codePoint & 0x3F));
+				}
+			}
+
+			uint32_t ParseHex4() {
+				uint32_t value = 0;
+				if(end - cursor < 4 || std::from_chars(cursor, cursor + 4, value, 16).ptr != cursor + 4) {
+					Fail("invalid escape");
+				}
+				cursor += 4;
+				return value;
+			}
+
+			std::string ParseString() {
+				if(cursor >= end || *cursor != '"') {
+					Fail("expected string");
+				}
+				cursor++;
+				std::string output;
+				while(cursor < end && *cursor != '"') {
+					if(*cursor != '\\') {
+						output += *cursor++;
+						continue;
+					}
+					if(++cursor >= end) {
+						break;
+					}
+					char escape = *cursor++;
+					switch(escape) {
+						case '"': output += '"'; break;
+						case '\\': output += '\\'; break;
+						case '/': output += '/'; break;
+						case 'b': output += '\b'; break;
+						case 'f': output += '\f'; break;
+						case 'n': output += '\n'; break;
+						case 'r': output += '\r'; break;
+						case 't': output += '\t'; break;
+						case 'u': {
+							uint32_t codePoint = ParseHex4();
+							if(codePoint >= 0xD800 && codePoint < 0xDC00 && Consume("\\u")) {
+								uint32_t low = ParseHex4();
+								codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+							}
+							AppendUtf8(output, codePoint);
+							break;
+						}
+						default: Fail("invalid escape");
+					}
+				}
+				if(cursor >= end) {
+					Fail("unterminated string");
+				}
+				cursor++;
+				return output;
+			}
+
+			const char *cursor;
+			const char *end;
+		};
+
+		constexpr uint32_t glbMagic = 0x46546C67;
+		constexpr uint32_t glbChunkJson = 0x4E4F534A;
+		constexpr uint32_t glbChunkBin = 0x004E4942;
+
+		constexpr uint32_t componentByte = 5120;
+		constexpr uint32_t componentUnsignedByte = 5121;
+		constexpr uint32_t componentShort = 5122;
+		constexpr uint32_t componentUnsignedShort = 5123;
+		constexpr uint32_t componentUnsignedInt = 5125;
+		constexpr uint32_t componentFloat = 5126;
+		constexpr uint32_t modeTriangles = 4;
+
+		uint32_t ReadUint32(const char *data) {
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		[[noreturn]] void FailGltf(const std::string& message) {
+			throw std::runtime_error("(rve_mesh_loader.cpp) " + message);
+		}
+
+		const JsonValue& GetElement(const JsonValue& root, std::string_view arrayName, double index) {
+			const JsonValue *array = root.Find(arrayName);
+			if(array == nullptr || array->type != JsonValue::Type::Array || index < 0.0 || index >= array->elements.size()) {
+				FailGltf("glTF references a missing " + std::string(arrayName) + " entry");
+			}
+			return array->elements[static_cast<size_t>(index)];
+		}
+
+		// Strided view of an accessor inside the binary chunk
+		struct AccessorView {
+			const char *data = nullptr;
+			size_t count = 0;
+			size_t stride = 0;
+			uint32_t componentType = 0;
+			uint32_t components = 0;
+			bool normalized = false;
+
+			float ReadFloat(size_t element, uint32_t component) const {
+				const char *source = data + element * stride;
+				switch(componentType) {
+					case componentFloat: {
+						float value;
+						std::memcpy(&value, source + component * 4, sizeof(value));
+						return value;
+					}
+					case componentUnsignedByte: {
+						float value = static_cast<uint8_t>(source[component]);
+						return normalized ? value / 255.0f : value;
+					}
+					case componentUnsignedShort: {
+						uint16_t value;
+						std::memcpy(&value, source + component * 2, sizeof(value));
+						return normalized ? value / 65535.0f : value;
+					}
+					case componentByte: {
+						float value = static_cast<int8_t>(source[component]);
+						return normalized ? std::max(value / 127.0f, -1.0f) : value;
+					}
+					case componentShort: {
+						int16_t value;
+						std::memcpy(&value, source + component * 2, sizeof(value));
+						return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+					}
+				}
+				FailGltf("Unsupported glTF component type");
+			}
+
+			uint32_t ReadIndex(size_t element) const {
+				const char *source = data + element * stride;
+				switch(componentType) {
+					case componentUnsignedByte:
+						return static_cast<uint8_t>(source[0]);
+					case componentUnsignedShort: {
+						uint16_t value;
+						std::memcpy(&value, source, sizeof(value));
+						return value;
+					}
+					case componentUnsignedInt: {
+						uint32_t value;
+						std::memcpy(&value, source, sizeof(value));
+						return value;
+					}
+				}
+				FailGltf("Unsupported glTF index component type");
+			}
+		};
+
+		AccessorView GetAccessor(const JsonValue& root, std::string_view binary, double accessorIndex) {
+			const JsonValue& accessor = GetElement(root, "accessors", accessorIndex);
+			if(accessor.Find("sparse") != nullptr) {
+				FailGltf("Sparse glTF accessors are not supported");
+			}
+			const JsonValue *bufferViewIndex = accessor.Find("bufferView");
+			if(bufferViewIndex == nullptr) {
+				FailGltf("glTF accessors without a buffer view are not supported");
+			}
+			const JsonValue& bufferView = GetElement(root, "bufferViews", bufferViewIndex->number);
+			if(bufferView.GetNumber("buffer", 0.0) != 0.0) {
+				FailGltf("Only the binary chunk of a .glb can be used as a glTF buffer");
+			}
+
+			AccessorView view{};
+			view.count = static_cast<size_t>(accessor.GetNumber("count", 0.0));
+			view.componentType = static_cast<uint32_t>(accessor.GetNumber("componentType", 0.0));
+			const JsonValue *normalized = accessor.Find("normalized");
+			view.normalized = normalized != nullptr && normalized->boolean;
+			const JsonValue *type = accessor.Find("type");
+			std::string_view typeName = type != nullptr ? std::string_view{type->string} : std::string_view{};
+			view.components = typeName == "SCALAR" ? 1 : typeName == "VEC2" ? 2 : typeName == "VEC3" ? 3 : typeName == "VEC4" ? 4 : 0;
+			uint32_t componentSize =
+				view.componentType == componentByte || view.componentType == componentUnsignedByte ? 1 :
+				view.componentType == componentShort || view.componentType == componentUnsignedShort ? 2 :
+				view.componentType == componentUnsignedInt || view.componentType == componentFloat ? 4 : 0;
+			if(view.components == 0 || componentSize == 0) {
+				FailGltf("Unsupported glTF accessor type");
+			}
+
+			size_t elementSize = view.components * componentSize;
+			view.stride = static_cast<size_t>(bufferView.GetNumber("byteStride", static_cast<double>(elementSize)));
+			size_t viewOffset = static_cast<size_t>(bufferView.GetNumber("byteOffset", 0.0));
+			size_t viewLength = static_cast<size_t>(bufferView.GetNumber("byteLength", 0.0));
+			size_t offset = static_cast<size_t>(accessor.GetNumber("byteOffset", 0.0));
+			size_t lastByte = view.count == 0 ? 0 : offset + (view.count - 1) * view.stride + elementSize;
+			if(view.stride < elementSize || lastByte > viewLength || viewOffset + viewLength > binary.size()) {
+				FailGltf("glTF accessor reads outside its buffer");
+			}
+			view.data = binary.data() + viewOffset + offset;
+			return view;
+		}
+
+		RveModel::Builder BuildGltfPrimitive(const JsonValue& root, std::string_view binary, const JsonValue& primitive) {
+			RveModel::Builder builder{};
+			const JsonValue *attributes = primitive.Find("attributes");
+			if(primitive.GetNumber("mode", modeTriangles) != modeTriangles || attributes == nullptr || attributes->Find("POSITION") == nullptr) {
+				return builder;
+			}
+
+			AccessorView positions = GetAccessor(root, binary, attributes->Find("POSITION")->number);
+			if(positions.componentType != componentFloat || positions.components != 3) {
+				FailGltf("glTF positions must be float vec3");
+			}
+			builder.vertices.resize(positions.count);
+			for(size_t vertex = 0; vertex < positions.count; vertex++) {
+				builder.vertices[vertex].position = {positions.ReadFloat(vertex, 0), positions.ReadFloat(vertex, 1), positions.ReadFloat(vertex, 2)};
+				builder.vertices[vertex].color = glm::vec3{RveMeshLoader::defaultColor};
+			}
+
+			auto readAttribute = [&](const char *name, uint32_t minComponents, auto&& store) {
+				const JsonValue *index = attributes->Find(name);
+				if(index == nullptr) {
+					return false;
+				}
+				AccessorView view = GetAccessor(root, binary, index->number);
+				if(view.count != positions.count || view.components < minComponents) {
+					FailGltf(std::string("glTF attribute ") + name + " does not match the positions");
+				}
+				// Only the components the accessor has are read, texture coordinates are two wide
+				uint32_t components = std::min(view.components, 3u);
+				for(size_t vertex = 0; vertex < view.count; vertex++) {
+					glm::vec3 value{0.0f};
+					for(uint32_t component = 0; component < components; component++) {
+						value[component] = view.ReadFloat(vertex, component);
+					}
+					store(builder.vertices[vertex], value);
+				}
+				return true;
+			};
+			bool hasNormals = readAttribute("NORMAL", 3, [](RveModel::Vertex& vertex, glm::vec3 value) { vertex.normal = value; });
+			readAttribute("COLOR_0", 3, [](RveModel::Vertex& vertex, glm::vec3 value) { vertex.color = value; });
+			readAttribute("TEXCOORD_0", 2, [](RveModel::Vertex& vertex, glm::vec3 value) { vertex.uv = {value.x, value.y}; });
+
+			if(const JsonValue *indicesIndex = primitive.Find("indices")) {
+				AccessorView indices = GetAccessor(root, binary, indicesIndex->number);
+				builder.indices.resize(indices.count / 3 * 3);
+				for(size_t index = 0; index < builder.indices.size(); index++) {
+					builder.indices[index] = indices.ReadIndex(index);
+					if(builder.indices[index] >= positions.count) {
+						FailGltf("glTF index out of range");
+					}
+				}
+			} else {
+				builder.indices.resize(positions.count / 3 * 3);
+				for(size_t index = 0; index < builder.indices.size(); index++) {
+					builder.indices[index] = static_cast<uint32_t>(index);
+				}
+			}
+
+			if(!hasNormals) {
+				ComputeMissingNormals(builder, std::vector<uint8_t>(builder.vertices.size(), 1));
+			}
+			// Double sided materials are seen from behind, so their meshlets must not be cone culled
+			if(const JsonValue *materialIndex = primitive.Find("material")) {
+				const JsonValue *doubleSided = GetElement(root, "materials", materialIndex->number).Find("doubleSided");
+				builder.twoSided = doubleSided != nullptr && doubleSided->type == JsonValue::Type::Bool && doubleSided->boolean;
+			}
+			return builder;
+		}
+
+		std::string LowerExtension(const std::string& filePath) {
+			size_t dot = filePath.find_last_of('.');
+			std::string extension = dot == std::string::npos ? std::string{} : filePath.substr(dot);
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) {
+				return static_cast<char>(std::tolower(character));
+			});
+			return extension;
+		}
+	} // namespace
+
+	bool RveMeshLoader::IsSupported(const std::string& filePath) {
+		std::string extension = LowerExtension(filePath);
+		return extension == ".obj" || extension == ".glb";
+	}
+
+	std::vector<RveModel::Builder> RveMeshLoader::Load(const std::vector<std::string>& filePaths, std::vector<uint32_t> *meshCounts) {
+		auto startTime = std::chrono::steady_clock::now();
+		struct FileResult {
+			std::vector<RveModel::Builder> builders;
+			uint64_t bytes = 0;
+			std::exception_ptr error;
+		};
+		std::vector<FileResult> results(filePaths.size());
+		RveJobCounter counter;
+		for(size_t file = 0; file < filePaths.size(); file++) {
+			jobSystem.Schedule([this, &filePaths, &results, file]() {
+				FileResult& result = results[file];
+				try {
+					RveMappedFile mappedFile{filePaths[file]};
+					result.bytes = mappedFile.GetSize();
+					std::string extension = LowerExtension(filePaths[file]);
+					if(extension == ".obj") {
+						result.builders = LoadObj(mappedFile, filePaths[file]);
+					} else if(extension == ".glb") {
+						result.builders = LoadGlb(mappedFile, filePaths[file]);
+					} else {
+						throw std::runtime_error("(rve_mesh_loader.cpp) Unsupported mesh format: " + filePaths[file]);
+					}
+				} catch(...) {
+					result.error = std::current_exception();
+				}
+			}, &counter);
+		}
+		jobSystem.Wait(counter);
+
+		stats = {};
+		std::vector<RveModel::Builder> builders;
+		if(meshCounts != nullptr) {
+			meshCounts->clear();
+		}
+		for(FileResult& result : results) {
+			if(result.error) {
+				std::rethrow_exception(result.error);
+			}
+			if(meshCounts != nullptr) {
+				meshCounts->push_back(static_cast<uint32_t>(result.builders.size()));
+			}
+			stats.files++;
+			stats.bytesRead += result.bytes;
+			for(RveModel::Builder& builder : result.builders) {
+				stats.meshes++;
+				stats.vertices += builder.vertices.size();
+				stats.triangles += (builder.lods.empty() ? builder.indices.size() : builder.lods[0].indexCount) / 3;
+				builders.push_back(std::move(builder));
+			}
+		}
+		stats.parseSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+		return builders;
+	}
+
+	std::vector<std::unique_ptr<RveModel>> RveMeshLoader::LoadModels(RveGeometryPool& pool, const std::vector<std::string>& filePaths) {
+		std::vector<RveModel::Builder> builders = Load(filePaths);
+		auto startTime = std::chrono::steady_clock::now();
+		std::vector<std::unique_ptr<RveModel>> models;
+		models.reserve(builders.size());
+		for(const RveModel::Builder& builder : builders) {
+			models.push_back(std::make_unique<RveModel>(pool, builder));
+		}
+		stats.uploadSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count();
+		return models;
+	}
+
+	std::vector<RveModel::Builder> RveMeshLoader::LoadObj(const RveMappedFile& file, const std::string& filePath) {
+		const char *data = file.GetData();
+		const size_t size = file.GetSize();
+
+		// Chunk boundaries are moved to the next line start, every line belongs to exactly one chunk
+		const size_t chunkCount = std::max<size_t>(1, (size + objChunkSize - 1) / objChunkSize);
+		std::vector<size_t> boundaries(chunkCount + 1, size);
+		boundaries[0] = 0;
+		for(size_t chunk = 1; chunk < chunkCount; chunk++) {
+			size_t boundary = std::max(chunk * objChunkSize, boundaries[chunk - 1]);
+			if(boundary < size && data[boundary - 1] != '\n') {
+				const char *lineEnd = static_cast<const char*>(std::memchr(data + boundary, '\n', size - boundary));
+				boundary = lineEnd != nullptr ? static_cast<size_t>(lineEnd - data) + 1 : size;
+			}
+			boundaries[chunk] = boundary;
+		}
+
+		std::vector<ObjChunk> chunks(chunkCount);
+		jobSystem.ParallelFor(static_cast<uint32_t>(chunkCount), 1, [&](uint32_t begin, uint32_t end) {
+			for(uint32_t chunk = begin; chunk < end; chunk++) {
+				ParseObjChunk(data + boundaries[chunk], data + boundaries[chunk + 1], chunks[chunk]);
+			}
+		});
+
+		std::vector<size_t> positionBases(chunkCount + 1, 0);
+		std::vector<size_t> normalBases(chunkCount + 1, 0);
+		std::vector<size_t> texcoordBases(chunkCount + 1, 0);
+		size_t cornerCount = 0;
+		for(size_t chunk = 0; chunk < chunkCount; chunk++) {
+			if(!chunks[chunk].error.empty()) {
+				throw std::runtime_error("(rve_mesh_loader.cpp) " + chunks[chunk].error + " in " + filePath);
+			}
+			positionBases[chunk + 1] = positionBases[chunk] + chunks[chunk].positions.size();
+			normalBases[chunk + 1] = normalBases[chunk] + chunks[chunk].normals.size();
+			texcoordBases[chunk + 1] = texcoordBases[chunk] + chunks[chunk].texcoords.size();
+			cornerCount += chunks[chunk].corners.size();
+		}
+		const size_t positionCount = positionBases[chunkCount];
+		const size_t normalCount = normalBases[chunkCount];
+		const size_t texcoordCount = texcoordBases[chunkCount];
+		if(cornerCount == 0) {
+			return {};
+		}
+		const size_t maxAttributes = static_cast<size_t>(std::numeric_limits<int32_t>::max());
+		if(positionCount >= noVertex || normalCount > maxAttributes || texcoordCount > maxAttributes) {
+			throw std::runtime_error("(rve_mesh_loader.cpp) Too many vertices in " + filePath);
+		}
+
+		// Elements stay in their chunks, a lookup only happens once per welded vertex
+		auto findChunk = [](const std::vector<size_t>& bases, size_t index) {
+			return static_cast<size_t>(std::upper_bound(bases.begin(), bases.end(), index) - bases.begin()) - 1;
+		};
+
+		// Welds corners sharing a position, normal and texture coordinate. Most positions only ever see one
+		// of each, so the first vertex of each position is found directly and only the rest go through the hash map.
+		RveModel::Builder builder{};
+		builder.indices.reserve(cornerCount);
+		builder.vertices.reserve(positionCount);
+		std::vector<uint32_t> firstVertices(positionCount, noVertex);
+		std::vector<int32_t> vertexNormals;
+		std::vector<int32_t> vertexTexcoords;
+		vertexNormals.reserve(positionCount);
+		vertexTexcoords.reserve(positionCount);
+		std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> splitVertices;
+		auto addVertex = [&](size_t position, int32_t normal, int32_t texcoord) {
+			size_t positionChunk = findChunk(positionBases, position);
+			RveModel::Vertex vertex{};
+			vertex.position = chunks[positionChunk].positions[position - positionBases[positionChunk]];
+			vertex.color = chunks[positionChunk].colors[position - positionBases[positionChunk]];
+			if(normal != noIndex) {
+				size_t normalChunk = findChunk(normalBases, normal);
+				vertex.normal = chunks[normalChunk].normals[normal - normalBases[normalChunk]];
+			}
+			if(texcoord != noIndex) {
+				size_t texcoordChunk = findChunk(texcoordBases, texcoord);
+				vertex.uv = chunks[texcoordChunk].texcoords[texcoord - texcoordBases[texcoordChunk]];
+			}
+			builder.vertices.push_back(vertex);
+			vertexNormals.push_back(normal);
+			vertexTexcoords.push_back(texcoord);
+			return static_cast<uint32_t>(builder.vertices.size() - 1);
+		};
+
+		for(size_t chunk = 0; chunk < chunkCount; chunk++) {
+			for(const ObjCorner& corner : chunks[chunk].corners) {
+				int64_t position = corner.position + ((corner.relative & relativePosition) ? static_cast<int64_t>(positionBases[chunk]) : 0);
+				int64_t normal = corner.normal;
+				if(normal != noIndex && (corner.relative & relativeNormal)) {
+					normal += static_cast<int64_t>(normalBases[chunk]);
+				}
+				int64_t texcoord = corner.texcoord;
+				if(texcoord != noIndex && (corner.relative & relativeTexcoord)) {
+					texcoord += static_cast<int64_t>(texcoordBases[chunk]);
+				}
+				if(position < 0 || static_cast<size_t>(position) >= positionCount ||
+					(normal != noIndex && (normal < 0 || static_cast<size_t>(normal) >= normalCount)) ||
+					(texcoord != noIndex && (texcoord < 0 || static_cast<size_t>(texcoord) >= texcoordCount))) {
+					throw std::runtime_error("(rve_mesh_loader.cpp) Face index out of range in " + filePath);
+				}
+
+				uint32_t& firstVertex = firstVertices[position];
+				uint32_t vertex;
+				if(firstVertex == noVertex) {
+					vertex = firstVertex = addVertex(position, static_cast<int32_t>(normal), static_cast<int32_t>(texcoord));
+				} else if(vertexNormals[firstVertex] == normal && vertexTexcoords[firstVertex] == texcoord) {
+					vertex = firstVertex;
+				} else {
+					ObjVertexKey key{static_cast<uint64_t>(position), static_cast<int32_t>(normal), static_cast<int32_t>(texcoord)};
+					auto [entry, inserted] = splitVertices.try_emplace(key, 0);
+					if(inserted) {
+						entry->second = addVertex(position, static_cast<int32_t>(normal), static_cast<int32_t>(texcoord));
+					}
+					vertex = entry->second;
+				}
+				builder.indices.push_back(vertex);
+			}
+			// Vertex attributes may still be referenced from later chunks, the corners are done with
+			chunks[chunk].corners = {};
+		}
+		if(builder.vertices.size() < 3) {
+			return {};
+		}
+
+		std::vector<uint8_t> missingNormals(builder.vertices.size());
+		for(size_t vertex = 0; vertex < vertexNormals.size(); vertex++) {
+			missingNormals[vertex] = vertexNormals[vertex] == noIndex;
+		}
+		ComputeMissingNormals(builder, missingNormals);
+		FinishBuilder(builder);
+
+		std::vector<RveModel::Builder> builders;
+		builders.push_back(std::move(builder));
+		return builders;
+	}
+
+	std::vector<RveModel::Builder> RveMeshLoader::LoadGlb(const RveMappedFile& file, const std::string& filePath) {
+		const char *data = file.GetData();
+		const size_t size = file.GetSize();
+		if(size < 20 || ReadUint32(data) != glbMagic || ReadUint32(data + 4) != 2) {
+			throw std::runtime_error("(rve_mesh_loader.cpp) Not a glTF 2.0 binary file: " + filePath);
+		}
+
+		std::string_view json;
+		std::string_view binary;
+		const size_t totalLength = std::min<size_t>(ReadUint32(data + 8), size);
+		for(size_t offset = 12; offset + 8 <= totalLength;) {
+			size_t chunkLength = ReadUint32(data + offset);
+			uint32_t chunkType = ReadUint32(data + offset + 4);
+			if(offset + 8 + chunkLength > totalLength) {
+				throw std::runtime_error("(rve_mesh_loader.cpp) Truncated glTF chunk in " + filePath);
+			}
+			std::string_view chunkData{data + offset + 8, chunkLength};
+			if(chunkType == glbChunkJson && json.empty()) {
+				json = chunkData;
+			} else if(chunkType == glbChunkBin && binary.empty()) {
+				binary = chunkData;
+			}
+			offset += 8 + chunkLength;
+		}
+		if(json.empty()) {
+			throw std::runtime_error("(rve_mesh_loader.cpp) Missing glTF JSON chunk in " + filePath);
+		}
+
+		const JsonValue root = JsonParser{json.data(), json.data() + json.size()}.Parse();
+		std::vector<const JsonValue*> primitives;
+		if(const JsonValue *meshes = root.Find("meshes")) {
+			for(const JsonValue& mesh : meshes->elements) {
+				if(const JsonValue *meshPrimitives = mesh.Find("primitives")) {
+					for(const JsonValue& primitive : meshPrimitives->elements) {
+						primitives.push_back(&primitive);
+					}
+				}
+			}
+		}
+
+		std::vector<RveModel::Builder> builders(primitives.size());
+		std::vector<std::exception_ptr> errors(primitives.size());
+		jobSystem.ParallelFor(static_cast<uint32_t>(primitives.size()), 1, [&](uint32_t begin, uint32_t end) {
+			for(uint32_t primitive = begin; primitive < end; primitive++) {
+				try {
+					builders[primitive] = BuildGltfPrimitive(root, binary, *primitives[primitive]);
+					if(builders[primitive].vertices.size() >= 3 && !builders[primitive].indices.empty()) {
+						FinishBuilder(builders[primitive]);
+					}
+				} catch(...) {
+					errors[primitive] = std::current_exception();
+				}
+			}
+		});
+		for(const std::exception_ptr& error : errors) {
+			if(error) {
+				std::rethrow_exception(error);
+			}
+		}
+
+		// Primitives that are not triangle lists are skipped
+		builders.erase(std::remove_if(builders.begin(), builders.end(), [](const RveModel::Builder& builder) {
+			return builder.vertices.size() < 3 || builder.indices.empty();
+		}), builders.end());
+		return builders;
+	}
+} // namespace rve
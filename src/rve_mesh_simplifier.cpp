@@ -0,0 +1,233 @@
+#include "../include/rve_mesh_simplifier.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace rve {
+	namespace {
+		// Border edges get a perpendicular constraint plane so open edges and attribute seams stay in place
+		constexpr double borderWeight = 100.0;
+		// Reject collapses that rotate a neighbouring triangle's normal too far
+		constexpr double minFlipCosine = 0.2;
+
+		uint64_t EdgeKey(uint32_t a, uint32_t b) {
+			return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+		}
+
+		struct Candidate {
+			double cost;
+			uint32_t from;
+			uint32_t to;
+			uint32_t fromVersion;
+			uint32_t toVersion;
+
+			bool operator>(const Candidate &other) const { return cost > other.cost; }
+		};
+	} // namespace
+
+	RveMeshSimplifier::Quadric RveMeshSimplifier::Quadric::FromPlane(glm::dvec3 normal, double distance, double weight) {
+		Quadric quadric{};
+		quadric.a2 = weight * normal.x * normal.x;
+		quadric.ab = weight * normal.x * normal.y;
+		quadric.ac = weight * normal.x * normal.z;
+		quadric.ad = weight * normal.x * distance;
+		quadric.b2 = weight * normal.y * normal.y;
+		quadric.bc = weight * normal.y * normal.z;
+		quadric.bd = weight * normal.y * distance;
+		quadric.c2 = weight * normal.z * normal.z;
+		quadric.cd = weight * normal.z * distance;
+		quadric.d2 = weight * distance * distance;
+		return quadric;
+	}
+
+	RveMeshSimplifier::Quadric &RveMeshSimplifier::Quadric::operator+=(const Quadric &other) {
+		a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+		b2 += other.b2; bc += other.bc; bd += other.bd;
+		c2 += other.c2; cd += other.cd;
+		d2 += other.d2;
+		return *this;
+	}
+
+	double RveMeshSimplifier::Quadric::Evaluate(glm::dvec3 p) const {
+		return a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x +
+			b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y +
+			c2 * p.z * p.z + 2.0 * cd * p.z +
+			d2;
+	}
+
+	RveMeshSimplifier::Result RveMeshSimplifier::Simplify(
+		const std::vector<glm::vec3> &positions,
+		const std::vector<uint32_t> &indices,
+		size_t targetIndexCount,
+		float maxError) {
+			assert(indices.size() % 3 == 0 && "(rve_mesh_simplifier.cpp) Index count must be a multiple of 3");
+			const size_t vertexCount = positions.size();
+			const size_t triangleCount = indices.size() / 3;
+
+			std::vector<uint32_t> triangles = indices;
+			std::vector<bool> triangleAlive(triangleCount, true);
+			std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+			std::vector<Quadric> quadrics(vertexCount);
+			std::unordered_map<uint64_t, uint32_t> edgeUse;
+
+			auto position = [&](uint32_t vertex) { return glm::dvec3{positions[vertex]}; };
+			auto triangleNormal = [&](glm::dvec3 p0, glm::dvec3 p1, glm::dvec3 p2) {
+				return glm::cross(p1 - p0, p2 - p0);
+			};
+
+			for(uint32_t t = 0; t < triangleCount; t++) {
+				const uint32_t *tri = &triangles[t * 3];
+				for(int k = 0; k < 3; k++) {
+					vertexTriangles[tri[k]].push_back(t);
+					edgeUse[EdgeKey(tri[k], tri[(k + 1) % 3])]++;
+				}
+				glm::dvec3 normal = triangleNormal(position(tri[0]), position(tri[1]), position(tri[2]));
+				double length = glm::length(normal);
+				if(length == 0.0) {
+					continue;
+				}
+				normal /= length;
+				Quadric plane = Quadric::FromPlane(normal, -glm::dot(normal, position(tri[0])), 1.0);
+				for(int k = 0; k < 3; k++) {
+					quadrics[tri[k]] += plane;
+				}
+			}
+
+			for(uint32_t t = 0; t < triangleCount; t++) {
+				const uint32_t *tri = &triangles[t * 3];
+				glm::dvec3 normal = triangleNormal(position(tri[0]), position(tri[1]), position(tri[2]));
+				for(int k = 0; k < 3; k++) {
+					uint32_t a = tri[k];
+					uint32_t b = tri[(k + 1) % 3];
+					if(edgeUse[EdgeKey(a, b)] != 1) {
+						continue;
+					}
+					glm::dvec3 borderNormal = glm::cross(position(b) - position(a), normal);
+					double length = glm::length(borderNormal);
+					if(length == 0.0) {
+						continue;
+					}
+					borderNormal /= length;
+					Quadric plane = Quadric::FromPlane(borderNormal, -glm::dot(borderNormal, position(a)), borderWeight);
+					quadrics[a] += plane;
+					quadrics[b] += plane;
+				}
+			}
+
+			std::vector<uint32_t> versions(vertexCount, 0);
+			std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+			auto pushEdge = [&](uint32_t a, uint32_t b) {
+				Quadric combined = quadrics[a];
+				combined += quadrics[b];
+				double costIntoB = std::max(combined.Evaluate(position(b)), 0.0);
+				double costIntoA = std::max(combined.Evaluate(position(a)), 0.0);
+				if(costIntoB <= costIntoA) {
+					candidates.push({costIntoB, a, b, versions[a], versions[b]});
+				} else {
+					candidates.push({costIntoA, b, a, versions[b], versions[a]});
+				}
+			};
+			for(auto &edge : edgeUse) {
+				pushEdge(static_cast<uint32_t>(edge.first >> 32), static_cast<uint32_t>(edge.first & 0xffffffffu));
+			}
+
+			size_t liveIndexCount = triangleCount * 3;
+			const double maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+			double appliedCost = 0.0;
+			std::unordered_set<uint32_t> neighbours;
+
+			while(liveIndexCount > targetIndexCount && !candidates.empty()) {
+				Candidate candidate = candidates.top();
+				candidates.pop();
+				if(versions[candidate.from] != candidate.fromVersion || versions[candidate.to] != candidate.toVersion) {
+					continue;
+				}
+				if(candidate.cost > maxCost) {
+					break;
+				}
+
+				bool adjacent = false;
+				bool flips = false;
+				for(uint32_t t : vertexTriangles[candidate.from]) {
+					if(!triangleAlive[t]) {
+						continue;
+					}
+					uint32_t *tri = &triangles[t * 3];
+					if(tri[0] == candidate.to || tri[1] == candidate.to || tri[2] == candidate.to) {
+						adjacent = true;
+						continue;
+					}
+					glm::dvec3 p[3];
+					glm::dvec3 moved[3];
+					for(int k = 0; k < 3; k++) {
+						p[k] = position(tri[k]);
+						moved[k] = tri[k] == candidate.from ? position(candidate.to) : p[k];
+					}
+					glm::dvec3 before = triangleNormal(p[0], p[1], p[2]);
+					glm::dvec3 after = triangleNormal(moved[0], moved[1], moved[2]);
+					double lengths = glm::length(before) * glm::length(after);
+					if(lengths == 0.0 || glm::dot(before, after) < minFlipCosine * lengths) {
+						flips = true;
+						break;
+					}
+				}
+				if(!adjacent || flips) {
+					continue;
+				}
+
+				auto &toTriangles = vertexTriangles[candidate.to];
+				for(uint32_t t : vertexTriangles[candidate.from]) {
+					if(!triangleAlive[t]) {
+						continue;
+					}
+					uint32_t *tri = &triangles[t * 3];
+					if(tri[0] == candidate.to || tri[1] == candidate.to || tri[2] == candidate.to) {
+						triangleAlive[t] = false;
+						liveIndexCount -= 3;
+						continue;
+					}
+					for(int k = 0; k < 3; k++) {
+						if(tri[k] == candidate.from) {
+							tri[k] = candidate.to;
+						}
+					}
+					toTriangles.push_back(t);
+				}
+				vertexTriangles[candidate.from].clear();
+				toTriangles.erase(
+					std::remove_if(toTriangles.begin(), toTriangles.end(), [&](uint32_t t) { return !triangleAlive[t]; }),
+					toTriangles.end());
+
+				quadrics[candidate.to] += quadrics[candidate.from];
+				versions[candidate.from]++;
+				versions[candidate.to]++;
+				appliedCost = std::max(appliedCost, candidate.cost);
+
+				neighbours.clear();
+				for(uint32_t t : toTriangles) {
+					for(int k = 0; k < 3; k++) {
+						if(triangles[t * 3 + k] != candidate.to) {
+							neighbours.insert(triangles[t * 3 + k]);
+						}
+					}
+				}
+				for(uint32_t neighbour : neighbours) {
+					pushEdge(candidate.to, neighbour);
+				}
+			}
+
+			Result result{};
+			result.indices.reserve(liveIndexCount);
+			for(uint32_t t = 0; t < triangleCount; t++) {
+				if(triangleAlive[t]) {
+					result.indices.insert(result.indices.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+				}
+			}
+			result.error = static_cast<float>(std::sqrt(appliedCost));
+			return result;
+	}
+} // namespace rve
@@ -0,0 +1,151 @@
+#include "../include/rve_meshlet_builder.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace rve {
+	std::vector<RveMeshlet> RveMeshletBuilder::Build(
+		const std::vector<glm::vec3> &positions,
+		std::vector<uint32_t> &indices,
+		uint32_t firstIndex,
+		uint32_t indexCount) {
+			assert(indexCount % 3 == 0 && "(rve_meshlet_builder.cpp) Index count must be a multiple of 3");
+			assert(firstIndex + indexCount <= indices.size() && "(rve_meshlet_builder.cpp) Index range out of bounds");
+			const uint32_t triangleCount = indexCount / 3;
+			const uint32_t *source = indices.data() + firstIndex;
+
+			std::vector<std::vector<uint32_t>> vertexTriangles(positions.size());
+			for(uint32_t t = 0; t < triangleCount; t++) {
+				for(int k = 0; k < 3; k++) {
+					vertexTriangles[source[t * 3 + k]].push_back(t);
+				}
+			}
+
+			std::vector<bool> emitted(triangleCount, false);
+			std::vector<uint32_t> vertexMeshlet(positions.size(), std::numeric_limits<uint32_t>::max());
+			std::vector<uint32_t> reordered;
+			reordered.reserve(indexCount);
+			std::vector<RveMeshlet> meshlets;
+			std::vector<uint32_t> candidates;
+			uint32_t emittedCount = 0;
+			uint32_t nextSeed = 0;
+
+			while(emittedCount < triangleCount) {
+				const uint32_t meshletId = static_cast<uint32_t>(meshlets.size());
+				RveMeshlet meshlet{};
+				meshlet.firstIndex = firstIndex + static_cast<uint32_t>(reordered.size());
+				uint32_t meshletTriangles = 0;
+				candidates.clear();
+
+				auto newVertices = [&](uint32_t t) {
+					uint32_t count = 0;
+					for(int k = 0; k < 3; k++) {
+						count += vertexMeshlet[source[t * 3 + k]] != meshletId ? 1 : 0;
+					}
+					return count;
+				};
+				auto emit = [&](uint32_t t) {
+					emitted[t] = true;
+					emittedCount++;
+					meshletTriangles++;
+					for(int k = 0; k < 3; k++) {
+						uint32_t vertex = source[t * 3 + k];
+						reordered.push_back(vertex);
+						if(vertexMeshlet[vertex] != meshletId) {
+							vertexMeshlet[vertex] = meshletId;
+							meshlet.vertexCount++;
+						}
+						for(uint32_t neighbour : vertexTriangles[vertex]) {
+							if(!emitted[neighbour]) {
+								candidates.push_back(neighbour);
+							}
+						}
+					}
+				};
+
+				while(emitted[nextSeed]) {
+					nextSeed++;
+				}
+				emit(nextSeed);
+
+				// Grow through shared vertices, preferring triangles that add the fewest new vertices
+				while(meshletTriangles < maxTriangles) {
+					candidates.erase(
+						std::remove_if(candidates.begin(), candidates.end(), [&](uint32_t t) { return emitted[t]; }),
+						candidates.end());
+					uint32_t best = std::numeric_limits<uint32_t>::max();
+					uint32_t bestNew = 4;
+					for(uint32_t candidate : candidates) {
+						uint32_t added = newVertices(candidate);
+						if(added < bestNew) {
+							best = candidate;
+							bestNew = added;
+							if(added == 0) {
+								break;
+							}
+						}
+					}
+					if(best == std::numeric_limits<uint32_t>::max() || meshlet.vertexCount + bestNew > maxVertices) {
+						break;
+					}
+					emit(best);
+				}
+
+				meshlet.indexCount = meshletTriangles * 3;
+				ComputeBounds(positions, reordered.data() + (meshlet.firstIndex - firstIndex), meshlet);
+				meshlets.push_back(meshlet);
+			}
+
+			std::copy(reordered.begin(), reordered.end(), indices.begin() + firstIndex);
+			return meshlets;
+	}
+
+	void RveMeshletBuilder::ComputeBounds(
+		const std::vector<glm::vec3> &positions,
+		const uint32_t *meshletIndices,
+		RveMeshlet &meshlet) {
+			glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+			glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+			for(uint32_t i = 0; i < meshlet.indexCount; i++) {
+				boundsMin = glm::min(boundsMin, positions[meshletIndices[i]]);
+				boundsMax = glm::max(boundsMax, positions[meshletIndices[i]]);
+			}
+			meshlet.center = (boundsMin + boundsMax) * 0.5f;
+			meshlet.radius = 0.0f;
+			for(uint32_t i = 0; i < meshlet.indexCount; i++) {
+				meshlet.radius = glm::max(meshlet.radius, glm::length(positions[meshletIndices[i]] - meshlet.center));
+			}
+
+			std::vector<glm::vec3> normals;
+			normals.reserve(meshlet.indexCount / 3);
+			glm::vec3 normalSum{0.0f};
+			for(uint32_t i = 0; i < meshlet.indexCount; i += 3) {
+				const glm::vec3 &p0 = positions[meshletIndices[i]];
+				glm::vec3 normal = glm::cross(positions[meshletIndices[i + 1]] - p0, positions[meshletIndices[i + 2]] - p0);
+				float length = glm::length(normal);
+				if(length > 0.0f) {
+					normals.push_back(normal / length);
+					normalSum += normals.back();
+				}
+			}
+
+			// Cone cutoff is the sine of the widest normal spread, the cluster is skipped when the view
+			// direction lies inside the cone mirrored behind it (same convention as meshoptimizer)
+			meshlet.coneAxis = {0.0f, 0.0f, 1.0f};
+			meshlet.coneCutoff = 1.0f;
+			float sumLength = glm::length(normalSum);
+			if(sumLength == 0.0f) {
+				return;
+			}
+			meshlet.coneAxis = normalSum / sumLength;
+			float minDot = 1.0f;
+			for(auto &normal : normals) {
+				minDot = glm::min(minDot, glm::dot(normal, meshlet.coneAxis));
+			}
+			if(minDot > 0.0f) {
+				meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+	}
+} // namespace rve
@@ -0,0 +1,463 @@
+#include "../include/rve_meshlet_culler.hpp"
+#include "../include/rve_geometry_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace rve {
+	struct RveMeshletCullPushConstants {
+		glm::vec4 frustumPlanes[6];
+		glm::vec4 cameraPosition;
+		uint32_t instanceCount;
+		uint32_t commandCount;
+		uint32_t phase;
+	};
+
+	RveMeshletCuller::RveMeshletCuller(RveVulkanDevice& device) : rveVulkanDevice{device} {
+		CreateDescriptorResources();
+		CreatePipelineLayout();
+		cullPipeline = std::make_unique<RveComputePipeline>(
+			rveVulkanDevice,
+			"shaders/meshlet_cull.comp.spv",
+			pipelineLayout
+		);
+		for(auto& frame : frames) {
+			CreateFrameResources(frame);
+		}
+	}
+
+	RveMeshletCuller::~RveMeshletCuller() {
+		for(auto& frame : frames) {
+			DestroyFrameResources(frame);
+		}
+		rveVulkanDevice.GetDeletionQueue().DestroyBuffer(meshletBuffer);
+		rveVulkanDevice.GetDeletionQueue().FreeMemory(meshletMemory);
+		cullPipeline = nullptr;
+		vkDestroyPipelineLayout(rveVulkanDevice.Device(), pipelineLayout, nullptr);
+		vkDestroyDescriptorPool(rveVulkanDevice.Device(), descriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(rveVulkanDevice.Device(), descriptorSetLayout, nullptr);
+	}
+
+	void RveMeshletCuller::CreateDescriptorResources() {
+		std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+		for(uint32_t i = 0; i < bindings.size(); i++) {
+			bindings[i].binding = i;
+			bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			bindings[i].descriptorCount = 1;
+			bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+		if(vkCreateDescriptorSetLayout(rveVulkanDevice.Device(), &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_meshlet_culler.cpp) Failed to create descriptor set layout");
+		}
+
+		VkDescriptorPoolSize poolSize{};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = static_cast<uint32_t>(bindings.size() * frames.size());
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+		poolInfo.maxSets = static_cast<uint32_t>(frames.size());
+		if(vkCreateDescriptorPool(rveVulkanDevice.Device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_meshlet_culler.cpp) Failed to create descriptor pool");
+		}
+	}
+
+	void RveMeshletCuller::CreatePipelineLayout() {
+		VkPushConstantRange pushConstantRange;
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(RveMeshletCullPushConstants);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if(vkCreatePipelineLayout(rveVulkanDevice.Device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_meshlet_culler.cpp) Failed to create pipeline layout");
+		}
+	}
+
+	void RveMeshletCuller::CreateFrameResources(FrameResources& frame) {
+		rveVulkanDevice.CreateBuffer(
+			sizeof(GpuStats),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			frame.statsBuffer,
+			frame.statsMemory);
+		vkMapMemory(rveVulkanDevice.Device(), frame.statsMemory, 0, sizeof(GpuStats), 0, &frame.statsMapped);
+		memset(frame.statsMapped, 0, sizeof(GpuStats));
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &descriptorSetLayout;
+		if(vkAllocateDescriptorSets(rveVulkanDevice.Device(), &allocInfo, &frame.descriptorSet) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_meshlet_culler.cpp) Failed to allocate descriptor set");
+		}
+		EnsureFrameCapacity(frame, 64, 1024);
+	}
+
+	void RveMeshletCuller::DestroyFrameResources(FrameResources& frame) {
+		if(frame.instanceBuffer != VK_NULL_HANDLE) {
+			vkUnmapMemory(rveVulkanDevice.Device(), frame.instanceMemory);
+			vkDestroyBuffer(rveVulkanDevice.Device(), frame.instanceBuffer, nullptr);
+			vkFreeMemory(rveVulkanDevice.Device(), frame.instanceMemory, nullptr);
+		}
+		if(frame.commandBuffer != VK_NULL_HANDLE) {
+			vkDestroyBuffer(rveVulkanDevice.Device(), frame.commandBuffer, nullptr);
+			vkFreeMemory(rveVulkanDevice.Device(), frame.commandMemory, nullptr);
+		}
+		vkUnmapMemory(rveVulkanDevice.Device(), frame.statsMemory);
+		vkDestroyBuffer(rveVulkanDevice.Device(), frame.statsBuffer, nullptr);
+		vkFreeMemory(rveVulkanDevice.Device(), frame.statsMemory, nullptr);
+	}
+
+	void RveMeshletCuller::EnsureFrameCapacity(FrameResources& frame, uint32_t instanceCount, uint32_t requiredCommands) {
+		// The slot's previous submission has retired, so its buffers can be replaced right away
+		bool changed = false;
+		if(instanceCount > frame.instanceCapacity) {
+			if(frame.instanceBuffer != VK_NULL_HANDLE) {
+				vkUnmapMemory(rveVulkanDevice.Device(), frame.instanceMemory);
+				vkDestroyBuffer(rveVulkanDevice.Device(), frame.instanceBuffer, nullptr);
+				vkFreeMemory(rveVulkanDevice.Device(), frame.instanceMemory, nullptr);
+			}
+			frame.instanceCapacity = std::max(instanceCount, frame.instanceCapacity * 2);
+			rveVulkanDevice.CreateBuffer(
+				sizeof(Instance) * frame.instanceCapacity,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+				frame.instanceBuffer,
+				frame.instanceMemory);
+			vkMapMemory(rveVulkanDevice.Device(), frame.instanceMemory, 0, VK_WHOLE_SIZE, 0, &frame.instanceMapped);
+			changed = true;
+		}
+		if(requiredCommands > frame.commandCapacity) {
+			if(frame.commandBuffer != VK_NULL_HANDLE) {
+				vkDestroyBuffer(rveVulkanDevice.Device(), frame.commandBuffer, nullptr);
+				vkFreeMemory(rveVulkanDevice.Device(), frame.commandMemory, nullptr);
+			}
+			frame.commandCapacity = std::max(requiredCommands, frame.commandCapacity * 2);
+			// Early commands first, then late commands
+			rveVulkanDevice.CreateBuffer(
+				sizeof(VkDrawIndexedIndirectCommand) * frame.commandCapacity * 2,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				frame.commandBuffer,
+				frame.commandMemory);
+			changed = true;
+		}
+		if(changed) {
+			frame.descriptorSetStale = true;
+		}
+	}
+
+	void RveMeshletCuller::WriteDescriptorSet(FrameResources& frame) {
+		std::array<VkDescriptorBufferInfo, 5> bufferInfos{};
+		bufferInfos[0] = {meshletBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[1] = {frame.instanceBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[2] = {frame.commandBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[3] = {frame.statsBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[4] = {frame.objectPhaseBuffer, 0, VK_WHOLE_SIZE};
+
+		std::array<VkWriteDescriptorSet, 5> writes{};
+		for(uint32_t i = 0; i < writes.size(); i++) {
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = frame.descriptorSet;
+			writes[i].dstBinding = i;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writes[i].pBufferInfo = &bufferInfos[i];
+		}
+		vkUpdateDescriptorSets(rveVulkanDevice.Device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		frame.descriptorSetStale = false;
+	}
+
+	void RveMeshletCuller::UploadMeshlets(VkCommandBuffer commandBuffer) {
+		RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		bool copiedOld = false;
+		if(meshletCapacity > bufferCapacity) {
+			VkBuffer newBuffer;
+			VkDeviceMemory newMemory;
+			rveVulkanDevice.CreateBuffer(
+				sizeof(RveMeshlet) * meshletCapacity,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				newBuffer,
+				newMemory);
+			if(bufferCapacity > 0) {
+				// Earlier frames uploaded what is copied over
+				VkMemoryBarrier growBarrier{};
+				growBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+				growBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				growBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0, 1, &growBarrier, 0, nullptr, 0, nullptr);
+				VkBufferCopy copyRegion{0, 0, sizeof(RveMeshlet) * bufferCapacity};
+				vkCmdCopyBuffer(commandBuffer, meshletBuffer, newBuffer, 1, &copyRegion);
+				copiedOld = true;
+			}
+			// Frames in flight and the copy above still read the old buffer
+			deletionQueue.DestroyBuffer(meshletBuffer);
+			deletionQueue.FreeMemory(meshletMemory);
+			meshletBuffer = newBuffer;
+			meshletMemory = newMemory;
+			bufferCapacity = meshletCapacity;
+			for(auto& frame : frames) {
+				frame.descriptorSetStale = true;
+			}
+		}
+
+		if(!stagedUploads.empty()) {
+			if(copiedOld) {
+				// Reused ranges may have been part of the copy above
+				VkMemoryBarrier copyBarrier{};
+				copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+				copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				copyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				vkCmdPipelineBarrier(
+					commandBuffer,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					VK_PIPELINE_STAGE_TRANSFER_BIT,
+					0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+			}
+			// Released right away, the deletion queue keeps it until this frame retires
+			VkDeviceSize uploadSize = sizeof(RveMeshlet) * stagedMeshlets.size();
+			RveBuffer stagingBuffer{
+				rveVulkanDevice,
+				uploadSize,
+				1,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+			if(stagingBuffer.Map() != VK_SUCCESS) {
+				throw std::runtime_error("(rve_meshlet_culler.cpp) Failed to map meshlet staging buffer");
+			}
+			stagingBuffer.WriteToBuffer(stagedMeshlets.data(), uploadSize);
+			std::vector<VkBufferCopy> copyRegions;
+			copyRegions.reserve(stagedUploads.size());
+			for(const auto& upload : stagedUploads) {
+				copyRegions.push_back({
+					sizeof(RveMeshlet) * upload.dataOffset,
+					sizeof(RveMeshlet) * upload.range.first,
+					sizeof(RveMeshlet) * upload.range.count});
+			}
+			vkCmdCopyBuffer(
+				commandBuffer,
+				stagingBuffer.GetBuffer(),
+				meshletBuffer,
+				static_cast<uint32_t>(copyRegions.size()),
+				copyRegions.data());
+			stagedMeshlets.clear();
+			stagedUploads.clear();
+		}
+
+		VkMemoryBarrier uploadBarrier{};
+		uploadBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		uploadBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		uploadBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &uploadBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void RveMeshletCuller::ReleaseRetired() {
+		const RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		size_t released = 0;
+		for(; released < pendingFrees.size() && deletionQueue.IsRetired(pendingFrees[released].frame); released++) {
+			meshletAllocator.Release(pendingFrees[released].range.first, pendingFrees[released].range.count);
+		}
+		pendingFrees.erase(pendingFrees.begin(), pendingFrees.begin() + released);
+	}
+
+	void RveMeshletCuller::BeginFrame(int frameIndex) {
+		currentFrame = frameIndex;
+		FrameResources& frame = frames[currentFrame];
+		GpuStats gpuStats;
+		memcpy(&gpuStats, frame.statsMapped, sizeof(GpuStats));
+		stats.meshletsTotal = frame.meshletsSubmitted;
+		stats.meshletsVisible = gpuStats.meshletsVisible;
+		stats.frustumCulled = gpuStats.frustumCulled;
+		stats.coneCulled = gpuStats.coneCulled;
+
+		ReleaseRetired();
+		instances.clear();
+		commandCount = 0;
+		maxMeshletsPerInstance = 0;
+	}
+
+	uint32_t RveMeshletCuller::AddInstance(
+		RveModelHandle handle,
+		const RveModel& model,
+		const glm::mat4& modelMatrix,
+		float maxScale,
+		uint32_t objectIndex) {
+			assert(model.HasMeshlets() && "(rve_meshlet_culler.cpp) Model has no meshlets");
+			auto registered = modelMeshlets.find(handle.value);
+			if(registered == modelMeshlets.end()) {
+				const auto& meshlets = model.GetMeshlets();
+				MeshletRange range{0, static_cast<uint32_t>(meshlets.size())};
+				if(!meshletAllocator.Allocate(range.count, range.first)) {
+					// The new tail merges with any free block before it, the buffer itself grows on upload
+					uint32_t newCapacity = std::max(meshletCapacity * 2, meshletCapacity + range.count);
+					meshletAllocator.Release(meshletCapacity, newCapacity - meshletCapacity);
+					meshletCapacity = newCapacity;
+					meshletAllocator.Allocate(range.count, range.first);
+				}
+				stagedUploads.push_back({range, stagedMeshlets.size()});
+				stagedMeshlets.insert(stagedMeshlets.end(), meshlets.begin(), meshlets.end());
+				registered = modelMeshlets.emplace(handle.value, range).first;
+			}
+
+			const auto& range = model.GetGeometryPool().GetRange(model.GetMeshHandle());
+			Instance instance{};
+			instance.modelMatrix = modelMatrix;
+			instance.firstMeshlet = registered->second.first;
+			instance.meshletCount = registered->second.count;
+			instance.firstCommand = commandCount;
+			instance.maxScale = maxScale;
+			instance.vertexOffset = static_cast<int32_t>(range.firstVertex);
+			instance.firstIndex = range.firstIndex;
+			instance.objectIndex = objectIndex;
+			instances.push_back(instance);
+
+			commandCount += instance.meshletCount;
+			maxMeshletsPerInstance = std::max(maxMeshletsPerInstance, instance.meshletCount);
+			return static_cast<uint32_t>(instances.size() - 1);
+	}
+
+	void RveMeshletCuller::RemoveModel(RveModelHandle handle) {
+		auto registered = modelMeshlets.find(handle.value);
+		if(registered == modelMeshlets.end()) {
+			return;
+		}
+		const MeshletRange range = registered->second;
+		modelMeshlets.erase(registered);
+		// A staged upload that was never recorded must not land in the range once it is reused
+		stagedUploads.erase(
+			std::remove_if(
+				stagedUploads.begin(),
+				stagedUploads.end(),
+				[&](const StagedUpload& upload) { return upload.range.first == range.first; }),
+			stagedUploads.end());
+		pendingFrees.push_back({range, rveVulkanDevice.GetDeletionQueue().GetFrame()});
+	}
+
+	void RveMeshletCuller::Dispatch(const RveFrameInfo& frameInfo, RveDrawPhase phase, VkBuffer objectPhaseBuffer) {
+		FrameResources& frame = frames[currentFrame];
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+		if(phase == RveDrawPhase::Early) {
+			frame.meshletsSubmitted = commandCount;
+			if(instances.empty()) {
+				memset(frame.statsMapped, 0, sizeof(GpuStats));
+				return;
+			}
+			if(meshletCapacity > bufferCapacity || !stagedUploads.empty()) {
+				UploadMeshlets(commandBuffer);
+			}
+			EnsureFrameCapacity(frame, static_cast<uint32_t>(instances.size()), commandCount);
+			if(frame.objectPhaseBuffer != objectPhaseBuffer) {
+				frame.objectPhaseBuffer = objectPhaseBuffer;
+				frame.descriptorSetStale = true;
+			}
+			if(frame.descriptorSetStale) {
+				WriteDescriptorSet(frame);
+			}
+			memcpy(frame.instanceMapped, instances.data(), sizeof(Instance) * instances.size());
+
+			vkCmdFillBuffer(commandBuffer, frame.statsBuffer, 0, sizeof(GpuStats), 0);
+
+			VkMemoryBarrier clearBarrier{};
+			clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+		} else if(instances.empty()) {
+			return;
+		}
+		assert(
+			frame.objectPhaseBuffer == objectPhaseBuffer &&
+			"(rve_meshlet_culler.cpp) Phase buffer changed between early and late dispatch"
+		);
+
+		RveMeshletCullPushConstants push{};
+		auto planes = frameInfo.camera.GetFrustumPlanes();
+		for(size_t i = 0; i < planes.size(); i++) {
+			push.frustumPlanes[i] = planes[i];
+		}
+		push.cameraPosition = glm::vec4{frameInfo.camera.GetPosition(), 1.0f};
+		push.instanceCount = static_cast<uint32_t>(instances.size());
+		push.commandCount = commandCount;
+		push.phase = static_cast<uint32_t>(phase);
+
+		cullPipeline->Bind(commandBuffer);
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			pipelineLayout,
+			0, 1, &frame.descriptorSet,
+			0, nullptr);
+		vkCmdPushConstants(
+			commandBuffer,
+			pipelineLayout,
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			0,
+			sizeof(RveMeshletCullPushConstants),
+			&push);
+		vkCmdDispatch(commandBuffer, (maxMeshletsPerInstance + 63) / 64, push.instanceCount, 1);
+
+		VkMemoryBarrier cullBarrier{};
+		cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+			0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void RveMeshletCuller::DrawInstance(VkCommandBuffer commandBuffer, uint32_t instanceIndex, RveDrawPhase phase) {
+		const Instance& instance = instances[instanceIndex];
+		const FrameResources& frame = frames[currentFrame];
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+		const uint32_t firstCommand = static_cast<uint32_t>(phase) * commandCount + instance.firstCommand;
+		if(rveVulkanDevice.EnabledFeatures().multiDrawIndirect) {
+			vkCmdDrawIndexedIndirect(
+				commandBuffer,
+				frame.commandBuffer,
+				static_cast<VkDeviceSize>(firstCommand) * stride,
+				instance.meshletCount,
+				stride);
+			return;
+		}
+		for(uint32_t i = 0; i < instance.meshletCount; i++) {
+			vkCmdDrawIndexedIndirect(
+				commandBuffer,
+				frame.commandBuffer,
+				static_cast<VkDeviceSize>(firstCommand + i) * stride,
+				1,
+				stride);
+		}
+	}
+} // namespace rve
@@ -1,64 +1,382 @@
 #include "../include/rve_model.hpp"
+#include "../include/rve_geometry_pool.hpp"
+#include "../include/rve_mesh_simplifier.hpp"
 
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
 #include <cstddef>
-#include <cstring>
 
 namespace rve {
-	RveModel::RveModel(RveVulkanDevice& device, std::vector<Vertex> &vertices) : rveDevice{device} {
-		CreateVertexBuffers(vertices);
+	namespace {
+		// https://knarkowicz.wordpress.com/2014/04/16/octahedron-normal-vector-encoding/
+		glm::vec2 EncodeOctahedral(glm::vec3 normal) {
+			float length = glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z);
+			if(length == 0.0f) {
+				return {0.0f, 0.0f};
+			}
+			normal /= length;
+			glm::vec2 encoded{normal.x, normal.y};
+			if(normal.z < 0.0f) {
+				encoded = {
+					(1.0f - glm::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f),
+					(1.0f - glm::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f)
+				};
+			}
+			return encoded;
+		}
+
+		glm::vec3 DecodeOctahedral(glm::vec2 encoded) {
+			glm::vec3 normal{encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y)};
+			float t = glm::max(-normal.z, 0.0f);
+			normal.x += normal.x >= 0.0f ? -t : t;
+			normal.y += normal.y >= 0.0f ? -t : t;
+			return glm::normalize(normal);
+		}
+
+		int16_t ToSnorm16(float value) {
+			return static_cast<int16_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+		}
+
+		uint8_t ToUnorm8(float value) {
+			return static_cast<uint8_t>(std::lround(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+		}
+	} // namespace
+
+	RveModel::RveModel(RveGeometryPool& pool, const MeshData& data, bool streamed) :
+		rveGeometryPool{pool}, vertexFormat{pool.GetVertexFormat()} {
+			vertexCount = static_cast<uint32_t>(data.vertices.size());
+			assert(vertexCount >= 3 && "(rve_model.cpp) Vertex count must be at least 3");
+			indexCount = static_cast<uint32_t>(data.indices.size());
+			lods.assign(data.lods.begin(), data.lods.end());
+			meshlets.assign(data.meshlets.begin(), data.meshlets.end());
+			if(lods.empty()) {
+				lods.push_back({0, indexCount, 0.0f});
+			}
+
+			if(streamed && data.hasBounds) {
+				// Boxing the sphere keeps streamed models from reading their vertices before they are needed
+				boundingCenter = data.boundingCenter;
+				boundingRadius = data.boundingRadius;
+				boundsMin = boundingCenter - glm::vec3{boundingRadius};
+				boundsExtent = glm::vec3{boundingRadius * 2.0f};
+			} else {
+				boundsMin = data.vertices[0].position;
+				glm::vec3 boundsMax{data.vertices[0].position};
+				for(auto& vertex : data.vertices) {
+					boundsMin = glm::min(boundsMin, vertex.position);
+					boundsMax = glm::max(boundsMax, vertex.position);
+				}
+				boundsExtent = boundsMax - boundsMin;
+				if(data.hasBounds) {
+					boundingCenter = data.boundingCenter;
+					boundingRadius = data.boundingRadius;
+				} else {
+					boundingCenter = (boundsMin + boundsMax) * 0.5f;
+					for(auto& vertex : data.vertices) {
+						boundingRadius = glm::max(boundingRadius, glm::length(vertex.position - boundingCenter));
+					}
+				}
+			}
+			for(int axis = 0; axis < 3; axis++) {
+				if(boundsExtent[axis] <= 0.0f) {
+					boundsExtent[axis] = 1.0f;
+				}
+			}
+			if(vertexFormat == RveVertexFormat::Compact) {
+				// unorm16 positions land in [0, 1], the model transform scales them back into mesh space
+				dequantizeTransform = glm::scale(glm::translate(glm::mat4{1.0f}, boundsMin), boundsExtent);
+			}
+
+			if(streamed) {
+				CreateCoarseMesh(data);
+			} else {
+				MakeResident(StageMesh(data));
+			}
 	}
 
 	RveModel::~RveModel() {
-		vkDestroyBuffer(rveDevice.Device(), vertexBuffer, nullptr);
-		vkFreeMemory(rveDevice.Device(), vertexBufferMemory, nullptr);
+		if(meshHandle != noHandle) {
+			rveGeometryPool.Free(meshHandle);
+		}
+		if(coarseHandle != noHandle) {
+			rveGeometryPool.Free(coarseHandle);
+		}
+	}
+
+	void RveModel::CreateCoarseMesh(const MeshData& data) {
+		StagedMesh staged{};
+		std::vector<Vertex> coarseVertices;
+		std::vector<uint32_t> coarseIndices;
+		if(lods.size() > 1 && lods.back().indexCount > 0) {
+			// The coarsest LOD references few of the vertices, so it gets its own compact vertex list
+			const Lod& lod = lods.back();
+			std::unordered_map<uint32_t, uint32_t> remap;
+			coarseIndices.reserve(lod.indexCount);
+			for(uint32_t index : data.indices.subspan(lod.firstIndex, lod.indexCount)) {
+				auto [entry, inserted] = remap.try_emplace(index, static_cast<uint32_t>(coarseVertices.size()));
+				if(inserted) {
+					coarseVertices.push_back(data.vertices[index]);
+				}
+				coarseIndices.push_back(entry->second);
+			}
+		} else {
+			// Without a coarser LOD a box over the bounds stands in while the mesh loads
+			static constexpr uint32_t boxIndices[] = {
+				0, 1, 3, 0, 3, 2,  4, 6, 7, 4, 7, 5,
+				0, 4, 5, 0, 5, 1,  2, 3, 7, 2, 7, 6,
+				0, 2, 6, 0, 6, 4,  1, 5, 7, 1, 7, 3};
+			for(uint32_t corner = 0; corner < 8; corner++) {
+				glm::vec3 unit{corner & 4 ? 1.0f : 0.0f, corner & 2 ? 1.0f : 0.0f, corner & 1 ? 1.0f : 0.0f};
+				Vertex vertex{};
+				vertex.position = boundsMin + unit * boundsExtent;
+				vertex.color = glm::vec3{0.5f};
+				vertex.normal = glm::normalize(unit * 2.0f - 1.0f);
+				vertex.uv = {unit.x, unit.y};
+				coarseVertices.push_back(vertex);
+			}
+			coarseIndices.assign(std::begin(boxIndices), std::end(boxIndices));
+		}
+
+		staged.data.vertices = coarseVertices;
+		staged.data.indices = coarseIndices;
+		if(vertexFormat == RveVertexFormat::Compact) {
+			staged.compactVertices = QuantizeVertices(coarseVertices, boundsMin, boundsExtent, nullptr);
+		}
+		coarseIndexCount = static_cast<uint32_t>(coarseIndices.size());
+		coarseHandle = AllocateMesh(staged);
+	}
+
+	RveModel::StagedMesh RveModel::StageMesh(const MeshData& data) const {
+		assert(data.vertices.size() == vertexCount && data.indices.size() == indexCount && "(rve_model.cpp) Staged data is not this model's mesh");
+		StagedMesh staged{};
+		staged.data = data;
+		if(vertexFormat == RveVertexFormat::Compact) {
+			staged.compactVertices = QuantizeVertices(data.vertices, boundsMin, boundsExtent, &staged.report);
+		} else {
+			// Touch every page so a mapped file is read here rather than during the upload
+			constexpr size_t pageSize = 4096;
+			const volatile char *vertexBytes = reinterpret_cast<const char*>(data.vertices.data());
+			for(size_t offset = 0; offset < data.vertices.size_bytes(); offset += pageSize) {
+				(void)vertexBytes[offset];
+			}
+			const volatile char *indexBytes = reinterpret_cast<const char*>(data.indices.data());
+			for(size_t offset = 0; offset < data.indices.size_bytes(); offset += pageSize) {
+				(void)indexBytes[offset];
+			}
+		}
+		return staged;
+	}
+
+	uint32_t RveModel::AllocateMesh(const StagedMesh& staged) {
+		const uint32_t *indexData = staged.data.indices.empty() ? nullptr : staged.data.indices.data();
+		const void *vertexData = vertexFormat == RveVertexFormat::Compact ?
+			static_cast<const void*>(staged.compactVertices.data()) :
+			static_cast<const void*>(staged.data.vertices.data());
+		return rveGeometryPool.Allocate(
+			vertexData,
+			static_cast<uint32_t>(staged.data.vertices.size()),
+			indexData,
+			static_cast<uint32_t>(staged.data.indices.size()));
+	}
+
+	void RveModel::MakeResident(const StagedMesh& staged) {
+		assert(!IsResident() && "(rve_model.cpp) Model is already resident");
+		meshHandle = AllocateMesh(staged);
+		if(vertexFormat == RveVertexFormat::Compact) {
+			quantizationReport = staged.report;
+		}
+	}
+
+	void RveModel::Evict() {
+		assert(IsStreamed() && IsResident() && "(rve_model.cpp) Only resident streamed models can be evicted");
+		rveGeometryPool.Free(meshHandle);
+		meshHandle = noHandle;
+	}
+
+	VkDeviceSize RveModel::GetMeshBytes() const {
+		return rveGeometryPool.GetVertexStride() * vertexCount + sizeof(uint32_t) * indexCount;
 	}
 
-	void RveModel::Bind(VkCommandBuffer commandBuffer) {
-		VkBuffer buffers[] = {vertexBuffer};
-		VkDeviceSize offsets[] = {0};
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+	void RveModel::Draw(VkCommandBuffer commandBuffer, uint32_t lodLevel) {
+		if(!IsResident()) {
+			rveGeometryPool.Draw(commandBuffer, coarseHandle);
+			return;
+		}
+		const Lod& lod = lods[lodLevel];
+		if(lod.indexCount == 0) {
+			rveGeometryPool.Draw(commandBuffer, meshHandle);
+		} else {
+			rveGeometryPool.DrawIndexRange(commandBuffer, meshHandle, lod.firstIndex, lod.indexCount);
+		}
 	}
 
-	void RveModel::Draw(VkCommandBuffer commandBuffer) {
-		vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+	uint32_t RveModel::GetTriangleCount(uint32_t lodLevel) const {
+		const Lod& lod = lods[lodLevel];
+		return (lod.indexCount == 0 ? vertexCount : lod.indexCount) / 3;
 	}
 
-	void RveModel::CreateVertexBuffers(std::vector<Vertex> &vertices) {
-		vertexCount = static_cast<uint32_t>(vertices.size());
-		assert(vertexCount >= 3 && "(rve_model.cpp) Vertex count must be at least 3");
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
-		rveDevice.CreateBuffer(
-			bufferSize,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			vertexBuffer,
-			vertexBufferMemory);
-		void *data;
-		vkMapMemory(rveDevice.Device(), vertexBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-		vkUnmapMemory(rveDevice.Device(), vertexBufferMemory);
+	void RveModel::Builder::GenerateMeshlets() {
+		if(indices.empty()) {
+			return;
+		}
+		std::vector<glm::vec3> positions(vertices.size());
+		for(size_t i = 0; i < vertices.size(); i++) {
+			positions[i] = vertices[i].position;
+		}
+		uint32_t baseIndexCount = lods.empty() ? static_cast<uint32_t>(indices.size()) : lods[0].indexCount;
+		meshlets = RveMeshletBuilder::Build(positions, indices, 0, baseIndexCount);
+		if(twoSided) {
+			// A cutoff of 1 disables the cone test in meshlet_cull.comp
+			for(RveMeshlet& meshlet : meshlets) {
+				meshlet.coneCutoff = 1.0f;
+			}
+		}
 	}
 
-	std::vector<VkVertexInputBindingDescription> RveModel::Vertex::GetBindingDescriptions() {
+	void RveModel::Builder::GenerateLods(uint32_t maxLodCount, float reduction) {
+		if(indices.empty()) {
+			return;
+		}
+		assert(lods.empty() && "(rve_model.cpp) LODs have already been generated");
+
+		std::vector<glm::vec3> positions(vertices.size());
+		for(size_t i = 0; i < vertices.size(); i++) {
+			positions[i] = vertices[i].position;
+		}
+
+		lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+		std::vector<uint32_t> previous = indices;
+		float error = 0.0f;
+		while(lods.size() < maxLodCount) {
+			size_t target = static_cast<size_t>(previous.size() * reduction) / 3 * 3;
+			auto result = RveMeshSimplifier::Simplify(positions, previous, target, std::numeric_limits<float>::max());
+			// Stop once the simplifier can no longer make meaningful progress
+			if(result.indices.empty() || result.indices.size() > previous.size() * 0.9f) {
+				break;
+			}
+			error += result.error;
+			lods.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(result.indices.size()), error});
+			indices.insert(indices.end(), result.indices.begin(), result.indices.end());
+			previous = std::move(result.indices);
+		}
+	}
+
+	std::vector<RveModel::CompactVertex> RveModel::QuantizeVertices(
+		std::span<const Vertex> vertices,
+		glm::vec3 boundsMin,
+		glm::vec3 extent,
+		QuantizationReport *reportOut) {
+		std::vector<CompactVertex> compactVertices(vertices.size());
+		QuantizationReport report{};
+		report.floatBytes = sizeof(Vertex) * vertices.size();
+		report.compactBytes = sizeof(CompactVertex) * vertices.size();
+		double positionErrorSum = 0.0;
+
+		for(size_t i = 0; i < vertices.size(); i++) {
+			const Vertex& vertex = vertices[i];
+			CompactVertex& compact = compactVertices[i];
+
+			glm::vec3 relative = (vertex.position - boundsMin) / extent;
+			glm::vec3 decodedPosition{};
+			for(int axis = 0; axis < 3; axis++) {
+				compact.position[axis] = static_cast<uint16_t>(
+					std::lround(glm::clamp(relative[axis], 0.0f, 1.0f) * 65535.0f));
+				decodedPosition[axis] = boundsMin[axis] + (compact.position[axis] / 65535.0f) * extent[axis];
+			}
+			compact.position[3] = 65535;
+
+			for(int channel = 0; channel < 3; channel++) {
+				compact.color[channel] = ToUnorm8(vertex.color[channel]);
+				report.maxColorError = glm::max(
+					report.maxColorError,
+					glm::abs(compact.color[channel] / 255.0f - vertex.color[channel]));
+			}
+			compact.color[3] = 255;
+
+			glm::vec2 octahedral = EncodeOctahedral(vertex.normal);
+			compact.normal[0] = ToSnorm16(octahedral.x);
+			compact.normal[1] = ToSnorm16(octahedral.y);
+			if(glm::dot(vertex.normal, vertex.normal) > 0.0f) {
+				glm::vec3 decodedNormal = DecodeOctahedral({compact.normal[0] / 32767.0f, compact.normal[1] / 32767.0f});
+				float cosine = glm::clamp(glm::dot(decodedNormal, glm::normalize(vertex.normal)), -1.0f, 1.0f);
+				report.maxNormalErrorDegrees = glm::max(report.maxNormalErrorDegrees, glm::degrees(std::acos(cosine)));
+			}
+
+			uint32_t packedUv = glm::packHalf2x16(vertex.uv);
+			compact.uv[0] = static_cast<uint16_t>(packedUv);
+			compact.uv[1] = static_cast<uint16_t>(packedUv >> 16);
+			glm::vec2 uvError = glm::abs(glm::unpackHalf2x16(packedUv) - vertex.uv);
+			report.maxUvError = glm::max(report.maxUvError, glm::max(uvError.x, uvError.y));
+
+			float positionError = glm::length(decodedPosition - vertex.position);
+			report.maxPositionError = glm::max(report.maxPositionError, positionError);
+			positionErrorSum += positionError;
+		}
+		report.meanPositionError = static_cast<float>(positionErrorSum / vertices.size());
+		if(reportOut != nullptr) {
+			*reportOut = report;
+		}
+		return compactVertices;
+	}
+
+	std::vector<VkVertexInputBindingDescription> RveModel::Vertex::GetBindingDescriptions(RveVertexFormat format) {
 		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
 		bindingDescriptions[0].binding = 0;
 		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-		bindingDescriptions[0].stride = sizeof(Vertex);
+		bindingDescriptions[0].stride = format == RveVertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex);
 		return bindingDescriptions;
 	}
 
-	std::vector<VkVertexInputAttributeDescription> RveModel::Vertex::GetAttributeDescriptions() {
-		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
+	std::vector<VkVertexInputAttributeDescription> RveModel::Vertex::GetAttributeDescriptions(RveVertexFormat format) {
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(4);
+		if(format == RveVertexFormat::Compact) {
+			attributeDescriptions[0].binding = 0;
+			attributeDescriptions[0].location = 0;
+			attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+			attributeDescriptions[0].offset = offsetof(CompactVertex, position);
+
+			attributeDescriptions[1].binding = 0;
+			attributeDescriptions[1].location = 1;
+			attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+			attributeDescriptions[1].offset = offsetof(CompactVertex, color);
+
+			attributeDescriptions[2].binding = 0;
+			attributeDescriptions[2].location = 2;
+			attributeDescriptions[2].format = VK_FORMAT_R16G16_SNORM;
+			attributeDescriptions[2].offset = offsetof(CompactVertex, normal);
+
+			attributeDescriptions[3].binding = 0;
+			attributeDescriptions[3].location = 3;
+			attributeDescriptions[3].format = VK_FORMAT_R16G16_SFLOAT;
+			attributeDescriptions[3].offset = offsetof(CompactVertex, uv);
+			return attributeDescriptions;
+		}
+
 		attributeDescriptions[0].binding = 0;
 		attributeDescriptions[0].location = 0;
 		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
 		attributeDescriptions[0].offset = offsetof(Vertex, position);
-		
+
 		attributeDescriptions[1].binding = 0;
 		attributeDescriptions[1].location = 1;
 		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
 		attributeDescriptions[1].offset = offsetof(Vertex, color);
+
+		attributeDescriptions[2].binding = 0;
+		attributeDescriptions[2].location = 2;
+		attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[2].offset = offsetof(Vertex, normal);
+
+		attributeDescriptions[3].binding = 0;
+		attributeDescriptions[3].location = 3;
+		attributeDescriptions[3].format = VK_FORMAT_R32G32_SFLOAT;
+		attributeDescriptions[3].offset = offsetof(Vertex, uv);
 		return attributeDescriptions;
 	}
 } // namespace rve
@@ -0,0 +1,625 @@
+#include "../include/rve_occlusion_culler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace rve {
+	struct RveOcclusionCullPushConstants {
+		float p00;
+		float p11;
+		float p22;
+		float p32;
+		float zNear;
+		float zFar;
+		uint32_t depthWidth;
+		uint32_t depthHeight;
+		uint32_t objectCount;
+		uint32_t phase;
+		uint32_t pyramidLevels;
+		uint32_t occlusionEnabled;
+	};
+
+	struct RveDepthPyramidPushConstants {
+		uint32_t sourceWidth;
+		uint32_t sourceHeight;
+		uint32_t destinationWidth;
+		uint32_t destinationHeight;
+	};
+
+	RveOcclusionCuller::RveOcclusionCuller(RveVulkanDevice& device) : rveVulkanDevice{device} {
+		CreateDescriptorResources();
+		CreatePipelineLayouts();
+		cullPipeline = std::make_unique<RveComputePipeline>(
+			rveVulkanDevice,
+			"shaders/occlusion_cull.comp.spv",
+			cullPipelineLayout
+		);
+		pyramidPipeline = std::make_unique<RveComputePipeline>(
+			rveVulkanDevice,
+			"shaders/depth_pyramid.comp.spv",
+			pyramidPipelineLayout
+		);
+		for(auto& frame : frames) {
+			CreateFrameResources(frame);
+		}
+	}
+
+	RveOcclusionCuller::~RveOcclusionCuller() {
+		for(auto& frame : frames) {
+			DestroyFrameResources(frame);
+		}
+		rveVulkanDevice.GetDeletionQueue().DestroyBuffer(visibilityBuffer);
+		rveVulkanDevice.GetDeletionQueue().FreeMemory(visibilityMemory);
+		cullPipeline = nullptr;
+		pyramidPipeline = nullptr;
+		vkDestroySampler(rveVulkanDevice.Device(), pyramidSampler, nullptr);
+		vkDestroyPipelineLayout(rveVulkanDevice.Device(), cullPipelineLayout, nullptr);
+		vkDestroyPipelineLayout(rveVulkanDevice.Device(), pyramidPipelineLayout, nullptr);
+		vkDestroyDescriptorPool(rveVulkanDevice.Device(), descriptorPool, nullptr);
+		vkDestroyDescriptorSetLayout(rveVulkanDevice.Device(), cullSetLayout, nullptr);
+		vkDestroyDescriptorSetLayout(rveVulkanDevice.Device(), pyramidSetLayout, nullptr);
+	}
+
+	void RveOcclusionCuller::CreateDescriptorResources() {
+		std::array<VkDescriptorSetLayoutBinding, 6> cullBindings{};
+		for(uint32_t i = 0; i < cullBindings.size(); i++) {
+			cullBindings[i].binding = i;
+			cullBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			cullBindings[i].descriptorCount = 1;
+			cullBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		}
+		cullBindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(cullBindings.size());
+		layoutInfo.pBindings = cullBindings.data();
+		if(vkCreateDescriptorSetLayout(rveVulkanDevice.Device(), &layoutInfo, nullptr, &cullSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create cull descriptor set layout");
+		}
+
+		std::array<VkDescriptorSetLayoutBinding, 2> pyramidBindings{};
+		pyramidBindings[0].binding = 0;
+		pyramidBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		pyramidBindings[0].descriptorCount = 1;
+		pyramidBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pyramidBindings[1].binding = 1;
+		pyramidBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		pyramidBindings[1].descriptorCount = 1;
+		pyramidBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		layoutInfo.bindingCount = static_cast<uint32_t>(pyramidBindings.size());
+		layoutInfo.pBindings = pyramidBindings.data();
+		if(vkCreateDescriptorSetLayout(rveVulkanDevice.Device(), &layoutInfo, nullptr, &pyramidSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create pyramid descriptor set layout");
+		}
+
+		const uint32_t frameCount = static_cast<uint32_t>(frames.size());
+		std::array<VkDescriptorPoolSize, 3> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[0].descriptorCount = 5 * frameCount;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[1].descriptorCount = (1 + maxPyramidLevels) * frameCount;
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		poolSizes[2].descriptorCount = maxPyramidLevels * frameCount;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = (1 + maxPyramidLevels) * frameCount;
+		if(vkCreateDescriptorPool(rveVulkanDevice.Device(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create descriptor pool");
+		}
+
+		// Only texelFetch is used, the sampler exists to satisfy the combined image sampler bindings
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_NEAREST;
+		samplerInfo.minFilter = VK_FILTER_NEAREST;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+		if(vkCreateSampler(rveVulkanDevice.Device(), &samplerInfo, nullptr, &pyramidSampler) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create pyramid sampler");
+		}
+	}
+
+	void RveOcclusionCuller::CreatePipelineLayouts() {
+		VkPushConstantRange pushConstantRange;
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(RveOcclusionCullPushConstants);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &cullSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		if(vkCreatePipelineLayout(rveVulkanDevice.Device(), &pipelineLayoutInfo, nullptr, &cullPipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create cull pipeline layout");
+		}
+
+		pushConstantRange.size = sizeof(RveDepthPyramidPushConstants);
+		pipelineLayoutInfo.pSetLayouts = &pyramidSetLayout;
+		if(vkCreatePipelineLayout(rveVulkanDevice.Device(), &pipelineLayoutInfo, nullptr, &pyramidPipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create pyramid pipeline layout");
+		}
+	}
+
+	void RveOcclusionCuller::CreateFrameResources(FrameResources& frame) {
+		rveVulkanDevice.CreateBuffer(
+			sizeof(GpuStats),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			frame.statsBuffer,
+			frame.statsMemory);
+		vkMapMemory(rveVulkanDevice.Device(), frame.statsMemory, 0, sizeof(GpuStats), 0, &frame.statsMapped);
+		memset(frame.statsMapped, 0, sizeof(GpuStats));
+
+		std::array<VkDescriptorSetLayout, 1 + maxPyramidLevels> setLayouts;
+		setLayouts[0] = cullSetLayout;
+		std::fill(setLayouts.begin() + 1, setLayouts.end(), pyramidSetLayout);
+		std::array<VkDescriptorSet, 1 + maxPyramidLevels> sets;
+
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = descriptorPool;
+		allocInfo.descriptorSetCount = static_cast<uint32_t>(setLayouts.size());
+		allocInfo.pSetLayouts = setLayouts.data();
+		if(vkAllocateDescriptorSets(rveVulkanDevice.Device(), &allocInfo, sets.data()) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to allocate descriptor sets");
+		}
+		frame.cullDescriptorSet = sets[0];
+		std::copy(sets.begin() + 1, sets.end(), frame.pyramidDescriptorSets.begin());
+
+		EnsureObjectCapacity(frame, 256);
+	}
+
+	void RveOcclusionCuller::DestroyFrameResources(FrameResources& frame) {
+		DestroyPyramid(frame);
+		vkUnmapMemory(rveVulkanDevice.Device(), frame.objectMemory);
+		vkDestroyBuffer(rveVulkanDevice.Device(), frame.objectBuffer, nullptr);
+		vkFreeMemory(rveVulkanDevice.Device(), frame.objectMemory, nullptr);
+		vkDestroyBuffer(rveVulkanDevice.Device(), frame.commandBuffer, nullptr);
+		vkFreeMemory(rveVulkanDevice.Device(), frame.commandMemory, nullptr);
+		vkDestroyBuffer(rveVulkanDevice.Device(), frame.phaseBuffer, nullptr);
+		vkFreeMemory(rveVulkanDevice.Device(), frame.phaseMemory, nullptr);
+		vkUnmapMemory(rveVulkanDevice.Device(), frame.statsMemory);
+		vkDestroyBuffer(rveVulkanDevice.Device(), frame.statsBuffer, nullptr);
+		vkFreeMemory(rveVulkanDevice.Device(), frame.statsMemory, nullptr);
+	}
+
+	void RveOcclusionCuller::DestroyPyramid(FrameResources& frame) {
+		if(frame.pyramidImage == VK_NULL_HANDLE) {
+			return;
+		}
+		for(uint32_t level = 0; level < frame.pyramidLevels; level++) {
+			vkDestroyImageView(rveVulkanDevice.Device(), frame.pyramidLevelViews[level], nullptr);
+		}
+		vkDestroyImageView(rveVulkanDevice.Device(), frame.pyramidView, nullptr);
+		vkDestroyImage(rveVulkanDevice.Device(), frame.pyramidImage, nullptr);
+		vkFreeMemory(rveVulkanDevice.Device(), frame.pyramidMemory, nullptr);
+		frame.pyramidImage = VK_NULL_HANDLE;
+		frame.pyramidLevels = 0;
+		frame.depthExtent = {0, 0};
+	}
+
+	void RveOcclusionCuller::EnsureObjectCapacity(FrameResources& frame, uint32_t objectCount) {
+		// The slot's previous submission has retired, so its buffers can be replaced right away
+		if(objectCount <= frame.objectCapacity) {
+			return;
+		}
+		if(frame.objectBuffer != VK_NULL_HANDLE) {
+			vkUnmapMemory(rveVulkanDevice.Device(), frame.objectMemory);
+			vkDestroyBuffer(rveVulkanDevice.Device(), frame.objectBuffer, nullptr);
+			vkFreeMemory(rveVulkanDevice.Device(), frame.objectMemory, nullptr);
+			vkDestroyBuffer(rveVulkanDevice.Device(), frame.commandBuffer, nullptr);
+			vkFreeMemory(rveVulkanDevice.Device(), frame.commandMemory, nullptr);
+			vkDestroyBuffer(rveVulkanDevice.Device(), frame.phaseBuffer, nullptr);
+			vkFreeMemory(rveVulkanDevice.Device(), frame.phaseMemory, nullptr);
+		}
+		frame.objectCapacity = std::max(objectCount, frame.objectCapacity * 2);
+
+		rveVulkanDevice.CreateBuffer(
+			sizeof(Object) * frame.objectCapacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			frame.objectBuffer,
+			frame.objectMemory);
+		vkMapMemory(rveVulkanDevice.Device(), frame.objectMemory, 0, VK_WHOLE_SIZE, 0, &frame.objectMapped);
+		// Early commands first, then late commands
+		rveVulkanDevice.CreateBuffer(
+			sizeof(VkDrawIndexedIndirectCommand) * frame.objectCapacity * 2,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			frame.commandBuffer,
+			frame.commandMemory);
+		rveVulkanDevice.CreateBuffer(
+			sizeof(uint32_t) * frame.objectCapacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			frame.phaseBuffer,
+			frame.phaseMemory);
+		if(frame.pyramidImage != VK_NULL_HANDLE) {
+			WriteCullDescriptorSet(frame);
+		}
+	}
+
+	void RveOcclusionCuller::EnsureVisibilityCapacity(VkCommandBuffer commandBuffer, uint32_t visibilityCount) {
+		if(visibilityCount <= visibilityCapacity) {
+			return;
+		}
+		uint32_t newCapacity = std::max({visibilityCount, visibilityCapacity * 2, 256u});
+		VkBuffer newBuffer;
+		VkDeviceMemory newMemory;
+		rveVulkanDevice.CreateBuffer(
+			sizeof(uint32_t) * newCapacity,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			newBuffer,
+			newMemory);
+
+		// Old entries are copied over and only the new tail is cleared, so the two never overlap
+		VkDeviceSize copiedSize = sizeof(uint32_t) * visibilityCapacity;
+		if(visibilityBuffer != VK_NULL_HANDLE) {
+			// The previous frame's late pass wrote what is copied
+			VkMemoryBarrier copyBarrier{};
+			copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			copyBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			copyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+			VkBufferCopy copyRegion{};
+			copyRegion.size = copiedSize;
+			vkCmdCopyBuffer(commandBuffer, visibilityBuffer, newBuffer, 1, &copyRegion);
+		}
+		vkCmdFillBuffer(commandBuffer, newBuffer, copiedSize, VK_WHOLE_SIZE, 0);
+
+		// Frames in flight and the copy above still use the old buffer
+		rveVulkanDevice.GetDeletionQueue().DestroyBuffer(visibilityBuffer);
+		rveVulkanDevice.GetDeletionQueue().FreeMemory(visibilityMemory);
+		visibilityBuffer = newBuffer;
+		visibilityMemory = newMemory;
+		visibilityCapacity = newCapacity;
+		for(auto& frame : frames) {
+			frame.cullDescriptorSetStale = true;
+		}
+	}
+
+	void RveOcclusionCuller::EnsurePyramid(FrameResources& frame, VkExtent2D depthExtent) {
+		if(frame.pyramidImage != VK_NULL_HANDLE &&
+			frame.depthExtent.width == depthExtent.width &&
+			frame.depthExtent.height == depthExtent.height) {
+				return;
+		}
+		DestroyPyramid(frame);
+
+		// Level 0 is half the depth resolution rounded up, so every texel covers a 2^(level+1) pixel square
+		uint32_t width = (depthExtent.width + 1) / 2;
+		uint32_t height = (depthExtent.height + 1) / 2;
+		uint32_t levels = 1;
+		while((width > 1 || height > 1) && levels < maxPyramidLevels) {
+			width = (width + 1) / 2;
+			height = (height + 1) / 2;
+			levels++;
+		}
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent.width = (depthExtent.width + 1) / 2;
+		imageInfo.extent.height = (depthExtent.height + 1) / 2;
+		imageInfo.extent.depth = 1;
+		imageInfo.mipLevels = levels;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = VK_FORMAT_R32_SFLOAT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		rveVulkanDevice.CreateImageWithInfo(
+			imageInfo,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			frame.pyramidImage,
+			frame.pyramidMemory);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = frame.pyramidImage;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R32_SFLOAT;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = levels;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+		if(vkCreateImageView(rveVulkanDevice.Device(), &viewInfo, nullptr, &frame.pyramidView) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create pyramid image view");
+		}
+		viewInfo.subresourceRange.levelCount = 1;
+		for(uint32_t level = 0; level < levels; level++) {
+			viewInfo.subresourceRange.baseMipLevel = level;
+			if(vkCreateImageView(rveVulkanDevice.Device(), &viewInfo, nullptr, &frame.pyramidLevelViews[level]) != VK_SUCCESS) {
+				throw std::runtime_error("(rve_occlusion_culler.cpp) Failed to create pyramid level image view");
+			}
+		}
+		frame.depthExtent = depthExtent;
+		frame.pyramidLevels = levels;
+		frame.pyramidNeedsTransition = true;
+
+		// Level 0 reads the swap chain depth, it is written every frame in BuildDepthPyramid
+		std::vector<VkDescriptorImageInfo> imageInfos(levels * 2);
+		std::vector<VkWriteDescriptorSet> writes;
+		for(uint32_t level = 0; level < levels; level++) {
+			imageInfos[level * 2] = {pyramidSampler, level > 0 ? frame.pyramidLevelViews[level - 1] : VK_NULL_HANDLE, VK_IMAGE_LAYOUT_GENERAL};
+			imageInfos[level * 2 + 1] = {VK_NULL_HANDLE, frame.pyramidLevelViews[level], VK_IMAGE_LAYOUT_GENERAL};
+
+			VkWriteDescriptorSet write{};
+			write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write.dstSet = frame.pyramidDescriptorSets[level];
+			write.descriptorCount = 1;
+			if(level > 0) {
+				write.dstBinding = 0;
+				write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				write.pImageInfo = &imageInfos[level * 2];
+				writes.push_back(write);
+			}
+			write.dstBinding = 1;
+			write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			write.pImageInfo = &imageInfos[level * 2 + 1];
+			writes.push_back(write);
+		}
+		vkUpdateDescriptorSets(rveVulkanDevice.Device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		WriteCullDescriptorSet(frame);
+	}
+
+	void RveOcclusionCuller::WriteCullDescriptorSet(FrameResources& frame) {
+		std::array<VkDescriptorBufferInfo, 5> bufferInfos{};
+		bufferInfos[0] = {frame.objectBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[1] = {frame.commandBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[2] = {frame.phaseBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[3] = {visibilityBuffer, 0, VK_WHOLE_SIZE};
+		bufferInfos[4] = {frame.statsBuffer, 0, VK_WHOLE_SIZE};
+		VkDescriptorImageInfo pyramidInfo{pyramidSampler, frame.pyramidView, VK_IMAGE_LAYOUT_GENERAL};
+
+		std::array<VkWriteDescriptorSet, 6> writes{};
+		for(uint32_t i = 0; i < writes.size(); i++) {
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].dstSet = frame.cullDescriptorSet;
+			writes[i].dstBinding = i;
+			writes[i].descriptorCount = 1;
+			if(i < bufferInfos.size()) {
+				writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writes[i].pBufferInfo = &bufferInfos[i];
+			} else {
+				writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				writes[i].pImageInfo = &pyramidInfo;
+			}
+		}
+		vkUpdateDescriptorSets(rveVulkanDevice.Device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+		frame.cullDescriptorSetStale = false;
+	}
+
+	void RveOcclusionCuller::BeginFrame(int frameIndex) {
+		currentFrame = frameIndex;
+		FrameResources& frame = frames[currentFrame];
+		GpuStats gpuStats;
+		memcpy(&gpuStats, frame.statsMapped, sizeof(GpuStats));
+		stats.objectsTotal = frame.objectsSubmitted;
+		stats.drawnEarly = gpuStats.drawnEarly;
+		stats.drawnLate = gpuStats.drawnLate;
+		stats.frustumCulled = gpuStats.frustumCulled;
+		stats.occlusionCulled = gpuStats.occlusionCulled;
+
+		objects.clear();
+		maxVisibilityIndex = 0;
+		lateActive = false;
+	}
+
+	uint32_t RveOcclusionCuller::AddObject(
+		uint32_t visibilityIndex,
+		const glm::vec3& viewCenter,
+		float radius,
+		uint32_t indexCount,
+		uint32_t firstIndex,
+		int32_t vertexOffset) {
+			Object object{};
+			object.viewCenter = viewCenter;
+			object.radius = radius;
+			object.indexCount = indexCount;
+			object.firstIndex = firstIndex;
+			object.vertexOffset = vertexOffset;
+			object.visibilityIndex = visibilityIndex;
+			objects.push_back(object);
+			maxVisibilityIndex = std::max(maxVisibilityIndex, visibilityIndex);
+			return static_cast<uint32_t>(objects.size() - 1);
+	}
+
+	void RveOcclusionCuller::DispatchEarly(const RveFrameInfo& frameInfo, bool occlusionEnabled) {
+		FrameResources& frame = frames[currentFrame];
+		frame.objectsSubmitted = static_cast<uint32_t>(objects.size());
+		if(objects.empty()) {
+			memset(frame.statsMapped, 0, sizeof(GpuStats));
+			return;
+		}
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+		EnsureVisibilityCapacity(commandBuffer, maxVisibilityIndex + 1);
+		EnsureObjectCapacity(frame, static_cast<uint32_t>(objects.size()));
+		EnsurePyramid(frame, frameInfo.extent);
+		if(frame.cullDescriptorSetStale) {
+			WriteCullDescriptorSet(frame);
+		}
+		memcpy(frame.objectMapped, objects.data(), sizeof(Object) * objects.size());
+
+		if(frame.pyramidNeedsTransition) {
+			VkImageMemoryBarrier pyramidBarrier{};
+			pyramidBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			pyramidBarrier.srcAccessMask = 0;
+			pyramidBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			pyramidBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			pyramidBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+			pyramidBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			pyramidBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			pyramidBarrier.image = frame.pyramidImage;
+			pyramidBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, frame.pyramidLevels, 0, 1};
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &pyramidBarrier);
+			frame.pyramidNeedsTransition = false;
+		}
+
+		vkCmdFillBuffer(commandBuffer, frame.statsBuffer, 0, sizeof(GpuStats), 0);
+
+		// Also orders this frame's visibility reads after the previous frame's late pass writes
+		VkMemoryBarrier clearBarrier{};
+		clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+		DispatchCull(frameInfo, RveDrawPhase::Early, occlusionEnabled);
+		lateActive = occlusionEnabled;
+	}
+
+	void RveOcclusionCuller::DispatchLate(const RveFrameInfo& frameInfo, VkImageView depthView) {
+		if(!lateActive) {
+			return;
+		}
+		FrameResources& frame = frames[currentFrame];
+		BuildDepthPyramid(frameInfo.commandBuffer, frame, depthView);
+		DispatchCull(frameInfo, RveDrawPhase::Late, true);
+	}
+
+	void RveOcclusionCuller::BuildDepthPyramid(VkCommandBuffer commandBuffer, FrameResources& frame, VkImageView depthView) {
+		VkDescriptorImageInfo depthInfo{pyramidSampler, depthView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = frame.pyramidDescriptorSets[0];
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &depthInfo;
+		vkUpdateDescriptorSets(rveVulkanDevice.Device(), 1, &write, 0, nullptr);
+
+		pyramidPipeline->Bind(commandBuffer);
+		VkMemoryBarrier levelBarrier{};
+		levelBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		levelBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		levelBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		RveDepthPyramidPushConstants push{};
+		push.sourceWidth = frame.depthExtent.width;
+		push.sourceHeight = frame.depthExtent.height;
+		for(uint32_t level = 0; level < frame.pyramidLevels; level++) {
+			push.destinationWidth = (push.sourceWidth + 1) / 2;
+			push.destinationHeight = (push.sourceHeight + 1) / 2;
+			vkCmdBindDescriptorSets(
+				commandBuffer,
+				VK_PIPELINE_BIND_POINT_COMPUTE,
+				pyramidPipelineLayout,
+				0, 1, &frame.pyramidDescriptorSets[level],
+				0, nullptr);
+			vkCmdPushConstants(
+				commandBuffer,
+				pyramidPipelineLayout,
+				VK_SHADER_STAGE_COMPUTE_BIT,
+				0,
+				sizeof(RveDepthPyramidPushConstants),
+				&push);
+			vkCmdDispatch(commandBuffer, (push.destinationWidth + 7) / 8, (push.destinationHeight + 7) / 8, 1);
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+				0, 1, &levelBarrier, 0, nullptr, 0, nullptr);
+			push.sourceWidth = push.destinationWidth;
+			push.sourceHeight = push.destinationHeight;
+		}
+	}
+
+	void RveOcclusionCuller::DispatchCull(const RveFrameInfo& frameInfo, RveDrawPhase phase, bool occlusionEnabled) {
+		FrameResources& frame = frames[currentFrame];
+		VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+		const glm::mat4& projection = frameInfo.camera.GetProjection();
+
+		RveOcclusionCullPushConstants push{};
+		push.p00 = projection[0][0];
+		push.p11 = projection[1][1];
+		push.p22 = projection[2][2];
+		push.p32 = projection[3][2];
+		// Inverse of the depth mapping in RveCamera::SetPerspectiveProjection
+		push.zNear = -push.p32 / push.p22;
+		push.zFar = push.p32 / (1.0f - push.p22);
+		push.depthWidth = frame.depthExtent.width;
+		push.depthHeight = frame.depthExtent.height;
+		push.objectCount = static_cast<uint32_t>(objects.size());
+		push.phase = static_cast<uint32_t>(phase);
+		push.pyramidLevels = frame.pyramidLevels;
+		push.occlusionEnabled = occlusionEnabled ? 1 : 0;
+
+		cullPipeline->Bind(commandBuffer);
+		vkCmdBindDescriptorSets(
+			commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			cullPipelineLayout,
+			0, 1, &frame.cullDescriptorSet,
+			0, nullptr);
+		vkCmdPushConstants(
+			commandBuffer,
+			cullPipelineLayout,
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			0,
+			sizeof(RveOcclusionCullPushConstants),
+			&push);
+		vkCmdDispatch(commandBuffer, (push.objectCount + 63) / 64, 1, 1);
+
+		// Phase flags feed the meshlet culler, commands feed the draws and stats are read back on the host
+		VkMemoryBarrier cullBarrier{};
+		cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		cullBarrier.dstAccessMask =
+			VK_ACCESS_SHADER_READ_BIT |
+			VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+			VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+			VK_PIPELINE_STAGE_HOST_BIT,
+			0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void RveOcclusionCuller::DrawObject(VkCommandBuffer commandBuffer, uint32_t objectIndex, RveDrawPhase phase) {
+		assert(
+			(phase == RveDrawPhase::Early || lateActive) &&
+			"(rve_occlusion_culler.cpp) Late phase was not dispatched this frame"
+		);
+		const FrameResources& frame = frames[currentFrame];
+		const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+		uint32_t command = static_cast<uint32_t>(phase) * static_cast<uint32_t>(objects.size()) + objectIndex;
+		vkCmdDrawIndexedIndirect(
+			commandBuffer,
+			frame.commandBuffer,
+			static_cast<VkDeviceSize>(command) * stride,
+			1,
+			stride);
+	}
+} // namespace rve
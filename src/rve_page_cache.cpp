@@ -0,0 +1,527 @@
+#include "../include/rve_page_cache.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace rve {
+	// std430 layouts of VirtualTextureBuffer and VirtualTexture in the bindless fragment shader, the
+	// buffer starts with the atlas description followed by one entry per virtual texture
+	struct RvePageCacheInfo {
+		uint32_t atlas;
+		uint32_t atlasPages;
+		uint32_t pageSize;
+		uint32_t pageBorder;
+	};
+
+	struct RveVirtualTextureData {
+		uint32_t pageTable;
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipCount;
+	};
+
+	static_assert(sizeof(RvePageCacheInfo) == sizeof(RveVirtualTextureData), "Virtual texture buffer entries must share a stride");
+
+	namespace {
+		// Matches FeedbackBuffer in the bindless fragment shader: width, height, scale and jitter, then the requests
+		constexpr uint32_t feedbackHeaderWords = 4;
+		constexpr uint32_t emptyRequest = ~0u;
+
+		VkImageMemoryBarrier ImageBarrier(
+			VkImage image,
+			uint32_t levelCount,
+			VkImageLayout oldLayout,
+			VkImageLayout newLayout,
+			VkAccessFlags srcAccess,
+			VkAccessFlags dstAccess) {
+				VkImageMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				barrier.srcAccessMask = srcAccess;
+				barrier.dstAccessMask = dstAccess;
+				barrier.oldLayout = oldLayout;
+				barrier.newLayout = newLayout;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.image = image;
+				barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, levelCount, 0, 1};
+				return barrier;
+		}
+
+		// Frames already submitted may still sample the image, the copy waits for them on the queue
+		void RecordImageCopy(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t levelCount, const std::vector<VkBufferImageCopy>& regions) {
+			VkImageMemoryBarrier toTransfer = ImageBarrier(
+				image, levelCount,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				0, VK_ACCESS_TRANSFER_WRITE_BIT);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+			vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+			VkImageMemoryBarrier toShader = ImageBarrier(
+				image, levelCount,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+		}
+	} // namespace
+
+	RvePageCache::RvePageCache(
+		RveVulkanDevice& device,
+		RveBindlessTable& bindlessTable,
+		RveJobSystem& jobSystem,
+		RveSamplerCache& samplers,
+		uint32_t atlasPages,
+		VkFormat atlasFormat) :
+			rveVulkanDevice{device}, bindlessTable{bindlessTable}, jobSystem{jobSystem}, atlasPages{atlasPages}, atlasFormat{atlasFormat} {
+			// Page table texels hold the atlas page coordinates in 8 bit channels
+			assert(atlasPages > 0 && atlasPages <= 256 && "(rve_page_cache.cpp) Atlas must be 1 to 256 pages wide");
+			const uint32_t atlasSize = atlasPages * RveVirtualTexture::tileSize;
+			if(atlasSize > rveVulkanDevice.properties.limits.maxImageDimension2D) {
+				throw std::runtime_error("(rve_page_cache.cpp) Page atlas is larger than the device allows");
+			}
+
+			// Pages are filtered within their borders and have no mips, the page table is only fetched
+			RveSamplerInfo atlasInfo{};
+			atlasInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+			atlasInfo.addressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+			atlasInfo.maxAnisotropy = 1.0f;
+			atlasSampler = samplers.GetSampler(atlasInfo);
+			RveSamplerInfo pageTableInfo = atlasInfo;
+			pageTableInfo.filter = VK_FILTER_NEAREST;
+			pageTableSampler = samplers.GetSampler(pageTableInfo);
+
+			CreateImage(atlasSize, atlasSize, 1, atlasFormat, atlas, atlasMemory, atlasView);
+			// Unallocated pages are never read, the atlas only needs the layout uploads expect
+			VkCommandBuffer commandBuffer = rveVulkanDevice.BeginSingleTimeCommands();
+			VkImageMemoryBarrier toShader = ImageBarrier(
+				atlas, 1,
+				VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				0, VK_ACCESS_SHADER_READ_BIT);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+			rveVulkanDevice.EndSingleTimeCommands(commandBuffer);
+			atlasSlot = bindlessTable.AddTexture({atlasSampler, atlasView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+			physicalPages.resize(atlasPages * atlasPages);
+
+			infoBuffer = std::make_unique<RveBuffer>(
+				rveVulkanDevice,
+				sizeof(RveVirtualTextureData),
+				1 + maxVirtualTextures,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			if(infoBuffer->Map() != VK_SUCCESS) {
+				throw std::runtime_error("(rve_page_cache.cpp) Failed to map virtual texture buffer");
+			}
+			RvePageCacheInfo info{atlasSlot, atlasPages, RveVirtualTexture::pageSize, RveVirtualTexture::pageBorder};
+			infoBuffer->WriteToIndex(&info, 0);
+			infoSlot = bindlessTable.AddStorageBuffer(infoBuffer->DescriptorInfo());
+	}
+
+	RvePageCache::~RvePageCache() {
+		// Jobs write into the loads and read the mapped files
+		for(auto& load : loads) {
+			jobSystem.Wait(load->counter);
+		}
+		RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		for(VirtualTextureEntry& entry : virtualTextures) {
+			bindlessTable.Release(RveBindlessTable::Binding::Texture, entry.slot);
+			deletionQueue.DestroyImageView(entry.pageTableView);
+			deletionQueue.DestroyImage(entry.pageTable);
+			deletionQueue.FreeMemory(entry.pageTableMemory);
+		}
+		for(FrameResources& resources : frames) {
+			if(resources.slot != RveBindlessTable::invalidIndex) {
+				bindlessTable.Release(RveBindlessTable::Binding::StorageBuffer, resources.slot);
+			}
+		}
+		bindlessTable.Release(RveBindlessTable::Binding::StorageBuffer, infoSlot);
+		bindlessTable.Release(RveBindlessTable::Binding::Texture, atlasSlot);
+		deletionQueue.DestroyImageView(atlasView);
+		deletionQueue.DestroyImage(atlas);
+		deletionQueue.FreeMemory(atlasMemory);
+	}
+
+	void RvePageCache::CreateImage(
+		uint32_t width,
+		uint32_t height,
+		uint32_t mipLevels,
+		VkFormat format,
+		VkImage& image,
+		VkDeviceMemory& memory,
+		VkImageView& view) {
+			VkImageCreateInfo imageInfo{};
+			imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+			imageInfo.imageType = VK_IMAGE_TYPE_2D;
+			imageInfo.format = format;
+			imageInfo.extent = {width, height, 1};
+			imageInfo.mipLevels = mipLevels;
+			imageInfo.arrayLayers = 1;
+			imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+			imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+			imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+			imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			rveVulkanDevice.CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = image;
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = format;
+			viewInfo.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1};
+			if(vkCreateImageView(rveVulkanDevice.Device(), &viewInfo, nullptr, &view) != VK_SUCCESS) {
+				throw std::runtime_error("(rve_page_cache.cpp) Failed to create page cache image view");
+			}
+	}
+
+	uint32_t RvePageCache::Register(std::shared_ptr<RveVirtualTexture> texture) {
+		if(virtualTextures.size() == maxVirtualTextures) {
+			throw std::runtime_error("(rve_page_cache.cpp) Too many virtual textures");
+		}
+		if(texture->GetFormat() != atlasFormat) {
+			throw std::runtime_error("(rve_page_cache.cpp) Virtual texture format does not match the page atlas");
+		}
+		const uint32_t index = static_cast<uint32_t>(virtualTextures.size());
+		VirtualTextureEntry& entry = virtualTextures.emplace_back();
+		entry.file = std::move(texture);
+		const RveVirtualTexture& file = *entry.file;
+		entry.residency.assign(file.GetPageCount(), noPage);
+		entry.tableTexels.assign(file.GetPageCount(), 0);
+		// Sides are powers of two, so the page table's mip chain has exactly the page grid of every mip
+		CreateImage(file.GetPagesWide(0), file.GetPagesHigh(0), file.GetMipCount(), VK_FORMAT_R8G8B8A8_UNORM, entry.pageTable, entry.pageTableMemory, entry.pageTableView);
+		entry.slot = bindlessTable.AddTexture({pageTableSampler, entry.pageTableView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+
+		const uint32_t physicalPage = AllocatePhysicalPage();
+		if(physicalPage == noPage) {
+			throw std::runtime_error("(rve_page_cache.cpp) Page atlas has no room for another virtual texture");
+		}
+		const uint32_t coarsestPage = file.GetPageCount() - 1;
+		physicalPages[physicalPage] = {index, coarsestPage, frame, true};
+		entry.residency[coarsestPage] = physicalPage;
+		entry.tableDirty = true;
+
+		// Taking the page may evict one of another texture, whose page table is then rewritten as well
+		RveBuffer staging{
+			rveVulkanDevice,
+			GetStagingSize(),
+			1,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		};
+		if(staging.Map() != VK_SUCCESS) {
+			throw std::runtime_error("(rve_page_cache.cpp) Failed to map page staging buffer");
+		}
+		VkCommandBuffer commandBuffer = rveVulkanDevice.BeginSingleTimeCommands();
+		VkImageMemoryBarrier toShader = ImageBarrier(
+			entry.pageTable, file.GetMipCount(),
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			0, 0);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+		RecordUploads(commandBuffer, staging, {{physicalPage, file.GetTile(coarsestPage)}});
+		rveVulkanDevice.EndSingleTimeCommands(commandBuffer);
+
+		RveVirtualTextureData data{entry.slot, file.GetWidth(), file.GetHeight(), file.GetMipCount()};
+		infoBuffer->WriteToIndex(&data, 1 + index);
+		return index;
+	}
+
+	void RvePageCache::EnsureFeedbackCapacity(FrameResources& resources, VkExtent2D extent) {
+		const uint32_t width = (extent.width + feedbackScale - 1) / feedbackScale;
+		const uint32_t height = (extent.height + feedbackScale - 1) / feedbackScale;
+		if(resources.feedback != nullptr && resources.width == width && resources.height == height) {
+			return;
+		}
+		// The slot's previous buffer was last written by the frame whose fence has just been waited on
+		resources.feedback = std::make_unique<RveBuffer>(
+			rveVulkanDevice,
+			sizeof(uint32_t),
+			feedbackHeaderWords + width * height,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		if(resources.feedback->Map() != VK_SUCCESS) {
+			throw std::runtime_error("(rve_page_cache.cpp) Failed to map feedback buffer");
+		}
+		uint32_t *requests = static_cast<uint32_t*>(resources.feedback->GetMappedMemory()) + feedbackHeaderWords;
+		std::fill(requests, requests + width * height, emptyRequest);
+		resources.width = width;
+		resources.height = height;
+		resources.recorded = false;
+		if(resources.slot == RveBindlessTable::invalidIndex) {
+			resources.slot = bindlessTable.AddStorageBuffer(resources.feedback->DescriptorInfo());
+		} else {
+			bindlessTable.UpdateStorageBuffer(resources.slot, resources.feedback->DescriptorInfo());
+		}
+	}
+
+	void RvePageCache::ReadFeedback(FrameResources& resources) {
+		uint32_t *requests = static_cast<uint32_t*>(resources.feedback->GetMappedMemory()) + feedbackHeaderWords;
+		const size_t count = static_cast<size_t>(resources.width) * resources.height;
+		feedbackKeys.assign(requests, requests + count);
+		// Cleared here for the frame about to be recorded into the same buffer
+		std::fill(requests, requests + count, emptyRequest);
+		std::sort(feedbackKeys.begin(), feedbackKeys.end());
+		feedbackKeys.erase(std::unique(feedbackKeys.begin(), feedbackKeys.end()), feedbackKeys.end());
+
+		requestedPages = 0;
+		for(uint32_t key : feedbackKeys) {
+			// Decodes the request packed by WriteFeedback in the bindless fragment shader
+			const uint32_t texture = key >> 26;
+			const uint32_t mip = (key >> 22) & 0xF;
+			const uint32_t y = (key >> 11) & 0x7FF;
+			const uint32_t x = key & 0x7FF;
+			if(key == emptyRequest || texture >= virtualTextures.size()) {
+				continue;
+			}
+			const RveVirtualTexture& file = *virtualTextures[texture].file;
+			if(mip >= file.GetMipCount() || x >= file.GetPagesWide(mip) || y >= file.GetPagesHigh(mip)) {
+				continue;
+			}
+			RequestPage(texture, mip, x, y);
+			requestedPages++;
+		}
+	}
+
+	void RvePageCache::RequestPage(uint32_t texture, uint32_t mip, uint32_t x, uint32_t y) {
+		VirtualTextureEntry& entry = virtualTextures[texture];
+		const RveVirtualTexture& file = *entry.file;
+		bool queued = false;
+		for(uint32_t level = file.GetMipCount(); level-- > mip;) {
+			const uint32_t shift = level - mip;
+			const uint32_t page = file.GetPageIndex(
+				level,
+				std::min(x >> shift, file.GetPagesWide(level) - 1),
+				std::min(y >> shift, file.GetPagesHigh(level) - 1));
+			const uint32_t physicalPage = entry.residency[page];
+			if(physicalPage == noPage) {
+				// Finer pages wait until this one is in, so detail arrives coarse to fine
+				if(!queued) {
+					pendingRequests.push_back({level, texture, page});
+					queued = true;
+				}
+			} else if(physicalPage != loadingPage) {
+				physicalPages[physicalPage].lastRequested = frame;
+			}
+		}
+	}
+
+	uint32_t RvePageCache::AllocatePhysicalPage() {
+		uint32_t victim = noPage;
+		for(uint32_t index = 0; index < physicalPages.size(); index++) {
+			const PhysicalPage& page = physicalPages[index];
+			if(page.texture == noPage) {
+				return index;
+			}
+			if(!page.pinned && page.lastRequested < frame && (victim == noPage || page.lastRequested < physicalPages[victim].lastRequested)) {
+				victim = index;
+			}
+		}
+		if(victim != noPage) {
+			Evict(victim);
+		}
+		return victim;
+	}
+
+	void RvePageCache::Evict(uint32_t physicalPage) {
+		PhysicalPage& page = physicalPages[physicalPage];
+		VirtualTextureEntry& entry = virtualTextures[page.texture];
+		entry.residency[page.page] = noPage;
+		entry.tableDirty = true;
+		page = PhysicalPage{};
+		evictions++;
+	}
+
+	void RvePageCache::RebuildPageTable(VirtualTextureEntry& entry) {
+		const RveVirtualTexture& file = *entry.file;
+		// Coarse to fine, so a missing page copies the texel of its parent, and the coarsest page is always resident
+		for(uint32_t mip = file.GetMipCount(); mip-- > 0;) {
+			for(uint32_t y = 0; y < file.GetPagesHigh(mip); y++) {
+				for(uint32_t x = 0; x < file.GetPagesWide(mip); x++) {
+					const uint32_t page = file.GetPageIndex(mip, x, y);
+					const uint32_t physicalPage = entry.residency[page];
+					if(physicalPage != noPage && physicalPage != loadingPage) {
+						// R and G are the atlas page, B the mip it holds
+						entry.tableTexels[page] = physicalPage % atlasPages | (physicalPage / atlasPages) << 8 | mip << 16 | 0xFFu << 24;
+					} else {
+						entry.tableTexels[page] = entry.tableTexels[file.GetPageIndex(
+							mip + 1,
+							std::min(x / 2, file.GetPagesWide(mip + 1) - 1),
+							std::min(y / 2, file.GetPagesHigh(mip + 1) - 1))];
+					}
+				}
+			}
+		}
+	}
+
+	void RvePageCache::RecordUploads(VkCommandBuffer commandBuffer, RveBuffer& staging, const std::vector<TileUpload>& tiles) {
+		char *mapped = static_cast<char*>(staging.GetMappedMemory());
+		VkDeviceSize offset = 0;
+		auto checkFits = [&](VkDeviceSize size) {
+			if(offset + size > staging.GetBufferSize()) {
+				throw std::runtime_error("(rve_page_cache.cpp) Page staging buffer too small for the uploads");
+			}
+		};
+		std::vector<VkBufferImageCopy> regions;
+		for(const TileUpload& tile : tiles) {
+			checkFits(RveVirtualTexture::tileBytes);
+			std::memcpy(mapped + offset, tile.texels, RveVirtualTexture::tileBytes);
+			VkBufferImageCopy region{};
+			region.bufferOffset = offset;
+			region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+			region.imageOffset = {
+				static_cast<int32_t>(tile.physicalPage % atlasPages * RveVirtualTexture::tileSize),
+				static_cast<int32_t>(tile.physicalPage / atlasPages * RveVirtualTexture::tileSize),
+				0};
+			region.imageExtent = {RveVirtualTexture::tileSize, RveVirtualTexture::tileSize, 1};
+			regions.push_back(region);
+			offset += RveVirtualTexture::tileBytes;
+		}
+		if(!regions.empty()) {
+			RecordImageCopy(commandBuffer, staging.GetBuffer(), atlas, 1, regions);
+		}
+
+		for(VirtualTextureEntry& entry : virtualTextures) {
+			if(!entry.tableDirty) {
+				continue;
+			}
+			RebuildPageTable(entry);
+			const RveVirtualTexture& file = *entry.file;
+			checkFits(entry.tableTexels.size() * sizeof(uint32_t));
+			std::memcpy(mapped + offset, entry.tableTexels.data(), entry.tableTexels.size() * sizeof(uint32_t));
+			regions.clear();
+			for(uint32_t mip = 0; mip < file.GetMipCount(); mip++) {
+				VkBufferImageCopy region{};
+				region.bufferOffset = offset + file.GetPageIndex(mip, 0, 0) * sizeof(uint32_t);
+				region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 1};
+				region.imageExtent = {file.GetPagesWide(mip), file.GetPagesHigh(mip), 1};
+				regions.push_back(region);
+			}
+			RecordImageCopy(commandBuffer, staging.GetBuffer(), entry.pageTable, file.GetMipCount(), regions);
+			offset += entry.tableTexels.size() * sizeof(uint32_t);
+			entry.tableDirty = false;
+		}
+	}
+
+	VkDeviceSize RvePageCache::GetStagingSize() const {
+		VkDeviceSize size = maxUploadsPerFrame * RveVirtualTexture::tileBytes;
+		for(const VirtualTextureEntry& entry : virtualTextures) {
+			size += entry.tableTexels.size() * sizeof(uint32_t);
+		}
+		return size;
+	}
+
+	void RvePageCache::Update(RveFrameInfo& frameInfo) {
+		frame++;
+		FrameResources& resources = frames[frameInfo.frameIndex];
+		if(resources.recorded) {
+			ReadFeedback(resources);
+		}
+		EnsureFeedbackCapacity(resources, frameInfo.extent);
+		uint32_t *header = static_cast<uint32_t*>(resources.feedback->GetMappedMemory());
+		header[0] = resources.width;
+		header[1] = resources.height;
+		header[2] = feedbackScale;
+		// Each frame a different pixel of every cell reports, covering the cell over feedbackScale squared frames
+		header[3] = static_cast<uint32_t>(frame % (feedbackScale * feedbackScale));
+		resources.recorded = false;
+		currentFeedback = &resources;
+
+		// Loads were started coarse mips first, so uploading in order keeps that
+		std::vector<TileUpload> tiles;
+		std::vector<std::unique_ptr<Load>> uploaded;
+		for(auto load = loads.begin(); load != loads.end();) {
+			if(tiles.size() == maxUploadsPerFrame || !(*load)->counter.IsDone()) {
+				++load;
+				continue;
+			}
+			VirtualTextureEntry& entry = virtualTextures[(*load)->texture];
+			const uint32_t physicalPage = AllocatePhysicalPage();
+			if(physicalPage == noPage) {
+				// Every page is wanted by the latest feedback, the view needs more than the atlas holds
+				entry.residency[(*load)->page] = noPage;
+				load = loads.erase(load);
+				continue;
+			}
+			physicalPages[physicalPage] = {(*load)->texture, (*load)->page, frame, false};
+			entry.residency[(*load)->page] = physicalPage;
+			entry.tableDirty = true;
+			tiles.push_back({physicalPage, (*load)->texels.data()});
+			uploaded.push_back(std::move(*load));
+			load = loads.erase(load);
+			uploads++;
+		}
+
+		std::sort(pendingRequests.begin(), pendingRequests.end(), [](const auto& a, const auto& b) { return a[0] > b[0]; });
+		for(const auto& [mip, texture, page] : pendingRequests) {
+			if(loads.size() == maxLoadsInFlight) {
+				break;
+			}
+			// Requests for the same page collapse once the first has been started
+			VirtualTextureEntry& entry = virtualTextures[texture];
+			if(entry.residency[page] != noPage) {
+				continue;
+			}
+			entry.residency[page] = loadingPage;
+			auto load = std::make_unique<Load>();
+			load->texture = texture;
+			load->page = page;
+			Load *target = load.get();
+			const RveVirtualTexture *file = entry.file.get();
+			jobSystem.Schedule([target, file]() {
+				const uint8_t *tile = file->GetTile(target->page);
+				target->texels.assign(tile, tile + RveVirtualTexture::tileBytes);
+			}, &target->counter);
+			loads.push_back(std::move(load));
+		}
+		pendingRequests.clear();
+
+		if(tiles.empty()) {
+			return;
+		}
+		if(resources.staging == nullptr || resources.staging->GetBufferSize() < GetStagingSize()) {
+			resources.staging = std::make_unique<RveBuffer>(
+				rveVulkanDevice,
+				GetStagingSize(),
+				1,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			if(resources.staging->Map() != VK_SUCCESS) {
+				throw std::runtime_error("(rve_page_cache.cpp) Failed to map page staging buffer");
+			}
+		}
+		RecordUploads(frameInfo.commandBuffer, *resources.staging, tiles);
+	}
+
+	void RvePageCache::EndFrame(RveFrameInfo& frameInfo) {
+		if(currentFeedback == nullptr) {
+			return;
+		}
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer = currentFeedback->feedback->GetBuffer();
+		barrier.offset = 0;
+		barrier.size = VK_WHOLE_SIZE;
+		vkCmdPipelineBarrier(
+			frameInfo.commandBuffer,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_PIPELINE_STAGE_HOST_BIT,
+			0, 0, nullptr, 1, &barrier, 0, nullptr);
+		currentFeedback->recorded = true;
+	}
+
+	RvePageCache::Stats RvePageCache::GetStats() const {
+		Stats stats{};
+		stats.virtualTextures = static_cast<uint32_t>(virtualTextures.size());
+		stats.physicalPages = static_cast<uint32_t>(physicalPages.size());
+		for(const PhysicalPage& page : physicalPages) {
+			stats.residentPages += page.texture != noPage ? 1 : 0;
+		}
+		stats.loadingPages = static_cast<uint32_t>(loads.size());
+		stats.requestedPages = requestedPages;
+		stats.uploads = uploads;
+		stats.evictions = evictions;
+		return stats;
+	}
+} // namespace rve
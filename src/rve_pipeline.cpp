@@ -1,24 +1,48 @@
 #include "../include/rve_pipeline.hpp"
 #include "../include/rve_model.hpp"
+#include "../include/rve_shader_bundle.hpp"
 
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <cassert>
+#include <utility>
 
 namespace rve {
+	void RveSpecializationConstants::Set(uint32_t constantId, uint32_t value) {
+		for(auto& entry : entries) {
+			if(entry.constantID == constantId) {
+				data[entry.offset / sizeof(uint32_t)] = value;
+				return;
+			}
+		}
+		entries.push_back({constantId, static_cast<uint32_t>(data.size() * sizeof(uint32_t)), sizeof(uint32_t)});
+		data.push_back(value);
+	}
+
+	VkSpecializationInfo RveSpecializationConstants::Info() const {
+		VkSpecializationInfo info{};
+		info.mapEntryCount = static_cast<uint32_t>(entries.size());
+		info.pMapEntries = entries.data();
+		info.dataSize = data.size() * sizeof(uint32_t);
+		info.pData = data.data();
+		return info;
+	}
+
 	RvePipeline::RvePipeline(
 		RveVulkanDevice& device,
 		const std::string& vertFilePath,
 		const std::string& fragFilePath,
-		const RvePipelineConfigInfo& configInfo) : rveVulkanDevice{device} {
-			CreateGraphicsPipeline(vertFilePath, fragFilePath, configInfo);
+		const RvePipelineConfigInfo& configInfo,
+		VkPipelineCache pipelineCache) : rveVulkanDevice{device} {
+			CreateGraphicsPipeline(vertFilePath, fragFilePath, configInfo, pipelineCache);
 	}
 
 	RvePipeline::~RvePipeline() {
-		vkDestroyShaderModule(rveVulkanDevice.Device(), vertShaderModule, nullptr);
-		vkDestroyShaderModule(rveVulkanDevice.Device(), fragShaderModule, nullptr);
-		vkDestroyPipeline(rveVulkanDevice.Device(), graphicsPipeline, nullptr);
+		RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		deletionQueue.DestroyShaderModule(vertShaderModule);
+		deletionQueue.DestroyShaderModule(fragShaderModule);
+		deletionQueue.DestroyPipeline(graphicsPipeline);
 	}
 
 	std::vector<char> RvePipeline::ReadFile(const std::string& filePath) {
@@ -40,16 +64,23 @@ namespace rve {
 	void RvePipeline::CreateGraphicsPipeline(
 		const std::string& vertFilePath,
 		const std::string& fragFilePath,
-		const RvePipelineConfigInfo& configInfo) {
+		const RvePipelineConfigInfo& configInfo,
+		VkPipelineCache pipelineCache) {
 			assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "(rve_pipeline.cpp) Error: No pipelineLayout provided in configInfo");
 			assert(configInfo.renderPass != VK_NULL_HANDLE && "(rve_pipeline.cpp) Error: No renderPass provided in configInfo");
 
-			auto vertCode = ReadFile(vertFilePath);
-			auto fragCode = ReadFile(fragFilePath);
+			std::vector<char> vertFile;
+			std::vector<char> fragFile;
+			auto vertCode = LoadShaderCode(vertFilePath, vertFile);
+			auto fragCode = LoadShaderCode(fragFilePath, fragFile);
 
 			CreateShaderModule(vertCode, &vertShaderModule);
 			CreateShaderModule(fragCode, &fragShaderModule);
 
+			VkSpecializationInfo specializationInfo = configInfo.specialization.Info();
+			const VkSpecializationInfo *pSpecializationInfo = 
+				configInfo.specialization.entries.empty() ? nullptr : &specializationInfo;
+
 			VkPipelineShaderStageCreateInfo shaderStages[2];
 			shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 			shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -57,17 +88,17 @@ namespace rve {
 			shaderStages[0].pName = "main";
 			shaderStages[0].flags = 0;
 			shaderStages[0].pNext = nullptr;
-			shaderStages[0].pSpecializationInfo = nullptr;
+			shaderStages[0].pSpecializationInfo = pSpecializationInfo;
 			shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 			shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
 			shaderStages[1].module = fragShaderModule;
 			shaderStages[1].pName = "main";
 			shaderStages[1].flags = 0;
 			shaderStages[1].pNext = nullptr;
-			shaderStages[1].pSpecializationInfo = nullptr;
+			shaderStages[1].pSpecializationInfo = pSpecializationInfo;
 
-			auto bindingDescriptions = RveModel::Vertex::GetBindingDescriptions();
-			auto attributeDescriptions = RveModel::Vertex::GetAttributeDescriptions();
+			auto bindingDescriptions = RveModel::Vertex::GetBindingDescriptions(configInfo.vertexFormat);
+			auto attributeDescriptions = RveModel::Vertex::GetAttributeDescriptions(configInfo.vertexFormat);
 			VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 			vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 			vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -75,6 +106,14 @@ namespace rve {
 			vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 			vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 
+			// Point at this config's own members so copied configs stay valid
+			VkPipelineColorBlendStateCreateInfo colorBlendInfo = configInfo.colorBlendInfo;
+			colorBlendInfo.attachmentCount = 1;
+			colorBlendInfo.pAttachments = &configInfo.colorBlendAttachment;
+			VkPipelineDynamicStateCreateInfo dynamicStateInfo = configInfo.dynamicStateInfo;
+			dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
+			dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
+
 			VkGraphicsPipelineCreateInfo pipelineInfo{};
 			pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 			pipelineInfo.stageCount = 2;
@@ -84,8 +123,9 @@ namespace rve {
 			pipelineInfo.pViewportState = &configInfo.viewportInfo;
 			pipelineInfo.pRasterizationState = &configInfo.rasterizationInfo;
 			pipelineInfo.pMultisampleState = &configInfo.multisampleInfo;
-			pipelineInfo.pColorBlendState = &configInfo.colorBlendInfo;
-			pipelineInfo.pDynamicState = &configInfo.dynamicStateInfo;
+			pipelineInfo.pColorBlendState = &colorBlendInfo;
+			pipelineInfo.pDepthStencilState = &configInfo.depthStencilInfo;
+			pipelineInfo.pDynamicState = &dynamicStateInfo;
 			pipelineInfo.layout = configInfo.pipelineLayout;
 			pipelineInfo.renderPass = configInfo.renderPass;
 			pipelineInfo.subpass = configInfo.subpass;
@@ -94,7 +134,7 @@ namespace rve {
 
 			if(vkCreateGraphicsPipelines(
 				rveVulkanDevice.Device(),
-				VK_NULL_HANDLE, 1,
+				pipelineCache, 1,
 				&pipelineInfo,
 				nullptr,
 				&graphicsPipeline) != VK_SUCCESS) {
@@ -102,11 +142,20 @@ namespace rve {
 			}
 	}
 
-	void RvePipeline::CreateShaderModule(const std::vector<char>& shaderCode, VkShaderModule* shaderModule) {
+	std::span<const uint32_t> RvePipeline::LoadShaderCode(const std::string& filePath, std::vector<char>& fileStorage) {
+		auto bundled = RveShaderBundle::Find(filePath);
+		if(!bundled.empty()) {
+			return bundled;
+		}
+		fileStorage = ReadFile(filePath);
+		return {reinterpret_cast<const uint32_t*>(fileStorage.data()), fileStorage.size() / sizeof(uint32_t)};
+	}
+
+	void RvePipeline::CreateShaderModule(std::span<const uint32_t> shaderCode, VkShaderModule* shaderModule) {
 		VkShaderModuleCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		createInfo.codeSize = shaderCode.size();
-		createInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+		createInfo.codeSize = shaderCode.size_bytes();
+		createInfo.pCode = shaderCode.data();
 
 		if(vkCreateShaderModule(rveVulkanDevice.Device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS) {
 			throw std::runtime_error("(rve_pipeline.cpp) Failed to create shader module");
@@ -186,4 +235,57 @@ namespace rve {
 	void RvePipeline::Bind(VkCommandBuffer commandBuffer) {
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 	}
+
+	void RvePipeline::Swap(RvePipeline& other) {
+		assert(&rveVulkanDevice == &other.rveVulkanDevice && "(rve_pipeline.cpp) Cannot swap pipelines of different devices");
+		std::swap(graphicsPipeline, other.graphicsPipeline);
+		std::swap(vertShaderModule, other.vertShaderModule);
+		std::swap(fragShaderModule, other.fragShaderModule);
+	}
+
+	RveComputePipeline::RveComputePipeline(
+		RveVulkanDevice& device,
+		const std::string& compFilePath,
+		VkPipelineLayout pipelineLayout) : rveVulkanDevice{device} {
+			assert(pipelineLayout != VK_NULL_HANDLE && "(rve_pipeline.cpp) Error: No pipelineLayout provided for compute pipeline");
+			std::vector<char> compFile;
+			auto compCode = RvePipeline::LoadShaderCode(compFilePath, compFile);
+
+			VkShaderModuleCreateInfo moduleInfo{};
+			moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			moduleInfo.codeSize = compCode.size_bytes();
+			moduleInfo.pCode = compCode.data();
+			if(vkCreateShaderModule(rveVulkanDevice.Device(), &moduleInfo, nullptr, &compShaderModule) != VK_SUCCESS) {
+				throw std::runtime_error("(rve_pipeline.cpp) Failed to create shader module");
+			}
+
+			VkComputePipelineCreateInfo pipelineInfo{};
+			pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			pipelineInfo.stage.module = compShaderModule;
+			pipelineInfo.stage.pName = "main";
+			pipelineInfo.stage.pSpecializationInfo = nullptr;
+			pipelineInfo.layout = pipelineLayout;
+			pipelineInfo.basePipelineIndex = -1;
+			pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+			if(vkCreateComputePipelines(
+				rveVulkanDevice.Device(),
+				VK_NULL_HANDLE, 1,
+				&pipelineInfo,
+				nullptr,
+				&computePipeline) != VK_SUCCESS) {
+					throw std::runtime_error("(rve_pipeline.cpp) Failed to create vulkan compute pipeline");
+			}
+	}
+
+	RveComputePipeline::~RveComputePipeline() {
+		rveVulkanDevice.GetDeletionQueue().DestroyShaderModule(compShaderModule);
+		rveVulkanDevice.GetDeletionQueue().DestroyPipeline(computePipeline);
+	}
+
+	void RveComputePipeline::Bind(VkCommandBuffer commandBuffer) {
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+	}
 } // namespace rve
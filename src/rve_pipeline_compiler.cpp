@@ -0,0 +1,73 @@
+#include "../include/rve_pipeline_compiler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace rve {
+	RvePipelineCompiler::RvePipelineCompiler(RveVulkanDevice& device, uint32_t workerCount) : rveVulkanDevice{device} {
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		if(vkCreatePipelineCache(rveVulkanDevice.Device(), &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_pipeline_compiler.cpp) Failed to create pipeline cache");
+		}
+
+		if(workerCount == 0) {
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			workerCount = std::clamp(hardwareThreads > 1 ? hardwareThreads - 1 : 1u, 1u, maxWorkers);
+		}
+		for(uint32_t i = 0; i < workerCount; i++) {
+			workers.emplace_back(&RvePipelineCompiler::WorkerLoop, this);
+		}
+	}
+
+	RvePipelineCompiler::~RvePipelineCompiler() {
+		{
+			std::lock_guard<std::mutex> lock{jobMutex};
+			stopping = true;
+		}
+		jobCondition.notify_all();
+		for(auto& worker : workers) {
+			worker.join();
+		}
+		vkDestroyPipelineCache(rveVulkanDevice.Device(), pipelineCache, nullptr);
+	}
+
+	std::future<std::unique_ptr<RvePipeline>> RvePipelineCompiler::CompileGraphicsPipeline(
+		const std::string& vertFilePath,
+		const std::string& fragFilePath,
+		const RvePipelineConfigInfo& configInfo) {
+			// std::function needs a copyable callable, so the task is shared
+			auto task = std::make_shared<std::packaged_task<std::unique_ptr<RvePipeline>()>>(
+				[this, vertFilePath, fragFilePath, configInfo]() {
+					return std::make_unique<RvePipeline>(rveVulkanDevice, vertFilePath, fragFilePath, configInfo, pipelineCache);
+				});
+			auto future = task->get_future();
+			pendingCount++;
+			{
+				std::lock_guard<std::mutex> lock{jobMutex};
+				jobs.emplace_back([this, task]() {
+					(*task)();
+					pendingCount--;
+				});
+			}
+			jobCondition.notify_one();
+			return future;
+	}
+
+	void RvePipelineCompiler::WorkerLoop() {
+		while(true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock{jobMutex};
+				jobCondition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+				// Queued jobs are still drained so no future is left without a value
+				if(jobs.empty()) {
+					return;
+				}
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+			job();
+		}
+	}
+} // namespace rve
@@ -0,0 +1,254 @@
+#include "../include/rve_pipeline_registry.hpp"
+#include "../include/rve_shader_bundle.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+
+namespace rve {
+	static uint64_t FloatBits(float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	size_t RvePipelineRegistry::KeyHash::operator()(const Key& key) const {
+		// FNV-1a over the flattened state, combined with the shader path hashes
+		uint64_t hash = 14695981039346656037ull;
+		auto combine = [&](uint64_t value) {
+			hash ^= value;
+			hash *= 1099511628211ull;
+		};
+		combine(std::hash<std::string>{}(key.vertFilePath));
+		combine(std::hash<std::string>{}(key.fragFilePath));
+		for(uint64_t value : key.state) {
+			combine(value);
+		}
+		return static_cast<size_t>(hash);
+	}
+
+	void RvePipelineRegistry::AppendConfigState(const RvePipelineConfigInfo& configInfo, std::vector<uint64_t>& state) {
+		// Viewport and scissor are always dynamic, so only their counts take part
+		state.push_back(configInfo.subpass);
+		state.push_back((uint64_t)configInfo.renderPass);
+		state.push_back((uint64_t)configInfo.pipelineLayout);
+		state.push_back(static_cast<uint64_t>(configInfo.vertexFormat));
+		state.push_back(configInfo.viewportInfo.viewportCount);
+		state.push_back(configInfo.viewportInfo.scissorCount);
+
+		const auto& inputAssembly = configInfo.inputAssemblyCreateInfo;
+		state.push_back(inputAssembly.topology);
+		state.push_back(inputAssembly.primitiveRestartEnable);
+
+		const auto& rasterization = configInfo.rasterizationInfo;
+		state.push_back(rasterization.depthClampEnable);
+		state.push_back(rasterization.rasterizerDiscardEnable);
+		state.push_back(rasterization.polygonMode);
+		state.push_back(rasterization.cullMode);
+		state.push_back(rasterization.frontFace);
+		state.push_back(rasterization.depthBiasEnable);
+		state.push_back(FloatBits(rasterization.depthBiasConstantFactor));
+		state.push_back(FloatBits(rasterization.depthBiasClamp));
+		state.push_back(FloatBits(rasterization.depthBiasSlopeFactor));
+		state.push_back(FloatBits(rasterization.lineWidth));
+
+		const auto& multisample = configInfo.multisampleInfo;
+		state.push_back(multisample.rasterizationSamples);
+		state.push_back(multisample.sampleShadingEnable);
+		state.push_back(FloatBits(multisample.minSampleShading));
+		state.push_back(multisample.alphaToCoverageEnable);
+		state.push_back(multisample.alphaToOneEnable);
+
+		const auto& blendInfo = configInfo.colorBlendInfo;
+		state.push_back(blendInfo.logicOpEnable);
+		state.push_back(blendInfo.logicOp);
+		for(float constant : blendInfo.blendConstants) {
+			state.push_back(FloatBits(constant));
+		}
+		const auto& blend = configInfo.colorBlendAttachment;
+		state.push_back(blend.blendEnable);
+		state.push_back(blend.srcColorBlendFactor);
+		state.push_back(blend.dstColorBlendFactor);
+		state.push_back(blend.colorBlendOp);
+		state.push_back(blend.srcAlphaBlendFactor);
+		state.push_back(blend.dstAlphaBlendFactor);
+		state.push_back(blend.alphaBlendOp);
+		state.push_back(blend.colorWriteMask);
+
+		const auto& depthStencil = configInfo.depthStencilInfo;
+		state.push_back(depthStencil.depthTestEnable);
+		state.push_back(depthStencil.depthWriteEnable);
+		state.push_back(depthStencil.depthCompareOp);
+		state.push_back(depthStencil.depthBoundsTestEnable);
+		state.push_back(FloatBits(depthStencil.minDepthBounds));
+		state.push_back(FloatBits(depthStencil.maxDepthBounds));
+		state.push_back(depthStencil.stencilTestEnable);
+		for(const VkStencilOpState& op : {depthStencil.front, depthStencil.back}) {
+			state.push_back(op.failOp);
+			state.push_back(op.passOp);
+			state.push_back(op.depthFailOp);
+			state.push_back(op.compareOp);
+			state.push_back(op.compareMask);
+			state.push_back(op.writeMask);
+			state.push_back(op.reference);
+		}
+
+		for(VkDynamicState dynamicState : configInfo.dynamicStateEnables) {
+			state.push_back(dynamicState);
+		}
+
+		const auto& specialization = configInfo.specialization;
+		state.push_back(specialization.entries.size());
+		for(const auto& entry : specialization.entries) {
+			state.push_back((static_cast<uint64_t>(entry.constantID) << 32) | specialization.data[entry.offset / sizeof(uint32_t)]);
+		}
+	}
+
+	RvePipelineRegistry::~RvePipelineRegistry() {
+		Clear();
+	}
+
+	void RvePipelineRegistry::Clear() {
+		// In flight compiles still reference the config's layout and render pass
+		for(auto& [key, entry] : pipelines) {
+			if(entry.pending.valid()) {
+				entry.pending.wait();
+			}
+			if(entry.reload.valid()) {
+				entry.reload.wait();
+			}
+		}
+		pipelines.clear();
+	}
+
+	RvePipelineRegistry::Stats RvePipelineRegistry::GetStats() const {
+		Stats stats{};
+		stats.variants = static_cast<uint32_t>(pipelines.size());
+		stats.pending = compiler.GetPendingCount();
+		stats.hits = hits;
+		stats.misses = misses;
+		stats.compileFailures = compileFailures;
+		stats.reloads = reloads;
+		stats.reloadFailures = reloadFailures;
+		return stats;
+	}
+
+	RvePipelineRegistry::Key RvePipelineRegistry::MakeKey(
+		const std::string& vertFilePath,
+		const std::string& fragFilePath,
+		const RvePipelineConfigInfo& configInfo) {
+			Key key{vertFilePath, fragFilePath, {}};
+			key.state.reserve(96);
+			AppendConfigState(configInfo, key.state);
+			return key;
+	}
+
+	RvePipeline *RvePipelineRegistry::Resolve(const Key& key, Entry& entry, bool wait) {
+		if(entry.pipeline == nullptr && entry.pending.valid()) {
+			if(!wait && entry.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				return nullptr;
+			}
+			try {
+				entry.pipeline = entry.pending.get();
+			} catch(const std::exception& error) {
+				// Requests keep getting nullptr instead of compiling the variant again every frame
+				entry.failed = true;
+				compileFailures++;
+				std::cerr << "Pipeline variant failed to compile " << key.vertFilePath << " + " << key.fragFilePath
+					<< ": " << error.what() << std::endl;
+			}
+		}
+		return entry.pipeline.get();
+	}
+
+	RvePipeline& RvePipelineRegistry::GetGraphicsPipeline(
+		const std::string& vertFilePath,
+		const std::string& fragFilePath,
+		const RvePipelineConfigInfo& configInfo) {
+			Key key = MakeKey(vertFilePath, fragFilePath, configInfo);
+			auto cached = pipelines.find(key);
+			if(cached != pipelines.end()) {
+				hits++;
+				RvePipeline *pipeline = Resolve(cached->first, cached->second, true);
+				if(pipeline == nullptr) {
+					throw std::runtime_error("(rve_pipeline_registry.cpp) Pipeline variant failed to compile");
+				}
+				return *pipeline;
+			}
+			misses++;
+			Entry entry{};
+			entry.configInfo = configInfo;
+			entry.pipeline = std::make_unique<RvePipeline>(
+				rveVulkanDevice,
+				vertFilePath,
+				fragFilePath,
+				configInfo,
+				compiler.GetPipelineCache());
+			RvePipeline& result = *entry.pipeline;
+			pipelines.emplace(std::move(key), std::move(entry));
+			return result;
+	}
+
+	RvePipeline *RvePipelineRegistry::RequestGraphicsPipeline(
+		const std::string& vertFilePath,
+		const std::string& fragFilePath,
+		const RvePipelineConfigInfo& configInfo) {
+			Key key = MakeKey(vertFilePath, fragFilePath, configInfo);
+			auto cached = pipelines.find(key);
+			if(cached != pipelines.end()) {
+				hits++;
+				return Resolve(cached->first, cached->second, false);
+			}
+			misses++;
+			Entry entry{};
+			entry.configInfo = configInfo;
+			entry.pending = compiler.CompileGraphicsPipeline(vertFilePath, fragFilePath, configInfo);
+			pipelines.emplace(std::move(key), std::move(entry));
+			return nullptr;
+	}
+
+	void RvePipelineRegistry::ReloadShader(const std::string& spvFilePath) {
+		RveShaderBundle::PreferFile(spvFilePath);
+		for(auto& [key, entry] : pipelines) {
+			if(key.vertFilePath != spvFilePath && key.fragFilePath != spvFilePath) {
+				continue;
+			}
+			if(entry.failed) {
+				// The saved file may fix what made the first compile fail
+				entry.failed = false;
+				entry.pending = compiler.CompileGraphicsPipeline(key.vertFilePath, key.fragFilePath, entry.configInfo);
+				continue;
+			}
+			// A compile in flight may have read the file before this save, BeginFrame rebuilds once it is done
+			if(entry.pipeline == nullptr || entry.reload.valid()) {
+				entry.reloadAgain = true;
+				continue;
+			}
+			entry.reload = compiler.CompileGraphicsPipeline(key.vertFilePath, key.fragFilePath, entry.configInfo);
+		}
+	}
+
+	void RvePipelineRegistry::BeginFrame() {
+		for(auto& [key, entry] : pipelines) {
+			if(entry.reload.valid() && entry.reload.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+				try {
+					std::unique_ptr<RvePipeline> rebuilt = entry.reload.get();
+					// The old objects end up in rebuilt, whose destruction waits for the frames that bound them
+					entry.pipeline->Swap(*rebuilt);
+					reloads++;
+					std::cout << "Reloaded pipeline " << key.vertFilePath << " + " << key.fragFilePath << std::endl;
+				} catch(const std::exception& error) {
+					reloadFailures++;
+					std::cerr << "Keeping previous pipeline, reload failed: " << error.what() << std::endl;
+				}
+			}
+			// Picks up the newest SPIR-V of a shader saved again while the previous compile ran
+			if(entry.reloadAgain && entry.pipeline != nullptr && !entry.reload.valid()) {
+				entry.reloadAgain = false;
+				entry.reload = compiler.CompileGraphicsPipeline(key.vertFilePath, key.fragFilePath, entry.configInfo);
+			}
+		}
+	}
+} // namespace rve
@@ -0,0 +1,65 @@
+#include "../include/rve_range_allocator.hpp"
+
+#include <algorithm>
+
+namespace rve {
+	void RveRangeAllocator::Reset(uint32_t capacity, uint32_t used) {
+		freeBlocks.clear();
+		if(used < capacity) {
+			freeBlocks.push_back({used, capacity - used});
+		}
+	}
+
+	bool RveRangeAllocator::Allocate(uint32_t count, uint32_t &offset) {
+		for(size_t i = 0; i < freeBlocks.size(); i++) {
+			if(freeBlocks[i].count < count) {
+				continue;
+			}
+			offset = freeBlocks[i].offset;
+			freeBlocks[i].offset += count;
+			freeBlocks[i].count -= count;
+			if(freeBlocks[i].count == 0) {
+				freeBlocks.erase(freeBlocks.begin() + i);
+			}
+			return true;
+		}
+		return false;
+	}
+
+	void RveRangeAllocator::Release(uint32_t offset, uint32_t count) {
+		if(count == 0) {
+			return;
+		}
+		auto next = std::lower_bound(
+			freeBlocks.begin(),
+			freeBlocks.end(),
+			offset,
+			[](const FreeBlock& block, uint32_t value) { return block.offset < value; });
+		next = freeBlocks.insert(next, {offset, count});
+
+		if(next + 1 != freeBlocks.end() && next->offset + next->count == (next + 1)->offset) {
+			next->count += (next + 1)->count;
+			freeBlocks.erase(next + 1);
+		}
+		if(next != freeBlocks.begin() && (next - 1)->offset + (next - 1)->count == next->offset) {
+			(next - 1)->count += next->count;
+			freeBlocks.erase(next);
+		}
+	}
+
+	uint32_t RveRangeAllocator::LargestBlock() const {
+		uint32_t largest = 0;
+		for(auto& block : freeBlocks) {
+			largest = std::max(largest, block.count);
+		}
+		return largest;
+	}
+
+	uint32_t RveRangeAllocator::FreeCount() const {
+		uint32_t count = 0;
+		for(auto& block : freeBlocks) {
+			count += block.count;
+		}
+		return count;
+	}
+} // namespace rve
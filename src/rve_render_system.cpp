@@ -1,4 +1,5 @@
 #include "../include/rve_render_system.hpp"
+#include "../include/rve_geometry_pool.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -6,33 +7,171 @@
 #include <glm/gtc/constants.hpp>
 #include <stdexcept>
 #include <array>
+#include <cassert>
+#include <cstddef>
 
 namespace rve {
 	struct RveSimplePushConstantData {
-		glm::mat4 tranform{1.0f};
-		alignas(16) glm::vec3 color{};
+		glm::mat4 modelMatrix{1.0f};
+		glm::mat4 normalMatrix{1.0f};
 	};
 
-	RveRenderSystem::RveRenderSystem(RveVulkanDevice& device, VkRenderPass renderPass) : 
-		rveVulkanDevice{device}  {
+	// Matches Push in the bindless shaders, buffers are slots in the bindless storage buffer array
+	struct RveBindlessPushConstantData {
+		uint32_t frameBuffer;
+		uint32_t materialBuffer;
+		uint32_t objectIndex;
+		uint32_t virtualTextureBuffer;
+		uint32_t feedbackBuffer;
+	};
+
+	// The fragment shader reads the page cache slots, so every bindless push names both stages
+	static constexpr VkShaderStageFlags bindlessPushStages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	// std430 layouts of ObjectData and Material in the bindless vertex shader
+	struct RveBindlessObjectData {
+		glm::mat4 modelMatrix;
+		glm::mat4 normalMatrix;
+		uint32_t materialIndex;
+		uint32_t padding[3];
+	};
+
+	struct RveBindlessMaterialData {
+		glm::vec4 baseColor;
+		uint32_t textureIndex;
+		uint32_t virtualTextureIndex;
+		uint32_t padding[2];
+	};
+
+	static_assert(sizeof(RveGlobalUbo) == 96, "Bindless frame buffer expects the global data to be 96 bytes");
+	static_assert(sizeof(RveBindlessObjectData) == 144, "RveBindlessObjectData must match the std430 ObjectData stride");
+	static_assert(sizeof(RveBindlessMaterialData) == 32, "RveBindlessMaterialData must match the std430 Material stride");
+
+	RveRenderSystem::RveRenderSystem(
+		RveVulkanDevice& device,
+		RvePipelineRegistry& registry,
+		RveJobSystem& jobSystem,
+		const RveAssetRegistry& assets,
+		RveSamplerCache& samplers,
+		VkRenderPass renderPass,
+		RveVertexFormat format) : 
+			rveVulkanDevice{device}, pipelineRegistry{registry}, assetRegistry{assets}, renderPass{renderPass}, vertexFormat{format}, spatialIndex{jobSystem} {
+			bindlessEnabled = rveVulkanDevice.IsBindlessSupported();
+			if(bindlessEnabled) {
+				CreateBindlessResources();
+				pageCache = std::make_unique<RvePageCache>(rveVulkanDevice, *bindlessTable, jobSystem, samplers);
+			} else {
+				CreateDescriptorResources();
+			}
+			RegisterMaterial(RveMaterial{});
 			CreatePipelineLayout();
-			CreatePipeline(renderPass);
+			// The default variant is built up front so there is always something to draw with
+			RvePipelineConfigInfo fallbackConfig{};
+			BuildPipelineConfig(fallbackConfig, RveLightingModel::Lambert, RveDebugView::None);
+			fallbackPipeline = &pipelineRegistry.GetGraphicsPipeline(
+				GetVertexShaderPath(),
+				GetFragmentShaderPath(),
+				fallbackConfig
+			);
+			meshletCuller = std::make_unique<RveMeshletCuller>(rveVulkanDevice);
+			occlusionCuller = std::make_unique<RveOcclusionCuller>(rveVulkanDevice);
 	}
 
 	RveRenderSystem::~RveRenderSystem() {
 		vkDestroyPipelineLayout(rveVulkanDevice.Device(), pipelineLayout, nullptr);
 	}
 
+	void RveRenderSystem::CreateDescriptorResources() {
+		globalSetLayout = RveDescriptorSetLayout::Builder(rveVulkanDevice)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+			.Build();
+		descriptorPool = RveDescriptorPool::Builder(rveVulkanDevice)
+			.SetMaxSets(64)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 64)
+			.Build();
+		descriptorSetCache = std::make_unique<RveDescriptorSetCache>(*descriptorPool);
+		frameRing = std::make_unique<RveFrameRing>(rveVulkanDevice, frameRingSize);
+	}
+
+	void RveRenderSystem::CreateBindlessResources() {
+		bindlessTable = std::make_unique<RveBindlessTable>(rveVulkanDevice);
+		materialBuffer = std::make_unique<RveBuffer>(
+			rveVulkanDevice,
+			sizeof(RveBindlessMaterialData),
+			maxMaterials,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		if(materialBuffer->Map() != VK_SUCCESS) {
+			throw std::runtime_error("(rve_render_system.cpp) Failed to map material buffer");
+		}
+		materialSlot = bindlessTable->AddStorageBuffer(materialBuffer->DescriptorInfo());
+	}
+
+	uint32_t RveRenderSystem::RegisterMaterial(const RveMaterial& material) {
+		if(materialCount == maxMaterials) {
+			throw std::runtime_error("(rve_render_system.cpp) Too many materials");
+		}
+		// The fallback path has no material data, only the index is handed out
+		if(bindlessEnabled) {
+			RveBindlessMaterialData data{};
+			data.baseColor = material.baseColor;
+			data.textureIndex = material.textureIndex;
+			data.virtualTextureIndex = material.virtualTextureIndex;
+			materialBuffer->WriteToIndex(&data, materialCount);
+		}
+		return materialCount++;
+	}
+
+	uint32_t RveRenderSystem::RegisterTexture(const RveTexture& texture, VkSampler sampler) {
+		if(!bindlessEnabled) {
+			return RveBindlessTable::invalidIndex;
+		}
+		return bindlessTable->AddTexture(texture.DescriptorInfo(sampler));
+	}
+
+	uint32_t RveRenderSystem::RegisterVirtualTexture(std::shared_ptr<RveVirtualTexture> texture) {
+		if(!bindlessEnabled) {
+			return RveBindlessTable::invalidIndex;
+		}
+		return pageCache->Register(std::move(texture));
+	}
+
+	void RveRenderSystem::EnsureBindlessCapacity(BindlessFrame& frame, uint32_t objectCount) {
+		if(frame.buffer != nullptr && objectCount <= frame.objectCapacity) {
+			return;
+		}
+		// The slot's previous buffer was last read by the frame whose fence has just been waited on
+		frame.objectCapacity = glm::max(glm::max(objectCount, frame.objectCapacity * 2), 64u);
+		frame.buffer = std::make_unique<RveBuffer>(
+			rveVulkanDevice,
+			sizeof(RveGlobalUbo) + sizeof(RveBindlessObjectData) * frame.objectCapacity,
+			1,
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		if(frame.buffer->Map() != VK_SUCCESS) {
+			throw std::runtime_error("(rve_render_system.cpp) Failed to map bindless frame buffer");
+		}
+		if(frame.slot == RveBindlessTable::invalidIndex) {
+			frame.slot = bindlessTable->AddStorageBuffer(frame.buffer->DescriptorInfo());
+		} else {
+			bindlessTable->UpdateStorageBuffer(frame.slot, frame.buffer->DescriptorInfo());
+		}
+		stats.descriptorSetWrites++;
+	}
+
 	void RveRenderSystem::CreatePipelineLayout() {
 		VkPushConstantRange pushConstantRange;
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.stageFlags = bindlessEnabled ? bindlessPushStages : VK_SHADER_STAGE_VERTEX_BIT;
 		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(RveSimplePushConstantData);
+		pushConstantRange.size = bindlessEnabled ? sizeof(RveBindlessPushConstantData) : sizeof(RveSimplePushConstantData);
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 0;
-		pipelineLayoutInfo.pSetLayouts = nullptr;
+		VkDescriptorSetLayout setLayout = bindlessEnabled ?
+			bindlessTable->GetSetLayout() :
+			globalSetLayout->GetDescriptorSetLayout();
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &setLayout;
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -41,51 +180,377 @@ namespace rve {
 		}
 	}
 
-	void RveRenderSystem::CreatePipeline(VkRenderPass renderPass) {
-		assert(
-			pipelineLayout != nullptr &&
-			"(rve_engine.cpp) Cannot create pipeline before pipeline layout"
-		);
+	void RveRenderSystem::BuildPipelineConfig(
+		RvePipelineConfigInfo& pipelineConfig,
+		RveLightingModel lighting,
+		RveDebugView view) const {
+			assert(
+				pipelineLayout != nullptr &&
+				"(rve_render_system.cpp) Cannot create pipeline before pipeline layout"
+			);
+			RvePipeline::DefaultPipelineConfigInfo(pipelineConfig);
+			pipelineConfig.renderPass = renderPass;
+			pipelineConfig.pipelineLayout = pipelineLayout;
+			pipelineConfig.vertexFormat = vertexFormat;
+			pipelineConfig.specialization.Set(0, static_cast<uint32_t>(vertexFormat));
+			pipelineConfig.specialization.Set(1, static_cast<uint32_t>(lighting));
+			pipelineConfig.specialization.Set(2, static_cast<uint32_t>(view));
+	}
+
+	const char *RveRenderSystem::GetVertexShaderPath() const {
+		return bindlessEnabled ? "shaders/bindless_shader.vert.spv" : "shaders/simple_shader.vert.spv";
+	}
 
+	const char *RveRenderSystem::GetFragmentShaderPath() const {
+		return bindlessEnabled ? "shaders/bindless_shader.frag.spv" : "shaders/simple_shader.frag.spv";
+	}
+
+	RvePipeline& RveRenderSystem::GetPipeline() {
+		if(rvePipeline != nullptr) {
+			return *rvePipeline;
+		}
 		RvePipelineConfigInfo pipelineConfig{};
-		RvePipeline::DefaultPipelineConfigInfo(pipelineConfig);
-		pipelineConfig.renderPass = renderPass;
-		pipelineConfig.pipelineLayout = pipelineLayout;
-		rvePipeline = std::make_unique<RvePipeline>(
-			rveVulkanDevice,
-			"shaders/simple_shader.vert.spv",
-			"shaders/simple_shader.frag.spv",
+		BuildPipelineConfig(pipelineConfig, lightingModel, debugView);
+		rvePipeline = pipelineRegistry.RequestGraphicsPipeline(
+			GetVertexShaderPath(),
+			GetFragmentShaderPath(),
 			pipelineConfig
 		);
-	}	
-
-	void RveRenderSystem::RenderGameObjects(
-		VkCommandBuffer commandBuffer, 
-		std::vector<RveGameObject>& gameObjects) {
-			/* int i = 0;
-			for(auto& object: gameObjects) {
-				i += 1;
-				object.transform.rotation.y = glm::mod<float>(
-					object.transform.rotation.y + 0.001f * i, 2.0f * glm::pi<float>()
+		// Draw with the default variant until the requested one has compiled
+		return rvePipeline != nullptr ? *rvePipeline : *fallbackPipeline;
+	}
+
+	void RveRenderSystem::SetLightingModel(RveLightingModel model) {
+		if(model != lightingModel) {
+			lightingModel = model;
+			rvePipeline = nullptr;
+		}
+	}
+
+	void RveRenderSystem::SetDebugView(RveDebugView view) {
+		if(view != debugView) {
+			debugView = view;
+			rvePipeline = nullptr;
+		}
+	}
+
+	RvePipeline *RveRenderSystem::RequestTaggedVariant(uint32_t tag, bool wait) {
+		RvePipelineConfigInfo pipelineConfig{};
+		BuildPipelineConfig(pipelineConfig, lightingModel, debugView);
+		pipelineConfig.specialization.Set(variantTagConstantId, tag);
+		if(wait) {
+			return &pipelineRegistry.GetGraphicsPipeline(GetVertexShaderPath(), GetFragmentShaderPath(), pipelineConfig);
+		}
+		return pipelineRegistry.RequestGraphicsPipeline(GetVertexShaderPath(), GetFragmentShaderPath(), pipelineConfig);
+	}
+
+	uint32_t RveRenderSystem::SelectLod(
+		const RveModel& model,
+		ModelComponent& modelComponent,
+		const glm::mat4& modelMatrix,
+		float maxScale,
+		const RveFrameInfo& frameInfo) {
+		const uint32_t lodCount = model.GetLodCount();
+		if(!lodEnabled || lodCount == 1 || !frameInfo.camera.IsPerspective()) {
+			modelComponent.lodLevel = 0;
+			return 0;
+		}
+
+		glm::vec3 center{modelMatrix * glm::vec4{model.GetBoundingCenter(), 1.0f}};
+		float distance = glm::length(center - frameInfo.camera.GetPosition()) - model.GetBoundingRadius() * maxScale;
+		distance = glm::max(distance, 0.001f);
+
+		// Model space units to screen pixels at the nearest point of the bounding sphere
+		float pixelScale = frameInfo.camera.GetProjection()[1][1] * 0.5f * frameInfo.extent.height * maxScale / distance;
+		auto projectedError = [&](uint32_t level) { return model.GetLod(level).error * pixelScale; };
+
+		uint32_t current = glm::min(modelComponent.lodLevel, lodCount - 1);
+		uint32_t target = 0;
+		for(uint32_t level = 1; level < lodCount; level++) {
+			if(projectedError(level) > lodErrorThreshold) {
+				break;
+			}
+			target = level;
+		}
+		while(target > current && projectedError(target) > lodErrorThreshold * lodHysteresis) {
+			target--;
+		}
+		modelComponent.lodLevel = target;
+		return target;
+	}
+
+	void RveRenderSystem::PrepareFrame(RveFrameInfo& frameInfo, RveWorld& world, const RveTransformHierarchy& hierarchy) {
+			stats = {};
+			const uint32_t objectCount = renderQuery.Count(world);
+			const uint32_t attachedCount = attachedQuery.Count(world);
+			drawItems.clear();
+			meshletCuller->BeginFrame(frameInfo.frameIndex);
+			// Meshlets are cached per model handle, the registry destroyed these models this frame
+			for(RveModelHandle handle : assetRegistry.GetDestroyedModels()) {
+				meshletCuller->RemoveModel(handle);
+			}
+			occlusionCuller->BeginFrame(frameInfo.frameIndex);
+			const glm::mat4& view = frameInfo.camera.GetView();
+			RveGlobalUbo ubo{};
+			ubo.projectionView = frameInfo.camera.GetProjection() * view;
+			RveBindlessObjectData *objectData = nullptr;
+			if(bindlessEnabled) {
+				bindlessTable->BeginFrame(frameInfo.frameIndex);
+				pageCache->Update(frameInfo);
+				currentBindlessFrame = &bindlessFrames[frameInfo.frameIndex];
+				EnsureBindlessCapacity(*currentBindlessFrame, objectCount + attachedCount);
+				char *mapped = static_cast<char*>(currentBindlessFrame->buffer->GetMappedMemory());
+				*reinterpret_cast<RveGlobalUbo*>(mapped) = ubo;
+				objectData = reinterpret_cast<RveBindlessObjectData*>(mapped + sizeof(RveGlobalUbo));
+			} else {
+				frameRing->BeginFrame(frameInfo.frameIndex);
+				// The set only names the slot's ring buffer, so after the first frames it is always a cache hit
+				globalOffset = frameRing->Push(ubo).offset;
+				auto globalInfo = frameRing->DescriptorInfo(sizeof(RveGlobalUbo));
+				uint32_t writesBefore = descriptorSetCache->GetStats().misses;
+				if(!RveDescriptorWriter(*globalSetLayout, *descriptorPool)
+					.WriteBuffer(0, &globalInfo)
+					.Build(globalSet, *descriptorSetCache)) {
+						throw std::runtime_error("(rve_render_system.cpp) Failed to build global descriptor set");
+				}
+				stats.descriptorSetWrites = descriptorSetCache->GetStats().misses - writesBefore;
+			}
+			// Both passes walk the query in the same order, so the running index lines up with the transform store
+			transformStore.Resize(objectCount);
+			uint32_t objectIndex = 0;
+			renderQuery.ForEachChunk(world, [&](uint32_t count, const RveEntity *, const TransformComponent *transforms, ModelComponent *) {
+				for(uint32_t row = 0; row < count; row++) {
+					transformStore.Set(objectIndex++, transforms[row]);
+				}
+			});
+			transformStore.Update();
+			objectIndex = 0;
+			drawCandidates.clear();
+			spatialFrame++;
+			renderQuery.ForEach(world, [&](RveEntity entity, TransformComponent&, ModelComponent& modelComponent) {
+				AddCandidate(entity, modelComponent, transformStore.GetWorldMatrix(objectIndex++));
+			});
+			attachedQuery.ForEach(world, [&](RveEntity entity, const HierarchyComponent& attachment, ModelComponent& modelComponent) {
+				AddCandidate(entity, modelComponent, hierarchy.GetWorldMatrix(attachment.node));
+			});
+			// Entities not seen this frame were destroyed or lost a component
+			for(SpatialProxy& spatialProxy : spatialProxies) {
+				if(spatialProxy.proxy != RveBvh::noProxy && spatialProxy.lastFrame != spatialFrame) {
+					spatialIndex.Remove(spatialProxy.proxy);
+					spatialProxy.proxy = RveBvh::noProxy;
+				}
+			}
+			spatialIndex.Maintain();
+
+			if(spatialCullingEnabled) {
+				visibleEntities.clear();
+				spatialIndex.QueryFrustum(frameInfo.camera.GetFrustumPlanes(), visibleEntities);
+				for(uint32_t entityIndex : visibleEntities) {
+					const DrawCandidate& candidate = drawCandidates[candidateByEntity[entityIndex]];
+					AddDrawItem(frameInfo, candidate.entity, *candidate.model, *candidate.modelComponent, *candidate.modelMatrix, objectData);
+				}
+				stats.spatialCulled = static_cast<uint32_t>(drawCandidates.size() - visibleEntities.size());
+			} else {
+				for(const DrawCandidate& candidate : drawCandidates) {
+					AddDrawItem(frameInfo, candidate.entity, *candidate.model, *candidate.modelComponent, *candidate.modelMatrix, objectData);
+				}
+			}
+			stats.spatial = spatialIndex.GetStats();
+			// The sphere projection in the occlusion test assumes a perspective camera
+			occlusionCuller->DispatchEarly(frameInfo, occlusionCullingEnabled && frameInfo.camera.IsPerspective());
+			meshletCuller->Dispatch(frameInfo, RveDrawPhase::Early, occlusionCuller->GetObjectPhaseBuffer());
+			stats.meshlets = meshletCuller->GetStats();
+			stats.occlusion = occlusionCuller->GetStats();
+			if(bindlessEnabled) {
+				stats.bindless = bindlessTable->GetStats();
+				stats.virtualTexturing = pageCache->GetStats();
+			} else {
+				stats.frameRingBytes = frameRing->GetUsedBytes();
+			}
+	}
+
+	static float MaxAxisScale(const glm::mat4& modelMatrix) {
+		// Column lengths are the axis scales, including any inherited from hierarchy parents
+		return glm::sqrt(glm::max(
+			glm::dot(modelMatrix[0], modelMatrix[0]),
+			glm::max(glm::dot(modelMatrix[1], modelMatrix[1]), glm::dot(modelMatrix[2], modelMatrix[2]))));
+	}
+
+	void RveRenderSystem::AddCandidate(RveEntity entity, ModelComponent& modelComponent, const glm::mat4& modelMatrix) {
+		// Entities whose model was released are not drawn, their spatial proxy goes stale and is removed
+		RveModel *model = assetRegistry.TryGet(modelComponent.model);
+		if(model == nullptr) {
+			return;
+		}
+		if(candidateByEntity.size() <= entity.index) {
+			candidateByEntity.resize(entity.index + 1);
+			spatialProxies.resize(entity.index + 1);
+		}
+		candidateByEntity[entity.index] = static_cast<uint32_t>(drawCandidates.size());
+		drawCandidates.push_back({entity, model, &modelComponent, &modelMatrix});
+
+		glm::vec3 center{modelMatrix * glm::vec4{model->GetBoundingCenter(), 1.0f}};
+		glm::vec3 extent{model->GetBoundingRadius() * MaxAxisScale(modelMatrix)};
+		RveAabb bounds{center - extent, center + extent};
+		SpatialProxy& spatialProxy = spatialProxies[entity.index];
+		if(spatialProxy.proxy != RveBvh::noProxy && spatialProxy.generation != entity.generation) {
+			spatialIndex.Remove(spatialProxy.proxy);
+			spatialProxy.proxy = RveBvh::noProxy;
+		}
+		if(spatialProxy.proxy == RveBvh::noProxy) {
+			spatialProxy.proxy = spatialIndex.Insert(bounds, entity.index);
+			spatialProxy.generation = entity.generation;
+		} else {
+			spatialIndex.Update(spatialProxy.proxy, bounds);
+		}
+		spatialProxy.lastFrame = spatialFrame;
+	}
+
+	void RveRenderSystem::AddDrawItem(
+		const RveFrameInfo& frameInfo,
+		RveEntity entity,
+		RveModel& model,
+		ModelComponent& modelComponent,
+		const glm::mat4& modelMatrix,
+		RveBindlessObjectData *objectData) {
+			assert(
+				model.GetVertexFormat() == vertexFormat &&
+				"(rve_render_system.cpp) Model vertex format does not match pipeline"
+			);
+			float maxScale = MaxAxisScale(modelMatrix);
+			uint32_t lodLevel = SelectLod(model, modelComponent, modelMatrix, maxScale, frameInfo);
+
+			DrawItem item{};
+			item.model = &model;
+			item.modelMatrix = modelMatrix * model.GetDequantizeTransform();
+			item.normalMatrix = glm::transpose(glm::inverse(glm::mat3{modelMatrix}));
+			item.lodLevel = lodLevel;
+			item.occlusionObject = noCullIndex;
+			item.meshletInstance = noCullIndex;
+			// The projected radius in pixels is the streaming priority, orthographic views count as full screen
+			glm::vec3 viewCenter{frameInfo.camera.GetView() * modelMatrix * glm::vec4{model.GetBoundingCenter(), 1.0f}};
+			float screenRadius = static_cast<float>(frameInfo.extent.height);
+			if(frameInfo.camera.IsPerspective()) {
+				screenRadius = frameInfo.camera.GetProjection()[1][1] * 0.5f * frameInfo.extent.height *
+					model.GetBoundingRadius() * maxScale / glm::max(glm::length(viewCenter), 0.001f);
+			}
+			model.NoteDrawn(screenRadius);
+			// Streamed models still loading draw their coarse mesh directly, it is not culled any further
+			const RveModel::Lod& lod = model.GetLod(lodLevel);
+			if(lod.indexCount > 0 && model.IsResident()) {
+				const auto& range = model.GetGeometryPool().GetRange(model.GetMeshHandle());
+				item.occlusionObject = occlusionCuller->AddObject(
+					entity.index,
+					viewCenter,
+					model.GetBoundingRadius() * maxScale,
+					lod.indexCount,
+					range.firstIndex + lod.firstIndex,
+					static_cast<int32_t>(range.firstVertex));
+			}
+			// Meshlets only cover LOD0, coarser levels are already cheap enough to draw whole
+			if(meshletCullingEnabled && item.occlusionObject != noCullIndex && lodLevel == 0 && model.HasMeshlets()) {
+				item.meshletInstance = meshletCuller->AddInstance(modelComponent.model, model, modelMatrix, maxScale, item.occlusionObject);
+			}
+			if(objectData != nullptr) {
+				assert(modelComponent.materialIndex < materialCount && "(rve_render_system.cpp) Material index out of range");
+				RveBindlessObjectData& data = objectData[drawItems.size()];
+				data.modelMatrix = item.modelMatrix;
+				data.normalMatrix = item.normalMatrix;
+				data.materialIndex = modelComponent.materialIndex;
+			}
+			drawItems.push_back(item);
+
+			stats.objectsDrawn++;
+			stats.trianglesFullDetail += model.GetTriangleCount(0);
+	}
+
+	void RveRenderSystem::CullOccluded(RveFrameInfo& frameInfo, VkImageView depthView) {
+		if(!occlusionCuller->IsLateActive()) {
+			return;
+		}
+		occlusionCuller->DispatchLate(frameInfo, depthView);
+		meshletCuller->Dispatch(frameInfo, RveDrawPhase::Late, occlusionCuller->GetObjectPhaseBuffer());
+	}
+
+	void RveRenderSystem::RenderGameObjects(RveFrameInfo& frameInfo, RveDrawPhase phase) {
+		if(phase == RveDrawPhase::Late && !occlusionCuller->IsLateActive()) {
+			return;
+		}
+		GetPipeline().Bind(frameInfo.commandBuffer);
+		if(bindlessEnabled) {
+			bindlessTable->Bind(frameInfo.commandBuffer, pipelineLayout, 0);
+			RveBindlessPushConstantData push{};
+			push.frameBuffer = currentBindlessFrame->slot;
+			push.materialBuffer = materialSlot;
+			push.virtualTextureBuffer = pageCache->GetInfoSlot();
+			push.feedbackBuffer = pageCache->GetFeedbackSlot();
+			vkCmdPushConstants(
+				frameInfo.commandBuffer,
+				pipelineLayout,
+				bindlessPushStages,
+				0,
+				sizeof(RveBindlessPushConstantData),
+				&push
+			);
+		} else {
+			vkCmdBindDescriptorSets(
+				frameInfo.commandBuffer,
+				VK_PIPELINE_BIND_POINT_GRAPHICS,
+				pipelineLayout,
+				0, 1, &globalSet,
+				1, &globalOffset);
+		}
+		RveGeometryPool *boundPool = nullptr;
+		for(uint32_t itemIndex = 0; itemIndex < drawItems.size(); itemIndex++) {
+			const DrawItem& item = drawItems[itemIndex];
+			// Non indexed models skip occlusion culling and are always drawn early
+			if(item.occlusionObject == noCullIndex && phase == RveDrawPhase::Late) {
+				continue;
+			}
+			if(bindlessEnabled) {
+				// Only the object index changes per draw, the buffer slots were pushed above
+				vkCmdPushConstants(
+					frameInfo.commandBuffer,
+					pipelineLayout,
+					bindlessPushStages,
+					offsetof(RveBindlessPushConstantData, objectIndex),
+					sizeof(uint32_t),
+					&itemIndex
 				);
-			} */
-			rvePipeline->Bind(commandBuffer);
-			for(auto& object: gameObjects) {
-				object.transform.rotation.y = glm::mod(object.transform.rotation.y + 0.01f, glm::two_pi<float>());
-				object.transform.rotation.x = glm::mod(object.transform.rotation.x + 0.01f, glm::two_pi<float>());
+			} else {
 				RveSimplePushConstantData push{};
-				push.color = object.color;
-				push.tranform = object.transform.mat4();
+				push.modelMatrix = item.modelMatrix;
+				push.normalMatrix = item.normalMatrix;
 				vkCmdPushConstants(
-					commandBuffer, 
+					frameInfo.commandBuffer, 
 					pipelineLayout,
-					VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 
+					VK_SHADER_STAGE_VERTEX_BIT, 
 					0, 
 					sizeof(RveSimplePushConstantData), 
 					&push
 				);
-				object.model->Bind(commandBuffer);
-				object.model->Draw(commandBuffer);
 			}
+			if(&item.model->GetGeometryPool() != boundPool) {
+				boundPool = &item.model->GetGeometryPool();
+				boundPool->Bind(frameInfo.commandBuffer);
+			}
+			if(item.meshletInstance != noCullIndex) {
+				meshletCuller->DrawInstance(frameInfo.commandBuffer, item.meshletInstance, phase);
+			} else if(item.occlusionObject != noCullIndex) {
+				occlusionCuller->DrawObject(frameInfo.commandBuffer, item.occlusionObject, phase);
+			} else {
+				item.model->Draw(frameInfo.commandBuffer, item.lodLevel);
+			}
+			if(phase == RveDrawPhase::Early) {
+				stats.trianglesRendered += item.model->IsResident() ?
+					item.model->GetTriangleCount(item.lodLevel) : item.model->GetCoarseTriangleCount();
+			}
+		}
+	}
+
+	void RveRenderSystem::FinishFrame(RveFrameInfo& frameInfo) {
+		if(bindlessEnabled) {
+			pageCache->EndFrame(frameInfo);
+		}
 	}
 } // namespace rve
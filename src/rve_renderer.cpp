@@ -27,6 +27,8 @@ namespace rve {
 		if(result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
 			throw std::runtime_error("(rve_engine.cpp) Failed to get swap chain image");
 		}
+		// Acquiring waited on this slot's fence, so the frame that last used it has retired
+		rveVulkanDevice.GetDeletionQueue().BeginFrame();
 		
 		isFrameStarted = true;
 		auto commandBuffer = GetCurrentCommandBuffer();
@@ -62,6 +64,14 @@ namespace rve {
 	}
 
 	void RveRenderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+		BeginRenderPass(commandBuffer, rveSwapChain->GetRenderPass());
+	}
+
+	void RveRenderer::ResumeSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+		BeginRenderPass(commandBuffer, rveSwapChain->GetLoadRenderPass());
+	}
+
+	void RveRenderer::BeginRenderPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass) {
 		assert(
 			isFrameStarted && 
 			"(rve_renderer.cpp) Cannot begin render pass while not in progress"
@@ -72,7 +82,7 @@ namespace rve {
 		);
 		VkRenderPassBeginInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = rveSwapChain->GetRenderPass();
+		renderPassInfo.renderPass = renderPass;
 		renderPassInfo.framebuffer = rveSwapChain->GetFrameBuffer(currentImageIndex);
 		renderPassInfo.renderArea.offset = {0, 0};
 		renderPassInfo.renderArea.extent = rveSwapChain->GetSwapChainExtent();
@@ -141,6 +151,7 @@ namespace rve {
 		}
 
 		vkDeviceWaitIdle(rveVulkanDevice.Device());
+		rveVulkanDevice.GetDeletionQueue().Flush();
 		rveSwapChain = nullptr;
 
 		if(rveSwapChain == nullptr) {
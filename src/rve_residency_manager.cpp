@@ -0,0 +1,149 @@
+#include "../include/rve_residency_manager.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace rve {
+	RveResidencyManager::RveResidencyManager(RveJobSystem& jobSystem, VkDeviceSize budget) :
+		jobSystem{jobSystem}, budgetBytes{budget} {}
+
+	RveResidencyManager::~RveResidencyManager() {
+		// Jobs write into the loads and read the caches, both owned by the entries
+		for(Entry& entry : entries) {
+			if(entry.load != nullptr) {
+				jobSystem.Wait(entry.load->counter);
+			}
+		}
+	}
+
+	void RveResidencyManager::Register(RveModel& model, std::shared_ptr<RveMeshCache> cache, uint32_t mesh) {
+		assert(model.IsStreamed() && "(rve_residency_manager.cpp) Only streamed models can be registered");
+		assert(mesh < cache->GetMeshCount() && "(rve_residency_manager.cpp) Mesh index out of range");
+		Entry entry{};
+		entry.bytes = model.GetMeshBytes();
+		if(model.IsResident()) {
+			residentBytes += entry.bytes;
+		}
+		entry.model = &model;
+		entry.cache = std::move(cache);
+		entry.mesh = mesh;
+		entries.push_back(std::move(entry));
+	}
+
+	void RveResidencyManager::Unregister(RveModel& model) {
+		auto found = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.model == &model; });
+		assert(found != entries.end() && "(rve_residency_manager.cpp) Model is not registered");
+		if(found->load != nullptr) {
+			jobSystem.Wait(found->load->counter);
+		}
+		if(model.IsResident()) {
+			residentBytes -= found->bytes;
+		}
+		std::swap(*found, entries.back());
+		entries.pop_back();
+	}
+
+	bool RveResidencyManager::IsEvictable(const Entry& entry) const {
+		return entry.model->IsResident() && frame - entry.lastDrawnFrame >= evictionGraceFrames;
+	}
+
+	bool RveResidencyManager::MakeRoom(VkDeviceSize bytes) {
+		while(residentBytes + bytes > budgetBytes) {
+			Entry *victim = nullptr;
+			for(Entry& entry : entries) {
+				if(IsEvictable(entry) && (victim == nullptr || entry.lastDrawnFrame < victim->lastDrawnFrame)) {
+					victim = &entry;
+				}
+			}
+			if(victim == nullptr) {
+				return false;
+			}
+			victim->model->Evict();
+			residentBytes -= victim->bytes;
+			evictions++;
+		}
+		return true;
+	}
+
+	void RveResidencyManager::Update() {
+		frame++;
+
+		uint32_t loadsInFlight = 0;
+		std::vector<Entry*> finished;
+		std::vector<Entry*> requested;
+		for(Entry& entry : entries) {
+			float priority = 0.0f;
+			if(entry.model->TakeDrawRequest(priority)) {
+				entry.lastDrawnFrame = frame;
+				entry.priority = priority;
+			}
+			if(entry.load != nullptr) {
+				loadsInFlight++;
+				if(entry.load->counter.IsDone()) {
+					finished.push_back(&entry);
+				}
+			} else if(!entry.model->IsResident() && entry.lastDrawnFrame == frame && entry.bytes <= budgetBytes) {
+				requested.push_back(&entry);
+			}
+		}
+		auto byPriority = [](const Entry *a, const Entry *b) { return a->priority > b->priority; };
+
+		// A lowered budget is met before anything new comes in
+		MakeRoom(0);
+
+		std::sort(finished.begin(), finished.end(), byPriority);
+		VkDeviceSize frameUploadBytes = 0;
+		for(Entry *entry : finished) {
+			if(frame - entry->lastDrawnFrame >= evictionGraceFrames) {
+				// Out of view since it was requested, not worth the memory now
+				entry->load.reset();
+				loadsInFlight--;
+				continue;
+			}
+			bool fitsFrame = frameUploadBytes == 0 || frameUploadBytes + entry->bytes <= maxUploadBytesPerFrame;
+			if(!fitsFrame || !MakeRoom(entry->bytes)) {
+				continue;
+			}
+			entry->model->MakeResident(entry->load->staged);
+			entry->load.reset();
+			residentBytes += entry->bytes;
+			loadsInFlight--;
+			frameUploadBytes += entry->bytes;
+			uploads++;
+			uploadBytes += entry->bytes;
+		}
+
+		std::sort(requested.begin(), requested.end(), byPriority);
+		for(Entry *entry : requested) {
+			if(loadsInFlight == maxLoadsInFlight) {
+				break;
+			}
+			entry->load = std::make_unique<Load>();
+			Load *load = entry->load.get();
+			const RveModel *model = entry->model;
+			const RveMeshCache *cache = entry->cache.get();
+			uint32_t mesh = entry->mesh;
+			jobSystem.Schedule([load, model, cache, mesh]() {
+				load->staged = model->StageMesh(cache->GetMeshData(mesh));
+			}, &load->counter);
+			loadsInFlight++;
+			loadsStarted++;
+		}
+	}
+
+	RveResidencyManager::Stats RveResidencyManager::GetStats() const {
+		Stats stats{};
+		stats.meshes = static_cast<uint32_t>(entries.size());
+		for(const Entry& entry : entries) {
+			stats.residentMeshes += entry.model->IsResident() ? 1 : 0;
+			stats.loadingMeshes += entry.load != nullptr ? 1 : 0;
+		}
+		stats.loadsStarted = loadsStarted;
+		stats.uploads = uploads;
+		stats.uploadBytes = uploadBytes;
+		stats.evictions = evictions;
+		stats.residentBytes = residentBytes;
+		stats.budgetBytes = budgetBytes;
+		return stats;
+	}
+} // namespace rve
@@ -0,0 +1,60 @@
+#include "../include/rve_sampler_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace rve {
+	RveSamplerCache::~RveSamplerCache() {
+		for(const auto& [info, sampler] : samplers) {
+			rveVulkanDevice.GetDeletionQueue().DestroySampler(sampler);
+		}
+	}
+
+	VkSampler RveSamplerCache::GetSampler(const RveSamplerInfo& info) {
+		requests++;
+		auto cached = samplers.find(info);
+		if(cached != samplers.end()) {
+			return cached->second;
+		}
+
+		float maxAnisotropy = std::min(info.maxAnisotropy, rveVulkanDevice.properties.limits.maxSamplerAnisotropy);
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = info.filter;
+		samplerInfo.minFilter = info.filter;
+		samplerInfo.mipmapMode = info.mipmapMode;
+		samplerInfo.addressModeU = info.addressMode;
+		samplerInfo.addressModeV = info.addressMode;
+		samplerInfo.addressModeW = info.addressMode;
+		samplerInfo.anisotropyEnable = maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+		samplerInfo.maxAnisotropy = std::max(maxAnisotropy, 1.0f);
+		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+		VkSampler sampler;
+		if(vkCreateSampler(rveVulkanDevice.Device(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_sampler_cache.cpp) Failed to create sampler");
+		}
+		samplers.emplace(info, sampler);
+		return sampler;
+	}
+
+	size_t RveSamplerCache::InfoHash::operator()(const RveSamplerInfo& info) const {
+		// FNV-1a over the fields, the float is hashed by its bits
+		uint64_t hash = 14695981039346656037ull;
+		auto combine = [&](uint64_t value) {
+			hash ^= value;
+			hash *= 1099511628211ull;
+		};
+		combine(static_cast<uint64_t>(info.filter));
+		combine(static_cast<uint64_t>(info.mipmapMode));
+		combine(static_cast<uint64_t>(info.addressMode));
+		uint32_t anisotropyBits;
+		std::memcpy(&anisotropyBits, &info.maxAnisotropy, sizeof(anisotropyBits));
+		combine(anisotropyBits);
+		return static_cast<size_t>(hash);
+	}
+} // namespace rve
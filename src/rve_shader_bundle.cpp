@@ -0,0 +1,30 @@
+#include "../include/rve_shader_bundle.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <unordered_set>
+
+namespace rve {
+	static std::mutex preferFileMutex;
+	static std::unordered_set<std::string> preferFilePaths;
+
+	std::span<const uint32_t> RveShaderBundle::Find(const std::string& filePath) {
+		{
+			std::lock_guard<std::mutex> lock{preferFileMutex};
+			if(preferFilePaths.count(filePath) != 0) {
+				return {};
+			}
+		}
+		for(uint32_t i = 0; i < entryCount; i++) {
+			if(std::strcmp(entries[i].path, filePath.c_str()) == 0) {
+				return {words + entries[i].offset, entries[i].wordCount};
+			}
+		}
+		return {};
+	}
+
+	void RveShaderBundle::PreferFile(const std::string& filePath) {
+		std::lock_guard<std::mutex> lock{preferFileMutex};
+		preferFilePaths.insert(filePath);
+	}
+} // namespace rve
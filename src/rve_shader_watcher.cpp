@@ -0,0 +1,164 @@
+#include "../include/rve_shader_watcher.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#ifdef __linux__
+	#include <poll.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+#ifdef RVE_WITH_SHADERC
+	#include <shaderc/shaderc.hpp>
+#endif
+
+namespace rve {
+	static bool IsShaderSource(const std::string& fileName) {
+		for(const char *extension : {".vert", ".frag", ".comp"}) {
+			std::string suffix{extension};
+			if(fileName.size() > suffix.size() && fileName.compare(fileName.size() - suffix.size(), suffix.size(), suffix) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	RveShaderWatcher::RveShaderWatcher(const std::string& sourceDirectory, const std::string& outputDirectory) :
+		sourceDirectory{sourceDirectory}, outputDirectory{outputDirectory} {
+			#ifdef __linux__
+				inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+				if(inotifyDescriptor < 0) {
+					std::cerr << "(rve_shader_watcher.cpp) inotify unavailable, shader hot reload disabled" << std::endl;
+					return;
+				}
+				// Editors either rewrite the file in place or rename a temporary over it
+				watchDescriptor = inotify_add_watch(inotifyDescriptor, sourceDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+				if(watchDescriptor < 0) {
+					std::cerr << "(rve_shader_watcher.cpp) Cannot watch " << sourceDirectory << ", shader hot reload disabled" << std::endl;
+					return;
+				}
+				watchThread = std::thread(&RveShaderWatcher::WatchLoop, this);
+			#else
+				std::cerr << "(rve_shader_watcher.cpp) Shader hot reload requires inotify" << std::endl;
+			#endif
+	}
+
+	RveShaderWatcher::~RveShaderWatcher() {
+		stopping = true;
+		if(watchThread.joinable()) {
+			watchThread.join();
+		}
+		#ifdef __linux__
+			if(inotifyDescriptor >= 0) {
+				close(inotifyDescriptor);
+			}
+		#endif
+	}
+
+	std::vector<std::string> RveShaderWatcher::TakeCompiledShaders() {
+		std::lock_guard<std::mutex> lock{compiledMutex};
+		std::vector<std::string> shaders;
+		shaders.swap(compiledShaders);
+		return shaders;
+	}
+
+	void RveShaderWatcher::WatchLoop() {
+		#ifdef __linux__
+			alignas(inotify_event) char buffer[4096];
+			while(!stopping) {
+				pollfd pollDescriptor{inotifyDescriptor, POLLIN, 0};
+				if(poll(&pollDescriptor, 1, pollTimeoutMs) <= 0) {
+					continue;
+				}
+				// A single save can raise several events, each file is compiled once per batch
+				std::set<std::string> changed;
+				ssize_t length;
+				while((length = read(inotifyDescriptor, buffer, sizeof(buffer))) > 0) {
+					for(char *cursor = buffer; cursor < buffer + length;) {
+						auto *event = reinterpret_cast<inotify_event*>(cursor);
+						if(event->len > 0 && IsShaderSource(event->name)) {
+							changed.insert(event->name);
+						}
+						cursor += sizeof(inotify_event) + event->len;
+					}
+				}
+				for(const auto& fileName : changed) {
+					CompileShader(fileName);
+				}
+			}
+		#endif
+	}
+
+	void RveShaderWatcher::CompileShader(const std::string& fileName) {
+		const std::string sourcePath = sourceDirectory + fileName;
+		const std::string outputPath = outputDirectory + fileName + ".spv";
+
+		#ifdef RVE_WITH_SHADERC
+			std::ifstream sourceStream{sourcePath};
+			if(!sourceStream.is_open()) {
+				std::cerr << "(rve_shader_watcher.cpp) Failed to open shader: " << sourcePath << std::endl;
+				return;
+			}
+			std::stringstream source;
+			source << sourceStream.rdbuf();
+
+			shaderc_shader_kind kind = shaderc_glsl_infer_from_source;
+			if(fileName.ends_with(".vert")) {
+				kind = shaderc_glsl_vertex_shader;
+			} else if(fileName.ends_with(".frag")) {
+				kind = shaderc_glsl_fragment_shader;
+			} else if(fileName.ends_with(".comp")) {
+				kind = shaderc_glsl_compute_shader;
+			}
+
+			shaderc::Compiler compiler;
+			shaderc::CompileOptions options;
+			options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_1);
+			auto result = compiler.CompileGlslToSpv(source.str(), kind, fileName.c_str(), options);
+			if(result.GetCompilationStatus() != shaderc_compilation_status_success) {
+				std::cerr << "Shader compile failed, keeping previous version:\n" << result.GetErrorMessage() << std::endl;
+				return;
+			}
+			if(!WriteSpirv(outputPath, {result.cbegin(), result.cend()})) {
+				return;
+			}
+		#else
+			const std::string temporaryPath = outputPath + ".tmp";
+			const std::string command = "glslc --target-env=vulkan1.1 \"" + sourcePath + "\" -o \"" + temporaryPath + "\"";
+			if(std::system(command.c_str()) != 0) {
+				std::cerr << "Shader compile failed, keeping previous version: " << sourcePath << std::endl;
+				std::remove(temporaryPath.c_str());
+				return;
+			}
+			if(std::rename(temporaryPath.c_str(), outputPath.c_str()) != 0) {
+				std::cerr << "(rve_shader_watcher.cpp) Failed to replace " << outputPath << std::endl;
+				return;
+			}
+		#endif
+
+		std::lock_guard<std::mutex> lock{compiledMutex};
+		compiledShaders.push_back(outputPath);
+	}
+
+	bool RveShaderWatcher::WriteSpirv(const std::string& filePath, const std::vector<uint32_t>& spirv) {
+		const std::string temporaryPath = filePath + ".tmp";
+		{
+			std::ofstream output{temporaryPath, std::ios::binary | std::ios::trunc};
+			if(!output.is_open()) {
+				std::cerr << "(rve_shader_watcher.cpp) Failed to write " << temporaryPath << std::endl;
+				return false;
+			}
+			output.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+		}
+		if(std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+			std::cerr << "(rve_shader_watcher.cpp) Failed to replace " << filePath << std::endl;
+			return false;
+		}
+		return true;
+	}
+} // namespace rve
@@ -0,0 +1,139 @@
+#include "../include/rve_simulation.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+
+namespace rve {
+	RveSimulation::RveSimulation() {
+		simulationThread = std::thread(&RveSimulation::SimulationLoop, this);
+	}
+
+	RveSimulation::~RveSimulation() {
+		stopping = true;
+		simulationThread.join();
+	}
+
+	void RveSimulation::AddBody(RveEntity entity, const TransformComponent& transform, glm::vec3 angularVelocity) {
+		std::lock_guard<std::mutex> lock{pendingMutex};
+		pendingBodies.push_back({{entity, RveTransformHierarchy::noNode}, transform, angularVelocity});
+	}
+
+	void RveSimulation::AddBody(RveTransformHierarchy::Node node, const TransformComponent& transform, glm::vec3 angularVelocity) {
+		std::lock_guard<std::mutex> lock{pendingMutex};
+		pendingBodies.push_back({{RveEntity{}, node}, transform, angularVelocity});
+	}
+
+	void RveSimulation::RemoveBody(RveEntity entity) {
+		std::lock_guard<std::mutex> lock{pendingMutex};
+		pendingRemovals.push_back(entity);
+	}
+
+	void RveSimulation::SimulationLoop() {
+		const auto timestep = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>{fixedTimestep});
+		auto nextTick = Clock::now();
+		while(!stopping) {
+			ApplyPendingChanges();
+			Step();
+			Publish();
+			tickCount.fetch_add(1, std::memory_order_relaxed);
+
+			nextTick += timestep;
+			auto now = Clock::now();
+			if(now > nextTick + timestep * maxCatchUpTicks) {
+				nextTick = now;
+			}
+			std::this_thread::sleep_until(nextTick);
+		}
+	}
+
+	void RveSimulation::ApplyPendingChanges() {
+		std::lock_guard<std::mutex> lock{pendingMutex};
+		for(const Body& body : pendingBodies) {
+			targets.push_back(body.target);
+			previous.push_back(body.transform);
+			current.push_back(body.transform);
+			angularVelocities.push_back(body.angularVelocity);
+		}
+		pendingBodies.clear();
+		for(RveEntity entity : pendingRemovals) {
+			for(size_t body = 0; body < targets.size(); body++) {
+				if(targets[body].node == RveTransformHierarchy::noNode && targets[body].entity == entity) {
+					targets[body] = targets.back();
+					previous[body] = previous.back();
+					current[body] = current.back();
+					angularVelocities[body] = angularVelocities.back();
+					targets.pop_back();
+					previous.pop_back();
+					current.pop_back();
+					angularVelocities.pop_back();
+					break;
+				}
+			}
+		}
+		pendingRemovals.clear();
+	}
+
+	void RveSimulation::Step() {
+		previous = current;
+		for(size_t body = 0; body < current.size(); body++) {
+			glm::vec3& rotation = current[body].rotation;
+			rotation += angularVelocities[body] * fixedTimestep;
+			// Both ticks are wrapped together so interpolating between them never crosses the seam
+			for(int axis = 0; axis < 3; axis++) {
+				if(rotation[axis] > glm::two_pi<float>()) {
+					rotation[axis] -= glm::two_pi<float>();
+					previous[body].rotation[axis] -= glm::two_pi<float>();
+				} else if(rotation[axis] < -glm::two_pi<float>()) {
+					rotation[axis] += glm::two_pi<float>();
+					previous[body].rotation[axis] += glm::two_pi<float>();
+				}
+			}
+		}
+	}
+
+	void RveSimulation::Publish() {
+		Snapshot& snapshot = snapshots[back];
+		snapshot.targets = targets;
+		snapshot.previous = previous;
+		snapshot.current = current;
+		snapshot.publishTime = Clock::now();
+		snapshot.tick = tickCount.load(std::memory_order_relaxed) + 1;
+		back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+	}
+
+	const RveSimulation::Snapshot& RveSimulation::AcquireSnapshot() {
+		if(middle.load(std::memory_order_acquire) & freshBit) {
+			front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+		}
+		return snapshots[front];
+	}
+
+	void RveSimulation::Interpolate(RveWorld& world, RveTransformHierarchy& hierarchy) {
+		const Snapshot& snapshot = AcquireSnapshot();
+		if(snapshot.tick == 0) {
+			return;
+		}
+		// Blends from the previous tick at publish time to the current one a timestep later, staying one tick
+		// behind so there is always a newer tick to blend towards
+		float alpha = std::chrono::duration<float>(Clock::now() - snapshot.publishTime).count() / fixedTimestep;
+		alpha = std::clamp(alpha, 0.0f, 1.0f);
+		for(size_t body = 0; body < snapshot.targets.size(); body++) {
+			const TransformComponent& from = snapshot.previous[body];
+			const TransformComponent& to = snapshot.current[body];
+			TransformComponent blended{};
+			blended.translation = glm::mix(from.translation, to.translation, alpha);
+			blended.scale = glm::mix(from.scale, to.scale, alpha);
+			blended.rotation = glm::mix(from.rotation, to.rotation, alpha);
+
+			const Target& target = snapshot.targets[body];
+			if(target.node != RveTransformHierarchy::noNode) {
+				if(hierarchy.IsValid(target.node)) {
+					hierarchy.SetLocal(target.node, blended);
+				}
+			} else if(TransformComponent *transform = world.GetComponent<TransformComponent>(target.entity)) {
+				*transform = blended;
+			}
+		}
+	}
+} // namespace rve
@@ -0,0 +1,361 @@
+#include "../include/rve_texture.hpp"
+#include "../include/rve_block_decoder.hpp"
+#include "../include/rve_buffer.hpp"
+#include "../include/rve_mapped_file.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace rve {
+	namespace {
+		constexpr uint8_t ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+		constexpr size_t ktx2HeaderSize = 80;
+		constexpr size_t ktx2LevelIndexEntrySize = 24;
+
+		uint32_t ReadUint32(const char *data) {
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		uint64_t ReadUint64(const char *data) {
+			uint64_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		size_t AlignLevel(size_t offset) {
+			return (offset + RveTexture::levelAlignment - 1) / RveTexture::levelAlignment * RveTexture::levelAlignment;
+		}
+
+		uint32_t GetTexelSize(VkFormat format) {
+			switch(format) {
+				case VK_FORMAT_R8_UNORM:
+					return 1;
+				case VK_FORMAT_R8G8_UNORM:
+					return 2;
+				case VK_FORMAT_R8G8B8A8_UNORM:
+				case VK_FORMAT_R8G8B8A8_SRGB:
+				case VK_FORMAT_B8G8R8A8_UNORM:
+				case VK_FORMAT_B8G8R8A8_SRGB:
+					return 4;
+				default:
+					return 0;
+			}
+		}
+
+		VkImageMemoryBarrier LevelBarrier(
+			VkImage image,
+			uint32_t baseLevel,
+			uint32_t levelCount,
+			VkImageLayout oldLayout,
+			VkImageLayout newLayout,
+			VkAccessFlags srcAccess,
+			VkAccessFlags dstAccess) {
+				VkImageMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				barrier.srcAccessMask = srcAccess;
+				barrier.dstAccessMask = dstAccess;
+				barrier.oldLayout = oldLayout;
+				barrier.newLayout = newLayout;
+				barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+				barrier.image = image;
+				barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				barrier.subresourceRange.baseMipLevel = baseLevel;
+				barrier.subresourceRange.levelCount = levelCount;
+				barrier.subresourceRange.baseArrayLayer = 0;
+				barrier.subresourceRange.layerCount = 1;
+				return barrier;
+		}
+	} // namespace
+
+	RveTexture::RveTexture(RveVulkanDevice& device, const ImageData& source, bool generateMips) : rveVulkanDevice{device} {
+		auto startTime = std::chrono::steady_clock::now();
+		assert(!source.levels.empty() && source.width > 0 && source.height > 0 && "(rve_texture.cpp) Image has no pixels");
+		uploadReport.sourceFormat = source.format;
+
+		const ImageData *data = &source;
+		ImageData decompressed{};
+		if(RveBlockDecoder::IsSupported(source.format) && !HasFormatFeatures(source.format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+			decompressed = Decompress(source);
+			data = &decompressed;
+			uploadReport.decompressed = true;
+		}
+		if(!HasFormatFeatures(data->format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)) {
+			throw std::runtime_error("(rve_texture.cpp) Texture format cannot be sampled on this device");
+		}
+		format = data->format;
+		width = data->width;
+		height = data->height;
+		const uint32_t givenLevels = static_cast<uint32_t>(data->levels.size());
+		mipLevels = givenLevels;
+		// Compressed formats cannot be blitted to, they only get the levels they came with
+		bool blitMips = generateMips && givenLevels == 1 && !IsBlockCompressed(format) && HasFormatFeatures(
+			format,
+			VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+		if(blitMips) {
+			uint32_t size = std::max(width, height);
+			while(size >> mipLevels != 0) {
+				mipLevels++;
+			}
+		}
+		uploadReport.generatedMips = mipLevels > givenLevels;
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = format;
+		imageInfo.extent = {width, height, 1};
+		imageInfo.mipLevels = mipLevels;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+			(uploadReport.generatedMips ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		rveVulkanDevice.CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(rveVulkanDevice.Device(), image, &memoryRequirements);
+		uploadReport.memoryBytes = memoryRequirements.size;
+
+		RveBuffer stagingBuffer{
+			rveVulkanDevice,
+			data->bytes.size(),
+			1,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+		};
+		if(stagingBuffer.Map() != VK_SUCCESS) {
+			throw std::runtime_error("(rve_texture.cpp) Failed to map texture staging buffer");
+		}
+		stagingBuffer.WriteToBuffer(data->bytes.data());
+		uploadReport.uploadBytes = data->bytes.size();
+
+		std::vector<VkBufferImageCopy> regions(givenLevels);
+		for(uint32_t level = 0; level < givenLevels; level++) {
+			VkBufferImageCopy& region = regions[level];
+			region.bufferOffset = data->levels[level].offset;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1};
+		}
+
+		VkCommandBuffer commandBuffer = rveVulkanDevice.BeginSingleTimeCommands();
+		VkImageMemoryBarrier toTransfer = LevelBarrier(
+			image, 0, mipLevels,
+			VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+		vkCmdCopyBufferToImage(
+			commandBuffer,
+			stagingBuffer.GetBuffer(),
+			image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			static_cast<uint32_t>(regions.size()),
+			regions.data());
+		if(uploadReport.generatedMips) {
+			RecordMipGeneration(commandBuffer);
+		} else {
+			VkImageMemoryBarrier toShader = LevelBarrier(
+				image, 0, mipLevels,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+		}
+		rveVulkanDevice.EndSingleTimeCommands(commandBuffer);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = format;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel = 0;
+		viewInfo.subresourceRange.levelCount = mipLevels;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount = 1;
+		if(vkCreateImageView(rveVulkanDevice.Device(), &viewInfo, nullptr, &imageView) != VK_SUCCESS) {
+			throw std::runtime_error("(rve_texture.cpp) Failed to create texture image view");
+		}
+		uploadReport.uploadMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	RveTexture::~RveTexture() {
+		RveDeletionQueue& deletionQueue = rveVulkanDevice.GetDeletionQueue();
+		deletionQueue.DestroyImageView(imageView);
+		deletionQueue.DestroyImage(image);
+		deletionQueue.FreeMemory(imageMemory);
+	}
+
+	VkDescriptorImageInfo RveTexture::DescriptorInfo(VkSampler sampler) const {
+		return {sampler, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+	}
+
+	bool RveTexture::HasFormatFeatures(VkFormat candidate, VkFormatFeatureFlags features) const {
+		VkFormatProperties properties;
+		vkGetPhysicalDeviceFormatProperties(rveVulkanDevice.PhysicalDevice(), candidate, &properties);
+		return (properties.optimalTilingFeatures & features) == features;
+	}
+
+	void RveTexture::RecordMipGeneration(VkCommandBuffer commandBuffer) {
+		// Each level is read once it has been written, then handed to the shaders
+		int32_t levelWidth = static_cast<int32_t>(width);
+		int32_t levelHeight = static_cast<int32_t>(height);
+		for(uint32_t level = 1; level < mipLevels; level++) {
+			VkImageMemoryBarrier toSource = LevelBarrier(
+				image, level - 1, 1,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toSource);
+
+			int32_t nextWidth = std::max(levelWidth / 2, 1);
+			int32_t nextHeight = std::max(levelHeight / 2, 1);
+			VkImageBlit blit{};
+			blit.srcOffsets[1] = {levelWidth, levelHeight, 1};
+			blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+			blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+			blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+			vkCmdBlitImage(
+				commandBuffer,
+				image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				1, &blit,
+				VK_FILTER_LINEAR);
+
+			VkImageMemoryBarrier toShader = LevelBarrier(
+				image, level - 1, 1,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1, &toShader);
+			levelWidth = nextWidth;
+			levelHeight = nextHeight;
+		}
+		VkImageMemoryBarrier lastToShader = LevelBarrier(
+			image, mipLevels - 1, 1,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0, nullptr, 1, &lastToShader);
+	}
+
+	RveTexture::ImageData RveTexture::LoadKtx2(const std::string& filePath) {
+		RveMappedFile file{filePath};
+		const char *data = file.GetData();
+		const size_t size = file.GetSize();
+		if(size < ktx2HeaderSize || std::memcmp(data, ktx2Identifier, sizeof(ktx2Identifier)) != 0) {
+			throw std::runtime_error("(rve_texture.cpp) Not a KTX2 file: " + filePath);
+		}
+		ImageData image{};
+		image.format = static_cast<VkFormat>(ReadUint32(data + 12));
+		image.width = ReadUint32(data + 20);
+		image.height = ReadUint32(data + 24);
+		uint32_t depth = ReadUint32(data + 28);
+		uint32_t layerCount = ReadUint32(data + 32);
+		uint32_t faceCount = ReadUint32(data + 36);
+		// Zero levels asks the loader to generate the mip chain
+		uint32_t levelCount = std::max(ReadUint32(data + 40), 1u);
+		uint32_t supercompression = ReadUint32(data + 44);
+		if(supercompression != 0 || image.format == VK_FORMAT_UNDEFINED) {
+			throw std::runtime_error("(rve_texture.cpp) Supercompressed KTX2 files are not supported: " + filePath);
+		}
+		if(image.width == 0 || image.height == 0 || depth > 1 || layerCount > 1 || faceCount != 1) {
+			throw std::runtime_error("(rve_texture.cpp) Only 2D KTX2 textures are supported: " + filePath);
+		}
+		if(GetLevelSize(image.format, image.width, image.height) == 0) {
+			throw std::runtime_error("(rve_texture.cpp) Unsupported KTX2 texture format: " + filePath);
+		}
+		if(levelCount > 32 || ktx2HeaderSize + levelCount * ktx2LevelIndexEntrySize > size) {
+			throw std::runtime_error("(rve_texture.cpp) Truncated KTX2 level index: " + filePath);
+		}
+
+		size_t totalSize = 0;
+		for(uint32_t level = 0; level < levelCount; level++) {
+			totalSize = AlignLevel(totalSize) + GetLevelSize(image.format, std::max(image.width >> level, 1u), std::max(image.height >> level, 1u));
+		}
+		image.bytes.resize(totalSize);
+		size_t offset = 0;
+		for(uint32_t level = 0; level < levelCount; level++) {
+			const char *entry = data + ktx2HeaderSize + level * ktx2LevelIndexEntrySize;
+			uint64_t byteOffset = ReadUint64(entry);
+			uint64_t byteLength = ReadUint64(entry + 8);
+			size_t levelSize = GetLevelSize(image.format, std::max(image.width >> level, 1u), std::max(image.height >> level, 1u));
+			if(byteLength != levelSize || byteOffset > size || byteLength > size - byteOffset) {
+				throw std::runtime_error("(rve_texture.cpp) Malformed KTX2 level: " + filePath);
+			}
+			offset = AlignLevel(offset);
+			std::memcpy(image.bytes.data() + offset, data + byteOffset, levelSize);
+			image.levels.push_back({offset, levelSize});
+			offset += levelSize;
+		}
+		return image;
+	}
+
+	RveTexture::ImageData RveTexture::FromPixels(uint32_t width, uint32_t height, const uint8_t *pixels, bool srgb) {
+		ImageData image{};
+		image.format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		image.width = width;
+		image.height = height;
+		image.bytes.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+		image.levels.push_back({0, image.bytes.size()});
+		return image;
+	}
+
+	RveTexture::ImageData RveTexture::Decompress(const ImageData& source) {
+		assert(RveBlockDecoder::IsSupported(source.format) && "(rve_texture.cpp) No decoder for the image format");
+		ImageData image{};
+		image.format = RveBlockDecoder::IsSrgb(source.format) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		image.width = source.width;
+		image.height = source.height;
+		size_t totalSize = 0;
+		for(uint32_t level = 0; level < source.levels.size(); level++) {
+			totalSize = AlignLevel(totalSize) + GetLevelSize(image.format, std::max(source.width >> level, 1u), std::max(source.height >> level, 1u));
+		}
+		image.bytes.resize(totalSize);
+
+		const uint32_t blockSize = RveBlockDecoder::GetBlockSize(source.format);
+		size_t offset = 0;
+		uint8_t pixels[64];
+		for(uint32_t level = 0; level < source.levels.size(); level++) {
+			uint32_t levelWidth = std::max(source.width >> level, 1u);
+			uint32_t levelHeight = std::max(source.height >> level, 1u);
+			uint32_t blocksWide = (levelWidth + 3) / 4;
+			uint32_t blocksHigh = (levelHeight + 3) / 4;
+			offset = AlignLevel(offset);
+			const uint8_t *blocks = source.bytes.data() + source.levels[level].offset;
+			uint8_t *output = image.bytes.data() + offset;
+			for(uint32_t blockY = 0; blockY < blocksHigh; blockY++) {
+				for(uint32_t blockX = 0; blockX < blocksWide; blockX++) {
+					RveBlockDecoder::DecodeBlock(source.format, blocks + (blockY * blocksWide + blockX) * blockSize, pixels);
+					// Blocks overhanging the edge of small levels are clipped
+					uint32_t rows = std::min(4u, levelHeight - blockY * 4);
+					uint32_t columns = std::min(4u, levelWidth - blockX * 4);
+					for(uint32_t row = 0; row < rows; row++) {
+						size_t pixel = static_cast<size_t>(blockY * 4 + row) * levelWidth + blockX * 4;
+						std::memcpy(output + pixel * 4, pixels + row * 16, columns * 4);
+					}
+				}
+			}
+			size_t levelSize = static_cast<size_t>(levelWidth) * levelHeight * 4;
+			image.levels.push_back({offset, levelSize});
+			offset += levelSize;
+		}
+		return image;
+	}
+
+	bool RveTexture::IsBlockCompressed(VkFormat format) {
+		return format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK;
+	}
+
+	size_t RveTexture::GetLevelSize(VkFormat format, uint32_t width, uint32_t height) {
+		if(uint32_t blockSize = RveBlockDecoder::GetBlockSize(format)) {
+			return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+		}
+		return static_cast<size_t>(width) * height * GetTexelSize(format);
+	}
+} // namespace rve
@@ -0,0 +1,182 @@
+#include "../include/rve_transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace rve {
+	RveTransformHierarchy::Node RveTransformHierarchy::AddNode(const TransformComponent& local, Node parent) {
+		assert((parent == noNode || IsValid(parent)) && "(rve_transform_hierarchy.cpp) Invalid parent node");
+		Node node;
+		if(!freeNodes.empty()) {
+			node = freeNodes.back();
+			freeNodes.pop_back();
+		} else {
+			node = static_cast<Node>(positions.size());
+			positions.push_back(noNode);
+			parents.push_back(noNode);
+			firstChildren.push_back(noNode);
+			nextSiblings.push_back(noNode);
+		}
+		// Appended for now, RebuildOrder moves it into its level on the next Update
+		positions[node] = static_cast<uint32_t>(locals.size());
+		parentPositions.push_back(noNode);
+		locals.push_back(local);
+		worldMatrices.emplace_back(1.0f);
+		dirty.push_back(1);
+		updated.push_back(0);
+
+		firstChildren[node] = noNode;
+		Link(node, parent);
+		orderDirty = true;
+		anyDirty = true;
+		return node;
+	}
+
+	void RveTransformHierarchy::RemoveNode(Node node) {
+		assert(IsValid(node) && "(rve_transform_hierarchy.cpp) Invalid node");
+		Unlink(node);
+		std::vector<Node> subtree{node};
+		while(!subtree.empty()) {
+			Node current = subtree.back();
+			subtree.pop_back();
+			for(Node child = firstChildren[current]; child != noNode; child = nextSiblings[child]) {
+				subtree.push_back(child);
+			}
+			positions[current] = noNode;
+			freeNodes.push_back(current);
+		}
+		orderDirty = true;
+	}
+
+	void RveTransformHierarchy::SetParent(Node node, Node parent) {
+		assert(IsValid(node) && (parent == noNode || IsValid(parent)) && "(rve_transform_hierarchy.cpp) Invalid node");
+		for(Node ancestor = parent; ancestor != noNode; ancestor = parents[ancestor]) {
+			assert(ancestor != node && "(rve_transform_hierarchy.cpp) Node cannot be parented to its own subtree");
+		}
+		Unlink(node);
+		Link(node, parent);
+		dirty[positions[node]] = 1;
+		orderDirty = true;
+		anyDirty = true;
+	}
+
+	void RveTransformHierarchy::SetLocal(Node node, const TransformComponent& local) {
+		assert(IsValid(node) && "(rve_transform_hierarchy.cpp) Invalid node");
+		uint32_t position = positions[node];
+		locals[position] = local;
+		dirty[position] = 1;
+		anyDirty = true;
+	}
+
+	void RveTransformHierarchy::Link(Node node, Node parent) {
+		Node& head = parent == noNode ? firstRoot : firstChildren[parent];
+		parents[node] = parent;
+		nextSiblings[node] = head;
+		head = node;
+	}
+
+	void RveTransformHierarchy::Unlink(Node node) {
+		Node *link = parents[node] == noNode ? &firstRoot : &firstChildren[parents[node]];
+		while(*link != node) {
+			link = &nextSiblings[*link];
+		}
+		*link = nextSiblings[node];
+		nextSiblings[node] = noNode;
+		parents[node] = noNode;
+	}
+
+	void RveTransformHierarchy::RebuildOrder() {
+		std::vector<Node> order;
+		order.reserve(locals.size());
+		levelStarts.clear();
+		for(Node root = firstRoot; root != noNode; root = nextSiblings[root]) {
+			order.push_back(root);
+		}
+		size_t levelBegin = 0;
+		while(levelBegin < order.size()) {
+			levelStarts.push_back(static_cast<uint32_t>(levelBegin));
+			const size_t levelEnd = order.size();
+			for(size_t position = levelBegin; position < levelEnd; position++) {
+				for(Node child = firstChildren[order[position]]; child != noNode; child = nextSiblings[child]) {
+					order.push_back(child);
+				}
+			}
+			levelBegin = levelEnd;
+		}
+		levelStarts.push_back(static_cast<uint32_t>(order.size()));
+
+		std::vector<TransformComponent> orderedLocals(order.size());
+		std::vector<glm::mat4> orderedWorldMatrices(order.size());
+		std::vector<uint8_t> orderedDirty(order.size());
+		for(size_t position = 0; position < order.size(); position++) {
+			uint32_t previous = positions[order[position]];
+			orderedLocals[position] = locals[previous];
+			orderedWorldMatrices[position] = worldMatrices[previous];
+			orderedDirty[position] = dirty[previous];
+		}
+		for(size_t position = 0; position < order.size(); position++) {
+			positions[order[position]] = static_cast<uint32_t>(position);
+		}
+		parentPositions.resize(order.size());
+		for(size_t position = 0; position < order.size(); position++) {
+			Node parent = parents[order[position]];
+			parentPositions[position] = parent == noNode ? noNode : positions[parent];
+		}
+
+		locals.swap(orderedLocals);
+		worldMatrices.swap(orderedWorldMatrices);
+		dirty.swap(orderedDirty);
+		updated.assign(order.size(), 0);
+	}
+
+	uint32_t RveTransformHierarchy::UpdateRange(uint32_t first, uint32_t last) {
+		uint32_t count = 0;
+		for(uint32_t position = first; position < last; position++) {
+			// Parents sit in the previous level, which is complete before this one starts
+			uint32_t parent = parentPositions[position];
+			if(dirty[position] || (parent != noNode && updated[parent])) {
+				glm::mat4 local = locals[position].mat4();
+				worldMatrices[position] = parent == noNode ? local : worldMatrices[parent] * local;
+				dirty[position] = 0;
+				updated[position] = 1;
+				count++;
+			} else {
+				updated[position] = 0;
+			}
+		}
+		return count;
+	}
+
+	void RveTransformHierarchy::Update() {
+		if(orderDirty) {
+			RebuildOrder();
+			orderDirty = false;
+		}
+		stats.nodes = static_cast<uint32_t>(locals.size());
+		stats.levels = levelStarts.empty() ? 0 : static_cast<uint32_t>(levelStarts.size() - 1);
+		stats.nodesUpdated = 0;
+		stats.parallelLevels = 0;
+		if(!anyDirty) {
+			return;
+		}
+
+		for(uint32_t level = 0; level < stats.levels; level++) {
+			const uint32_t first = levelStarts[level];
+			const uint32_t last = levelStarts[level + 1];
+			const uint32_t size = last - first;
+			if(size < parallelLevelSize) {
+				stats.nodesUpdated += UpdateRange(first, last);
+				continue;
+			}
+
+			std::atomic<uint32_t> levelUpdated{0};
+			jobSystem.ParallelFor(size, parallelLevelSize / 4, [&](uint32_t begin, uint32_t end) {
+				levelUpdated.fetch_add(UpdateRange(first + begin, first + end), std::memory_order_relaxed);
+			});
+			stats.nodesUpdated += levelUpdated.load(std::memory_order_relaxed);
+			stats.parallelLevels++;
+		}
+		anyDirty = false;
+	}
+} // namespace rve
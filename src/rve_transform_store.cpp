@@ -0,0 +1,266 @@
+#include "../include/rve_transform_store.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define RVE_TRANSFORM_AVX2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define RVE_TRANSFORM_NEON
+#endif
+
+namespace rve {
+	// Entries of TransformComponent::mat4() that depend on rotation and scale, column major
+	struct RveMatrixTerms {
+		float m00, m01, m02;
+		float m10, m11, m12;
+		float m20, m21, m22;
+	};
+
+	static void StoreMatrix(const RveMatrixTerms& terms, float tx, float ty, float tz, glm::mat4& out) {
+		out = glm::mat4{
+			{terms.m00, terms.m01, terms.m02, 0.0f},
+			{terms.m10, terms.m11, terms.m12, 0.0f},
+			{terms.m20, terms.m21, terms.m22, 0.0f},
+			{tx, ty, tz, 1.0f}
+		};
+	}
+
+	static void BuildMatrixScalar(const float *const *components, uint32_t index, glm::mat4& out) {
+		const float c3 = std::cos(components[5][index]);
+		const float s3 = std::sin(components[5][index]);
+		const float c2 = std::cos(components[3][index]);
+		const float s2 = std::sin(components[3][index]);
+		const float c1 = std::cos(components[4][index]);
+		const float s1 = std::sin(components[4][index]);
+		const float sx = components[6][index];
+		const float sy = components[7][index];
+		const float sz = components[8][index];
+		RveMatrixTerms terms{
+			sx * (c1 * c3 + s1 * s2 * s3), sx * (c2 * s3), sx * (c1 * s2 * s3 - c3 * s1),
+			sy * (c3 * s1 * s2 - c1 * s3), sy * (c2 * c3), sy * (c1 * c3 * s2 + s1 * s3),
+			sz * (c2 * s1), sz * (-s2), sz * (c1 * c2)
+		};
+		StoreMatrix(terms, components[0][index], components[1][index], components[2][index], out);
+	}
+
+	// Cephes style sincos: reduce to [-pi/4, pi/4] around the nearest multiple of pi/2, evaluate
+	// both polynomials and pick or negate them by quadrant. Absolute error stays below 1e-6 for
+	// the angle range TransformComponent uses.
+	static constexpr float sinCosPiOver2Hi = 1.5707963705062866f;
+	static constexpr float sinCosPiOver2Lo = -4.37113900018624283e-8f;
+	static constexpr float sinCoeff0 = -1.6666654611e-1f;
+	static constexpr float sinCoeff1 = 8.3321608736e-3f;
+	static constexpr float sinCoeff2 = -1.9515295891e-4f;
+	static constexpr float cosCoeff0 = 4.166664568298827e-2f;
+	static constexpr float cosCoeff1 = -1.388731625493765e-3f;
+	static constexpr float cosCoeff2 = 2.443315711809948e-5f;
+
+#ifdef RVE_TRANSFORM_AVX2
+	__attribute__((target("avx2,fma")))
+	static inline void SinCosAvx2(__m256 x, __m256& sinOut, __m256& cosOut) {
+		__m256 q = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(0.63661977236f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m256 r = _mm256_fnmadd_ps(q, _mm256_set1_ps(sinCosPiOver2Hi), x);
+		r = _mm256_fnmadd_ps(q, _mm256_set1_ps(sinCosPiOver2Lo), r);
+		__m256 r2 = _mm256_mul_ps(r, r);
+
+		__m256 sinPoly = _mm256_fmadd_ps(r2, _mm256_set1_ps(sinCoeff2), _mm256_set1_ps(sinCoeff1));
+		sinPoly = _mm256_fmadd_ps(r2, sinPoly, _mm256_set1_ps(sinCoeff0));
+		__m256 sinR = _mm256_fmadd_ps(_mm256_mul_ps(r, r2), sinPoly, r);
+
+		__m256 cosPoly = _mm256_fmadd_ps(r2, _mm256_set1_ps(cosCoeff2), _mm256_set1_ps(cosCoeff1));
+		cosPoly = _mm256_fmadd_ps(r2, cosPoly, _mm256_set1_ps(cosCoeff0));
+		__m256 cosR = _mm256_fmadd_ps(_mm256_mul_ps(r2, r2), cosPoly, _mm256_fnmadd_ps(r2, _mm256_set1_ps(0.5f), _mm256_set1_ps(1.0f)));
+
+		__m256i quadrant = _mm256_cvtps_epi32(q);
+		__m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(
+			_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+		__m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+		__m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(
+			_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+		sinOut = _mm256_xor_ps(_mm256_blendv_ps(sinR, cosR, swap), sinSign);
+		cosOut = _mm256_xor_ps(_mm256_blendv_ps(cosR, sinR, swap), cosSign);
+	}
+
+	__attribute__((target("avx2,fma")))
+	static void BuildBatchAvx2(const float *const *components, uint32_t first, uint32_t laneCount, glm::mat4 *out) {
+		__m256 s1, c1, s2, c2, s3, c3;
+		SinCosAvx2(_mm256_loadu_ps(components[4] + first), s1, c1);
+		SinCosAvx2(_mm256_loadu_ps(components[3] + first), s2, c2);
+		SinCosAvx2(_mm256_loadu_ps(components[5] + first), s3, c3);
+		__m256 sx = _mm256_loadu_ps(components[6] + first);
+		__m256 sy = _mm256_loadu_ps(components[7] + first);
+		__m256 sz = _mm256_loadu_ps(components[8] + first);
+		__m256 s2s3 = _mm256_mul_ps(s2, s3);
+		__m256 c1s2 = _mm256_mul_ps(c1, s2);
+
+		alignas(32) float terms[9][8];
+		_mm256_store_ps(terms[0], _mm256_mul_ps(sx, _mm256_fmadd_ps(s1, s2s3, _mm256_mul_ps(c1, c3))));
+		_mm256_store_ps(terms[1], _mm256_mul_ps(sx, _mm256_mul_ps(c2, s3)));
+		_mm256_store_ps(terms[2], _mm256_mul_ps(sx, _mm256_fmsub_ps(c1, s2s3, _mm256_mul_ps(c3, s1))));
+		_mm256_store_ps(terms[3], _mm256_mul_ps(sy, _mm256_fmsub_ps(_mm256_mul_ps(c3, s1), s2, _mm256_mul_ps(c1, s3))));
+		_mm256_store_ps(terms[4], _mm256_mul_ps(sy, _mm256_mul_ps(c2, c3)));
+		_mm256_store_ps(terms[5], _mm256_mul_ps(sy, _mm256_fmadd_ps(c1s2, c3, _mm256_mul_ps(s1, s3))));
+		_mm256_store_ps(terms[6], _mm256_mul_ps(sz, _mm256_mul_ps(c2, s1)));
+		_mm256_store_ps(terms[7], _mm256_mul_ps(sz, _mm256_sub_ps(_mm256_setzero_ps(), s2)));
+		_mm256_store_ps(terms[8], _mm256_mul_ps(sz, _mm256_mul_ps(c1, c2)));
+
+		for(uint32_t lane = 0; lane < laneCount; lane++) {
+			RveMatrixTerms laneTerms{
+				terms[0][lane], terms[1][lane], terms[2][lane],
+				terms[3][lane], terms[4][lane], terms[5][lane],
+				terms[6][lane], terms[7][lane], terms[8][lane]
+			};
+			uint32_t index = first + lane;
+			StoreMatrix(laneTerms, components[0][index], components[1][index], components[2][index], out[index]);
+		}
+	}
+#endif
+
+#ifdef RVE_TRANSFORM_NEON
+	static inline void SinCosNeon(float32x4_t x, float32x4_t& sinOut, float32x4_t& cosOut) {
+		float32x4_t q = vrndnq_f32(vmulq_n_f32(x, 0.63661977236f));
+		float32x4_t r = vfmsq_f32(x, q, vdupq_n_f32(sinCosPiOver2Hi));
+		r = vfmsq_f32(r, q, vdupq_n_f32(sinCosPiOver2Lo));
+		float32x4_t r2 = vmulq_f32(r, r);
+
+		float32x4_t sinPoly = vfmaq_f32(vdupq_n_f32(sinCoeff1), r2, vdupq_n_f32(sinCoeff2));
+		sinPoly = vfmaq_f32(vdupq_n_f32(sinCoeff0), r2, sinPoly);
+		float32x4_t sinR = vfmaq_f32(r, vmulq_f32(r, r2), sinPoly);
+
+		float32x4_t cosPoly = vfmaq_f32(vdupq_n_f32(cosCoeff1), r2, vdupq_n_f32(cosCoeff2));
+		cosPoly = vfmaq_f32(vdupq_n_f32(cosCoeff0), r2, cosPoly);
+		float32x4_t cosR = vfmaq_f32(vfmsq_f32(vdupq_n_f32(1.0f), r2, vdupq_n_f32(0.5f)), vmulq_f32(r2, r2), cosPoly);
+
+		int32x4_t quadrant = vcvtq_s32_f32(q);
+		uint32x4_t swap = vceqq_s32(vandq_s32(quadrant, vdupq_n_s32(1)), vdupq_n_s32(1));
+		uint32x4_t sinSign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(quadrant, vdupq_n_s32(2)), 30));
+		uint32x4_t cosSign = vreinterpretq_u32_s32(vshlq_n_s32(vandq_s32(vaddq_s32(quadrant, vdupq_n_s32(1)), vdupq_n_s32(2)), 30));
+		sinOut = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, cosR, sinR)), sinSign));
+		cosOut = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, sinR, cosR)), cosSign));
+	}
+
+	static void BuildBatchNeon(const float *const *components, uint32_t first, uint32_t laneCount, glm::mat4 *out) {
+		float32x4_t s1, c1, s2, c2, s3, c3;
+		SinCosNeon(vld1q_f32(components[4] + first), s1, c1);
+		SinCosNeon(vld1q_f32(components[3] + first), s2, c2);
+		SinCosNeon(vld1q_f32(components[5] + first), s3, c3);
+		float32x4_t sx = vld1q_f32(components[6] + first);
+		float32x4_t sy = vld1q_f32(components[7] + first);
+		float32x4_t sz = vld1q_f32(components[8] + first);
+		float32x4_t s2s3 = vmulq_f32(s2, s3);
+		float32x4_t c1s2 = vmulq_f32(c1, s2);
+
+		alignas(16) float terms[9][4];
+		vst1q_f32(terms[0], vmulq_f32(sx, vfmaq_f32(vmulq_f32(c1, c3), s1, s2s3)));
+		vst1q_f32(terms[1], vmulq_f32(sx, vmulq_f32(c2, s3)));
+		vst1q_f32(terms[2], vmulq_f32(sx, vfmsq_f32(vmulq_f32(c1, s2s3), c3, s1)));
+		vst1q_f32(terms[3], vmulq_f32(sy, vfmsq_f32(vmulq_f32(vmulq_f32(c3, s1), s2), c1, s3)));
+		vst1q_f32(terms[4], vmulq_f32(sy, vmulq_f32(c2, c3)));
+		vst1q_f32(terms[5], vmulq_f32(sy, vfmaq_f32(vmulq_f32(s1, s3), c1s2, c3)));
+		vst1q_f32(terms[6], vmulq_f32(sz, vmulq_f32(c2, s1)));
+		vst1q_f32(terms[7], vmulq_f32(sz, vnegq_f32(s2)));
+		vst1q_f32(terms[8], vmulq_f32(sz, vmulq_f32(c1, c2)));
+
+		for(uint32_t lane = 0; lane < laneCount; lane++) {
+			RveMatrixTerms laneTerms{
+				terms[0][lane], terms[1][lane], terms[2][lane],
+				terms[3][lane], terms[4][lane], terms[5][lane],
+				terms[6][lane], terms[7][lane], terms[8][lane]
+			};
+			uint32_t index = first + lane;
+			StoreMatrix(laneTerms, components[0][index], components[1][index], components[2][index], out[index]);
+		}
+	}
+#endif
+
+	void RveTransformStore::Resize(uint32_t newCount) {
+		uint32_t padded = (newCount + batchPadding - 1) / batchPadding * batchPadding;
+		static constexpr float defaults[ComponentCount] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+		for(int component = 0; component < ComponentCount; component++) {
+			components[component].resize(padded, defaults[component]);
+		}
+		dirty.resize(padded, 0);
+		for(uint32_t i = count; i < newCount; i++) {
+			dirty[i] = 1;
+		}
+		worldMatrices.resize(newCount, glm::mat4{1.0f});
+		count = newCount;
+	}
+
+	void RveTransformStore::Set(uint32_t index, const TransformComponent& transform) {
+		assert(index < count && "(rve_transform_store.cpp) Transform index out of range");
+		const float values[ComponentCount] = {
+			transform.translation.x, transform.translation.y, transform.translation.z,
+			transform.rotation.x, transform.rotation.y, transform.rotation.z,
+			transform.scale.x, transform.scale.y, transform.scale.z
+		};
+		for(int component = 0; component < ComponentCount; component++) {
+			if(components[component][index] != values[component]) {
+				components[component][index] = values[component];
+				dirty[index] = 1;
+			}
+		}
+	}
+
+	TransformComponent RveTransformStore::Get(uint32_t index) const {
+		assert(index < count && "(rve_transform_store.cpp) Transform index out of range");
+		TransformComponent transform{};
+		transform.translation = {components[TranslationX][index], components[TranslationY][index], components[TranslationZ][index]};
+		transform.rotation = {components[RotationX][index], components[RotationY][index], components[RotationZ][index]};
+		transform.scale = {components[ScaleX][index], components[ScaleY][index], components[ScaleZ][index]};
+		return transform;
+	}
+
+	void RveTransformStore::Update() {
+		const float *pointers[ComponentCount];
+		for(int component = 0; component < ComponentCount; component++) {
+			pointers[component] = components[component].data();
+		}
+		lastUpdateCount = 0;
+
+	#ifdef RVE_TRANSFORM_AVX2
+		static const bool hasAvx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		if(hasAvx2) {
+			for(uint32_t first = 0; first < count; first += 8) {
+				uint64_t dirtyBatch;
+				std::memcpy(&dirtyBatch, dirty.data() + first, sizeof(dirtyBatch));
+				if(dirtyBatch == 0) {
+					continue;
+				}
+				uint32_t laneCount = std::min(8u, count - first);
+				BuildBatchAvx2(pointers, first, laneCount, worldMatrices.data());
+				std::memset(dirty.data() + first, 0, 8);
+				lastUpdateCount += laneCount;
+			}
+			return;
+		}
+	#endif
+	#ifdef RVE_TRANSFORM_NEON
+		for(uint32_t first = 0; first < count; first += 4) {
+			uint32_t dirtyBatch;
+			std::memcpy(&dirtyBatch, dirty.data() + first, sizeof(dirtyBatch));
+			if(dirtyBatch == 0) {
+				continue;
+			}
+			uint32_t laneCount = std::min(4u, count - first);
+			BuildBatchNeon(pointers, first, laneCount, worldMatrices.data());
+			std::memset(dirty.data() + first, 0, 4);
+			lastUpdateCount += laneCount;
+		}
+	#else
+		for(uint32_t i = 0; i < count; i++) {
+			if(dirty[i] == 0) {
+				continue;
+			}
+			BuildMatrixScalar(pointers, i, worldMatrices[i]);
+			dirty[i] = 0;
+			lastUpdateCount++;
+		}
+	#endif
+	}
+} // namespace rve
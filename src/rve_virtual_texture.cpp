@@ -0,0 +1,173 @@
+#include "../include/rve_virtual_texture.hpp"
+#include "../include/rve_block_decoder.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace rve {
+	namespace {
+		bool IsPowerOfTwo(uint32_t value) {
+			return value != 0 && (value & (value - 1)) == 0;
+		}
+
+		uint8_t LinearToSrgb(float value) {
+			value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+			return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+
+		// 2x2 box filter, sRGB colors are averaged in linear space the way RveTexture's blits filter them
+		std::vector<uint8_t> Downsample(const std::vector<uint8_t>& level, uint32_t width, uint32_t height, const float *toLinear) {
+			const uint32_t nextWidth = std::max(width / 2, 1u);
+			const uint32_t nextHeight = std::max(height / 2, 1u);
+			std::vector<uint8_t> next(static_cast<size_t>(nextWidth) * nextHeight * 4);
+			for(uint32_t y = 0; y < nextHeight; y++) {
+				const uint32_t rows[2] = {std::min(y * 2, height - 1), std::min(y * 2 + 1, height - 1)};
+				for(uint32_t x = 0; x < nextWidth; x++) {
+					const uint32_t columns[2] = {std::min(x * 2, width - 1), std::min(x * 2 + 1, width - 1)};
+					const uint8_t *texels[4] = {
+						&level[(static_cast<size_t>(rows[0]) * width + columns[0]) * 4],
+						&level[(static_cast<size_t>(rows[0]) * width + columns[1]) * 4],
+						&level[(static_cast<size_t>(rows[1]) * width + columns[0]) * 4],
+						&level[(static_cast<size_t>(rows[1]) * width + columns[1]) * 4]};
+					uint8_t *output = &next[(static_cast<size_t>(y) * nextWidth + x) * 4];
+					for(uint32_t channel = 0; channel < 4; channel++) {
+						if(toLinear != nullptr && channel < 3) {
+							float sum = 0.0f;
+							for(const uint8_t *texel : texels) {
+								sum += toLinear[texel[channel]];
+							}
+							output[channel] = LinearToSrgb(sum * 0.25f);
+						} else {
+							uint32_t sum = 2;
+							for(const uint8_t *texel : texels) {
+								sum += texel[channel];
+							}
+							output[channel] = static_cast<uint8_t>(sum / 4);
+						}
+					}
+				}
+			}
+			return next;
+		}
+	} // namespace
+
+	RveVirtualTexture::RveVirtualTexture(const std::string& filePath) : file{filePath} {
+		if(file.GetSize() < sizeof(Header)) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Not a virtual texture: " + filePath);
+		}
+		std::memcpy(&header, file.GetData(), sizeof(Header));
+		if(header.magic != magic || header.version != version) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Not a virtual texture or cooked by another version: " + filePath);
+		}
+		if(header.pageSize != pageSize || header.pageBorder != pageBorder) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Virtual texture cooked with other page dimensions: " + filePath);
+		}
+		if(!IsPowerOfTwo(header.width) || !IsPowerOfTwo(header.height) || header.mipCount == 0 || header.mipCount > maxMipCount ||
+			GetPagesWide(0) > maxPagesPerSide || GetPagesHigh(0) > maxPagesPerSide ||
+			GetPagesWide(header.mipCount - 1) != 1 || GetPagesHigh(header.mipCount - 1) != 1) {
+				throw std::runtime_error("(rve_virtual_texture.cpp) Malformed virtual texture header: " + filePath);
+		}
+		mipFirstPage.push_back(0);
+		for(uint32_t mip = 0; mip < header.mipCount; mip++) {
+			mipFirstPage.push_back(mipFirstPage.back() + GetPagesWide(mip) * GetPagesHigh(mip));
+		}
+		if(header.fileSize != file.GetSize() || sizeof(Header) + GetPageCount() * static_cast<uint64_t>(tileBytes) != header.fileSize) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Truncated virtual texture: " + filePath);
+		}
+	}
+
+	const uint8_t *RveVirtualTexture::GetTile(uint32_t page) const {
+		assert(page < GetPageCount() && "(rve_virtual_texture.cpp) Page index out of range");
+		return reinterpret_cast<const uint8_t*>(file.GetData()) + sizeof(Header) + page * tileBytes;
+	}
+
+	void RveVirtualTexture::Write(const std::string& filePath, const RveTexture::ImageData& source) {
+		const RveTexture::ImageData *image = &source;
+		RveTexture::ImageData decompressed{};
+		if(RveBlockDecoder::IsSupported(source.format)) {
+			decompressed = RveTexture::Decompress(source);
+			image = &decompressed;
+		}
+		if(image->format != VK_FORMAT_R8G8B8A8_SRGB && image->format != VK_FORMAT_R8G8B8A8_UNORM) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Virtual textures are cooked from RGBA8 or BC images");
+		}
+		if(!IsPowerOfTwo(image->width) || !IsPowerOfTwo(image->height) || std::max(image->width, image->height) < pageSize) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Virtual texture sides must be powers of two, at least one a page long");
+		}
+
+		Header fileHeader{};
+		fileHeader.magic = magic;
+		fileHeader.version = version;
+		fileHeader.format = image->format;
+		fileHeader.width = image->width;
+		fileHeader.height = image->height;
+		fileHeader.pageSize = pageSize;
+		fileHeader.pageBorder = pageBorder;
+		while(std::max(image->width, image->height) >> fileHeader.mipCount >= pageSize) {
+			fileHeader.mipCount++;
+		}
+		if(fileHeader.mipCount > maxMipCount || GetPageCount(image->width, 0) > maxPagesPerSide || GetPageCount(image->height, 0) > maxPagesPerSide) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Image is too large for a virtual texture");
+		}
+		uint64_t pageCount = 0;
+		for(uint32_t mip = 0; mip < fileHeader.mipCount; mip++) {
+			pageCount += GetPageCount(image->width, mip) * GetPageCount(image->height, mip);
+		}
+		fileHeader.fileSize = sizeof(Header) + pageCount * tileBytes;
+
+		std::array<float, 256> toLinear{};
+		for(uint32_t value = 0; value < 256; value++) {
+			float color = value / 255.0f;
+			toLinear[value] = color <= 0.04045f ? color / 12.92f : std::pow((color + 0.055f) / 1.055f, 2.4f);
+		}
+		const float *srgbTable = image->format == VK_FORMAT_R8G8B8A8_SRGB ? toLinear.data() : nullptr;
+
+		// Written next to the target and renamed like mesh caches, tiles are streamed out a mip at a time
+		const std::string temporaryPath = filePath + ".tmp";
+		{
+			std::ofstream output{temporaryPath, std::ios::binary | std::ios::trunc};
+			if(!output.is_open()) {
+				throw std::runtime_error("(rve_virtual_texture.cpp) Failed to write " + temporaryPath);
+			}
+			output.write(reinterpret_cast<const char*>(&fileHeader), sizeof(Header));
+
+			const uint8_t *levelBytes = image->bytes.data() + image->levels[0].offset;
+			std::vector<uint8_t> level(levelBytes, levelBytes + image->levels[0].size);
+			std::vector<uint8_t> tile(tileBytes);
+			for(uint32_t mip = 0; mip < fileHeader.mipCount; mip++) {
+				const int32_t levelWidth = static_cast<int32_t>(std::max(image->width >> mip, 1u));
+				const int32_t levelHeight = static_cast<int32_t>(std::max(image->height >> mip, 1u));
+				for(uint32_t pageY = 0; pageY < GetPageCount(image->height, mip); pageY++) {
+					for(uint32_t pageX = 0; pageX < GetPageCount(image->width, mip); pageX++) {
+						// Borders and the part of a page past a level narrower than a page repeat the edge texels
+						for(int32_t tileY = 0; tileY < static_cast<int32_t>(tileSize); tileY++) {
+							int32_t sourceY = std::clamp(static_cast<int32_t>(pageY * pageSize + tileY) - static_cast<int32_t>(pageBorder), 0, levelHeight - 1);
+							for(int32_t tileX = 0; tileX < static_cast<int32_t>(tileSize); tileX++) {
+								int32_t sourceX = std::clamp(static_cast<int32_t>(pageX * pageSize + tileX) - static_cast<int32_t>(pageBorder), 0, levelWidth - 1);
+								std::memcpy(
+									&tile[(static_cast<size_t>(tileY) * tileSize + tileX) * 4],
+									&level[(static_cast<size_t>(sourceY) * levelWidth + sourceX) * 4],
+									4);
+							}
+						}
+						output.write(reinterpret_cast<const char*>(tile.data()), tile.size());
+					}
+				}
+				if(mip + 1 < fileHeader.mipCount) {
+					level = Downsample(level, levelWidth, levelHeight, srgbTable);
+				}
+			}
+			if(!output) {
+				throw std::runtime_error("(rve_virtual_texture.cpp) Failed to write " + temporaryPath);
+			}
+		}
+		if(std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+			throw std::runtime_error("(rve_virtual_texture.cpp) Failed to replace " + filePath);
+		}
+	}
+} // namespace rve
@@ -1,4 +1,5 @@
 #include "../include/rve_vulkan_device.hpp"
+#include "../include/rve_swap_chain.hpp"
 
 #include <cstring>
 #include <iostream>
@@ -47,9 +48,12 @@ namespace rve {
 		PickPhysicalDevice();
 		CreateLogicalDevice();
 		CreateCommandPool();
+		deletionQueue = std::make_unique<RveDeletionQueue>(device_, RveSwapChain::MAX_FRAMES_IN_FLIGHT);
 	}
 
 	RveVulkanDevice::~RveVulkanDevice() {
+		vkDeviceWaitIdle(device_);
+		deletionQueue.reset();
 		vkDestroyCommandPool(device_, commandPool, nullptr);
 		vkDestroyDevice(device_, nullptr);
 
@@ -72,7 +76,7 @@ namespace rve {
 		appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		appInfo.apiVersion = VK_API_VERSION_1_1;
 
 		VkInstanceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -142,18 +146,64 @@ namespace rve {
 			queueCreateInfos.push_back(queueCreateInfo);
 		}
 
+		VkPhysicalDeviceFeatures supportedFeatures;
+		vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures deviceFeatures = {};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+		// Block compressed textures are uploaded as is when available, decompressed on load otherwise
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+		// The bindless fragment shader writes virtual texture page requests to a storage buffer
+		deviceFeatures.fragmentStoresAndAtomics = supportedFeatures.fragmentStoresAndAtomics;
+		// The bindless shaders index the storage buffer array with slots from push constants
+		deviceFeatures.shaderStorageBufferArrayDynamicIndexing = supportedFeatures.shaderStorageBufferArrayDynamicIndexing;
+		enabledFeatures = deviceFeatures;
+
+		// Descriptor indexing is optional, the bindless path is only used when every feature it needs is present
+		std::vector<const char *> enabledExtensions = deviceExtensions;
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures = {};
+		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		if (properties.apiVersion >= VK_API_VERSION_1_1
+				&& IsDeviceExtensionAvailable(physicalDevice, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+			VkPhysicalDeviceDescriptorIndexingFeaturesEXT supportedIndexing = {};
+			supportedIndexing.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+			VkPhysicalDeviceFeatures2 supportedFeatures2 = {};
+			supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			supportedFeatures2.pNext = &supportedIndexing;
+			vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures2);
+
+			bindlessSupported = supportedIndexing.runtimeDescriptorArray
+				&& supportedIndexing.descriptorBindingPartiallyBound
+				&& supportedIndexing.descriptorBindingStorageBufferUpdateAfterBind
+				&& supportedIndexing.descriptorBindingSampledImageUpdateAfterBind
+				&& supportedIndexing.shaderSampledImageArrayNonUniformIndexing
+				&& supportedFeatures.fragmentStoresAndAtomics
+				&& supportedFeatures.shaderStorageBufferArrayDynamicIndexing;
+			if (bindlessSupported) {
+				indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+				indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+				indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+				indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+				indexingFeatures.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+				enabledExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+				// Required by descriptor indexing on 1.0 devices, core from 1.1 but harmless to list
+				if (IsDeviceExtensionAvailable(physicalDevice, VK_KHR_MAINTENANCE3_EXTENSION_NAME)) {
+					enabledExtensions.push_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+				}
+			}
+		}
 
 		VkDeviceCreateInfo createInfo = {};
 		createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		createInfo.pNext = bindlessSupported ? &indexingFeatures : nullptr;
 
 		createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 		createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
 		createInfo.pEnabledFeatures = &deviceFeatures;
-		createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-		createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+		createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+		createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 		// might not really be necessary anymore because device specific validation layers
 		// have been deprecated
@@ -310,6 +360,21 @@ namespace rve {
 		return requiredExtensions.empty();
 	}
 
+	bool RveVulkanDevice::IsDeviceExtensionAvailable(VkPhysicalDevice device, const char *extensionName) {
+		uint32_t extensionCount;
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+		for (const auto &extension : availableExtensions) {
+			if (std::strcmp(extension.extensionName, extensionName) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	QueueFamilyIndices RveVulkanDevice::FindQueueFamilies(VkPhysicalDevice device) {
 		QueueFamilyIndices indices;
 
@@ -459,12 +524,13 @@ namespace rve {
 		vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
 	}
 
-	void RveVulkanDevice::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+	void RveVulkanDevice::CopyBuffer(
+			VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset) {
 		VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
 
 		VkBufferCopy copyRegion{};
-		copyRegion.srcOffset = 0;	// Optional
-		copyRegion.dstOffset = 0;	// Optional
+		copyRegion.srcOffset = srcOffset;
+		copyRegion.dstOffset = dstOffset;
 		copyRegion.size = size;
 		vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 